@@ -0,0 +1,111 @@
+#include "SauceTool.h"
+#include "BenchRes.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// BatchFilterBench, Compares filtering an array of SAUCE structs one record at a time against
+// filtering the columns of a SAUCE_Batch with SAUCE_Batch_select_equal(), SAUCE_Batch_select_range()
+// and SAUCE_Batch_select_prefix(). No files are read, and each call filters every record.
+//
+// Usage: BatchFilterBench [records] [rounds]
+
+
+// Default number of generated records
+#define DEFAULT_RECORDS     1000000
+
+// Ways of filtering the records
+#define FILTER_DATATYPE     0
+#define FILTER_DATE         1
+#define FILTER_TITLE        2
+
+
+static SAUCE* records = NULL;
+static uint64_t* bitmap = NULL;
+static volatile int64_t sink;
+
+
+// Select records from the array of structs, setting the same bitmap as the batch functions
+static int64_t select_rows(uint32_t count, int how) {
+  int64_t selected = 0;
+  for (uint32_t w = 0; w < SAUCE_BITMAP_WORDS(count); w++) {
+    uint64_t bits = 0;
+    for (uint32_t j = 0; j < 64 && w * 64 + j < count; j++) {
+      const SAUCE* sauce = &records[w * 64 + j];
+      int match;
+      if (how == FILTER_DATATYPE) {
+        match = sauce->DataType == SAUCE_DT_CHARACTER;
+      } else if (how == FILTER_DATE) {
+        match = memcmp(sauce->Date, "19900101", 8) >= 0 && memcmp(sauce->Date, "19991231", 8) <= 0;
+      } else {
+        match = memcmp(sauce->Title, "ACiD", 4) == 0;
+      }
+      bits |= (uint64_t)match << j;
+      selected += match;
+    }
+    bitmap[w] = bits;
+  }
+  return selected;
+}
+
+
+static int64_t select_batch(const SAUCE_Batch* batch, int how) {
+  if (how == FILTER_DATATYPE) return SAUCE_Batch_select_equal(batch, SAUCE_FIELD_DATATYPE, SAUCE_DT_CHARACTER, bitmap);
+  if (how == FILTER_DATE) return SAUCE_Batch_select_range(batch, SAUCE_FIELD_DATE, 19900101, 19991231, bitmap);
+  return SAUCE_Batch_select_prefix(batch, SAUCE_FIELD_TITLE, "ACiD", bitmap);
+}
+
+
+static void run(const char* name, int how, const SAUCE_Batch* batch, uint32_t count, uint32_t rounds) {
+  uint64_t start = bench_now_ns();
+  for (uint32_t r = 0; r < rounds; r++) {
+    sink = (batch != NULL) ? select_batch(batch, how) : select_rows(count, how);
+  }
+  bench_report(name, rounds, bench_now_ns() - start, 0, 0, 0);
+}
+
+
+int main(int argc, char** argv) {
+  uint32_t count = DEFAULT_RECORDS, rounds = SAUCE_BENCH_DEFAULT_ROUNDS;
+  if (argc > 1) count = (uint32_t)strtoul(argv[1], NULL, 10);
+  if (argc > 2) rounds = (uint32_t)strtoul(argv[2], NULL, 10);
+  if (count == 0) count = DEFAULT_RECORDS;
+  if (rounds == 0) rounds = SAUCE_BENCH_DEFAULT_ROUNDS;
+
+  SAUCE_Batch* batch = NULL;
+  records = malloc(sizeof(SAUCE) * (size_t)count);
+  bitmap = malloc(sizeof(uint64_t) * SAUCE_BITMAP_WORDS(count));
+  if (records == NULL || bitmap == NULL || SAUCE_Batch_create(count, &batch) != 0) {
+    fprintf(stderr, "Failed to allocate %u records\n", (unsigned)count);
+    free(records);
+    free(bitmap);
+    return 1;
+  }
+
+  // records with a spread of types, dates and titles
+  for (uint32_t i = 0; i < count; i++) {
+    SAUCE* sauce = &records[i];
+    SAUCE_set_default(sauce);
+    sauce->DataType = (uint8_t)(i * 7 % 9);
+    sauce->FileType = (uint8_t)(i % 3);
+    char date[9];
+    snprintf(date, sizeof(date), "%04u%02u%02u", 1980 + i % 45, 1 + i % 12, 1 + i % 28);
+    memcpy(sauce->Date, date, sizeof(sauce->Date));
+    memcpy(sauce->Title, (i % 5 == 0) ? "ACiD" : "iCE", (i % 5 == 0) ? 4 : 3);
+  }
+  SAUCE_Batch_append(batch, records, count);
+
+  printf("BatchFilterBench: %u records, %u rounds\n", (unsigned)count, (unsigned)rounds);
+  run("rows DataType ==", FILTER_DATATYPE, NULL, count, rounds);
+  run("SAUCE_Batch_select_equal DataType", FILTER_DATATYPE, batch, count, rounds);
+  run("rows Date range", FILTER_DATE, NULL, count, rounds);
+  run("SAUCE_Batch_select_range Date", FILTER_DATE, batch, count, rounds);
+  run("rows Title prefix", FILTER_TITLE, NULL, count, rounds);
+  run("SAUCE_Batch_select_prefix Title", FILTER_TITLE, batch, count, rounds);
+
+  SAUCE_Batch_free(batch);
+  free(records);
+  free(bitmap);
+  SAUCE_clear_error();
+  return 0;
+}
@@ -0,0 +1,190 @@
+#include "BenchRes.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+  #include <unistd.h>
+  #include <sys/stat.h>
+  #define BENCH_POSIX
+#endif
+
+#if defined (__linux__)
+  #include <fcntl.h>
+  #define BENCH_FADVISE
+#endif
+
+
+static void bench_make_dir(const char* path) {
+  #ifdef BENCH_POSIX
+  mkdir(path, 0755);
+  #else
+  (void)path;
+  #endif
+}
+
+
+// Generate `count` files. If `tree` is true, half of the files are split between two large
+// subdirectories and the rest are spread over small subdirectories of 20 files each.
+static int bench_corpus_generate(BenchCorpus* corpus, uint32_t count, int tree) {
+  corpus->count = 0;
+  corpus->dirs = 0;
+  corpus->paths = calloc(count, sizeof(char*));
+  if (corpus->paths == NULL) return -1;
+
+  bench_make_dir(SAUCE_BENCH_CORPUS_DIR);
+
+  char content[65536];
+  char comment[SAUCE_COMMENT_STRING_LENGTH(4) + 1];
+  memset(comment, 'c', sizeof(comment) - 1);
+  comment[sizeof(comment) - 1] = 0;
+
+  SAUCE sauce;
+  SAUCE_set_default(&sauce);
+  memcpy(sauce.Title, "Benchmark", 9);
+  memcpy(sauce.Author, "SauceTool", 9);
+
+  srand(1234);
+  for (uint32_t i = 0; i < count; i++) {
+    char path[256];
+    if (tree) {
+      uint32_t dir = (i < count / 2) ? i % 2 : 2 + (i - count / 2) / 20;
+      snprintf(path, sizeof(path), "%s/dir%05u", SAUCE_BENCH_CORPUS_DIR, (unsigned)dir);
+      if (dir >= corpus->dirs) {
+        bench_make_dir(path);
+        corpus->dirs = dir + 1;
+      }
+      snprintf(path, sizeof(path), "%s/dir%05u/file%05u.ans", SAUCE_BENCH_CORPUS_DIR, (unsigned)dir, (unsigned)i);
+    } else {
+      snprintf(path, sizeof(path), "%s/file%05u.ans", SAUCE_BENCH_CORPUS_DIR, (unsigned)i);
+    }
+
+    // content between 1KB and 64KB
+    size_t length = 1024 + (size_t)(rand() % (65536 - 1024));
+    for (size_t j = 0; j < length; j++) content[j] = (char)('A' + (j % 26));
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) return -1;
+    size_t written = fwrite(content, 1, length, file);
+    fclose(file);
+    if (written != length) return -1;
+
+    sauce.FileSize = (uint32_t)length;
+    if (i % 3 == 1 && SAUCE_fwrite(path, &sauce) < 0) return -1;
+    if (i % 3 == 2) {
+      if (SAUCE_fwrite(path, &sauce) < 0) return -1;
+      if (SAUCE_Comment_fwrite(path, comment, 4) < 0) return -1;
+    }
+
+    corpus->paths[i] = malloc(strlen(path) + 1);
+    if (corpus->paths[i] == NULL) return -1;
+    strcpy(corpus->paths[i], path);
+    corpus->count++;
+  }
+
+  return 0;
+}
+
+
+int bench_corpus_create(BenchCorpus* corpus, uint32_t count) {
+  return bench_corpus_generate(corpus, count, 0);
+}
+
+
+int bench_corpus_create_tree(BenchCorpus* corpus, uint32_t count) {
+  return bench_corpus_generate(corpus, count, 1);
+}
+
+
+void bench_corpus_destroy(BenchCorpus* corpus) {
+  for (uint32_t i = 0; i < corpus->count; i++) {
+    remove(corpus->paths[i]);
+    free(corpus->paths[i]);
+  }
+  free(corpus->paths);
+  corpus->paths = NULL;
+  corpus->count = 0;
+  for (uint32_t i = 0; i < corpus->dirs; i++) {
+    char path[256];
+    snprintf(path, sizeof(path), "%s/dir%05u", SAUCE_BENCH_CORPUS_DIR, (unsigned)i);
+    remove(path);
+  }
+  corpus->dirs = 0;
+  remove(SAUCE_BENCH_CORPUS_DIR);
+}
+
+
+int bench_corpus_drop_cache(const BenchCorpus* corpus) {
+  #ifdef BENCH_FADVISE
+  for (uint32_t i = 0; i < corpus->count; i++) {
+    int fd = open(corpus->paths[i], O_RDONLY);
+    if (fd < 0) return -1;
+    // dirty pages cannot be dropped, so write them back first
+    fdatasync(fd);
+    int res = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+    if (res != 0) return -1;
+  }
+  return 0;
+  #else
+  (void)corpus;
+  return -1;
+  #endif
+}
+
+
+uint64_t bench_now_ns(void) {
+  #ifdef BENCH_POSIX
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+  #else
+  return (uint64_t)clock() * (1000000000ULL / CLOCKS_PER_SEC);
+  #endif
+}
+
+
+int bench_syscall_counts(uint64_t* reads, uint64_t* writes) {
+  // Linux keeps per-process counts of read and write system calls in /proc/self/io
+  FILE* file = fopen("/proc/self/io", "r");
+  if (file == NULL) return -1;
+
+  char line[128];
+  int found = 0;
+  while (fgets(line, sizeof(line), file) != NULL) {
+    unsigned long long value;
+    if (sscanf(line, "syscr: %llu", &value) == 1) {
+      *reads = value;
+      found++;
+    } else if (sscanf(line, "syscw: %llu", &value) == 1) {
+      *writes = value;
+      found++;
+    }
+  }
+  fclose(file);
+
+  return (found == 2) ? 0 : -1;
+}
+
+
+void bench_report(const char* name, uint64_t calls, uint64_t elapsed_ns, uint64_t reads, uint64_t writes, int have_counts) {
+  double per_call = (calls > 0) ? (double)elapsed_ns / (double)calls : 0.0;
+  if (have_counts) {
+    printf("%-36s %10llu calls %10.0f ns/call %8.2f read syscalls/call %8.2f write syscalls/call\n",
+      name, (unsigned long long)calls, per_call,
+      (double)reads / (double)calls, (double)writes / (double)calls);
+  } else {
+    printf("%-36s %10llu calls %10.0f ns/call\n", name, (unsigned long long)calls, per_call);
+  }
+}
+
+
+void bench_parse_args(int argc, char** argv, uint32_t* files, uint32_t* rounds) {
+  *files = SAUCE_BENCH_DEFAULT_FILES;
+  *rounds = SAUCE_BENCH_DEFAULT_ROUNDS;
+  if (argc > 1) *files = (uint32_t)strtoul(argv[1], NULL, 10);
+  if (argc > 2) *rounds = (uint32_t)strtoul(argv[2], NULL, 10);
+  if (*files == 0) *files = SAUCE_BENCH_DEFAULT_FILES;
+  if (*rounds == 0) *rounds = SAUCE_BENCH_DEFAULT_ROUNDS;
+}
@@ -0,0 +1,56 @@
+#ifndef SAUCE_BENCH_RES_HEADER_INCLUDED
+#define SAUCE_BENCH_RES_HEADER_INCLUDED
+#include <stdint.h>
+#include "SauceTool.h"
+
+// Shared helpers for the benchmark executables
+
+
+// Directory that generated corpus files are written to, relative to the working directory
+#define SAUCE_BENCH_CORPUS_DIR    "bench_corpus"
+
+// Default number of files in a generated corpus
+#define SAUCE_BENCH_DEFAULT_FILES   3000
+
+// Default number of passes made over a corpus
+#define SAUCE_BENCH_DEFAULT_ROUNDS  5
+
+
+// A generated corpus of files. A third of the files have no SAUCE data, a third have
+// only a record and a third have a record and a comment.
+typedef struct BenchCorpus {
+  char**    paths;
+  uint32_t  count;
+  uint32_t  dirs;     // number of subdirectories the files were written to
+} BenchCorpus;
+
+
+// Generate `count` files in SAUCE_BENCH_CORPUS_DIR. Return 0 on success.
+int bench_corpus_create(BenchCorpus* corpus, uint32_t count);
+
+// Generate `count` files in an unbalanced tree of subdirectories of SAUCE_BENCH_CORPUS_DIR: half
+// of the files are in two large directories, and the rest are in many directories of 20 files.
+// Return 0 on success.
+int bench_corpus_create_tree(BenchCorpus* corpus, uint32_t count);
+
+// Remove the files of a corpus and free its paths
+void bench_corpus_destroy(BenchCorpus* corpus);
+
+// Write back and then drop the corpus files from the page cache, so the next access has to
+// go to the disk. Return 0 on success, or -1 if this is not supported on this system.
+int bench_corpus_drop_cache(const BenchCorpus* corpus);
+
+// Get a monotonic timestamp in nanoseconds
+uint64_t bench_now_ns(void);
+
+// Get the number of read and write system calls made by this process so far.
+// Return 0 on success, or -1 if the counters are not available on this system.
+int bench_syscall_counts(uint64_t* reads, uint64_t* writes);
+
+// Print a single result line
+void bench_report(const char* name, uint64_t calls, uint64_t elapsed_ns, uint64_t reads, uint64_t writes, int have_counts);
+
+// Parse the optional [files] [rounds] command line arguments
+void bench_parse_args(int argc, char** argv, uint32_t* files, uint32_t* rounds);
+
+#endif //SAUCE_BENCH_RES_HEADER_INCLUDED
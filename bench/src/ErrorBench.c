@@ -0,0 +1,75 @@
+#include "SauceTool.h"
+#include "BenchRes.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// ErrorBench, Measures the cost of the error path by reading files and buffers that have no
+// SAUCE data, where every call ends in SAUCE_ERMISS. Also measures reading the error message
+// of every call with SAUCE_get_error(), which is when the message is formatted.
+//
+// Usage: ErrorBench [files] [rounds]
+
+
+// Size of the buffer read by the buffer runs
+#define BUFFER_SIZE     4096
+
+// Ways of reading
+#define READ_FILE           0
+#define CHECK_FILE          1
+#define READ_BUFFER         2
+#define READ_BUFFER_ERROR   3
+
+
+static SAUCE record;
+static char buffer[BUFFER_SIZE];
+static volatile size_t sink;
+
+
+static void run(const char* name, int how, const BenchCorpus* corpus, uint32_t rounds) {
+  uint64_t calls = 0;
+  uint64_t start = bench_now_ns();
+  for (uint32_t r = 0; r < rounds; r++) {
+    // only the first of every three corpus files has no SAUCE data
+    for (uint32_t i = 0; i < corpus->count; i += 3) {
+      if (how == READ_FILE) {
+        SAUCE_fread(corpus->paths[i], &record);
+      } else if (how == CHECK_FILE) {
+        SAUCE_check_file(corpus->paths[i]);
+      } else {
+        SAUCE_read(buffer, BUFFER_SIZE, &record);
+        if (how == READ_BUFFER_ERROR) sink += strlen(SAUCE_get_error());
+      }
+      calls++;
+    }
+  }
+  bench_report(name, calls, bench_now_ns() - start, 0, 0, 0);
+}
+
+
+int main(int argc, char** argv) {
+  uint32_t files, rounds;
+  bench_parse_args(argc, argv, &files, &rounds);
+
+  BenchCorpus corpus = { NULL, 0, 0 };
+  if (bench_corpus_create(&corpus, files) != 0) {
+    fprintf(stderr, "Failed to create the benchmark corpus in %s\n", SAUCE_BENCH_CORPUS_DIR);
+    bench_corpus_destroy(&corpus);
+    return 1;
+  }
+  memset(buffer, 'A', sizeof(buffer));
+
+  printf("ErrorBench: %u files, %u rounds\n", (unsigned)files, (unsigned)rounds);
+
+  // warm the page cache
+  for (uint32_t i = 0; i < corpus.count; i++) SAUCE_fread(corpus.paths[i], &record);
+
+  run("SAUCE_fread (no SAUCE)", READ_FILE, &corpus, rounds);
+  run("SAUCE_check_file (no SAUCE)", CHECK_FILE, &corpus, rounds);
+  run("SAUCE_read (no SAUCE)", READ_BUFFER, &corpus, rounds * 100);
+  run("SAUCE_read + SAUCE_get_error", READ_BUFFER_ERROR, &corpus, rounds * 100);
+
+  bench_corpus_destroy(&corpus);
+  SAUCE_clear_error();
+  return 0;
+}
@@ -0,0 +1,108 @@
+#include "SauceTool.h"
+#include "BenchRes.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// FileBatchBench, Compares reading the records and comments of a corpus one file at a time with
+// SAUCE_fread() and SAUCE_Comment_fread() against reading them all at once with SAUCE_fread_many()
+// and SAUCE_Comment_fread_many(), on a warm and a cold page cache.
+//
+// Usage: FileBatchBench [files] [rounds]
+
+
+// Ways of reading the corpus
+#define READ_EACH_RECORD        0
+#define READ_RECORD_BATCH       1
+#define READ_RECORD_BATCH_POOL  2
+#define READ_EACH_COMMENT       3
+#define READ_COMMENT_BATCH      4
+
+// Number of comment lines read from each file
+#define COMMENT_LINES           4
+
+
+static SAUCE record;
+static SAUCE* records = NULL;
+static int* results = NULL;
+static char* comments = NULL;
+
+
+static void run(const char* name, int how, const BenchCorpus* corpus, uint32_t rounds, int cold) {
+  uint64_t reads = 0, writes = 0, elapsed = 0;
+  int have_counts = 1;
+
+  SAUCE_BatchOptions options;
+  memset(&options, 0, sizeof(options));
+  options.disable_uring = (how == READ_RECORD_BATCH_POOL);
+
+  for (uint32_t r = 0; r < rounds; r++) {
+    if (cold && bench_corpus_drop_cache(corpus) != 0) return;
+
+    uint64_t reads_before = 0, writes_before = 0, reads_after = 0, writes_after = 0;
+    have_counts = have_counts && bench_syscall_counts(&reads_before, &writes_before) == 0;
+
+    uint64_t start = bench_now_ns();
+    if (how == READ_RECORD_BATCH || how == READ_RECORD_BATCH_POOL) {
+      SAUCE_fread_many((const char* const*)corpus->paths, corpus->count, records, results, &options);
+    } else if (how == READ_COMMENT_BATCH) {
+      SAUCE_Comment_fread_many((const char* const*)corpus->paths, corpus->count, comments, COMMENT_LINES, results, &options);
+    } else {
+      for (uint32_t i = 0; i < corpus->count; i++) {
+        if (how == READ_EACH_RECORD) SAUCE_fread(corpus->paths[i], &record);
+        else SAUCE_Comment_fread(corpus->paths[i], comments, COMMENT_LINES);
+      }
+    }
+    elapsed += bench_now_ns() - start;
+
+    have_counts = have_counts && bench_syscall_counts(&reads_after, &writes_after) == 0;
+    reads += reads_after - reads_before;
+    writes += writes_after - writes_before;
+  }
+
+  char label[64];
+  snprintf(label, sizeof(label), "%s %s", cold ? "cold" : "warm", name);
+  bench_report(label, (uint64_t)rounds * corpus->count, elapsed, reads, writes, have_counts);
+}
+
+
+int main(int argc, char** argv) {
+  uint32_t files, rounds;
+  bench_parse_args(argc, argv, &files, &rounds);
+
+  BenchCorpus corpus = { NULL, 0, 0 };
+  records = malloc(sizeof(SAUCE) * files);
+  results = malloc(sizeof(int) * files);
+  comments = malloc((SAUCE_COMMENT_STRING_LENGTH(COMMENT_LINES) + 1) * (size_t)files);
+  if (records == NULL || results == NULL || comments == NULL || bench_corpus_create(&corpus, files) != 0) {
+    fprintf(stderr, "Failed to create the benchmark corpus in %s\n", SAUCE_BENCH_CORPUS_DIR);
+    bench_corpus_destroy(&corpus);
+    free(records);
+    free(results);
+    free(comments);
+    return 1;
+  }
+
+  printf("FileBatchBench: %u files, %u rounds\n", (unsigned)files, (unsigned)rounds);
+  if (bench_corpus_drop_cache(&corpus) != 0) {
+    printf("The page cache cannot be dropped on this system, cold runs are skipped\n");
+  }
+
+  // warm the page cache
+  for (uint32_t i = 0; i < corpus.count; i++) SAUCE_fread(corpus.paths[i], &record);
+
+  for (int cold = 0; cold <= 1; cold++) {
+    run("SAUCE_fread", READ_EACH_RECORD, &corpus, rounds, cold);
+    run("SAUCE_fread_many", READ_RECORD_BATCH, &corpus, rounds, cold);
+    run("SAUCE_fread_many (threads)", READ_RECORD_BATCH_POOL, &corpus, rounds, cold);
+    run("SAUCE_Comment_fread", READ_EACH_COMMENT, &corpus, rounds, cold);
+    run("SAUCE_Comment_fread_many", READ_COMMENT_BATCH, &corpus, rounds, cold);
+  }
+
+  bench_corpus_destroy(&corpus);
+  free(records);
+  free(results);
+  free(comments);
+  SAUCE_clear_error();
+  return 0;
+}
@@ -0,0 +1,115 @@
+#include "SauceTool.h"
+#include "BenchRes.h"
+#include <stdio.h>
+#include <string.h>
+
+// FileModeBench, Compares the ways the file functions can access files on a warm and a cold page cache.
+//
+// Usage: FileModeBench [files] [rounds]
+//
+// FileModeBench runs every SAUCE_FileMode that is supported on this system. FileModeBenchStdio is
+// the same benchmark linked against a copy of the library built with SAUCE_USE_STDIO, which
+// measures the C standard I/O (FILE*) path.
+//
+// For the cold runs, the corpus is dropped from the page cache before every round, which is not
+// included in the timings. Cold runs are skipped if the page cache cannot be dropped.
+
+
+typedef int (*bench_fn)(const char* path);
+
+static SAUCE record;
+static char comment[SAUCE_COMMENT_STRING_LENGTH(255) + 1];
+
+
+static int bench_fread(const char* path) {
+  return SAUCE_fread(path, &record);
+}
+
+static int bench_comment_fread(const char* path) {
+  return SAUCE_Comment_fread(path, comment, 255);
+}
+
+static int bench_check_file(const char* path) {
+  return SAUCE_check_file(path);
+}
+
+static int bench_fwrite(const char* path) {
+  return SAUCE_fwrite(path, &record);
+}
+
+
+static void run(const char* mode, const char* name, bench_fn fn, const BenchCorpus* corpus, uint32_t rounds, int cold) {
+  uint64_t reads = 0, writes = 0, elapsed = 0;
+  int have_counts = 1;
+
+  for (uint32_t r = 0; r < rounds; r++) {
+    if (cold && bench_corpus_drop_cache(corpus) != 0) return;
+
+    uint64_t reads_before = 0, writes_before = 0, reads_after = 0, writes_after = 0;
+    have_counts = have_counts && bench_syscall_counts(&reads_before, &writes_before) == 0;
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < corpus->count; i++) {
+      fn(corpus->paths[i]);
+    }
+    elapsed += bench_now_ns() - start;
+
+    have_counts = have_counts && bench_syscall_counts(&reads_after, &writes_after) == 0;
+    reads += reads_after - reads_before;
+    writes += writes_after - writes_before;
+  }
+
+  char label[64];
+  snprintf(label, sizeof(label), "%s %s %s", mode, cold ? "cold" : "warm", name);
+  bench_report(label, (uint64_t)rounds * corpus->count, elapsed, reads, writes, have_counts);
+}
+
+
+static void run_mode(const char* mode, const BenchCorpus* corpus, uint32_t rounds) {
+  // warm the page cache
+  for (uint32_t i = 0; i < corpus->count; i++) bench_fread(corpus->paths[i]);
+
+  run(mode, "SAUCE_fread", bench_fread, corpus, rounds, 0);
+  run(mode, "SAUCE_Comment_fread", bench_comment_fread, corpus, rounds, 0);
+  run(mode, "SAUCE_check_file", bench_check_file, corpus, rounds, 0);
+  run(mode, "SAUCE_fwrite", bench_fwrite, corpus, rounds, 0);
+
+  run(mode, "SAUCE_fread", bench_fread, corpus, rounds, 1);
+  run(mode, "SAUCE_Comment_fread", bench_comment_fread, corpus, rounds, 1);
+  run(mode, "SAUCE_check_file", bench_check_file, corpus, rounds, 1);
+}
+
+
+int main(int argc, char** argv) {
+  uint32_t files, rounds;
+  bench_parse_args(argc, argv, &files, &rounds);
+
+  BenchCorpus corpus;
+  if (bench_corpus_create(&corpus, files) != 0) {
+    fprintf(stderr, "Failed to create the benchmark corpus in %s\n", SAUCE_BENCH_CORPUS_DIR);
+    bench_corpus_destroy(&corpus);
+    return 1;
+  }
+
+  SAUCE_set_default(&record);
+  memcpy(record.Title, "Benchmark", 9);
+
+  printf("FileModeBench: %u files, %u rounds\n", (unsigned)files, (unsigned)rounds);
+  if (bench_corpus_drop_cache(&corpus) != 0) {
+    printf("The page cache cannot be dropped on this system, cold runs are skipped\n");
+  }
+
+  #ifdef SAUCE_USE_STDIO
+  run_mode("stdio", &corpus, rounds);
+  #else
+  run_mode("default", &corpus, rounds);
+  if (SAUCE_set_file_mode(SAUCE_FM_MMAP) == 0) {
+    run_mode("mmap", &corpus, rounds);
+    SAUCE_set_file_mode(SAUCE_FM_DEFAULT);
+  }
+  #endif
+
+  bench_corpus_destroy(&corpus);
+  SAUCE_clear_error();
+  return 0;
+}
@@ -0,0 +1,78 @@
+#include "SauceTool.h"
+#include "BenchRes.h"
+#include <stdio.h>
+#include <string.h>
+
+// FileReadBench, Measures the cost of the file functions over a generated corpus.
+//
+// Usage: FileReadBench [files] [rounds]
+//
+// On Linux, the number of read/write system calls per call is reported as well. For a
+// full breakdown of every system call, run the benchmark under `strace -c -f`.
+
+
+typedef int (*bench_fn)(const char* path);
+
+static SAUCE record;
+static char comment[SAUCE_COMMENT_STRING_LENGTH(255) + 1];
+
+
+static int bench_fread(const char* path) {
+  return SAUCE_fread(path, &record);
+}
+
+static int bench_comment_fread(const char* path) {
+  return SAUCE_Comment_fread(path, comment, 255);
+}
+
+static int bench_check_file(const char* path) {
+  return SAUCE_check_file(path);
+}
+
+static int bench_fwrite(const char* path) {
+  return SAUCE_fwrite(path, &record);
+}
+
+
+static void run(const char* name, bench_fn fn, const BenchCorpus* corpus, uint32_t rounds) {
+  uint64_t reads_before = 0, writes_before = 0, reads_after = 0, writes_after = 0;
+  int have_counts = bench_syscall_counts(&reads_before, &writes_before) == 0;
+
+  uint64_t start = bench_now_ns();
+  for (uint32_t r = 0; r < rounds; r++) {
+    for (uint32_t i = 0; i < corpus->count; i++) {
+      fn(corpus->paths[i]);
+    }
+  }
+  uint64_t elapsed = bench_now_ns() - start;
+
+  if (have_counts) have_counts = bench_syscall_counts(&reads_after, &writes_after) == 0;
+  bench_report(name, (uint64_t)rounds * corpus->count, elapsed,
+    reads_after - reads_before, writes_after - writes_before, have_counts);
+}
+
+
+int main(int argc, char** argv) {
+  uint32_t files, rounds;
+  bench_parse_args(argc, argv, &files, &rounds);
+
+  BenchCorpus corpus;
+  if (bench_corpus_create(&corpus, files) != 0) {
+    fprintf(stderr, "Failed to create the benchmark corpus in %s\n", SAUCE_BENCH_CORPUS_DIR);
+    bench_corpus_destroy(&corpus);
+    return 1;
+  }
+
+  SAUCE_set_default(&record);
+  memcpy(record.Title, "Benchmark", 9);
+
+  printf("FileReadBench: %u files, %u rounds\n", (unsigned)files, (unsigned)rounds);
+  run("SAUCE_fread", bench_fread, &corpus, rounds);
+  run("SAUCE_Comment_fread", bench_comment_fread, &corpus, rounds);
+  run("SAUCE_check_file", bench_check_file, &corpus, rounds);
+  run("SAUCE_fwrite", bench_fwrite, &corpus, rounds);
+
+  bench_corpus_destroy(&corpus);
+  SAUCE_clear_error();
+  return 0;
+}
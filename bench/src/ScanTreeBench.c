@@ -0,0 +1,125 @@
+#include "SauceTool.h"
+#include "BenchRes.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+  #include <unistd.h>
+  #define BENCH_SLEEP
+#endif
+
+// ScanTreeBench, Compares reading the records of an unbalanced directory tree one file at a time with
+// SAUCE_fread() against scanning the tree with SAUCE_scan_tree(), on a warm and a cold page cache.
+//
+// Usage: ScanTreeBench [files] [rounds]
+//
+// Half of the files are in two large directories and the rest are in many small directories, so a
+// scanner that hands out whole directories to its threads would leave most of them idle.
+//
+// The cached runs scan through a SAUCE_Cache that was filled by an earlier scan, as a rescan of an
+// unchanged tree would.
+
+
+// Cache file used by the cached runs, outside of the scanned tree
+#define SCAN_CACHE_PATH   SAUCE_BENCH_CORPUS_DIR ".cache"
+
+
+static SAUCE record;
+
+
+static int count_records(const SAUCE_ScanEntry* entry, void* data) {
+  if (entry->record_exists) __atomic_fetch_add((uint64_t*)data, 1, __ATOMIC_RELAXED);
+  return 0;
+}
+
+
+static void run(const char* name, uint32_t threads, const BenchCorpus* corpus, uint32_t rounds, int cold) {
+  uint64_t reads = 0, writes = 0, elapsed = 0;
+  int have_counts = 1;
+
+  SAUCE_ScanOptions options;
+  memset(&options, 0, sizeof(options));
+  options.threads = threads;
+
+  for (uint32_t r = 0; r < rounds; r++) {
+    if (cold && bench_corpus_drop_cache(corpus) != 0) return;
+
+    uint64_t reads_before = 0, writes_before = 0, reads_after = 0, writes_after = 0;
+    have_counts = have_counts && bench_syscall_counts(&reads_before, &writes_before) == 0;
+
+    uint64_t found = 0;
+    uint64_t start = bench_now_ns();
+    if (strstr(name, "SAUCE_fread") != NULL) {
+      for (uint32_t i = 0; i < corpus->count; i++) {
+        SAUCE_fread(corpus->paths[i], &record);
+      }
+    } else if (SAUCE_scan_tree(SAUCE_BENCH_CORPUS_DIR, count_records, &found, &options) < 0) {
+      printf("%s failed: %s\n", name, SAUCE_get_error());
+      return;
+    }
+    elapsed += bench_now_ns() - start;
+
+    have_counts = have_counts && bench_syscall_counts(&reads_after, &writes_after) == 0;
+    reads += reads_after - reads_before;
+    writes += writes_after - writes_before;
+  }
+
+  char label[64];
+  if (threads > 0) {
+    snprintf(label, sizeof(label), "%s %s (%u threads)", cold ? "cold" : "warm", name, (unsigned)threads);
+  } else {
+    snprintf(label, sizeof(label), "%s %s", cold ? "cold" : "warm", name);
+  }
+  bench_report(label, (uint64_t)rounds * corpus->count, elapsed, reads, writes, have_counts);
+}
+
+
+int main(int argc, char** argv) {
+  uint32_t files, rounds;
+  bench_parse_args(argc, argv, &files, &rounds);
+
+  BenchCorpus corpus;
+  if (bench_corpus_create_tree(&corpus, files) != 0) {
+    fprintf(stderr, "Failed to create the benchmark corpus in %s\n", SAUCE_BENCH_CORPUS_DIR);
+    bench_corpus_destroy(&corpus);
+    return 1;
+  }
+
+  printf("ScanTreeBench: %u files in %u directories, %u rounds\n", (unsigned)files, (unsigned)corpus.dirs, (unsigned)rounds);
+  if (bench_corpus_drop_cache(&corpus) != 0) {
+    printf("The page cache cannot be dropped on this system, cold runs are skipped\n");
+  }
+
+  // warm the page cache
+  for (uint32_t i = 0; i < corpus.count; i++) SAUCE_fread(corpus.paths[i], &record);
+
+  for (int cold = 0; cold <= 1; cold++) {
+    run("SAUCE_fread", 0, &corpus, rounds, cold);
+    run("SAUCE_scan_tree", 1, &corpus, rounds, cold);
+    run("SAUCE_scan_tree", 4, &corpus, rounds, cold);
+    run("SAUCE_scan_tree", 16, &corpus, rounds, cold);
+  }
+
+  // cache entries are only used once their files have gone unchanged for 2 seconds
+  SAUCE_Cache* cache;
+  remove(SCAN_CACHE_PATH);
+  if (SAUCE_Cache_open(SCAN_CACHE_PATH, &cache) == 0) {
+    #ifdef BENCH_SLEEP
+    sleep(3);
+    #endif
+    SAUCE_set_cache(cache);
+    run("SAUCE_scan_tree", 1, &corpus, 1, 0);
+    for (int cold = 0; cold <= 1; cold++) {
+      run("cached SAUCE_fread", 0, &corpus, rounds, cold);
+      run("cached SAUCE_scan_tree", 1, &corpus, rounds, cold);
+      run("cached SAUCE_scan_tree", 16, &corpus, rounds, cold);
+    }
+    SAUCE_Cache_save(cache);
+    SAUCE_Cache_close(cache);
+    remove(SCAN_CACHE_PATH);
+  }
+
+  bench_corpus_destroy(&corpus);
+  SAUCE_clear_error();
+  return 0;
+}
@@ -7,6 +7,7 @@
 #ifndef SAUCE_PARSE_HEADER_INCLUDED
 #define SAUCE_PARSE_HEADER_INCLUDED
 #include <stdint.h>
+#include <stddef.h>
 
 
 // Data structures
@@ -37,6 +38,221 @@ typedef struct SAUCE {
 #pragma pack(pop)
 
 
+/**
+ * @brief An on-disk cache of the decoded SAUCE data of files. See `SAUCE_Cache_open()`.
+ * 
+ */
+typedef struct SAUCE_Cache SAUCE_Cache;
+
+
+/**
+ * @brief Holds the last error, file mode, cache and durability used by the `_ctx` functions. See `SAUCE_Context_create()`.
+ * 
+ */
+typedef struct SAUCE_Context SAUCE_Context;
+
+
+/**
+ * @brief Struct of options for the batch functions, such as `SAUCE_fread_many()` and `SAUCE_fpatch_many()`. A zeroed struct gives the defaults.
+ * 
+ */
+typedef struct SAUCE_BatchOptions {
+  uint32_t      threads;          // Largest number of threads to read with, including the calling thread. 0 uses every thread in the pool.
+  int           disable_uring;    // True to never read through io_uring, only with the thread pool
+  int           durability;       // A SAUCE_Durability constant for the files written by SAUCE_fpatch_many() and SAUCE_fremove_many()
+} SAUCE_BatchOptions;
+
+
+/**
+ * @brief Struct describing a file found by `SAUCE_scan_tree()`.
+ * 
+ */
+typedef struct SAUCE_ScanEntry {
+  const char*   path;             // Path of the file, starting with the root directory that was scanned
+  int64_t       filesize;         // Size of the file in bytes
+  int           result;           // 0 if the file contains valid SAUCE data. Otherwise, the negative error code describing why it does not.
+  int           record_exists;    // True if the file contains a record, even if its comment is invalid
+  SAUCE         record;           // The record of the file, if `record_exists` is true
+  uint8_t       comment_lines;    // The number of comment lines in the file, or 0 if it has no valid comment
+  const char*   comment;          // The comment lines, not null-terminated. NULL if `comment_lines` is 0.
+} SAUCE_ScanEntry;
+
+
+/**
+ * @brief Function called by `SAUCE_scan_tree()` for every file. `entry` and its strings are only valid during
+ *        the call. Return 0 to continue the scan, or non-zero to stop it.
+ * 
+ */
+typedef int (*SAUCE_ScanCallback)(const SAUCE_ScanEntry* entry, void* data);
+
+
+/**
+ * @brief Struct of options for `SAUCE_scan_tree()`. A zeroed struct gives the defaults.
+ * 
+ */
+typedef struct SAUCE_ScanOptions {
+  uint32_t      threads;          // Number of threads to scan with, including the calling thread. 0 uses two per online processor.
+  int           follow_links;     // True to report symbolic links to regular files. Links to directories are never followed.
+  int           include_hidden;   // True to scan files and directories whose names start with '.'
+} SAUCE_ScanOptions;
+
+
+typedef struct SAUCE_Watcher SAUCE_Watcher;
+
+
+/**
+ * @brief Events reported by `SAUCE_Watcher_poll()`.
+ * 
+ */
+enum SAUCE_WatchEvent {
+  SAUCE_WATCH_CHANGED = 0,        // A file was written or moved into the tree. The entry holds its SAUCE data.
+  SAUCE_WATCH_REMOVED = 1,        // A file was deleted or moved out of the tree. Only the entry's path is set.
+  SAUCE_WATCH_DIR_REMOVED = 2,    // A directory was deleted or moved out of the tree, along with every file beneath it
+  SAUCE_WATCH_OVERFLOW = 3        // Events were lost and the tree should be scanned again. The entry's path is the root.
+};
+
+
+/**
+ * @brief Function called by `SAUCE_Watcher_poll()` for every event. `entry` and its strings are only valid
+ *        during the call. Return 0 to continue, or non-zero to leave the remaining events for the next poll.
+ * 
+ */
+typedef int (*SAUCE_WatchCallback)(enum SAUCE_WatchEvent event, const SAUCE_ScanEntry* entry, void* data);
+
+
+/**
+ * @brief Struct of options for `SAUCE_Watcher_open()`. A zeroed struct gives the defaults.
+ * 
+ */
+typedef struct SAUCE_WatchOptions {
+  uint32_t      delay_ms;         // Milliseconds a file must go without events before it is reported. 0 uses 100.
+  int           follow_links;     // True to report symbolic links to regular files. Links to directories are never followed.
+  int           include_hidden;   // True to watch files and directories whose names start with '.'
+} SAUCE_WatchOptions;
+
+
+/**
+ * @brief A columnar batch of records, where each field of the records is stored in its own array.
+ *        Record `i` of a batch is found at index `i` of every numeric column, and at `i` times the
+ *        width of the field in the `SAUCE` struct in every string column. See `SAUCE_Batch_create()`.
+ *        The columns should only be read.
+ * 
+ */
+typedef struct SAUCE_Batch {
+  uint64_t      count;            // Number of records in the batch
+  uint64_t      capacity;         // Number of records the columns have room for. Always a multiple of 64.
+  uint8_t*      DataType;         // DataType of every record
+  uint8_t*      FileType;         // FileType of every record
+  uint8_t*      Comments;         // Comments of every record
+  uint8_t*      TFlags;           // TFlags of every record
+  uint16_t*     TInfo1;           // TInfo1 of every record
+  uint16_t*     TInfo2;           // TInfo2 of every record
+  uint16_t*     TInfo3;           // TInfo3 of every record
+  uint16_t*     TInfo4;           // TInfo4 of every record
+  uint32_t*     FileSize;         // FileSize of every record
+  uint32_t*     Date;             // Date of every record as the number CCYYMMDD, or 0 if the date is not 8 digits
+  char*         DateText;         // Date of every record as written in the record, 8 characters each
+  char*         Version;          // Version of every record, 2 characters each
+  char*         Title;            // Title of every record, 35 characters each
+  char*         Author;           // Author of every record, 20 characters each
+  char*         Group;            // Group of every record, 20 characters each
+  char*         TInfoS;           // TInfoS of every record, 22 characters each
+} SAUCE_Batch;
+
+
+/**
+ * @brief The SAUCE data at the end of a buffer, found by `SAUCE_view()` without copying it.
+ *        Every pointer points into the buffer, and is only valid as long as the buffer is.
+ * 
+ */
+typedef struct SAUCE_View {
+  const SAUCE*  record;           // The record at the end of the buffer, or NULL if there is none
+  const char*   comment;          // The first comment line, after the COMNT id, or NULL if there is no comment
+  uint8_t       lines;            // Number of comment lines `comment` points to, or 0 if there is no comment
+} SAUCE_View;
+
+
+/**
+ * @brief Iterates over the lines of the comment of a `SAUCE_View`. See `SAUCE_Comment_iter_init()`.
+ * 
+ */
+typedef struct SAUCE_CommentIter {
+  const char*   next;             // The next line to be returned
+  uint8_t       remaining;        // Number of lines left to return
+} SAUCE_CommentIter;
+
+
+/**
+ * @brief Where the SAUCE data at the end of a file or buffer is. See `SAUCE_flayout()`.
+ * 
+ */
+typedef struct SAUCE_Layout {
+  int           record_exists;    // True if a record was found
+  int           comment_exists;   // True if a valid comment was found
+  int           eof_exists;       // True if an EOF character is immediately before the SAUCE data
+  uint8_t       lines;            // Number of comment lines claimed by the record
+  int64_t       start;            // Offset of the SAUCE data, or the size of the file if there is no record
+  uint32_t      sauce_length;     // Length of the SAUCE data, not including the EOF character
+  int64_t       content_length;   // Length of the contents before the EOF character and SAUCE data
+} SAUCE_Layout;
+
+
+/**
+ * @brief A parser of SAUCE data in content that is fed to it in chunks. See `SAUCE_Stream_open()`.
+ * 
+ */
+typedef struct SAUCE_Stream SAUCE_Stream;
+
+
+/**
+ * @brief Writer of content that appends SAUCE data to it when it is finished. See `SAUCE_Writer_open()`.
+ * 
+ */
+typedef struct SAUCE_Writer SAUCE_Writer;
+
+
+/**
+ * @brief Changes to the SAUCE data of a file that are applied together. See `SAUCE_Edit_open()`.
+ * 
+ */
+typedef struct SAUCE_Edit SAUCE_Edit;
+
+
+/**
+ * @brief Function called by a `SAUCE_Stream` or a `SAUCE_Writer` with the next bytes of its output. `content`
+ *        is only valid during the call. Return 0 to continue, or non-zero to stop the stream or writer.
+ * 
+ */
+typedef int (*SAUCE_StreamCallback)(const char* content, size_t n, void* data);
+
+
+/**
+ * @brief Function that allocates `size` bytes for the library, aligned for any type. Return NULL on failure.
+ *        `user` is the pointer given to `SAUCE_set_allocator()`.
+ * 
+ */
+typedef void* (*SAUCE_MallocFunction)(size_t size, void* user);
+
+
+/**
+ * @brief Function that frees an allocation made by a `SAUCE_MallocFunction`. See `SAUCE_set_allocator()`.
+ * 
+ */
+typedef void (*SAUCE_FreeFunction)(void* ptr, void* user);
+
+
+/**
+ * @brief Allocations made by the library on the calling thread. See `SAUCE_get_alloc_stats()`.
+ * 
+ */
+typedef struct SAUCE_AllocStats {
+  uint64_t      allocations;      // Number of allocations
+  uint64_t      frees;            // Number of frees
+  uint64_t      bytes_allocated;  // Number of bytes allocated, not including the allocator's overhead
+  uint64_t      bytes_freed;      // Number of bytes freed
+} SAUCE_AllocStats;
+
+
 
 
 // Constants and Helpful Macros
@@ -153,6 +369,53 @@ enum SAUCE_FileType {
 };
 
 
+/**
+ * @brief Enum constants for the ways the file functions can access files. See `SAUCE_set_file_mode()`.
+ * 
+ */
+enum SAUCE_FileMode {
+  SAUCE_FM_DEFAULT,         // Read and write the end of files with positioned reads and writes
+  SAUCE_FM_MMAP             // Map the end of files into memory. Only available on POSIX systems.
+};
+
+
+/**
+ * @brief Enum constants for how written files are synced to storage. See `SAUCE_set_durability()`.
+ * 
+ */
+enum SAUCE_Durability {
+  SAUCE_DURABLE_NONE,       // Leave written data for the system to sync
+  SAUCE_DURABLE_FILE,       // Sync each file before the function writing it returns
+  SAUCE_DURABLE_GROUP       // Start syncing each file of a batch once it is written, and wait for many files together
+};
+
+
+/**
+ * @brief Enum constants for the record fields a `SAUCE_Batch` can be filtered by, and that can be patched
+ *        with `SAUCE_fpatch()`.
+ * 
+ */
+enum SAUCE_Field {
+  SAUCE_FIELD_DATATYPE,     // Numeric, the DataType column
+  SAUCE_FIELD_FILETYPE,     // Numeric, the FileType column
+  SAUCE_FIELD_COMMENTS,     // Numeric, the Comments column
+  SAUCE_FIELD_TFLAGS,       // Numeric, the TFlags column
+  SAUCE_FIELD_TINFO1,       // Numeric, the TInfo1 column
+  SAUCE_FIELD_TINFO2,       // Numeric, the TInfo2 column
+  SAUCE_FIELD_TINFO3,       // Numeric, the TInfo3 column
+  SAUCE_FIELD_TINFO4,       // Numeric, the TInfo4 column
+  SAUCE_FIELD_FILESIZE,     // Numeric, the FileSize column
+  SAUCE_FIELD_DATE,         // Numeric, the Date column (CCYYMMDD)
+  SAUCE_FIELD_TITLE,        // String, the Title column
+  SAUCE_FIELD_AUTHOR,       // String, the Author column
+  SAUCE_FIELD_GROUP,        // String, the Group column
+  SAUCE_FIELD_TINFOS        // String, the TInfoS column
+};
+
+// Get the bit of a SAUCE_Field in the field mask given to `SAUCE_fpatch()`
+#define SAUCE_FIELD_BIT(field)        (1U << (field))
+
+
 // The required value for the SAUCE record ID field
 #define SAUCE_RECORD_ID               "SAUCE"
 
@@ -179,6 +442,13 @@ enum SAUCE_FileType {
 // Determine how large a record and optional comment 
 #define SAUCE_TOTAL_SIZE(lines)                 ((uint16_t)SAUCE_RECORD_SIZE + SAUCE_COMMENT_BLOCK_SIZE(lines))
 
+// The largest number of bytes SAUCE data can take up at the end of a file: an EOF character,
+// a CommentBlock with 255 lines and a record.
+#define SAUCE_MAX_TAIL_SIZE                     (SAUCE_TOTAL_SIZE(255) + 1)
+
+// Determine how many 64-bit words a selection bitmap needs for a batch of `count` records
+#define SAUCE_BITMAP_WORDS(count)               (((uint64_t)(count) + 63) / 64)
+
 
 // Error Codes
 
@@ -191,19 +461,25 @@ enum SAUCE_FileType {
 #define SAUCE_EEMPTY    -7    // The file was empty
 #define SAUCE_EOTHER    -8    // An error occurred, please call SAUCE_get_error() for latest error message
 
+// Returned instead of 0 by the file write functions when the SAUCE data already matched, so nothing was written
+#define SAUCE_UNCHANGED  1
+
 
 // Helper Functions
 
 /**
- * @brief Get an error message about the last SAUCE error that occurred.
+ * @brief Get an error message about the last SAUCE error that occurred on the calling thread.
+ *        Every thread has its own error, so errors on other threads do not change it.
  * 
- * @return an error message, or an empty string if no SAUCE error has occurred yet
+ * @return an error message, or an empty string if no SAUCE error has occurred yet. The message
+ *         is valid until the next SAUCE error on the calling thread.
  */
 const char* SAUCE_get_error(void);
 
 
 /**
- * @brief Clear the last error message. Will do nothing if no SAUCE error has occurred yet.
+ * @brief Clear the last error message of the calling thread. Will do nothing if no SAUCE error
+ *        has occurred yet.
  * 
  */
 void SAUCE_clear_error(void);
@@ -229,6 +505,127 @@ void SAUCE_set_default(SAUCE* sauce);
 uint8_t SAUCE_num_lines(const char* string);
 
 
+/**
+ * @brief Set how the file and file descriptor functions access files. By default, the end of a file
+ *        is read and written with positioned reads and writes (`SAUCE_FM_DEFAULT`).
+ * 
+ *        In `SAUCE_FM_MMAP` mode, only the pages at the end of a file are mapped into memory and
+ *        the SAUCE data is decoded directly from the mapping. Writes grow the file with a truncate
+ *        if needed and copy the new SAUCE data into a mapping of the end of the file. Files that
+ *        cannot be mapped will be accessed as in `SAUCE_FM_DEFAULT` mode.
+ * 
+ * @param mode a SAUCE_FileMode constant
+ * @return 0 on success. On error, a negative error code is returned, and the mode is not changed.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_set_file_mode(enum SAUCE_FileMode mode);
+
+
+/**
+ * @brief Get how the file and file descriptor functions access files. See `SAUCE_set_file_mode()`.
+ * 
+ * @return the current SAUCE_FileMode
+ */
+enum SAUCE_FileMode SAUCE_get_file_mode(void);
+
+
+/**
+ * @brief Set how the file and file descriptor write and remove functions sync the files they change. By default,
+ *        nothing is synced (`SAUCE_DURABLE_NONE`). Batches use the stronger of this and their own `durability` option.
+ * 
+ *        With `SAUCE_DURABLE_FILE`, a changed file is synced before the function returns. With `SAUCE_DURABLE_GROUP`,
+ *        the batch functions start writing each changed file back as soon as it is written, and sync up to 64 files
+ *        of each thread together, so their syncs overlap. Fewer files are kept open when the process may only open a
+ *        few files at once. Single files are synced as with `SAUCE_DURABLE_FILE`.
+ * 
+ *        Either way, the content of a file in front of its SAUCE data is never overwritten, and a change is only
+ *        known to be kept once the function returns. Changes that stay inside the record, and SAUCE data that is only
+ *        appended or cut off, are written in place, and a crash during the write can leave a partly written record.
+ *        For any other change, a copy of the new SAUCE data is written past the end of the file and synced before
+ *        the data is moved into place, and the copy is then cut off. A crash while the copy is written can leave
+ *        part of it at the end of the file, and a crash after that leaves the new SAUCE data at the end. If the
+ *        change adds an EOF character in front of SAUCE data that had none, the old record can then be left in the
+ *        content, in front of the new SAUCE data.
+ * 
+ * @param durability a SAUCE_Durability constant
+ * @return 0 on success. On error, a negative error code is returned, and the durability is not changed.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_set_durability(enum SAUCE_Durability durability);
+
+
+/**
+ * @brief Get how the file and file descriptor write and remove functions sync files. See `SAUCE_set_durability()`.
+ * 
+ * @return the current SAUCE_Durability
+ */
+enum SAUCE_Durability SAUCE_get_durability(void);
+
+
+/**
+ * @brief Set the cache used by the file and file descriptor read and check functions, by
+ *        `SAUCE_fread_many()`, `SAUCE_Comment_fread_many()` and by `SAUCE_scan_tree()`.
+ * 
+ *        A file whose device, inode, size, modification time and status change time match its cache
+ *        entry is answered from the cache. Records are then read without opening the file, and comments
+ *        are read with a single read of only the comment lines. Other files are read as usual and their
+ *        entries are added to the cache. Files that changed less than two seconds before they were read
+ *        are read again until they settle, since a change made within the same timestamp tick would not
+ *        change their key.
+ * 
+ *        Setting the cache is not thread-safe, but a cache can be used by several threads and contexts at
+ *        once. Every context using a cache must stop using it before it is closed.
+ * 
+ * @param cache a cache opened with `SAUCE_Cache_open()`, or NULL to stop using a cache
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_set_cache(SAUCE_Cache* cache);
+
+
+/**
+ * @brief Get the cache used by the file functions. See `SAUCE_set_cache()`.
+ * 
+ * @return the current cache, or NULL if no cache is used
+ */
+SAUCE_Cache* SAUCE_get_cache(void);
+
+
+/**
+ * @brief Set the functions every allocation of the library goes through, such as the allocations of caches,
+ *        watchers, batches, streams, writers, contexts and tree scans. The read, write, remove and check
+ *        functions do not allocate at all. By default, `malloc()` and `free()` are used.
+ * 
+ *        The allocator must only be changed while no other thread is using the library, and while no object
+ *        allocated with the previous allocator is open, since it will be freed with the new allocator.
+ * 
+ * @param mallocFn allocation function, or NULL to use `malloc()`
+ * @param freeFn function that frees allocations made by `mallocFn`, or NULL to use `free()`
+ * @param user passed to `mallocFn` and `freeFn`
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_set_allocator(SAUCE_MallocFunction mallocFn, SAUCE_FreeFunction freeFn, void* user);
+
+
+/**
+ * @brief Get the allocations made by the library on the calling thread since its stats were last reset.
+ *        Allocations made by the worker threads of a call, such as `SAUCE_scan_tree()`, are counted for the
+ *        thread that made the call. Reset the stats before a call and get them after it to count the
+ *        allocations of that call.
+ * 
+ * @param stats will be set to the calling thread's stats
+ */
+void SAUCE_get_alloc_stats(SAUCE_AllocStats* stats);
+
+
+/**
+ * @brief Set the calling thread's allocation stats to zero. See `SAUCE_get_alloc_stats()`.
+ * 
+ */
+void SAUCE_reset_alloc_stats(void);
+
+
 
 
 
@@ -263,95 +660,332 @@ int SAUCE_Comment_fread(const char* filepath, char* comment, uint8_t nLines);
 
 
 /**
- * @brief From the first `n` bytes of a buffer, read a SAUCE record into `sauce`.
+ * @brief From a file descriptor, read a SAUCE record into `sauce`. The end of the file is read
+ *        with a positioned read, so the offset of `fd` is left unchanged on POSIX systems.
  * 
- * @param buffer pointer to a buffer
- * @param n the length of the buffer
+ * @param fd a file descriptor open for reading
  * @param sauce a SAUCE struct that will be filled with the parsed SAUCE record
  * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
  *         to get more info on the error.
  */
-int SAUCE_read(const char* buffer, uint32_t n, SAUCE* sauce);
+int SAUCE_fd_read(int fd, SAUCE* sauce);
 
 
 /**
- * @brief From the first `n` bytes of a buffer, read at most `nLines` of a SAUCE CommentBlock into `comment`.
+ * @brief From a file descriptor, read at most `nLines` of a SAUCE CommentBlock into `comment`.
  *        A null character will be appended onto `comment` as well.
  * 
  * 
- *        If the buffer does not contain a comment or the actual number of lines is less than nLines, 
- *        then expect 0 lines or all lines to be read, respectively.
+ *        If the file does not contain a comment or the actual number of lines is less
+ *        than `nLines`, then expect 0 lines or all lines to be read, respectively.
  * 
- * @param buffer pointer to a buffer
- * @param n the length of the buffer
+ * @param fd a file descriptor open for reading
  * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1` that will contain the comment
  * @param nLines the number of lines to read
  * @return On success, the number of lines read. On error, a negative error code is returned. Use `SAUCE_get_error()`
  *         to get more info on the error.
  */
-int SAUCE_Comment_read(const char* buffer, uint32_t n, char* comment, uint8_t nLines);
+int SAUCE_Comment_fd_read(int fd, char* comment, uint8_t nLines);
 
 
+/**
+ * @brief Read the SAUCE records of many files at once. `records[i]` will be filled with the record of
+ *        `filepaths[i]`, and `results[i]` will be set to the result of reading `filepaths[i]`, which is
+ *        the same value `SAUCE_fread()` would return for that file. No per-file error messages are set,
+ *        so batches can be read from several threads at once.
+ * 
+ *        On Linux, the files are opened, stat-ed, read and closed in large batches through io_uring.
+ *        If io_uring is not available at runtime, the files are read by a pool of threads using
+ *        positioned reads. The pool is started by the first batch that needs it and is shared by
+ *        every batch. Otherwise, the files are read one at a time.
+ * 
+ * @param filepaths an array of `count` paths
+ * @param count the number of files
+ * @param records an array of `count` SAUCE structs
+ * @param results an array of `count` result codes
+ * @param options options for the batch. If NULL, every option will be 0.
+ * @return On success, the number of records that were read. On error, a negative error code is returned.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_fread_many(const char* const* filepaths, uint32_t count, SAUCE* records, int* results, const SAUCE_BatchOptions* options);
 
 
+/**
+ * @brief Read at most `nLines` of the SAUCE CommentBlocks of many files at once. The comment of
+ *        `filepaths[i]` will be copied to `&comments[i * (SAUCE_COMMENT_STRING_LENGTH(nLines) + 1)]`
+ *        followed by a null character, and `results[i]` will be set to the result of reading
+ *        `filepaths[i]`, which is the same value `SAUCE_Comment_fread()` would return for that file.
+ *        No per-file error messages are set, so batches can be read from several threads at once.
+ * 
+ * @param filepaths an array of `count` paths
+ * @param count the number of files
+ * @param comments a buffer of at least size `count * (SAUCE_COMMENT_STRING_LENGTH(nLines) + 1)`
+ * @param nLines the number of lines to read from each file
+ * @param results an array of `count` result codes
+ * @param options options for the batch. If NULL, every option will be 0.
+ * @return On success, the number of files whose comment was read, including files with a record but
+ *         no comment. On error, a negative error code is returned. Use `SAUCE_get_error()` to get more
+ *         info on the error.
+ */
+int SAUCE_Comment_fread_many(const char* const* filepaths, uint32_t count, char* comments, uint8_t nLines, int* results,
+                             const SAUCE_BatchOptions* options);
 
-// Write Functions
 
 /**
- * @brief Write a SAUCE record to a file. If the file already contains a SAUCE record, the record will be replaced.
- *        An EOF character will be added if the file previously did not contain a SAUCE record.
+ * @brief Scan a directory tree and report every regular file in it to `callback`, along with the SAUCE data
+ *        found in the file. Only the tail of each file is read. Subdirectories are scanned, but symbolic links
+ *        to directories are never followed.
  * 
- * @param filepath a path to a file
- * @param sauce a SAUCE struct
+ *        The tree is walked by a pool of threads that steal work from each other, so large directories are
+ *        shared between threads. `callback` is called from every thread, possibly at the same time, so it
+ *        must be thread-safe unless `options->threads` is 1. Return non-zero from `callback` to stop the scan.
+ *        Only available on POSIX systems.
+ * 
+ * @param root path to the root directory
+ * @param callback function called for every file, with data that is only valid during the call
+ * @param data passed to every call of `callback`
+ * @param options options for the scan. If NULL, every option will be 0.
+ * @return On success, the number of files passed to `callback`. On error, a negative error code is returned.
+ *         Use `SAUCE_get_error()` to get more info on the error. Directories that cannot be read are skipped,
+ *         and an error message is set without failing the scan.
+ */
+int64_t SAUCE_scan_tree(const char* root, SAUCE_ScanCallback callback, void* data, const SAUCE_ScanOptions* options);
+
+
+/**
+ * @brief From the first `n` bytes of a buffer, read a SAUCE record into `sauce`.
+ * 
+ * @param buffer pointer to a buffer
+ * @param n the length of the buffer
+ * @param sauce a SAUCE struct that will be filled with the parsed SAUCE record
  * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
  *         to get more info on the error.
  */
-int SAUCE_fwrite(const char* filepath, const SAUCE* sauce);
+int SAUCE_read(const char* buffer, uint32_t n, SAUCE* sauce);
 
 
 /**
- * @brief Write a SAUCE CommentBlock to a file, replacing a CommentBlock if one already exists.
- *        The "Comments" field of the file's SAUCE record will be updated to `lines`.
- *        
+ * @brief From the first `n` bytes of a buffer, read a SAUCE record into `sauce`. Same as `SAUCE_read()`,
+ *        but for buffers that may be larger than 4GB.
  * 
- * @param filepath a path to a file
- * @param comment a comment buffer that is as least `SAUCE_COMMENT_STRING_LENGTH(lines)` bytes long
- * @param lines the number of lines to write
+ * @param buffer pointer to a buffer
+ * @param n the length of the buffer
+ * @param sauce a SAUCE struct that will be filled with the parsed SAUCE record
  * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
  *         to get more info on the error.
  */
-int SAUCE_Comment_fwrite(const char* filepath, const char* comment, uint8_t lines);
+int SAUCE_read64(const char* buffer, size_t n, SAUCE* sauce);
 
 
 /**
- * @brief Write a SAUCE record to a buffer. 
+ * @brief From the first `n` bytes of a buffer, read at most `nLines` of a SAUCE CommentBlock into `comment`.
+ *        A null character will be appended onto `comment` as well.
  * 
  * 
- *        If the last 128 bytes of the buffer (bytes `n-1` to `n-128`)
- *        contain a SAUCE record, the buffer's SAUCE record will be replaced. Otherwise, an EOF character and
- *        the new SAUCE record will be appended to the buffer at index `n`.
- *        Important! - To prevent a buffer overflow error when appending a new record, 
- *        the buffer's actual size must be at least n + 129 bytes (the size of a SAUCE record including an EOF character).
+ *        If the buffer does not contain a comment or the actual number of lines is less than nLines, 
+ *        then expect 0 lines or all lines to be read, respectively.
  * 
- * @param buffer pointer to buffer
+ * @param buffer pointer to a buffer
  * @param n the length of the buffer
- * @param sauce a SAUCE struct
- * @return On success, the new length of the buffer is returned. On error, a negative error code
- *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1` that will contain the comment
+ * @param nLines the number of lines to read
+ * @return On success, the number of lines read. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
  */
-int SAUCE_write(char* buffer, uint32_t n, const SAUCE* sauce);
+int SAUCE_Comment_read(const char* buffer, uint32_t n, char* comment, uint8_t nLines);
 
 
 /**
- * @brief Write a SAUCE CommentBlock to a buffer, replacing a CommentBlock if one already exists.
- *        The "Comments" field of the buffer's SAUCE record will be updated to `lines`.
- * 
+ * @brief From the first `n` bytes of a buffer, read at most `nLines` of a SAUCE CommentBlock into `comment`.
+ *        Same as `SAUCE_Comment_read()`, but for buffers that may be larger than 4GB.
  * 
- *        If the last 128 bytes of the buffer (bytes `n-1` to `n-128`)
- *        contain a SAUCE record, the CommentBlock will be written. Otherwise, an
- *        error will be returned. 
- *        Important! - To prevent a buffer overflow error when writing a new comment, 
- *        the buffer's actual size must be at least `n` + `SAUCE_COMMENT_BLOCK_SIZE(number of comment lines)`.
+ * @param buffer pointer to a buffer
+ * @param n the length of the buffer
+ * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1` that will contain the comment
+ * @param nLines the number of lines to read
+ * @return On success, the number of lines read. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Comment_read64(const char* buffer, size_t n, char* comment, uint8_t nLines);
+
+
+/**
+ * @brief Find the record and comment at the end of the first `n` bytes of a buffer without copying them.
+ *        `view` is pointed at the SAUCE data inside of the buffer. Nothing is copied or allocated.
+ * 
+ *        If a record is found but its comment is invalid, `view->record` is still set and an error is returned.
+ * 
+ * @param buffer pointer to a buffer
+ * @param n the length of the buffer
+ * @param view will be set to the SAUCE data in the buffer
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_view(const char* buffer, size_t n, SAUCE_View* view);
+
+
+/**
+ * @brief Start iterating over the comment lines of a view. An iterator over a view without a comment
+ *        returns no lines.
+ * 
+ * @param view a view set by `SAUCE_view()`
+ * @param iter the iterator to initialize
+ */
+void SAUCE_Comment_iter_init(const SAUCE_View* view, SAUCE_CommentIter* iter);
+
+
+/**
+ * @brief Get the next comment line of a view. `*line` is pointed at the line inside of the buffer,
+ *        and `*length` is set to its length without any trailing spaces or null characters.
+ *        The line is not null-terminated.
+ * 
+ * @param iter an iterator started with `SAUCE_Comment_iter_init()`
+ * @param line will point to the next line
+ * @param length will be set to the length of the line, at most `SAUCE_COMMENT_LINE_LENGTH`
+ * @return 1 if a line was returned, or 0 if there are no more lines. On error, a negative error code is
+ *         returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_Comment_iter_next(SAUCE_CommentIter* iter, const char** line, uint8_t* length);
+
+
+
+
+
+// Write Functions
+
+/**
+ * @brief Write a SAUCE record to a file. If the file already contains a SAUCE record, the record will be replaced.
+ *        An EOF character will be added if the file previously did not contain a SAUCE record.
+ * 
+ * @param filepath a path to a file
+ * @param sauce a SAUCE struct
+ * @return 0 on success, or `SAUCE_UNCHANGED` if the file already contained the record and nothing was written.
+ *         On error, a negative error code is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_fwrite(const char* filepath, const SAUCE* sauce);
+
+
+/**
+ * @brief Patch fields of the SAUCE record of a file. Every field in `fields` is copied from `values` into the
+ *        record, and the other fields are left as they are. Only the last `SAUCE_RECORD_SIZE` bytes of the file
+ *        are read, and only the bytes of the record that change are written back with a single positioned write,
+ *        so any comment is never read or rewritten. If nothing changes, nothing is written.
+ * 
+ *        If the file has no record, an EOF character and a default record with the fields set are appended.
+ *        Unlike `SAUCE_fwrite()`, no EOF character is inserted in front of an existing record.
+ * 
+ * @param filepath a path to a file
+ * @param values a SAUCE struct holding the new values of the fields
+ * @param fields a mask of `SAUCE_FIELD_BIT()` values. `SAUCE_FIELD_COMMENTS` cannot be patched.
+ * @return 0 on success, or `SAUCE_UNCHANGED` if the fields already held the values and nothing was written.
+ *         On error, a negative error code is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_fpatch(const char* filepath, const SAUCE* values, uint32_t fields);
+
+
+/**
+ * @brief Patch fields of the SAUCE records of many files at once, like `SAUCE_fpatch()` does for one file.
+ *        `results[i]` will be set to the result of patching `filepaths[i]`, which is the same value
+ *        `SAUCE_fpatch()` would return for that file. No per-file error messages are set, so batches
+ *        can be patched from several threads at once.
+ * 
+ *        The files are patched by the pool of threads used by `SAUCE_fread_many()`. Otherwise, the files are
+ *        patched one at a time.
+ * 
+ * @param filepaths an array of `count` paths
+ * @param count the number of files
+ * @param values a SAUCE struct holding the new values of the fields
+ * @param fields a mask of `SAUCE_FIELD_BIT()` values. `SAUCE_FIELD_COMMENTS` cannot be patched.
+ * @param results an array of `count` result codes
+ * @param options options for the batch. If NULL, every option will be 0.
+ * @return On success, the number of files that were patched or already held the values. On error, a negative
+ *         error code is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_fpatch_many(const char* const* filepaths, uint32_t count, const SAUCE* values, uint32_t fields, int* results,
+                      const SAUCE_BatchOptions* options);
+
+
+/**
+ * @brief Write a SAUCE CommentBlock to a file, replacing a CommentBlock if one already exists.
+ *        The "Comments" field of the file's SAUCE record will be updated to `lines`.
+ *        
+ * 
+ * @param filepath a path to a file
+ * @param comment a comment buffer that is as least `SAUCE_COMMENT_STRING_LENGTH(lines)` bytes long
+ * @param lines the number of lines to write
+ * @return 0 on success, or `SAUCE_UNCHANGED` if the file already contained the comment and nothing was written.
+ *         On error, a negative error code is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_Comment_fwrite(const char* filepath, const char* comment, uint8_t lines);
+
+
+/**
+ * @brief Write a SAUCE record to a file descriptor. If the file already contains a SAUCE record, the record
+ *        will be replaced. An EOF character will be added if the file previously did not contain a SAUCE record.
+ * 
+ * @param fd a file descriptor open for reading and writing
+ * @param sauce a SAUCE struct
+ * @return 0 on success, or `SAUCE_UNCHANGED` if the file already contained the record and nothing was written.
+ *         On error, a negative error code is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_fd_write(int fd, const SAUCE* sauce);
+
+
+/**
+ * @brief Write a SAUCE CommentBlock to a file descriptor, replacing a CommentBlock if one already exists.
+ *        The "Comments" field of the file's SAUCE record will be updated to `lines`.
+ * 
+ * @param fd a file descriptor open for reading and writing
+ * @param comment a comment buffer that is as least `SAUCE_COMMENT_STRING_LENGTH(lines)` bytes long
+ * @param lines the number of lines to write
+ * @return 0 on success, or `SAUCE_UNCHANGED` if the file already contained the comment and nothing was written.
+ *         On error, a negative error code is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_Comment_fd_write(int fd, const char* comment, uint8_t lines);
+
+
+/**
+ * @brief Write a SAUCE record to a buffer. 
+ * 
+ * 
+ *        If the last 128 bytes of the buffer (bytes `n-1` to `n-128`)
+ *        contain a SAUCE record, the buffer's SAUCE record will be replaced. Otherwise, an EOF character and
+ *        the new SAUCE record will be appended to the buffer at index `n`.
+ *        Important! - To prevent a buffer overflow error when appending a new record, 
+ *        the buffer's actual size must be at least n + 129 bytes (the size of a SAUCE record including an EOF character).
+ * 
+ * @param buffer pointer to buffer
+ * @param n the length of the buffer
+ * @param sauce a SAUCE struct
+ * @return On success, the new length of the buffer is returned. On error, a negative error code
+ *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_write(char* buffer, uint32_t n, const SAUCE* sauce);
+
+
+/**
+ * @brief Write a SAUCE record to a buffer. Same as `SAUCE_write()`, but for buffers that may be larger than 4GB.
+ *        The buffer's actual size must be at least n + 129 bytes.
+ * 
+ * @param buffer pointer to buffer
+ * @param n the length of the buffer
+ * @param sauce a SAUCE struct
+ * @return On success, the new length of the buffer is returned. On error, a negative error code
+ *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_write64(char* buffer, size_t n, const SAUCE* sauce);
+
+
+/**
+ * @brief Write a SAUCE CommentBlock to a buffer, replacing a CommentBlock if one already exists.
+ *        The "Comments" field of the buffer's SAUCE record will be updated to `lines`.
+ * 
+ * 
+ *        If the last 128 bytes of the buffer (bytes `n-1` to `n-128`)
+ *        contain a SAUCE record, the CommentBlock will be written. Otherwise, an
+ *        error will be returned. 
+ *        Important! - To prevent a buffer overflow error when writing a new comment, 
+ *        the buffer's actual size must be at least `n` + `SAUCE_COMMENT_BLOCK_SIZE(number of comment lines)`.
  * 
  * @param buffer pointer to buffer
  * @param n the length of the buffer
@@ -363,6 +997,21 @@ int SAUCE_write(char* buffer, uint32_t n, const SAUCE* sauce);
 int SAUCE_Comment_write(char* buffer, uint32_t n, const char* comment, uint8_t lines);
 
 
+/**
+ * @brief Write a SAUCE CommentBlock to a buffer, replacing a CommentBlock if one already exists.
+ *        Same as `SAUCE_Comment_write()`, but for buffers that may be larger than 4GB. The buffer's
+ *        actual size must be at least `n` + `SAUCE_COMMENT_BLOCK_SIZE(number of comment lines)`.
+ * 
+ * @param buffer pointer to buffer
+ * @param n the length of the buffer
+ * @param comment a comment buffer that is as least `SAUCE_COMMENT_STRING_LENGTH(lines)` bytes long
+ * @param lines the number of lines to write
+ * @return On success, the new length of the buffer is returned. On error, a negative error code
+ *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_Comment_write64(char* buffer, size_t n, const char* comment, uint8_t lines);
+
+
 
 
 
@@ -379,6 +1028,25 @@ int SAUCE_Comment_write(char* buffer, uint32_t n, const char* comment, uint8_t l
 int SAUCE_fremove(const char* filepath);
 
 
+/**
+ * @brief Remove the SAUCE data of many files at once. `results[i]` will be set to the result of removing the
+ *        SAUCE data of `filepaths[i]`, which is the same value `SAUCE_fremove()` would return for that file.
+ *        No per-file error messages are set, so batches can be stripped from several threads at once.
+ * 
+ *        The files are stripped by the pool of threads used by `SAUCE_fread_many()`. Each file is opened once,
+ *        its tail is read with a single positioned read, and the same descriptor is truncated. If a cache is set,
+ *        files that the cache knows to have no record are not opened. Otherwise, the files are stripped one at a time.
+ * 
+ * @param filepaths an array of `count` paths
+ * @param count the number of files
+ * @param results an array of `count` result codes
+ * @param options options for the batch. If NULL, every option will be 0.
+ * @return On success, the number of files whose SAUCE data was removed. On error, a negative error code is returned.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_fremove_many(const char* const* filepaths, uint32_t count, int* results, const SAUCE_BatchOptions* options);
+
+
 /**
  * @brief Remove a SAUCE CommentBlock from a file. The "Comments" field of the file's SAUCE
  *        record will be set to 0.
@@ -390,6 +1058,28 @@ int SAUCE_fremove(const char* filepath);
 int SAUCE_Comment_fremove(const char* filepath);
 
 
+/**
+ * @brief Remove a SAUCE record from a file descriptor, along with the SAUCE CommentBlock if one exists.
+ *        The EOF character will be removed as well.
+ * 
+ * @param fd a file descriptor open for reading and writing
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_fd_remove(int fd);
+
+
+/**
+ * @brief Remove a SAUCE CommentBlock from a file descriptor. The "Comments" field of the file's SAUCE
+ *        record will be set to 0.
+ * 
+ * @param fd a file descriptor open for reading and writing
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Comment_fd_remove(int fd);
+
+
 /**
  * @brief Remove a SAUCE record from the first `n` bytes of a buffer, 
  *        along with the SAUCE CommentBlock if it exists. The EOF character will be
@@ -403,6 +1093,18 @@ int SAUCE_Comment_fremove(const char* filepath);
 int SAUCE_remove(char* buffer, uint32_t n);
 
 
+/**
+ * @brief Remove a SAUCE record from the first `n` bytes of a buffer, along with the SAUCE CommentBlock
+ *        if it exists. Same as `SAUCE_remove()`, but for buffers that may be larger than 4GB.
+ * 
+ * @param buffer pointer to buffer
+ * @param n the length of the buffer
+ * @return On success, the new length of the buffer is returned. On error, a negative error code
+ *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_remove64(char* buffer, size_t n);
+
+
 /**
  * @brief Remove a SAUCE CommentBlock from the first `n` bytes of a buffer.
  *        The "Comments" field of the buffer's SAUCE record will be set to 0.
@@ -415,6 +1117,18 @@ int SAUCE_remove(char* buffer, uint32_t n);
 int SAUCE_Comment_remove(char* buffer, uint32_t n);
 
 
+/**
+ * @brief Remove a SAUCE CommentBlock from the first `n` bytes of a buffer. Same as `SAUCE_Comment_remove()`,
+ *        but for buffers that may be larger than 4GB.
+ * 
+ * @param buffer pointer to buffer
+ * @param n the length of the buffer
+ * @return On success, the new length of the buffer is returned. On error, a negative error code
+ *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_Comment_remove64(char* buffer, size_t n);
+
+
 
 
 
@@ -432,6 +1146,18 @@ int SAUCE_Comment_remove(char* buffer, uint32_t n);
 int SAUCE_check_file(const char* filepath);
 
 
+/**
+ * @brief Check if a file descriptor refers to a file that contains valid SAUCE data. This will check the
+ *        SAUCE data against the SAUCE record and CommentBlock requirements listed in the docs.
+ * 
+ * @param fd a file descriptor open for reading
+ * @return 1 (i.e. true) if the file contains correct SAUCE data; 0 (i.e. false) if the file does not contain any
+ *         SAUCE data or if the SAUCE data was incorrect. If 0 is returned, you can call `SAUCE_get_error()` to 
+ *         learn more about why the check failed.
+ */
+int SAUCE_check_fd(int fd);
+
+
 /**
  * @brief Check if the first `n` bytes of a buffer contain correct SAUCE data. This will check
  *        the data against the SAUCE record and CommentBlock requirements listed in the docs.
@@ -445,6 +1171,54 @@ int SAUCE_check_file(const char* filepath);
 int SAUCE_check_buffer(const char* buffer, uint32_t n);
 
 
+/**
+ * @brief Check if the first `n` bytes of a buffer contain SAUCE data. Same as `SAUCE_check_buffer()`,
+ *        but for buffers that may be larger than 4GB.
+ * 
+ * @param buffer pointer to a buffer
+ * @param n the length of the buffer
+ * @return 1 (true) if the buffer contains valid SAUCE data; 0 (false) if the buffer does not contain valid
+ *         SAUCE data. If 0 is returned, you can call `SAUCE_get_error()` to learn more about
+ *         why the check failed.
+ */
+int SAUCE_check_buffer64(const char* buffer, size_t n);
+
+
+/**
+ * @brief Get the layout of the SAUCE data at the end of a file: whether a record, comment and eof character
+ *        exist, and where the SAUCE data starts. Uses the current cache, if there is one.
+ * 
+ * @param filepath path to a file
+ * @param layout will be set to the layout of the file. It is always set, no matter the return condition.
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_flayout(const char* filepath, SAUCE_Layout* layout);
+
+
+/**
+ * @brief Get the layout of the SAUCE data at the end of a file descriptor. See `SAUCE_flayout()`.
+ * 
+ * @param fd a file descriptor open for reading
+ * @param layout will be set to the layout of the file. It is always set, no matter the return condition.
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_fd_layout(int fd, SAUCE_Layout* layout);
+
+
+/**
+ * @brief Get the layout of the SAUCE data at the end of the first `n` bytes of a buffer. See `SAUCE_flayout()`.
+ * 
+ * @param buffer pointer to a buffer
+ * @param n the length of the buffer
+ * @param layout will be set to the layout of the buffer. It is always set, no matter the return condition.
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_layout(const char* buffer, size_t n, SAUCE_Layout* layout);
+
+
 /**
  * @brief Determine if two SAUCE records are equal. SAUCE records are equal if
  *        each field between the SAUCE records match.
@@ -472,4 +1246,579 @@ int SAUCE_equal(const SAUCE* first, const SAUCE* second);
 int SAUCE_Comment_equal(const char* first_comment, const char* second_comment, uint8_t lines);
 
 
+
+
+
+// Edit Functions
+
+/**
+ * @brief Open an edit of a file's SAUCE data. Changes made with `SAUCE_Edit_set_record()`, `SAUCE_Edit_set_comment()`
+ *        and `SAUCE_Edit_remove_comment()` are only collected, and are applied together by `SAUCE_Edit_commit()`.
+ *        The file stays open until the edit is closed.
+ * 
+ * @param filepath a path to a file
+ * @param edit will be set to the new edit
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Edit_open(const char* filepath, SAUCE_Edit** edit);
+
+
+/**
+ * @brief Open an edit of the SAUCE data of a file descriptor. Behaves like `SAUCE_Edit_open()`, except that the
+ *        file descriptor is not closed by the edit. The new data is written with positioned writes, so the file
+ *        offset of `fd` is not changed on POSIX systems.
+ * 
+ * @param fd a file descriptor open for reading and writing
+ * @param edit will be set to the new edit
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Edit_fd_open(int fd, SAUCE_Edit** edit);
+
+
+/**
+ * @brief Replace the record of a file when an edit is committed. If the file has no record, an EOF character and
+ *        the record are appended. The "Comments" field is ignored and is set from the comment the file ends up with.
+ * 
+ * @param edit an edit
+ * @param sauce the new record. It is copied, so it does not need to outlive the call.
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Edit_set_record(SAUCE_Edit* edit, const SAUCE* sauce);
+
+
+/**
+ * @brief Replace the comment of a file when an edit is committed. Setting a comment of 0 lines removes the comment.
+ * 
+ * @param edit an edit
+ * @param comment a comment buffer that is as least `SAUCE_COMMENT_STRING_LENGTH(lines)` bytes long. It is copied,
+ *                so it does not need to outlive the call.
+ * @param lines the number of lines to write
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Edit_set_comment(SAUCE_Edit* edit, const char* comment, uint8_t lines);
+
+
+/**
+ * @brief Remove the comment of a file when an edit is committed. It is not an error if the file has no comment.
+ * 
+ * @param edit an edit
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Edit_remove_comment(SAUCE_Edit* edit);
+
+
+/**
+ * @brief Apply the changes collected by an edit. The tail of the file is read once, and the new SAUCE data is
+ *        written with a single write, followed by a truncate if it is shorter than the old data. Bytes of the SAUCE
+ *        data that do not change are not written again. Once committed, the edit has no changes left and can
+ *        collect new ones.
+ * 
+ *        A comment can only be set or removed if the file has a record or a record is set. If the file's comment
+ *        is invalid, it must be set or removed as well.
+ * 
+ * @param edit an edit
+ * @return 0 on success, or `SAUCE_UNCHANGED` if the file already matched the edit and nothing was written.
+ *         On error, a negative error code is returned and the file is left unchanged. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Edit_commit(SAUCE_Edit* edit);
+
+
+/**
+ * @brief Free an edit, closing its file if it was opened by `SAUCE_Edit_open()`. Changes that were not
+ *        committed are dropped.
+ * 
+ * @param edit an edit, or NULL
+ */
+void SAUCE_Edit_close(SAUCE_Edit* edit);
+
+
+
+
+
+// Cache Functions
+
+/**
+ * @brief Open a cache and load the entries saved in `filepath`. If the file does not exist, or was
+ *        written by a different version of SauceTool or on a different platform, the cache starts
+ *        out empty. The file is not changed until `SAUCE_Cache_save()` is called.
+ * 
+ *        Use `SAUCE_set_cache()` to make the file functions use the cache.
+ * 
+ * @param filepath path to the cache file
+ * @param cache will be set to the new cache
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Cache_open(const char* filepath, SAUCE_Cache** cache);
+
+
+/**
+ * @brief Write every entry of a cache to its file. The entries are written to a temporary file
+ *        that then replaces the cache file, so the file is never left half written.
+ * 
+ * @param cache a cache
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Cache_save(SAUCE_Cache* cache);
+
+
+/**
+ * @brief Remove the entries of every file that was not read or looked up since the cache was
+ *        opened, such as files that were deleted. Call this after scanning every file of interest
+ *        and before `SAUCE_Cache_save()` to keep the cache from growing.
+ * 
+ * @param cache a cache
+ * @return On success, the number of entries removed. On error, a negative error code is returned.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_Cache_prune(SAUCE_Cache* cache);
+
+
+/**
+ * @brief Free a cache without saving it. If it is the cache used by the file functions, they
+ *        stop using a cache.
+ * 
+ * @param cache a cache, or NULL
+ */
+void SAUCE_Cache_close(SAUCE_Cache* cache);
+
+
+
+
+
+
+// Watch Functions
+
+/**
+ * @brief Start watching a directory tree for files that are written, moved, or deleted. Directories that
+ *        are created in the tree are watched as well. Nothing is read until `SAUCE_Watcher_poll()` is called.
+ *        Only available on Linux.
+ * 
+ * @param root path to the root directory
+ * @param options options for the watcher. If NULL, every option will be 0.
+ * @param watcher will be set to the new watcher
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Watcher_open(const char* root, const SAUCE_WatchOptions* options, SAUCE_Watcher** watcher);
+
+
+/**
+ * @brief Wait for files in a watched tree to change, and report them to `callback`. Events for the same file
+ *        are coalesced, and a file is only read once it has gone without events for the watcher's delay. 
+ *        Returns as soon as at least one event was reported, or once `timeout_ms` has passed.
+ * 
+ *        If a cache is set with `SAUCE_set_cache()`, changed files are read through it, which keeps its
+ *        entries current. Watchers are not thread-safe.
+ * 
+ * @param watcher a watcher
+ * @param timeout_ms the longest time to wait in milliseconds, or a negative value to wait without a limit
+ * @param callback function called for every event
+ * @param data passed to every call of `callback`
+ * @return On success, the number of events reported. 0 is returned if the timeout passed or a signal
+ *         interrupted the wait. On error, a negative error code is returned. Use `SAUCE_get_error()` to get
+ *         more info on the error.
+ */
+int64_t SAUCE_Watcher_poll(SAUCE_Watcher* watcher, int timeout_ms, SAUCE_WatchCallback callback, void* data);
+
+
+/**
+ * @brief Get the file descriptor a watcher receives events on, which becomes readable when files change.
+ *        It can be added to an event loop, calling `SAUCE_Watcher_poll()` with a timeout of 0 when it is
+ *        readable. Changed files are only reported after the watcher's delay, so the event loop should poll
+ *        again after the delay.
+ * 
+ * @param watcher a watcher
+ * @return the file descriptor, or a negative error code on error
+ */
+int SAUCE_Watcher_fd(const SAUCE_Watcher* watcher);
+
+
+/**
+ * @brief Stop watching a tree and free the watcher. Events that were not reported are discarded.
+ * 
+ * @param watcher a watcher, or NULL
+ */
+void SAUCE_Watcher_close(SAUCE_Watcher* watcher);
+
+
+
+// Batch Functions
+
+/**
+ * @brief Create an empty columnar batch of records. Filtering a batch only reads the columns of the
+ *        fields being filtered, instead of every 128 byte record.
+ * 
+ * @param capacity the number of records to make room for. The batch grows as records are appended.
+ * @param batch will be set to the new batch
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Batch_create(uint64_t capacity, SAUCE_Batch** batch);
+
+
+/**
+ * @brief Append records to the end of a batch, splitting each record into the batch's columns.
+ *        The ID of the records is not stored.
+ * 
+ * @param batch a batch
+ * @param records an array of `count` records
+ * @param count the number of records to append
+ * @return 0 on success. On error, a negative error code is returned and the batch is not changed.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_Batch_append(SAUCE_Batch* batch, const SAUCE* records, uint64_t count);
+
+
+/**
+ * @brief Gather a record of a batch back into a SAUCE struct. The ID is set to `SAUCE_RECORD_ID`.
+ * 
+ * @param batch a batch
+ * @param index the index of the record
+ * @param sauce a SAUCE struct that will be filled with the record
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Batch_get(const SAUCE_Batch* batch, uint64_t index, SAUCE* sauce);
+
+
+/**
+ * @brief Select the records of a batch whose numeric `field` is equal to `value`. Bit `i % 64` of
+ *        `bitmap[i / 64]` is set if record `i` is selected, and every other bit is cleared.
+ * 
+ *        Columns are compared with AVX2 or SSE2 instructions when the processor supports them.
+ * 
+ * @param batch a batch
+ * @param field a numeric SAUCE_Field
+ * @param value the value to compare with
+ * @param bitmap an array of at least `SAUCE_BITMAP_WORDS(batch->count)` words
+ * @return On success, the number of records selected. On error, a negative error code is returned.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_Batch_select_equal(const SAUCE_Batch* batch, enum SAUCE_Field field, uint32_t value, uint64_t* bitmap);
+
+
+/**
+ * @brief Select the records of a batch whose numeric `field` is between `min` and `max`, inclusive.
+ *        The bitmap is filled like `SAUCE_Batch_select_equal()` does.
+ * 
+ * @param batch a batch
+ * @param field a numeric SAUCE_Field
+ * @param min the smallest value to select
+ * @param max the largest value to select
+ * @param bitmap an array of at least `SAUCE_BITMAP_WORDS(batch->count)` words
+ * @return On success, the number of records selected. On error, a negative error code is returned.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_Batch_select_range(const SAUCE_Batch* batch, enum SAUCE_Field field, uint32_t min, uint32_t max, uint64_t* bitmap);
+
+
+/**
+ * @brief Select the records of a batch whose string `field` starts with `prefix`. The comparison is
+ *        case-sensitive, and a prefix longer than the field selects no records. The bitmap is filled
+ *        like `SAUCE_Batch_select_equal()` does.
+ * 
+ * @param batch a batch
+ * @param field a string SAUCE_Field
+ * @param prefix a null-terminated string
+ * @param bitmap an array of at least `SAUCE_BITMAP_WORDS(batch->count)` words
+ * @return On success, the number of records selected. On error, a negative error code is returned.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_Batch_select_prefix(const SAUCE_Batch* batch, enum SAUCE_Field field, const char* prefix, uint64_t* bitmap);
+
+
+/**
+ * @brief Free a batch and its columns.
+ * 
+ * @param batch a batch, or NULL
+ */
+void SAUCE_Batch_free(SAUCE_Batch* batch);
+
+
+
+// Stream Functions
+
+/**
+ * @brief Open a stream that parses SAUCE data from content fed to it in chunks, such as content read from
+ *        a pipe or a socket. Only the last `SAUCE_MAX_TAIL_SIZE` bytes are kept. Content is passed on to
+ *        `callback` once it is too far from the end to be SAUCE data, so it is delayed by at most
+ *        `SAUCE_MAX_TAIL_SIZE` bytes. When the stream is finished, the rest of the content is passed on,
+ *        without the EOF character and SAUCE data.
+ * 
+ * @param callback receives the content of the stream in order, or NULL
+ * @param data passed to `callback`
+ * @param stream will be set to the new stream
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Stream_open(SAUCE_StreamCallback callback, void* data, SAUCE_Stream** stream);
+
+
+/**
+ * @brief Feed the next chunk of content to a stream. Content that can no longer be SAUCE data is passed
+ *        to the stream's callback before returning. Bytes that are passed on are not copied.
+ * 
+ * @param stream a stream
+ * @param data the next chunk of content
+ * @param n the length of the chunk
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Stream_feed(SAUCE_Stream* stream, const char* data, size_t n);
+
+
+/**
+ * @brief End a stream. The SAUCE data at the end of the stream is decoded, and the rest of the content,
+ *        not including the EOF character and SAUCE data, is passed to the stream's callback. Afterwards,
+ *        the record and comment can be read with `SAUCE_Stream_read()` and `SAUCE_Stream_Comment_read()`.
+ * 
+ *        If the stream contains no record, all of it is content.
+ * 
+ * @param stream a stream
+ * @param layout will be set to the layout of the stream, where `layout->content_length` is the number
+ *               of bytes passed to the callback. Can be NULL.
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Stream_finish(SAUCE_Stream* stream, SAUCE_Layout* layout);
+
+
+/**
+ * @brief Read the record of a finished stream into `sauce`.
+ * 
+ * @param stream a stream finished with `SAUCE_Stream_finish()`
+ * @param sauce a SAUCE struct that will be filled with the record
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Stream_read(const SAUCE_Stream* stream, SAUCE* sauce);
+
+
+/**
+ * @brief Read at most `nLines` of the comment of a finished stream into `comment`, followed by a null character.
+ * 
+ * @param stream a stream finished with `SAUCE_Stream_finish()`
+ * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1` that will contain the comment
+ * @param nLines the number of lines to read
+ * @return On success, the number of lines read. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Stream_Comment_read(const SAUCE_Stream* stream, char* comment, uint8_t nLines);
+
+
+/**
+ * @brief Free a stream. Content that was not passed to the callback yet is dropped.
+ * 
+ * @param stream a stream, or NULL
+ */
+void SAUCE_Stream_close(SAUCE_Stream* stream);
+
+
+/**
+ * @brief Open a writer that passes content through to `callback` and appends SAUCE data when it is finished.
+ *        See `SAUCE_Writer_finish()`.
+ * 
+ * @param callback receives everything written, in order
+ * @param data passed to `callback`
+ * @param writer will be set to the new writer
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Writer_open(SAUCE_StreamCallback callback, void* data, SAUCE_Writer** writer);
+
+
+/**
+ * @brief Open a writer that writes content to a file descriptor and appends SAUCE data when it is finished.
+ *        The content is written at the file descriptor's current offset, so it can be a pipe or a socket.
+ *        The file descriptor is not closed by the writer.
+ * 
+ * @param fd a file descriptor open for writing
+ * @param writer will be set to the new writer
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Writer_fd_open(int fd, SAUCE_Writer** writer);
+
+
+/**
+ * @brief Write the next chunk of content through a writer. The content is passed on without being copied.
+ * 
+ * @param writer a writer
+ * @param data the content
+ * @param n the length of the content
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Writer_write(SAUCE_Writer* writer, const char* data, size_t n);
+
+
+/**
+ * @brief Finish a writer by writing an EOF character, an optional CommentBlock and a record after the content,
+ *        all in a single write. The record is copied from `sauce`, except that its "FileSize" field is set
+ *        to the number of content bytes written, and its "Comments" field is set to `lines`. "FileSize" is
+ *        set to 0 if the content is too large to be represented.
+ * 
+ * @param writer a writer
+ * @param sauce the record to write
+ * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(lines)`, or NULL if `lines` is 0
+ * @param lines the number of comment lines to write
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Writer_finish(SAUCE_Writer* writer, const SAUCE* sauce, const char* comment, uint8_t lines);
+
+
+/**
+ * @brief Free a writer. A writer that was not finished does not write any SAUCE data.
+ * 
+ * @param writer a writer, or NULL
+ */
+void SAUCE_Writer_close(SAUCE_Writer* writer);
+
+
+
+// Context Functions
+
+/**
+ * @brief Create a context. A context has its own last error, file mode and cache, so that threads
+ *        can each use their own context and never see each other's errors or options. A new context
+ *        uses `SAUCE_FM_DEFAULT` and no cache.
+ * 
+ * @param ctx will be set to the new context
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Context_create(SAUCE_Context** ctx);
+
+
+/**
+ * @brief Free a context. It must not be in use by another thread.
+ * 
+ * @param ctx a context, or NULL
+ */
+void SAUCE_Context_free(SAUCE_Context* ctx);
+
+
+/*
+ * The `_ctx` variants of the functions above. Each behaves like the function without the suffix, except that
+ * it uses `ctx` in place of the default context. The file and file descriptor functions, and the Edit, Cache
+ * and Watcher functions, use the file mode, cache and durability of `ctx` where the function without the suffix
+ * uses the default ones. Every variant sets the error of `ctx`, which is read with `SAUCE_get_error_ctx()`, and
+ * for the buffer, Batch, Stream and Writer variants that is the only difference. SAUCE functions called by
+ * callbacks during the call also use `ctx`. A context must only be used by one thread at a time. If `ctx` is
+ * NULL, the default context is used, which is what the functions without the suffix use.
+ */
+// Helper Functions
+const char* SAUCE_get_error_ctx(SAUCE_Context* ctx);
+void SAUCE_clear_error_ctx(SAUCE_Context* ctx);
+int SAUCE_set_file_mode_ctx(SAUCE_Context* ctx, enum SAUCE_FileMode mode);
+enum SAUCE_FileMode SAUCE_get_file_mode_ctx(SAUCE_Context* ctx);
+int SAUCE_set_cache_ctx(SAUCE_Context* ctx, SAUCE_Cache* cache);
+SAUCE_Cache* SAUCE_get_cache_ctx(SAUCE_Context* ctx);
+int SAUCE_set_durability_ctx(SAUCE_Context* ctx, enum SAUCE_Durability durability);
+enum SAUCE_Durability SAUCE_get_durability_ctx(SAUCE_Context* ctx);
+
+// Read Functions
+int SAUCE_fread_ctx(SAUCE_Context* ctx, const char* filepath, SAUCE* sauce);
+int SAUCE_Comment_fread_ctx(SAUCE_Context* ctx, const char* filepath, char* comment, uint8_t nLines);
+int SAUCE_fd_read_ctx(SAUCE_Context* ctx, int fd, SAUCE* sauce);
+int SAUCE_Comment_fd_read_ctx(SAUCE_Context* ctx, int fd, char* comment, uint8_t nLines);
+int SAUCE_fread_many_ctx(SAUCE_Context* ctx, const char* const* filepaths, uint32_t count, SAUCE* records,
+                         int* results, const SAUCE_BatchOptions* options);
+int SAUCE_Comment_fread_many_ctx(SAUCE_Context* ctx, const char* const* filepaths, uint32_t count, char* comments,
+                                 uint8_t nLines, int* results, const SAUCE_BatchOptions* options);
+int64_t SAUCE_scan_tree_ctx(SAUCE_Context* ctx, const char* root, SAUCE_ScanCallback callback, void* data,
+                            const SAUCE_ScanOptions* options);
+int SAUCE_read_ctx(SAUCE_Context* ctx, const char* buffer, uint32_t n, SAUCE* sauce);
+int SAUCE_read64_ctx(SAUCE_Context* ctx, const char* buffer, size_t n, SAUCE* sauce);
+int SAUCE_Comment_read_ctx(SAUCE_Context* ctx, const char* buffer, uint32_t n, char* comment, uint8_t nLines);
+int SAUCE_Comment_read64_ctx(SAUCE_Context* ctx, const char* buffer, size_t n, char* comment, uint8_t nLines);
+int SAUCE_view_ctx(SAUCE_Context* ctx, const char* buffer, size_t n, SAUCE_View* view);
+int SAUCE_Comment_iter_next_ctx(SAUCE_Context* ctx, SAUCE_CommentIter* iter, const char** line, uint8_t* length);
+
+// Write Functions
+int SAUCE_fwrite_ctx(SAUCE_Context* ctx, const char* filepath, const SAUCE* sauce);
+int SAUCE_fpatch_ctx(SAUCE_Context* ctx, const char* filepath, const SAUCE* values, uint32_t fields);
+int SAUCE_fpatch_many_ctx(SAUCE_Context* ctx, const char* const* filepaths, uint32_t count, const SAUCE* values,
+                          uint32_t fields, int* results, const SAUCE_BatchOptions* options);
+int SAUCE_Comment_fwrite_ctx(SAUCE_Context* ctx, const char* filepath, const char* comment, uint8_t lines);
+int SAUCE_fd_write_ctx(SAUCE_Context* ctx, int fd, const SAUCE* sauce);
+int SAUCE_Comment_fd_write_ctx(SAUCE_Context* ctx, int fd, const char* comment, uint8_t lines);
+int SAUCE_write_ctx(SAUCE_Context* ctx, char* buffer, uint32_t n, const SAUCE* sauce);
+int64_t SAUCE_write64_ctx(SAUCE_Context* ctx, char* buffer, size_t n, const SAUCE* sauce);
+int SAUCE_Comment_write_ctx(SAUCE_Context* ctx, char* buffer, uint32_t n, const char* comment, uint8_t lines);
+int64_t SAUCE_Comment_write64_ctx(SAUCE_Context* ctx, char* buffer, size_t n, const char* comment, uint8_t lines);
+
+// Remove Functions
+int SAUCE_fremove_ctx(SAUCE_Context* ctx, const char* filepath);
+int SAUCE_fremove_many_ctx(SAUCE_Context* ctx, const char* const* filepaths, uint32_t count, int* results,
+                           const SAUCE_BatchOptions* options);
+int SAUCE_Comment_fremove_ctx(SAUCE_Context* ctx, const char* filepath);
+int SAUCE_fd_remove_ctx(SAUCE_Context* ctx, int fd);
+int SAUCE_Comment_fd_remove_ctx(SAUCE_Context* ctx, int fd);
+int SAUCE_remove_ctx(SAUCE_Context* ctx, char* buffer, uint32_t n);
+int64_t SAUCE_remove64_ctx(SAUCE_Context* ctx, char* buffer, size_t n);
+int SAUCE_Comment_remove_ctx(SAUCE_Context* ctx, char* buffer, uint32_t n);
+int64_t SAUCE_Comment_remove64_ctx(SAUCE_Context* ctx, char* buffer, size_t n);
+
+// Check Functions
+int SAUCE_check_file_ctx(SAUCE_Context* ctx, const char* filepath);
+int SAUCE_check_fd_ctx(SAUCE_Context* ctx, int fd);
+int SAUCE_check_buffer_ctx(SAUCE_Context* ctx, const char* buffer, uint32_t n);
+int SAUCE_check_buffer64_ctx(SAUCE_Context* ctx, const char* buffer, size_t n);
+int SAUCE_flayout_ctx(SAUCE_Context* ctx, const char* filepath, SAUCE_Layout* layout);
+int SAUCE_fd_layout_ctx(SAUCE_Context* ctx, int fd, SAUCE_Layout* layout);
+int SAUCE_layout_ctx(SAUCE_Context* ctx, const char* buffer, size_t n, SAUCE_Layout* layout);
+
+// Edit Functions
+int SAUCE_Edit_open_ctx(SAUCE_Context* ctx, const char* filepath, SAUCE_Edit** edit);
+int SAUCE_Edit_fd_open_ctx(SAUCE_Context* ctx, int fd, SAUCE_Edit** edit);
+int SAUCE_Edit_set_record_ctx(SAUCE_Context* ctx, SAUCE_Edit* edit, const SAUCE* sauce);
+int SAUCE_Edit_set_comment_ctx(SAUCE_Context* ctx, SAUCE_Edit* edit, const char* comment, uint8_t lines);
+int SAUCE_Edit_remove_comment_ctx(SAUCE_Context* ctx, SAUCE_Edit* edit);
+int SAUCE_Edit_commit_ctx(SAUCE_Context* ctx, SAUCE_Edit* edit);
+
+// Cache Functions
+int SAUCE_Cache_open_ctx(SAUCE_Context* ctx, const char* filepath, SAUCE_Cache** cache);
+int SAUCE_Cache_save_ctx(SAUCE_Context* ctx, SAUCE_Cache* cache);
+int64_t SAUCE_Cache_prune_ctx(SAUCE_Context* ctx, SAUCE_Cache* cache);
+
+// Watch Functions
+int SAUCE_Watcher_open_ctx(SAUCE_Context* ctx, const char* root, const SAUCE_WatchOptions* options,
+                           SAUCE_Watcher** watcher);
+int64_t SAUCE_Watcher_poll_ctx(SAUCE_Context* ctx, SAUCE_Watcher* watcher, int timeout_ms,
+                               SAUCE_WatchCallback callback, void* data);
+int SAUCE_Watcher_fd_ctx(SAUCE_Context* ctx, const SAUCE_Watcher* watcher);
+
+// Batch Functions
+int SAUCE_Batch_create_ctx(SAUCE_Context* ctx, uint64_t capacity, SAUCE_Batch** batch);
+int SAUCE_Batch_append_ctx(SAUCE_Context* ctx, SAUCE_Batch* batch, const SAUCE* records, uint64_t count);
+int SAUCE_Batch_get_ctx(SAUCE_Context* ctx, const SAUCE_Batch* batch, uint64_t index, SAUCE* sauce);
+int64_t SAUCE_Batch_select_equal_ctx(SAUCE_Context* ctx, const SAUCE_Batch* batch, enum SAUCE_Field field,
+                                     uint32_t value, uint64_t* bitmap);
+int64_t SAUCE_Batch_select_range_ctx(SAUCE_Context* ctx, const SAUCE_Batch* batch, enum SAUCE_Field field,
+                                     uint32_t min, uint32_t max, uint64_t* bitmap);
+int64_t SAUCE_Batch_select_prefix_ctx(SAUCE_Context* ctx, const SAUCE_Batch* batch, enum SAUCE_Field field,
+                                      const char* prefix, uint64_t* bitmap);
+
+// Stream Functions
+int SAUCE_Stream_open_ctx(SAUCE_Context* ctx, SAUCE_StreamCallback callback, void* data, SAUCE_Stream** stream);
+int SAUCE_Stream_feed_ctx(SAUCE_Context* ctx, SAUCE_Stream* stream, const char* data, size_t n);
+int SAUCE_Stream_finish_ctx(SAUCE_Context* ctx, SAUCE_Stream* stream, SAUCE_Layout* layout);
+int SAUCE_Stream_read_ctx(SAUCE_Context* ctx, const SAUCE_Stream* stream, SAUCE* sauce);
+int SAUCE_Stream_Comment_read_ctx(SAUCE_Context* ctx, const SAUCE_Stream* stream, char* comment, uint8_t nLines);
+int SAUCE_Writer_open_ctx(SAUCE_Context* ctx, SAUCE_StreamCallback callback, void* data, SAUCE_Writer** writer);
+int SAUCE_Writer_fd_open_ctx(SAUCE_Context* ctx, int fd, SAUCE_Writer** writer);
+int SAUCE_Writer_write_ctx(SAUCE_Context* ctx, SAUCE_Writer* writer, const char* data, size_t n);
+int SAUCE_Writer_finish_ctx(SAUCE_Context* ctx, SAUCE_Writer* writer, const SAUCE* sauce, const char* comment,
+                            uint8_t lines);
+
 #endif //SAUCE_PARSE_HEADER_INCLUDED
\ No newline at end of file
@@ -4,10 +4,22 @@
  * This project is licensed under the MIT License.
  */
 
+// Use 64-bit file offsets on systems where off_t is 32 bits by default
+#ifndef _FILE_OFFSET_BITS
+  #define _FILE_OFFSET_BITS 64
+#endif
+
+// Linux only declares sync_file_range() for GNU sources
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+  #define _GNU_SOURCE
+#endif
+
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
+#include <errno.h>
+#include <limits.h>
 #include "SauceTool.h" 
 
 // Compiler and OS defines
@@ -20,17 +32,89 @@
   #if defined(_POSIX_VERSION) && _POSIX_VERSION >= 200112L
     #include <sys/types.h>
     #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <sys/resource.h>
     #define POSIX_IS_DEFINED
+    #if defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+      #include <sys/mman.h>
+      #define MMAP_IS_DEFINED
+    #endif
   #endif
 #endif
 
 #if defined (_WIN32) || defined(_WIN64)
   #include <windows.h>
-  #include <wchar.h>
   #include <io.h>
+  #include <fcntl.h>
+  #include <sys/stat.h>
   #define WINDOWS_IS_DEFINED
 #endif
 
+// SAUCE_USE_STDIO can be defined to only access files with C standard I/O functions
+#if (defined(POSIX_IS_DEFINED) || defined(WINDOWS_IS_DEFINED)) && !defined(SAUCE_USE_STDIO)
+  #define FD_IO_IS_DEFINED
+#endif
+
+#if defined(MMAP_IS_DEFINED) && !defined(FD_IO_IS_DEFINED)
+  #undef MMAP_IS_DEFINED
+#endif
+
+#if defined(FD_IO_IS_DEFINED) && defined(POSIX_IS_DEFINED) && defined(_POSIX_THREADS) && _POSIX_THREADS > 0
+  #include <pthread.h>
+  #define THREADS_IS_DEFINED
+#endif
+
+#ifdef THREADS_IS_DEFINED
+  #include <time.h>
+  #define CACHE_IS_DEFINED
+#endif
+
+#if defined(THREADS_IS_DEFINED) && defined(AT_FDCWD) && defined(O_DIRECTORY) && defined(O_NOFOLLOW)
+  #include <dirent.h>
+  #define SCAN_IS_DEFINED
+#endif
+
+#if defined(SCAN_IS_DEFINED) && defined(__linux__)
+  #include <sys/inotify.h>
+  #include <poll.h>
+  #define WATCH_IS_DEFINED
+#endif
+
+// io_uring is used through its system calls, so only the kernel headers are needed
+#if defined(MMAP_IS_DEFINED) && defined(THREADS_IS_DEFINED) && defined(__linux__) && defined(USE_ATTRIBUTE) && defined(__has_include)
+  #if __has_include(<linux/io_uring.h>)
+    #include <sys/syscall.h>
+    #include <linux/io_uring.h>
+    #include <linux/stat.h>
+    #if defined(__NR_io_uring_setup) && defined(AT_FDCWD) && defined(AT_EMPTY_PATH) && defined(STATX_SIZE)
+      #define URING_IS_DEFINED
+    #endif
+  #endif
+#endif
+
+// SAUCE_NO_SIMD can be defined to filter batches without SIMD instructions
+#if !defined(SAUCE_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+  #include <emmintrin.h>
+  #define SSE2_IS_DEFINED
+#endif
+
+// AVX2 kernels are compiled with a target attribute, and are only used if the processor supports them
+#if defined(SSE2_IS_DEFINED) && defined(USE_ATTRIBUTE) && (defined(__x86_64__) || defined(__i386__))
+  #include <immintrin.h>
+  #define AVX2_IS_DEFINED
+#endif
+
+// Storage class that gives every thread its own copy of a variable
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+  #define THREAD_LOCAL _Thread_local
+#elif defined(USE_ATTRIBUTE)
+  #define THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+  #define THREAD_LOCAL __declspec(thread)
+#else
+  #define THREAD_LOCAL
+#endif
+
 
 // Static asserts
 #define SAUCE_STATIC_ASSERT(condition, message) \
@@ -43,446 +127,920 @@ SAUCE_STATIC_ASSERT(sizeof(SAUCE) == 128, sizeof_SAUCE_struct_must_be_128_bytes)
 // Local constants
 #define FILE_BUF_READ_SIZE      256  
 
-// The SAUCE error message
-static char* error_msg = NULL;
+
+
+// Error state
+
+// Largest number of arguments kept for an error message
+#define ERROR_MAX_ARGS          4
+
+// Number of bytes kept for the string arguments of an error message. Longer strings are cut short.
+#define ERROR_STRINGS_SIZE      4096
+
+// Size of a formatted error message, including the terminating null character
+#define ERROR_MESSAGE_SIZE      (ERROR_STRINGS_SIZE + 512)
+
+// An argument of an error message
+typedef union SAUCEErrorArg {
+  long long i;                  // signed integers and characters
+  unsigned long long u;         // unsigned integers
+  const char* s;                // strings, which point into the state's `strings`
+  const void* p;                // pointers
+} SAUCEErrorArg;
+
+// The last error of a thread. Errors are recorded as their format string and arguments,
+// and are only formatted once the message is asked for.
+typedef struct SAUCEErrorState {
+  const char* format;           // format string literal of the last error, or NULL if there is none
+  SAUCEErrorArg args[ERROR_MAX_ARGS];
+  int formatted;                // true if `message` holds the formatted error
+  char strings[ERROR_STRINGS_SIZE];
+  char message[ERROR_MESSAGE_SIZE];
+} SAUCEErrorState;
+
+// The error state of the calling thread, used outside of the `_ctx` functions
+static THREAD_LOCAL SAUCEErrorState error_state;
+
+// Options that change how functions behave
+typedef struct SAUCEOptions {
+  enum SAUCE_FileMode fileMode; // how the file functions access files, see SAUCE_set_file_mode()
+  SAUCE_Cache* cache;           // cache used by the file functions, see SAUCE_set_cache()
+  enum SAUCE_Durability durability; // how the write functions sync files, see SAUCE_set_durability()
+} SAUCEOptions;
+
+// A context holds its own error and options, so that each thread can use its own without locks
+struct SAUCE_Context {
+  SAUCEOptions options;
+  SAUCEErrorState error;
+};
+
+// Options used outside of the `_ctx` functions
+static SAUCEOptions default_options = { SAUCE_FM_DEFAULT, NULL, SAUCE_DURABLE_NONE };
+
+// The context of the `_ctx` function the calling thread is in, or NULL
+static THREAD_LOCAL SAUCE_Context* current_context = NULL;
+
+
+/**
+ * @brief Get the error state of the calling thread's current context.
+ * 
+ * @return the error state
+ */
+static SAUCEErrorState* SAUCE_error_state(void) {
+  SAUCE_Context* ctx = current_context;
+  return (ctx != NULL) ? &ctx->error : &error_state;
+}
+
+
+/**
+ * @brief Get the options of the calling thread's current context. Threads that work for another
+ *        thread's call must be given the options they need, since they do not share its context.
+ * 
+ * @return the options
+ */
+static SAUCEOptions* SAUCE_options(void) {
+  SAUCE_Context* ctx = current_context;
+  return (ctx != NULL) ? &ctx->options : &default_options;
+}
+
+
+/**
+ * @brief Find the next conversion specification in a `printf()` format string.
+ * 
+ * @param format the format string
+ * @param spec will be set to the start of the specification, at its '%'
+ * @param length will be set to the number of 'l' length modifiers, or -1 for a 'z' modifier
+ * @return a pointer to the conversion character, or NULL if there are no more specifications
+ */
+static const char* SAUCE_error_next_spec(const char* format, const char** spec, int* length) {
+  while ((format = strchr(format, '%')) != NULL) {
+    *spec = format++;
+    while (*format == '-' || *format == '+' || *format == ' ' || *format == '#' || *format == '.' ||
+           (*format >= '0' && *format <= '9')) {
+      format++;
+    }
+    *length = 0;
+    if (*format == 'z') {
+      *length = -1;
+      format++;
+    }
+    while (*format == 'l') {
+      (*length)++;
+      format++;
+    }
+    if (*format == 0) return NULL;
+    if (*format != '%') return format;
+    format++;
+  }
+  return NULL;
+}
+
 
 // Declarations
 
 #ifdef USE_ATTRIBUTE
 __attribute__((format(printf, 1, 2)))
 #endif
-static int SAUCE_set_error(const char* format, ...);
+static void SAUCE_set_error(const char* format, ...);
 
 
 // Set the current error message using the `printf()` family formatting scheme.
-// Will return SAUCE_EOTHER from the calling function if SAUCE_set_error() fails.
 // Note that parameters must be ordered exactly as if you were calling SAUCE_set_error().
-#define SAUCE_SET_ERROR(...)     if (SAUCE_set_error(__VA_ARGS__) < 0) return SAUCE_EOTHER;
+#define SAUCE_SET_ERROR(...)     SAUCE_set_error(__VA_ARGS__)
 
 
 /**
- * @brief Set the current error message using the `printf()` family formatting scheme.
+ * @brief Set the error of the calling thread. Only the format string and its arguments are kept, and
+ *        string arguments are copied. The message is formatted by `SAUCE_get_error()`, so an error that
+ *        is never looked at costs neither an allocation nor a call to `vsnprintf()`.
+ * 
+ *        `format` must be a string literal, and may only use the 'd', 'i', 'u', 'x', 'X', 'c', 's' and
+ *        'p' conversions without '*' widths. Arguments past the first ERROR_MAX_ARGS are dropped.
  * 
  * @param format format string
  * @param ... optional arguments to be formatted
- * 
- * @return 0 on success. Otherwise, a negative number is returned.
  */
-static int SAUCE_set_error(const char* format, ...) {
-  va_list ap;
-
-  // free the error message
-  SAUCE_clear_error();
+static void SAUCE_set_error(const char* format, ...) {
+  SAUCEErrorState* state = SAUCE_error_state();
+  state->format = format;
+  state->formatted = 0;
 
-  // get the length of the formatted string
+  va_list ap;
   va_start(ap, format);
-  int len = vsnprintf(NULL, 0, format, ap);
-  va_end(ap);
-  if (len < 0) {
-    error_msg = malloc(128);
-    snprintf(error_msg, 128, "SAUCE_set_error: vsnprintf failed to get the formatted error message length");
-    return -1;
+  size_t used = 0;
+  const char* spec;
+  int length;
+  const char* next = format;
+  for (int n = 0; n < ERROR_MAX_ARGS && (next = SAUCE_error_next_spec(next, &spec, &length)) != NULL; n++) {
+    SAUCEErrorArg* arg = &state->args[n];
+    switch (*next++) {
+      case 's': {
+        const char* string = va_arg(ap, const char*);
+        if (string == NULL) string = "(null)";
+        size_t size = strlen(string);
+        if (size > ERROR_STRINGS_SIZE - 1 - used) size = ERROR_STRINGS_SIZE - 1 - used;
+        memcpy(state->strings + used, string, size);
+        state->strings[used + size] = 0;
+        arg->s = state->strings + used;
+        used += size + ((used + size < ERROR_STRINGS_SIZE - 1) ? 1 : 0);
+        break;
+      }
+      case 'd': case 'i': case 'c':
+        if (length == -1) arg->i = (long long)va_arg(ap, ptrdiff_t);
+        else if (length == 0) arg->i = va_arg(ap, int);
+        else if (length == 1) arg->i = va_arg(ap, long);
+        else arg->i = va_arg(ap, long long);
+        break;
+      case 'u': case 'x': case 'X':
+        if (length == -1) arg->u = va_arg(ap, size_t);
+        else if (length == 0) arg->u = va_arg(ap, unsigned int);
+        else if (length == 1) arg->u = va_arg(ap, unsigned long);
+        else arg->u = va_arg(ap, unsigned long long);
+        break;
+      default:
+        arg->p = va_arg(ap, const void*);
+        break;
+    }
   }
-
-  // malloc and copy the formatted string
-  error_msg = malloc(len + 1);
-  va_start(ap, format);
-  int res = vsnprintf(error_msg, len + 1, format, ap);
   va_end(ap);
-  if (res < 0) {
-    free(error_msg);
-    error_msg = malloc(128);
-    snprintf(error_msg, 128, "SAUCE_set_error: vsnprintf failed to write the formatted error message to error_msg string");
-    return -1;
-  }
-  if (len != res) {
-    free(error_msg);
-    error_msg = malloc(128);
-    snprintf(error_msg, 128, "SAUCE_set_error: vsnprintf only wrote %d characters instead of expected %d characters", res, len);
-    return -1;
-  }
-
-  return 0;
 }
 
 
 /**
- * @brief Clear the last error message. Will do nothing if no SAUCE error has occurred yet.
+ * @brief Format the error of the calling thread into its message, one conversion at a time.
  * 
+ * @param state the error state of the calling thread
  */
-void SAUCE_clear_error(void) {
-  if (error_msg != NULL) {
-    free(error_msg);
-    error_msg = NULL;
-  }
-}
-
-
-#if defined(POSIX_IS_DEFINED) || defined(WINDOWS_IS_DEFINED)
-/**
- * @brief Helper function for SAUCE_posix_file_find_record() and SAUCE_windows_file_find_record().
- *        Seeks to position and extracts record.
- *
- * @param file FILE pointer
- * @param record array of length SAUCE_RECORD_SIZE + 1
- * @param filesize size of file to be set; can be NULL; will not be set if SAUCE_EFFAIL is returned
- * @return 0 on success. If there is no record, SAUCE_ERMISS will be returned. If the file was empty,
- *         SAUCE_EEMPTY will be returned. Any other error codes that are returned indicate that the file could not be read.
- */
-static int SAUCE_find_record_helper(FILE* file, char* record, int32_t filesize) {
-  // check for empty file
-  if (filesize == 0) return SAUCE_EEMPTY;
-
-  // seek to read position
-  if (filesize < SAUCE_RECORD_SIZE) {
-    // get last byte of file
-    if (fseek(file, filesize - 1, SEEK_SET) < 0) {
-      SAUCE_SET_ERROR("Failed to seek to last byte of file");
-      return SAUCE_EFFAIL;
+static void SAUCE_error_format(SAUCEErrorState* state) {
+  char* out = state->message;
+  size_t left = ERROR_MESSAGE_SIZE;
+  const char* text = state->format;
+  const char* spec;
+  int length;
+  const char* next = text;
+
+  for (int n = 0; (next = SAUCE_error_next_spec(next, &spec, &length)) != NULL && left > 1; n++) {
+    // copy the text before the specification, where "%%" is written as '%'
+    for (; text < spec && left > 1; text++) {
+      if (text[0] == '%' && text[1] == '%') text++;
+      *out++ = *text;
+      left--;
     }
-  }
-  else if (filesize > SAUCE_RECORD_SIZE) {
-    if (fseek(file, filesize - SAUCE_RECORD_SIZE - 1, SEEK_SET) < 0) {
-      SAUCE_SET_ERROR("Failed to seek to byte before SAUCE record");
-      return SAUCE_EFFAIL;
+
+    char conversion[16];
+    size_t size = (size_t)(next - spec) + 1;
+    if (size >= sizeof(conversion) || n >= ERROR_MAX_ARGS) break;
+    memcpy(conversion, spec, size);
+    conversion[size] = 0;
+
+    const SAUCEErrorArg* arg = &state->args[n];
+    int written;
+    switch (*next) {
+      case 's': written = snprintf(out, left, conversion, arg->s); break;
+      case 'd': case 'i': case 'c':
+        if (length == -1) written = snprintf(out, left, conversion, (ptrdiff_t)arg->i);
+        else if (length == 0) written = snprintf(out, left, conversion, (int)arg->i);
+        else if (length == 1) written = snprintf(out, left, conversion, (long)arg->i);
+        else written = snprintf(out, left, conversion, arg->i);
+        break;
+      case 'u': case 'x': case 'X':
+        if (length == -1) written = snprintf(out, left, conversion, (size_t)arg->u);
+        else if (length == 0) written = snprintf(out, left, conversion, (unsigned int)arg->u);
+        else if (length == 1) written = snprintf(out, left, conversion, (unsigned long)arg->u);
+        else written = snprintf(out, left, conversion, arg->u);
+        break;
+      default: written = snprintf(out, left, conversion, arg->p); break;
     }
+    if (written < 0) break;
+    if ((size_t)written >= left) written = (int)left - 1;
+    out += written;
+    left -= (size_t)written;
+    text = ++next;
   }
 
-  // read as much as possible
-  size_t read = fread(record, 1, SAUCE_RECORD_SIZE + 1, file);
-  if (read == 1) {
-    return SAUCE_ESHORT;
-  }
-  else if (read == SAUCE_RECORD_SIZE + 1) {
-    return (memcmp(record + 1, SAUCE_RECORD_ID, 5) == 0) ? 0 : SAUCE_ERMISS;
+  // copy the text after the last specification
+  for (; *text != 0 && left > 1; text++) {
+    if (text[0] == '%' && text[1] == '%') text++;
+    *out++ = *text;
+    left--;
   }
-  else if (read == SAUCE_RECORD_SIZE) {
-    return (memcmp(record, SAUCE_RECORD_ID, 5) == 0) ? 0 : SAUCE_ERMISS;
-  }
-
-  SAUCE_SET_ERROR("When reading record, only %lu bytes were read", read);
-  return SAUCE_EOTHER;
+  *out = 0;
+  state->formatted = 1;
 }
-#endif
 
 
-#ifdef POSIX_IS_DEFINED
 /**
- * @brief POSIX implementation of `SAUCE_file_find_record()`.
- *      
+ * @brief Clear the last error message of the calling thread. Will do nothing if no SAUCE error
+ *        has occurred yet.
  * 
- * @param file FILE pointer
- * @param record array of length SAUCE_RECORD_SIZE + 1
- * @param filesize size of file to be set; can be NULL; will not be set if SAUCE_EFFAIL is returned
- * @return 0 on success. If there is no record, SAUCE_ERMISS will be returned. If the file was empty,
- *         SAUCE_EEMPTY will be returned. Any other error codes that are returned indicate that the file could not be read.
  */
-static int SAUCE_posix_file_find_record(FILE* file, char* record, int32_t* filesize) {
-  rewind(file);
-  
-  // get filesize
-  int fd = fileno(file);
-  if (fd < 0) {
-    SAUCE_SET_ERROR("Failed to get file descriptor for file");
-    return SAUCE_EFFAIL;
-  }
+void SAUCE_clear_error(void) {
+  SAUCEErrorState* state = SAUCE_error_state();
+  state->format = NULL;
+  state->formatted = 0;
+}
 
-  struct stat info;
-  if (fstat(fd, &info) < 0) {
-    SAUCE_SET_ERROR("fstat() failed to get info on file");
-    return SAUCE_EFFAIL;
-  }
 
-  if (info.st_size < 0) {
-    SAUCE_SET_ERROR("stat.st_size is negative");
-    return SAUCE_EOTHER;
-  }
-  if (info.st_size > INT32_MAX) {
-    SAUCE_SET_ERROR("File size is larger than 2GB limit. Files over 2GB are not yet supported by this project");
-    return SAUCE_EOTHER;
-  }
 
-  int32_t size = (int32_t)info.st_size;
+// Allocator
 
-  // set file size
-  if (filesize != NULL) *filesize = size;
+// Header in front of every allocation. It keeps the size of the allocation, so that freed bytes can be
+// counted and allocations can be grown with only a malloc and a free function, and is padded to keep
+// the allocation aligned for any type.
+typedef union SAUCEAllocHeader {
+  size_t size;
+  long double ld;
+  long long ll;
+  void* p;
+} SAUCEAllocHeader;
 
-  return SAUCE_find_record_helper(file, record, size);
+// The functions every allocation of the library goes through, see SAUCE_set_allocator()
+typedef struct SAUCEAllocator {
+  SAUCE_MallocFunction malloc;
+  SAUCE_FreeFunction free;
+  void* user;
+} SAUCEAllocator;
+
+
+static void* SAUCE_default_malloc(size_t size, void* user) {
+  (void)user;
+  return malloc(size);
 }
-#endif //POSIX_IS_DEFINED
 
+static void SAUCE_default_free(void* ptr, void* user) {
+  (void)user;
+  free(ptr);
+}
 
-#ifdef WINDOWS_IS_DEFINED
-/**
- * @brief Windows implementation of `SAUCE_file_find_record()`.
- *
- *
- * @param file FILE pointer
- * @param record array of length SAUCE_RECORD_SIZE + 1
- * @param filesize size of file to be set; can be NULL; will not be set if SAUCE_EFFAIL is returned
- * @return 0 on success. If there is no record, SAUCE_ERMISS will be returned. If the file was empty,
- *         SAUCE_EEMPTY will be returned. Any other error codes that are returned indicate that the file could not be read.
- */
-static int SAUCE_windows_file_find_record(FILE* file, char* record, int32_t* filesize) {
-  rewind(file);
-
-  HANDLE handle = (HANDLE)_get_osfhandle(_fileno(file));
-  LARGE_INTEGER lInt;
-  if (GetFileSizeEx(handle, &lInt) == 0) {
-    SAUCE_SET_ERROR("GetFileSizeEx() failed to get file size");
-    return SAUCE_EFFAIL;
-  }
+static SAUCEAllocator allocator = { SAUCE_default_malloc, SAUCE_default_free, NULL };
 
-  int64_t size64 = lInt.QuadPart;
-  if (size64 < 0) {
-    SAUCE_SET_ERROR("File size is negative");
-    return SAUCE_EOTHER;
-  }
-  if (size64 > INT32_MAX) {
-    SAUCE_SET_ERROR("File size is larger than 2GB limit. Files over 2GB are not yet supported by this project");
-    return SAUCE_EOTHER;
-  }
-  int32_t size = (int32_t)size64;
+// Allocations made by the calling thread since its stats were last reset
+static THREAD_LOCAL SAUCE_AllocStats alloc_stats;
 
-  // set file size
-  if (filesize != NULL) *filesize = size;
 
-  return SAUCE_find_record_helper(file, record, size);
+/**
+ * @brief Allocate memory with the library's allocator, and count it for the calling thread.
+ * 
+ * @param size number of bytes to allocate
+ * @return the allocation, or NULL if the allocator failed
+ */
+static void* SAUCE_malloc(size_t size) {
+  if (size > SIZE_MAX - sizeof(SAUCEAllocHeader)) return NULL;
+  SAUCEAllocHeader* header = allocator.malloc(sizeof(SAUCEAllocHeader) + size, allocator.user);
+  if (header == NULL) return NULL;
+  header->size = size;
+  alloc_stats.allocations++;
+  alloc_stats.bytes_allocated += size;
+  return header + 1;
 }
-#endif //WINDOWS_IS_DEFINED
 
 
 /**
- * @brief Find a record in a file. If the last 128 bytes of the file are a record, the record and the byte immediately before the record,
- *        if there is such a byte, will be copied to the beginning of `record`. If there is no record, the last byte of the file,
- *        if the file is not empty, will be copied to the beginning of `record`. `filesize` will be set to the file's total length. 
- *        
- *        
+ * @brief Allocate zeroed memory for `count` elements of `size` bytes with the library's allocator.
  * 
- * @param file FILE pointer
- * @param record array of length SAUCE_RECORD_SIZE + 1
- * @param filesize size of file to be set; can be NULL; will not be set if SAUCE_EFFAIL is returned
- * @return 0 on success. If there is no record, SAUCE_ERMISS will be returned. If the file was empty,
- *         SAUCE_EEMPTY will be returned. Any other error codes that are returned indicate that the file could not be read.
+ * @param count number of elements
+ * @param size size of an element
+ * @return the allocation, or NULL if the allocator failed or the size overflowed
  */
-static int SAUCE_file_find_record(FILE* file, char* record, int32_t* filesize) {
-  #if defined(POSIX_IS_DEFINED)
-  return SAUCE_posix_file_find_record(file, record, filesize);
-  #elif defined(WINDOWS_IS_DEFINED)
-  return SAUCE_windows_file_find_record(file, record, filesize);
-  #else
-  rewind(file);
-  
-  char buffer[FILE_BUF_READ_SIZE*2 + 1];
-  char* curr = &buffer[FILE_BUF_READ_SIZE]; // set curr to middle of buffer
-  memset(buffer, 0, FILE_BUF_READ_SIZE*2 + 1);
-  
-  size_t read = 0;
-  int32_t total = 0;
+static void* SAUCE_calloc(size_t count, size_t size) {
+  if (size != 0 && count > SIZE_MAX / size) return NULL;
+  void* ptr = SAUCE_malloc(count * size);
+  if (ptr != NULL) memset(ptr, 0, count * size);
+  return ptr;
+}
 
-  while(1) {
-    read = fread(curr, 1, FILE_BUF_READ_SIZE, file);
-    // check for overflow
-    if (total > INT32_MAX - read) {
-      SAUCE_SET_ERROR("File size is larger than 2GB limit. Files over 2GB are not yet supported by this project");
-      return SAUCE_EOTHER;
-    }
 
-    total += read;
-    if (read < FILE_BUF_READ_SIZE) {
-      if (total == read) {
-        memcpy(buffer, curr, total);
-        memset(curr, 0, FILE_BUF_READ_SIZE);
-      }
-      if (feof(file)) {
-        break;
-      }
-      SAUCE_SET_ERROR("Failed to read from file");
-      return SAUCE_EFFAIL;
-    }
+/**
+ * @brief Free memory allocated with `SAUCE_malloc()`, `SAUCE_calloc()` or `SAUCE_realloc()`.
+ * 
+ * @param ptr the allocation, or NULL
+ */
+static void SAUCE_free(void* ptr) {
+  if (ptr == NULL) return;
+  SAUCEAllocHeader* header = (SAUCEAllocHeader*)ptr - 1;
+  alloc_stats.frees++;
+  alloc_stats.bytes_freed += header->size;
+  allocator.free(header, allocator.user);
+}
 
-    memcpy(buffer, curr, FILE_BUF_READ_SIZE);
-    memset(curr, 0, FILE_BUF_READ_SIZE);
-  }
 
-  // set file size
-  if (filesize != NULL) *filesize = total;
+/**
+ * @brief Grow or shrink an allocation. Since the allocator has no realloc function, the allocation is
+ *        moved into a new one. On failure, `ptr` is left unchanged.
+ * 
+ * @param ptr the allocation, or NULL to make a new one
+ * @param size new size in bytes
+ * @return the new allocation, or NULL if the allocator failed
+ */
+static void* SAUCE_realloc(void* ptr, size_t size) {
+  if (ptr == NULL) return SAUCE_malloc(size);
+  size_t oldSize = ((SAUCEAllocHeader*)ptr - 1)->size;
+  if (size <= oldSize && size >= oldSize / 2) return ptr;
+
+  void* moved = SAUCE_malloc(size);
+  if (moved == NULL) return NULL;
+  memcpy(moved, ptr, (size < oldSize) ? size : oldSize);
+  SAUCE_free(ptr);
+  return moved;
+}
 
-  // check for empty file
-  if (total == 0) return SAUCE_EEMPTY;
 
-  // check for short file
-  if (total < SAUCE_RECORD_SIZE) {
-    record[0] = curr[total-1];
-    return SAUCE_ESHORT;
-  }
+#ifdef FD_IO_IS_DEFINED
+// Modes for SAUCE_fd_open()
+#define FD_OPEN_READ      0   // open for reading
+#define FD_OPEN_WRITE     1   // open for reading and writing
+#define FD_OPEN_CREATE    2   // open for reading and writing, create the file if it does not exist
 
-  
-  int32_t record_start = (total < FILE_BUF_READ_SIZE) ? 
-                            total - SAUCE_RECORD_SIZE : 
-                            (read + FILE_BUF_READ_SIZE) - SAUCE_RECORD_SIZE;
 
-  // check for record
-  if (memcmp(&buffer[record_start], SAUCE_RECORD_ID, 5) != 0) {
-    record[0] = (record_start > 0) ? buffer[record_start-1] : 0;
-    return SAUCE_ERMISS;
-  }
+/**
+ * @brief Open a file descriptor for a file.
+ * 
+ * @param filepath path to file
+ * @param mode FD_OPEN_READ, FD_OPEN_WRITE or FD_OPEN_CREATE
+ * @return a file descriptor on success. On error, a negative number is returned.
+ */
+static int SAUCE_fd_open(const char* filepath, int mode) {
+  #if defined(POSIX_IS_DEFINED)
+  int flags = (mode == FD_OPEN_READ) ? O_RDONLY : O_RDWR;
+  if (mode == FD_OPEN_CREATE) flags |= O_CREAT;
+  #ifdef O_CLOEXEC
+  flags |= O_CLOEXEC;
+  #endif
+  int fd;
+  do {
+    fd = open(filepath, flags, 0666);
+  } while (fd < 0 && errno == EINTR);
+  return fd;
+  #else
+  int flags = ((mode == FD_OPEN_READ) ? _O_RDONLY : _O_RDWR) | _O_BINARY;
+  if (mode == FD_OPEN_CREATE) flags |= _O_CREAT;
+  return _open(filepath, flags, _S_IREAD | _S_IWRITE);
+  #endif
+}
 
-  // copy record
-  if (record_start > 0) {
-    memcpy(record, &buffer[record_start - 1], SAUCE_RECORD_SIZE + 1);
-  } else {
-    memcpy(record, &buffer[record_start], SAUCE_RECORD_SIZE);
-  }
 
-  return 0;
+/**
+ * @brief Close a file descriptor opened by `SAUCE_fd_open()`.
+ * 
+ * @param fd file descriptor
+ * @return 0 on success. On error, a negative number is returned.
+ */
+static int SAUCE_fd_close(int fd) {
+  #if defined(POSIX_IS_DEFINED)
+  return close(fd);
+  #else
+  return _close(fd);
   #endif
 }
 
 
 /**
- * @brief Find a comment in a file. If the comment is found in a file, the comment and the byte immediately 
- *        before the comment, if such a byte exists, will be copied to the beginning of `comment`.
+ * @brief Get the size of the file referred to by a file descriptor.
  * 
- * @param file FILE pointer
- * @param comment comment buffer to be filled; length must be at least `SAUCE_COMMENT_BLOCK_SIZE(lines) + 1`
- * @param filesize the size/length of the file
- * @param totalLines the total number of lines reported by the record
- * @param lines the number of comment lines to read from the file
- * @return 0 on success. If the comment ID couldn't be found, then SAUCE_ECMISS will be returned.
- *         Any other returned errors indicate that the file could not be read or could not possibly contain a comment.
- */
-static int SAUCE_file_find_comment(FILE* file, char* comment, int32_t filesize, uint8_t totalLines, uint8_t lines) {
-  rewind(file);
-
-  // check if file is too short
-  if (filesize < SAUCE_TOTAL_SIZE(totalLines)) {
-    SAUCE_SET_ERROR("File is too short to contain a comment with a total of %d lines", totalLines);
-    return SAUCE_ESHORT;
-  }
+ * @param fd file descriptor
+ * @param size will be set to the size of the file
+ * @return 0 on success. On error, SAUCE_EFFAIL is returned.
+ */
+static int SAUCE_fd_size(int fd, int64_t* size) {
+  #if defined(POSIX_IS_DEFINED)
+  struct stat info;
+  if (fstat(fd, &info) < 0 || info.st_size < 0) return SAUCE_EFFAIL;
+  *size = (int64_t)info.st_size;
+  #else
+  __int64 length = _filelengthi64(fd);
+  if (length < 0) return SAUCE_EFFAIL;
+  *size = (int64_t)length;
+  #endif
+  return 0;
+}
 
-  // seek to byte before comment, if possible
-  if (filesize > SAUCE_TOTAL_SIZE(totalLines) + 1) {
-    if (fseek(file, filesize - SAUCE_TOTAL_SIZE(totalLines) - 1, SEEK_SET) < 0) {
-      SAUCE_SET_ERROR("Failed to seek to byte before comment in file");
-      return SAUCE_EFFAIL;
-    }
-  }
 
-  // read comment and possibly the byte immediately before
-  int read = fread(comment, 1, SAUCE_COMMENT_BLOCK_SIZE(lines) + 1, file);
-  if (read < SAUCE_COMMENT_BLOCK_SIZE(lines)) {
-    SAUCE_SET_ERROR("Failed to read entire comment in file");
-    return SAUCE_EFFAIL;
-  }
+/**
+ * @brief Read exactly `n` bytes at `offset` from a file descriptor. On POSIX systems, the file
+ *        offset of `fd` is not changed.
+ * 
+ * @param fd file descriptor
+ * @param buffer buffer of at least `n` bytes
+ * @param n number of bytes to read
+ * @param offset position in the file to read from
+ * @return 0 on success. On error, SAUCE_EFFAIL is returned.
+ */
+static int SAUCE_fd_pread(int fd, char* buffer, uint32_t n, int64_t offset) {
+  uint32_t total = 0;
 
-  // check for comment id, return if found
-  if (memcmp(((filesize == SAUCE_TOTAL_SIZE(lines)) ? comment : comment+1), SAUCE_COMMENT_ID, 5) == 0) {
-    return 0;
+  #if defined(POSIX_IS_DEFINED)
+  while (total < n) {
+    ssize_t read = pread(fd, buffer + total, n - total, (off_t)(offset + total));
+    if (read < 0 && errno == EINTR) continue;
+    if (read <= 0) return SAUCE_EFFAIL;
+    total += (uint32_t)read;
+  }
+  #else
+  if (_lseeki64(fd, offset, SEEK_SET) < 0) return SAUCE_EFFAIL;
+  while (total < n) {
+    int read = _read(fd, buffer + total, n - total);
+    if (read <= 0) return SAUCE_EFFAIL;
+    total += (uint32_t)read;
   }
+  #endif
 
-  // failed to find comment id
-  return SAUCE_ECMISS;
+  return 0;
 }
 
 
 /**
- * @brief Truncate the file by removing all SAUCE data from the end of the file.
- *        The last `totalSauceSize` bytes of the file will be removed. On success,
- *        writeRef will be set to the trucated file for writing and be positioned at end of the file.    
+ * @brief Write exactly `n` bytes at `offset` to a file descriptor. On POSIX systems, the file
+ *        offset of `fd` is not changed.
  * 
- * @param file FILE pointer to file to truncate; should be open for reading
- * @param filesize size of the original file
- * @param totalSauceSize size/length of the SAUCE data; this can include an EOF character
- * @param writeRef on success, will be set to the truncated file for writing and be positioned at the end of the file. 
- *                 If NULL, `writeRef` will not be set and the file will automatically be closed.
- * @return 0 on success. On error, a negative error code is returned.
+ * @param fd file descriptor
+ * @param buffer buffer of at least `n` bytes
+ * @param n number of bytes to write
+ * @param offset position in the file to write to
+ * @return 0 on success. On error, SAUCE_EFFAIL is returned.
  */
-static int SAUCE_file_truncate(const char* filepath, int32_t filesize, uint16_t totalSauceSize, FILE** writeRef) {
-  if (filesize < totalSauceSize) {
-    SAUCE_SET_ERROR("The total size of the SAUCE data cannot be greater than the filesize");
-    return SAUCE_EOTHER;
+static int SAUCE_fd_pwrite(int fd, const char* buffer, uint32_t n, int64_t offset) {
+  uint32_t total = 0;
+
+  #if defined(POSIX_IS_DEFINED)
+  while (total < n) {
+    ssize_t write = pwrite(fd, buffer + total, n - total, (off_t)(offset + total));
+    if (write < 0 && errno == EINTR) continue;
+    if (write <= 0) return SAUCE_EFFAIL;
+    total += (uint32_t)write;
   }
+  #else
+  if (_lseeki64(fd, offset, SEEK_SET) < 0) return SAUCE_EFFAIL;
+  while (total < n) {
+    int write = _write(fd, buffer + total, n - total);
+    if (write <= 0) return SAUCE_EFFAIL;
+    total += (uint32_t)write;
+  }
+  #endif
 
-  if (filesize == totalSauceSize) {
-    // just clear the entire file
-    FILE* file = fopen(filepath, "wb");
-    if (file == NULL) {
-      SAUCE_SET_ERROR("Could not open %s for writing", filepath);
-      return SAUCE_EFOPEN;
-    }
+  return 0;
+}
 
-    if (writeRef != NULL) *writeRef = file;
-    else fclose(file);
+/**
+ * @brief Write exactly `n` bytes to a file descriptor at its current file offset. Unlike
+ *        `SAUCE_fd_pwrite()`, this also works for pipes and sockets.
+ * 
+ * @param fd file descriptor
+ * @param buffer buffer of at least `n` bytes
+ * @param n number of bytes to write
+ * @return 0 on success. On error, SAUCE_EFFAIL is returned.
+ */
+static int SAUCE_fd_write_all(int fd, const char* buffer, size_t n) {
+  size_t total = 0;
 
-    return 0;
+  #if defined(POSIX_IS_DEFINED)
+  while (total < n) {
+    ssize_t written = write(fd, buffer + total, n - total);
+    if (written < 0 && errno == EINTR) continue;
+    if (written <= 0) return SAUCE_EFFAIL;
+    total += (size_t)written;
+  }
+  #else
+  while (total < n) {
+    unsigned int chunk = (n - total > INT32_MAX) ? INT32_MAX : (unsigned int)(n - total);
+    int written = _write(fd, buffer + total, chunk);
+    if (written <= 0) return SAUCE_EFFAIL;
+    total += (size_t)written;
   }
+  #endif
 
-  // check for windows/posix truncate functions
-  #if defined(POSIX_IS_DEFINED)
-    int truncateRes = truncate(filepath, filesize - (int32_t)totalSauceSize);
-    if (truncateRes < 0) {
-      SAUCE_SET_ERROR("Failed to truncate %s using POSIX truncate function", filepath);
-      return SAUCE_EFFAIL;
-    }
+  return 0;
+}
 
-    if (writeRef != NULL) {
-      FILE* file = fopen(filepath, "ab");
-      if (file == NULL) {
-        SAUCE_SET_ERROR("Failed to open %s for appending", filepath);
-        return SAUCE_EFOPEN;
-      }
-      *writeRef = file;
-    }
-    return 0;
-  #elif defined(WINDOWS_IS_DEFINED)
-    // convert filepath to wide char string
-    size_t filepathStrLen = strlen(filepath);
-    wchar_t* wideString = malloc((filepathStrLen + 1) * sizeof(wchar_t));
-    wideString[filepathStrLen] = L'\0';
-    if (mbstowcs(wideString, filepath, filepathStrLen) != filepathStrLen) {
-      free(wideString);
-      SAUCE_SET_ERROR("Failed to create wide character string representation of %s filepath", filepath);
-      return SAUCE_EOTHER;
-    }
 
-    // open file
-    HANDLE fh;
-    fh = CreateFileW(wideString, GENERIC_WRITE, 0, NULL, OPEN_EXISTING, 0, NULL);
-    free(wideString);
-    if (fh == INVALID_HANDLE_VALUE) {
-      SAUCE_SET_ERROR("Failed to open %s using Windows CreateFileW()", filepath);
-      return SAUCE_EFOPEN;
+
+/**
+ * @brief Truncate the file referred to by a file descriptor to `length` bytes.
+ * 
+ * @param fd file descriptor
+ * @param length the new length of the file
+ * @return 0 on success. On error, SAUCE_EFFAIL is returned.
+ */
+static int SAUCE_fd_truncate(int fd, int64_t length) {
+  #if defined(POSIX_IS_DEFINED)
+  int res;
+  do {
+    res = ftruncate(fd, (off_t)length);
+  } while (res < 0 && errno == EINTR);
+  return (res < 0) ? SAUCE_EFFAIL : 0;
+  #else
+  return (_chsize_s(fd, length) != 0) ? SAUCE_EFFAIL : 0;
+  #endif
+}
+
+
+/**
+ * @brief Sync the data of the file referred to by a file descriptor to storage, along with the metadata needed
+ *        to read it back, such as its size. On macOS, the drive is also asked to flush its cache.
+ * 
+ * @param fd file descriptor
+ * @return 0 on success. On error, SAUCE_EFFAIL is returned.
+ */
+static int SAUCE_fd_sync(int fd) {
+  #if defined(POSIX_IS_DEFINED)
+  int res;
+  #ifdef F_FULLFSYNC
+  // fsync() on macOS leaves the data in the drive's cache
+  do {
+    res = fcntl(fd, F_FULLFSYNC);
+  } while (res < 0 && errno == EINTR);
+  if (res == 0) return 0;
+  #endif
+  do {
+    #if defined(_POSIX_SYNCHRONIZED_IO) && _POSIX_SYNCHRONIZED_IO > 0
+    res = fdatasync(fd);
+    #else
+    res = fsync(fd);
+    #endif
+  } while (res < 0 && errno == EINTR);
+  return (res < 0) ? SAUCE_EFFAIL : 0;
+  #else
+  return (_commit(fd) != 0) ? SAUCE_EFFAIL : 0;
+  #endif
+}
+
+
+/**
+ * @brief Start writing the dirty pages of a file descriptor back to storage without waiting for them, so that a
+ *        later `SAUCE_fd_sync()` only has to wait. Does nothing on systems other than Linux.
+ * 
+ * @param fd file descriptor
+ */
+static void SAUCE_fd_start_sync(int fd) {
+  #if defined(__linux__) && defined(SYNC_FILE_RANGE_WRITE)
+  sync_file_range(fd, 0, 0, SYNC_FILE_RANGE_WRITE);
+  #else
+  (void)fd;
+  #endif
+}
+
+
+/**
+ * @brief Read the tail of a file descriptor into `tail`. See `SAUCE_file_read_tail()`.
+ * 
+ * @param fd file descriptor open for reading
+ * @param tail array of length SAUCE_MAX_TAIL_SIZE that will be filled with the tail of the file
+ * @param filesize will be set to the size of the file
+ * @param length will be set to the number of bytes read into `tail`
+ * @return 0 on success. On error, SAUCE_EFFAIL is returned.
+ */
+static int SAUCE_fd_read_tail(int fd, char* tail, int64_t* filesize, uint32_t* length) {
+  *filesize = 0;
+  *length = 0;
+
+  int64_t size = 0;
+  int res = SAUCE_fd_size(fd, &size);
+  if (res < 0) return res;
+
+  uint32_t toRead = (size < SAUCE_MAX_TAIL_SIZE) ? (uint32_t)size : SAUCE_MAX_TAIL_SIZE;
+  res = SAUCE_fd_pread(fd, tail, toRead, size - toRead);
+  if (res < 0) return res;
+
+  *filesize = size;
+  *length = toRead;
+  return 0;
+}
+
+
+// A region of a file that was mapped into memory
+typedef struct SAUCEMap {
+  void* addr;       // start of the mapping, or NULL if nothing is mapped
+  size_t length;    // length of the mapping
+} SAUCEMap;
+
+
+#ifdef MMAP_IS_DEFINED
+/**
+ * @brief Map `n` bytes of a file descriptor starting at `offset` into memory. Since mappings must start
+ *        on a page boundary, the mapping will begin at the page containing `offset`.
+ * 
+ * @param fd file descriptor
+ * @param writable true to map the region for reading and writing, false to only map it for reading
+ * @param n number of bytes to map
+ * @param offset position in the file where the region starts
+ * @param map will be set to the mapping
+ * @param ptr will be set to the position of `offset` inside the mapping
+ * @return 0 on success. On error, SAUCE_EFFAIL is returned.
+ */
+static int SAUCE_fd_map(int fd, int writable, uint32_t n, int64_t offset, SAUCEMap* map, char** ptr) {
+  map->addr = NULL;
+  map->length = 0;
+
+  long pagesize = sysconf(_SC_PAGESIZE);
+  if (pagesize <= 0) return SAUCE_EFFAIL;
+  int64_t start = offset - (offset % pagesize);
+  size_t length = (size_t)(offset - start) + n;
+
+  // fault in every page of the tail at once instead of one page at a time
+  int flags = MAP_SHARED;
+  #ifdef MAP_POPULATE
+  flags |= MAP_POPULATE;
+  #endif
+  int prot = (writable) ? PROT_READ | PROT_WRITE : PROT_READ;
+
+  void* addr = mmap(NULL, length, prot, flags, fd, (off_t)start);
+  if (addr == MAP_FAILED) return SAUCE_EFFAIL;
+
+  map->addr = addr;
+  map->length = length;
+  *ptr = (char*)addr + (offset - start);
+  return 0;
+}
+#endif
+
+
+/**
+ * @brief Unmap a region mapped by `SAUCE_fd_map()`. Does nothing if nothing is mapped.
+ * 
+ * @param map the mapping
+ */
+static void SAUCE_fd_unmap(SAUCEMap* map) {
+  #ifdef MMAP_IS_DEFINED
+  if (map->addr != NULL) munmap(map->addr, map->length);
+  #endif
+  map->addr = NULL;
+  map->length = 0;
+}
+
+
+/**
+ * @brief Load the tail of a file descriptor. See `SAUCE_file_read_tail()` for what the tail is.
+ * 
+ *        In SAUCE_FM_MMAP mode, the tail is mapped into memory and `tail` will point into the mapping,
+ *        so the SAUCE data can be decoded without being copied. Otherwise, or if the file cannot be
+ *        mapped, the tail is read into `buffer`. Call `SAUCE_fd_unmap()` on `map` when done with the tail.
+ * 
+ * @param fd file descriptor open for reading
+ * @param buffer array of length SAUCE_MAX_TAIL_SIZE that the tail may be read into
+ * @param tail will be set to the tail of the file
+ * @param filesize will be set to the size of the file
+ * @param length will be set to the length of the tail
+ * @param map will be set to the mapping holding the tail, if any
+ * @return 0 on success. On error, SAUCE_EFFAIL is returned.
+ */
+static int SAUCE_fd_load_tail(int fd, char* buffer, const char** tail, int64_t* filesize, uint32_t* length, SAUCEMap* map) {
+  map->addr = NULL;
+  map->length = 0;
+  *tail = buffer;
+
+  #ifdef MMAP_IS_DEFINED
+  if (SAUCE_options()->fileMode == SAUCE_FM_MMAP) {
+    *filesize = 0;
+    *length = 0;
+
+    int64_t size = 0;
+    int res = SAUCE_fd_size(fd, &size);
+    if (res < 0) return res;
+    if (size == 0) return 0;
+
+    uint32_t toMap = (size < SAUCE_MAX_TAIL_SIZE) ? (uint32_t)size : SAUCE_MAX_TAIL_SIZE;
+    char* ptr = NULL;
+    if (SAUCE_fd_map(fd, 0, toMap, size - toMap, map, &ptr) == 0) {
+      *tail = ptr;
+      *filesize = size;
+      *length = toMap;
+      return 0;
     }
+    // files that cannot be mapped are read instead
+  }
+  #endif
 
-    // go to beginning of SAUCE data
-    LARGE_INTEGER li;
-    li.QuadPart = filesize - totalSauceSize;
-    if (SetFilePointerEx(fh, li, NULL, FILE_BEGIN) == 0) {
-      CloseHandle(fh);
-      SAUCE_SET_ERROR("SetFilePointerEx() failed to seek to beginning of SAUCE data in %s", filepath);
-      return SAUCE_EFFAIL;
+  return SAUCE_fd_read_tail(fd, buffer, filesize, length);
+}
+
+
+/**
+ * @brief Write exactly `n` bytes at `offset` to a file descriptor.
+ * 
+ *        In SAUCE_FM_MMAP mode, the file is first grown with a truncate if the bytes extend past the end
+ *        of the file, and the bytes are then copied into a mapping of that region. Otherwise, or if the
+ *        region cannot be mapped, the bytes are written with `SAUCE_fd_pwrite()`.
+ * 
+ * @param fd file descriptor open for reading and writing
+ * @param buffer buffer of at least `n` bytes
+ * @param n number of bytes to write
+ * @param offset position in the file to write to
+ * @param filesize the current size of the file
+ * @return 0 on success. On error, SAUCE_EFFAIL is returned.
+ */
+static int SAUCE_fd_store(int fd, const char* buffer, uint32_t n, int64_t offset, int64_t filesize) {
+  #ifdef MMAP_IS_DEFINED
+  if (SAUCE_options()->fileMode == SAUCE_FM_MMAP && n > 0) {
+    int64_t end = offset + n;
+    if (end > filesize && SAUCE_fd_truncate(fd, end) < 0) return SAUCE_EFFAIL;
+
+    SAUCEMap map;
+    char* ptr = NULL;
+    if (SAUCE_fd_map(fd, 1, n, offset, &map, &ptr) == 0) {
+      memcpy(ptr, buffer, n);
+      SAUCE_fd_unmap(&map);
+      return 0;
+    }
+  }
+  #else
+  (void)filesize;
+  #endif
+
+  return SAUCE_fd_pwrite(fd, buffer, n, offset);
+}
+
+
+/**
+ * @brief Write a name for a file descriptor to be used in error messages.
+ * 
+ * @param fd file descriptor
+ * @param name array of length FD_NAME_SIZE
+ */
+#define FD_NAME_SIZE  32
+static void SAUCE_fd_name(int fd, char* name) {
+  snprintf(name, FD_NAME_SIZE, "file descriptor %d", fd);
+}
+#endif //FD_IO_IS_DEFINED
+
+
+#ifndef FD_IO_IS_DEFINED
+/**
+ * @brief Read the tail of a file into `tail`. The tail is the last `SAUCE_MAX_TAIL_SIZE` bytes of the file,
+ *        or the entire file if the file is shorter than that. Since the tail is large enough to hold the
+ *        largest possible SAUCE data, the record and comment can be decoded from `tail` without accessing
+ *        the file again.
+ * 
+ *        Only C standard I/O is used, so the whole file is read in chunks. On Windows and POSIX systems,
+ *        `SAUCE_fd_load_tail()` is used instead. No error message is set; use `SAUCE_set_tail_error()`
+ *        to report a failure.
+ * 
+ * @param filepath path to file
+ * @param tail array of length SAUCE_MAX_TAIL_SIZE that will be filled with the tail of the file
+ * @param filesize will be set to the size of the file
+ * @param length will be set to the number of bytes read into `tail`
+ * @return 0 on success. SAUCE_EFOPEN is returned if the file could not be opened, SAUCE_EFFAIL if the file could
+ *         not be read, and SAUCE_EOTHER if the size of the file cannot be represented.
+ */
+static int SAUCE_file_read_tail(const char* filepath, char* tail, int64_t* filesize, uint32_t* length) {
+  *filesize = 0;
+  *length = 0;
+
+  // Read the file from beginning to end in tail sized chunks. The previous chunk is kept in the
+  // first half of `buffer` so the tail can be put together when the last chunk is short.
+  FILE* file = fopen(filepath, "rb");
+  if (file == NULL) return SAUCE_EFOPEN;
+
+  char buffer[SAUCE_MAX_TAIL_SIZE * 2];
+  char* curr = &buffer[SAUCE_MAX_TAIL_SIZE];
+  size_t read = 0;
+  uint32_t prev = 0; // number of bytes held in the first half of buffer
+  int64_t total = 0;
+
+  while (1) {
+    read = fread(curr, 1, SAUCE_MAX_TAIL_SIZE, file);
+    // check for overflow
+    if (total > INT64_MAX - (int64_t)read) {
+      fclose(file);
+      return SAUCE_EOTHER;
     }
+    total += read;
 
-    // truncate by setting end of file
-    BOOL endOfFileRes = SetEndOfFile(fh);
-    CloseHandle(fh);
-    if (endOfFileRes == 0) {
-      SAUCE_SET_ERROR("Failed to truncate %s using Windows SetEndOfFile()", filepath);
+    if (read < SAUCE_MAX_TAIL_SIZE) {
+      if (feof(file)) break;
+      fclose(file);
       return SAUCE_EFFAIL;
     }
 
-    // set writeRef if needed
-    if (writeRef != NULL) {
-      FILE* file = fopen(filepath, "ab");
-      if (file == NULL) {
-        SAUCE_SET_ERROR("Failed to open %s for appending", filepath);
-        return SAUCE_EFOPEN;
-      }
-      *writeRef = file;
+    memcpy(buffer, curr, SAUCE_MAX_TAIL_SIZE);
+    prev = SAUCE_MAX_TAIL_SIZE;
+  }
+  fclose(file);
+
+  // the tail ends at the last byte read into curr
+  uint32_t available = prev + (uint32_t)read;
+  uint32_t tailLength = (available < SAUCE_MAX_TAIL_SIZE) ? available : SAUCE_MAX_TAIL_SIZE;
+  memcpy(tail, curr + read - tailLength, tailLength);
+
+  *filesize = total;
+  *length = tailLength;
+  return 0;
+}
+#endif
+
+
+/**
+ * @brief Set the error message for a failed `SAUCE_file_read_tail()` or `SAUCE_fd_load_tail()` call.
+ * 
+ * @param filepath path or name of the file
+ * @param res the error code returned when reading the tail
+ * @return `res`
+ */
+static int SAUCE_set_tail_error(const char* filepath, int res) {
+  switch (res) {
+    case SAUCE_EFOPEN:
+      SAUCE_SET_ERROR("Failed to open %s for reading", filepath);
+      break;
+    case SAUCE_EFFAIL:
+      SAUCE_SET_ERROR("Failed to read the end of %s", filepath);
+      break;
+    case SAUCE_EOTHER:
+      SAUCE_SET_ERROR("File size of %s is too large to be represented", filepath);
+      break;
+    default:
+      break;
+  }
+  return res;
+}
+
+
+#ifndef FD_IO_IS_DEFINED
+/**
+ * @brief Seek to `offset` from the beginning of a file. `fseek()` only takes a `long` offset,
+ *        so seeking fails if `offset` cannot be represented as one.
+ * 
+ * @param file FILE pointer
+ * @param offset position in the file
+ * @return 0 on success. On error, a negative number is returned.
+ */
+static int SAUCE_file_seek(FILE* file, int64_t offset) {
+  if (offset > LONG_MAX) return -1;
+  return fseek(file, (long)offset, SEEK_SET);
+}
+
+
+/**
+ * @brief Truncate the file by removing all SAUCE data from the end of the file.
+ *        The last `totalSauceSize` bytes of the file will be removed. On success,
+ *        writeRef will be set to the trucated file for writing and be positioned at end of the file.
+ * 
+ *        This is only used when file descriptors are not available, so the file is truncated by
+ *        copying it through a temporary file created with `tmpfile()`.
+ * 
+ * @param file FILE pointer to file to truncate; should be open for reading
+ * @param filesize size of the original file
+ * @param totalSauceSize size/length of the SAUCE data; this can include an EOF character
+ * @param writeRef on success, will be set to the truncated file for writing and be positioned at the end of the file. 
+ *                 If NULL, `writeRef` will not be set and the file will automatically be closed.
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_file_truncate(const char* filepath, int64_t filesize, uint16_t totalSauceSize, FILE** writeRef) {
+  if (filesize < totalSauceSize) {
+    SAUCE_SET_ERROR("The total size of the SAUCE data cannot be greater than the filesize");
+    return SAUCE_EOTHER;
+  }
+
+  if (filesize == totalSauceSize) {
+    // just clear the entire file
+    FILE* file = fopen(filepath, "wb");
+    if (file == NULL) {
+      SAUCE_SET_ERROR("Could not open %s for writing", filepath);
+      return SAUCE_EFOPEN;
     }
+
+    if (writeRef != NULL) *writeRef = file;
+    else fclose(file);
+
     return 0;
-  #else
+  }
 
   // open file and temp file
   FILE* file = fopen(filepath, "rb");
@@ -501,7 +1059,7 @@ static int SAUCE_file_truncate(const char* filepath, int32_t filesize, uint16_t
   // copy file into tempFile
   char buffer[FILE_BUF_READ_SIZE];
   size_t read, write, readSize;
-  int32_t total = 0;
+  int64_t total = 0;
   
   readSize = FILE_BUF_READ_SIZE;
   while (1) {
@@ -563,8 +1121,8 @@ static int SAUCE_file_truncate(const char* filepath, int32_t filesize, uint16_t
   if (writeRef != NULL) *writeRef = file;
   else fclose(file);
   return 0;
-  #endif
 }
+#endif //FD_IO_IS_DEFINED
 
 
 
@@ -579,14 +1137,14 @@ static int SAUCE_file_truncate(const char* filepath, int32_t filesize, uint16_t
  * @param lines the number of comment lines
  * @return the new length of the buffer
  */
-static uint32_t insert_eof_char(char* buffer, uint32_t n, uint8_t lines) {
+static size_t insert_eof_char(char* buffer, size_t n, uint8_t lines) {
   if (n < SAUCE_RECORD_SIZE) return n;
   if (memcmp(&buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_ID, 5) != 0) return n;
 
   if (lines > 0) {
     // comment could exist, check if n is large enough to contain EOF
     if (n > SAUCE_TOTAL_SIZE(lines)) {
-      uint32_t comment_index = n - SAUCE_TOTAL_SIZE(lines);
+      size_t comment_index = n - SAUCE_TOTAL_SIZE(lines);
       // check for COMNT id and if EOF character doesn't exist before it
       if (memcmp(&buffer[comment_index], SAUCE_COMMENT_ID, 5) == 0 && buffer[comment_index-1] != SAUCE_EOF_CHAR) {
         // move SAUCE data forward 1 byte
@@ -623,1089 +1181,7223 @@ typedef struct SAUCEInfo {
   int comment_exists;     // boolean; true if the comment exists, false if otherwise
   int eof_exists;         // boolean; true if the eof char exists, false if otherwise. Will be immediately before comment/record.
   uint8_t lines;          // The number of comment lines reported in the record. Note that a positive `lines` and false `comment_exists` signals an invalid comment.
-  int32_t start;         // The starting index/position of the SAUCE data; if an eof exists, it will be immediately before this index
+  int64_t start;          // The starting index/position of the SAUCE data; if an eof exists, it will be immediately before this index
   uint32_t sauce_length;  // The length of the found SAUCE data. This is also the length of the `dataBuffer`.
 } SAUCEInfo;
 
 /**
- * @brief Get info about SAUCE data in a file and optionally retrieve all available SAUCE data. 
- *        See SAUCEInfo struct for what info is collected. `info` will always be set appropriately, 
- *        no matter the return condition.
- * 
- *        If `dataBuffer` is not NULL, then `dataBuffer` will be malloced
- *        and contain a copy of any found SAUCE data. Length of `dataBuffer` will be
- *        `info->sauce_length`. The `dataBuffer` will not contain the eof character,
- *        if the eof exists. `dataBuffer` will NOT be allocated if no SAUCE record was
- *        found. As long a SAUCE record is found, the `dataBuffer` will be allocated.
+ * @brief Decode SAUCE data from the end of a buffer without setting any error messages. See SAUCEInfo struct for
+ *        what info is collected. `info` will always be set appropriately, no matter the return condition.
  * 
  *        Some info will be irrelevant if certain conditions are not met.
  *        For example, if no record exists, all other SAUCEInfo fields will be irrelevant.
  * 
- * @param filepath path to file
+ * @param buffer a buffer array
+ * @param n the length of the buffer
  * @param info SAUCEInfo struct which will be filled with info on the SAUCE data
- * @param filesizePtr will be set to the size of the file. Can be NULL.
- * @param dataBuffer buffer that will be malloced and contain the SAUCE data; if NULL, nothing will be allocated
  * @return 0 on success. A success is when a record is found or a record is found along with an optional valid comment. 
  *         On error, a negative error code is returned.
  */
-static int SAUCE_file_get_info(const char* filepath, SAUCEInfo* info, int32_t* filesizePtr, char** dataBuffer) {
-  if (info == NULL) {
-    SAUCE_SET_ERROR("SAUCEInfo struct was NULL");
-    return SAUCE_ENULL;
-  }
+static int SAUCE_decode_info(const char* buffer, size_t n, SAUCEInfo* info) {
   memset(info, 0, sizeof(SAUCEInfo));
 
-  if (filepath == NULL) {
-    SAUCE_SET_ERROR("Filepath was NULL");
-    return SAUCE_ENULL;
-  }
-
-  FILE* file = fopen(filepath, "rb");
-  if (file == NULL) {
-    SAUCE_SET_ERROR("Failed to open %s for reading", filepath);
-    return SAUCE_EFOPEN;
-  }
+  if (n == 0) return SAUCE_EEMPTY;
+  if (n < SAUCE_RECORD_SIZE) return SAUCE_ESHORT;
 
-  char record[SAUCE_RECORD_SIZE + 1];
-  int32_t filesize = 0;
-  int res = SAUCE_file_find_record(file, record, &filesize);
-  if (filesizePtr != NULL) *filesizePtr = filesize;
-  if (res < 0) {
-    fclose(file);
-    switch (res) {
-      case SAUCE_ERMISS:
-        SAUCE_SET_ERROR("%s does not contain a record", filepath);
-        break;
-      case SAUCE_EEMPTY:
-        SAUCE_SET_ERROR("%s is an empty file and cannot contain a record", filepath);
-        break;
-      case SAUCE_ESHORT:
-        SAUCE_SET_ERROR("%s is too short to contain a record", filepath);
-        break;
-      default:
-        break;
-    }
-    info->record_exists = 0;
-    return res;
+  // look for record
+  if (memcmp(&buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_ID, 5) != 0) {
+    return SAUCE_ERMISS;
   }
-
-  // found record, fill appropriate info
   info->record_exists = 1;
-  info->start = filesize - SAUCE_RECORD_SIZE;
+  info->start = n - SAUCE_RECORD_SIZE;
   info->sauce_length = SAUCE_RECORD_SIZE;
-  info->eof_exists = 0;
 
-  // get start of record and previous character
-  uint8_t record_start = 1;
-  if (memcmp(record, SAUCE_RECORD_ID, 5) == 0) record_start = 0;
-  if (record_start == 1 && record[0] == SAUCE_EOF_CHAR) info->eof_exists = 1;
-  info->lines = ((SAUCE*)(&record[record_start]))->Comments;
+  if (n > SAUCE_RECORD_SIZE && buffer[info->start - 1] == SAUCE_EOF_CHAR) info->eof_exists = 1;
+  info->lines = ((SAUCE*)(&buffer[info->start]))->Comments;
 
   // look for comment
-  res = 0; // SAUCE_file_find_comment may return error. res will keep track of it.
-  char* commentBuffer = NULL;
   if (info->lines == 0) {
     info->comment_exists = 0;
-  } else {
-    info->comment_exists = 1;
-    info->eof_exists = 0;
-    uint8_t linesToRead = (dataBuffer == NULL) ? 1 : info->lines;
-    commentBuffer = malloc(SAUCE_COMMENT_BLOCK_SIZE(info->lines) + 1);
-    res = SAUCE_file_find_comment(file, commentBuffer, filesize, info->lines, linesToRead);
-    if (res < 0) {
-      info->comment_exists = 0;
-      if (res == SAUCE_ECMISS) {
-        SAUCE_set_error("Record in %s claims that %d comment lines can be read, but the comment could not be found", filepath, info->lines);
-      }
-    } else {
-      if (commentBuffer[0] == SAUCE_EOF_CHAR) info->eof_exists = 1;
-      info->start = filesize - SAUCE_TOTAL_SIZE(info->lines);
-      info->sauce_length = SAUCE_TOTAL_SIZE(info->lines);
-    }
-  }
-
-  fclose(file);
-
-  if (dataBuffer == NULL) {
-    // nothing else to do, data does not need to copied
-    if (commentBuffer != NULL) free(commentBuffer);
-    return res;
+    return 0;
   }
 
-  // write to the dataBuffer
-  if (info->comment_exists) {
-    *dataBuffer = malloc(SAUCE_TOTAL_SIZE(info->lines));
-    if (memcmp(commentBuffer, SAUCE_COMMENT_ID, 5) == 0) {
-      memcpy(*dataBuffer, commentBuffer, SAUCE_COMMENT_BLOCK_SIZE(info->lines));
-    } else {
-      memcpy(*dataBuffer, commentBuffer+1, SAUCE_COMMENT_BLOCK_SIZE(info->lines));
-    }
-    memcpy(&((*dataBuffer)[SAUCE_COMMENT_BLOCK_SIZE(info->lines)]), &record[record_start], SAUCE_RECORD_SIZE);
+  info->eof_exists = 0;
+  uint32_t sauceSize = SAUCE_TOTAL_SIZE(info->lines);
+  if (n < sauceSize) {
+    return SAUCE_ESHORT;
   }
-  else {
-    *dataBuffer = malloc(SAUCE_RECORD_SIZE);
-    memcpy(*dataBuffer, &record[record_start], SAUCE_RECORD_SIZE);
+  if (memcmp(&buffer[n - sauceSize], SAUCE_COMMENT_ID, 5) != 0) {
+    return SAUCE_ECMISS;
   }
 
-  if (commentBuffer != NULL) free(commentBuffer);
+  // comment found
+  info->comment_exists = 1;
+  info->start = n - sauceSize;
+  info->sauce_length = sauceSize;
+  if (n > sauceSize && buffer[info->start - 1] == SAUCE_EOF_CHAR) info->eof_exists = 1;
+
+  return 0;
+}
+
+
+/**
+ * @brief Set the error message for a file whose SAUCE data could not be decoded.
+ * 
+ * @param name name of the file to be used in error messages
+ * @param res the result of decoding the SAUCE data
+ * @param info info on the SAUCE data
+ * @return `res`
+ */
+static int SAUCE_set_info_error(const char* name, int res, const SAUCEInfo* info) {
+  switch (res) {
+    case SAUCE_ERMISS:
+      SAUCE_SET_ERROR("%s does not contain a record", name);
+      break;
+    case SAUCE_EEMPTY:
+      SAUCE_SET_ERROR("%s is an empty file and cannot contain a record", name);
+      break;
+    case SAUCE_ESHORT:
+      if (!info->record_exists) {
+        SAUCE_SET_ERROR("%s is too short to contain a record", name);
+      } else {
+        SAUCE_SET_ERROR("%s is too short to contain a comment with a total of %d lines", name, info->lines);
+      }
+      break;
+    case SAUCE_ECMISS:
+      SAUCE_SET_ERROR("Record in %s claims that %d comment lines can be read, but the comment could not be found", name, info->lines);
+      break;
+    default:
+      break;
+  }
   return res;
 }
 
 
 /**
- * @brief Get info about SAUCE data in a buffer. See SAUCEInfo struct for what info is
- *        collected. `info` will always be set appropriately, no matter the return condition.
+ * @brief Get info about SAUCE data from the tail of a file, setting an error message on failure.
+ *        See SAUCEInfo struct for what info is collected. `info` will always be set appropriately,
+ *        no matter the return condition. `info->start` will be relative to the beginning of the file.
  * 
  *        Some info will be irrelevant if certain conditions are not met.
  *        For example, if no record exists, all other SAUCEInfo fields will be irrelevant.
  * 
- * @param buffer a buffer array
- * @param n the length of the buffer
+ * @param name name of the file to be used in error messages
+ * @param tail the tail of the file, see `SAUCE_file_read_tail()`
+ * @param length the length of the tail
+ * @param filesize the size of the file
  * @param info SAUCEInfo struct which will be filled with info on the SAUCE data
+ * @param dataPtr will be set to the beginning of the SAUCE data in `tail` if a record is found. Can be NULL.
  * @return 0 on success. A success is when a record is found or a record is found along with an optional valid comment. 
  *         On error, a negative error code is returned.
  */
-static int SAUCE_buffer_get_info(const char* buffer, uint32_t n, SAUCEInfo* info) {
-  if (info == NULL) {
-    SAUCE_SET_ERROR("SAUCEInfo struct was NULL");
-    return SAUCE_ENULL;
-  }
-  memset(info, 0, sizeof(SAUCEInfo));
-  
-  if (buffer == NULL) {
-    SAUCE_SET_ERROR("Buffer was NULL");
-    return SAUCE_ENULL;
-  }
-  if (n == 0) {
-    SAUCE_SET_ERROR("Buffer's length is zero and cannot contain a record");
-    return SAUCE_EEMPTY;
-  }
-  if (n < SAUCE_RECORD_SIZE) {
-    SAUCE_SET_ERROR("Buffer's length is too short to contain a record");
-    return SAUCE_ESHORT;
-  }
-
-  // look for record
-  if (memcmp(&buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_ID, 5) != 0) {
-    return SAUCE_ERMISS;
-  }
-  info->record_exists = 1;
-  info->start = n - SAUCE_RECORD_SIZE;
-  info->sauce_length = SAUCE_RECORD_SIZE;
-
-  if (n > SAUCE_RECORD_SIZE && buffer[info->start - 1] == SAUCE_EOF_CHAR) info->eof_exists = 1;
-  info->lines = ((SAUCE*)(&buffer[info->start]))->Comments;
-
-  // look for comment
-  if (info->lines == 0) {
-    info->comment_exists = 0;
-  } else {
-    info->comment_exists = 1;
-    info->eof_exists = 0;
-    uint32_t sauceSize = SAUCE_TOTAL_SIZE(info->lines);
-    if (n < sauceSize) {
-      SAUCE_SET_ERROR("Buffer is too short to contain a comment with %d lines", info->lines);
-      return SAUCE_ESHORT;
-    }
-    if (memcmp(&buffer[n - sauceSize], SAUCE_COMMENT_ID, 5) != 0) {
-      info->comment_exists = 0;
-      SAUCE_SET_ERROR("Record in buffer claims that %d comment lines can be read, but the comment could not be found", info->lines);
-      return SAUCE_ECMISS;
-    }
+static int SAUCE_tail_get_info(const char* name, const char* tail, uint32_t length, int64_t filesize, SAUCEInfo* info, const char** dataPtr) {
+  int res = SAUCE_set_info_error(name, SAUCE_decode_info(tail, length, info), info);
+  if (!info->record_exists) return res;
 
-    // comment found
-    info->start = n - sauceSize;
-    info->sauce_length = sauceSize;
-    if (n > sauceSize && buffer[info->start - 1] == SAUCE_EOF_CHAR) info->eof_exists = 1;
-  }
+  // make the start relative to the beginning of the file instead of the tail
+  if (dataPtr != NULL) *dataPtr = &tail[info->start];
+  info->start += filesize - length;
 
-  return 0;
+  return res;
 }
 
 
-
-
-// Helper Functions
-
+#ifndef FD_IO_IS_DEFINED
 /**
- * @brief Get an error message about the last SAUCE error that occurred.
+ * @brief Get info about SAUCE data in a file and optionally retrieve all available SAUCE data. 
+ *        See SAUCEInfo struct for what info is collected. `info` will always be set appropriately, 
+ *        no matter the return condition.
  * 
- * @return an error message, or an empty string if no SAUCE error has yet to occur
- */
-const char* SAUCE_get_error(void) {
-  return error_msg;
-}
-
-
-/**
- * @brief Fill a SAUCE struct with the default fields. ID and Version fields will be set
-          to their required values. All other fields will be set to their defaults, which
-          is typically 0 or spaces.
+ *        The file is opened once and its tail is read into `buffer` with a single read, after which
+ *        the record and comment are decoded in memory. If a record is found, `dataPtr` will point to
+ *        the SAUCE data inside of `buffer`, not including the eof character. Nothing is allocated.
  * 
- * @param sauce a SAUCE struct to be set
+ *        Some info will be irrelevant if certain conditions are not met.
+ *        For example, if no record exists, all other SAUCEInfo fields will be irrelevant.
+ * 
+ * @param filepath path to file
+ * @param info SAUCEInfo struct which will be filled with info on the SAUCE data
+ * @param filesizePtr will be set to the size of the file. Can be NULL.
+ * @param buffer array of length SAUCE_MAX_TAIL_SIZE that will be filled with the tail of the file
+ * @param dataPtr will be set to the beginning of the SAUCE data in `buffer` if a record is found. Can be NULL.
+ * @return 0 on success. A success is when a record is found or a record is found along with an optional valid comment. 
+ *         On error, a negative error code is returned.
  */
-void SAUCE_set_default(SAUCE* sauce) {
-  memset(sauce, 0, sizeof(SAUCE)); // zero everything out
+static int SAUCE_file_get_info(const char* filepath, SAUCEInfo* info, int64_t* filesizePtr, char* buffer, char** dataPtr) {
+  if (info == NULL) {
+    SAUCE_SET_ERROR("SAUCEInfo struct was NULL");
+    return SAUCE_ENULL;
+  }
+  memset(info, 0, sizeof(SAUCEInfo));
 
-  memcpy(sauce->ID, SAUCE_RECORD_ID, 5);
-  memcpy(sauce->Version, "00", 2);
+  if (filepath == NULL) {
+    SAUCE_SET_ERROR("Filepath was NULL");
+    return SAUCE_ENULL;
+  }
 
-  // set the character fields to spaces
-  memset(sauce->Title, ' ', sizeof(sauce->Title));
-  memset(sauce->Author, ' ', sizeof(sauce->Author));
-  memset(sauce->Group, ' ', sizeof(sauce->Group));
-  memset(sauce->Date, ' ', sizeof(sauce->Date));
+  uint32_t length = 0;
+  int64_t filesize = 0;
+  int res = SAUCE_file_read_tail(filepath, buffer, &filesize, &length);
+  if (filesizePtr != NULL) *filesizePtr = filesize;
+  if (res < 0) return SAUCE_set_tail_error(filepath, res);
+
+  const char* data = NULL;
+  res = SAUCE_tail_get_info(filepath, buffer, length, filesize, info, &data);
+  if (dataPtr != NULL && info->record_exists) *dataPtr = buffer + (data - buffer);
+  return res;
 }
+#endif
 
 
+#ifdef FD_IO_IS_DEFINED
 /**
- * @brief Determine how many comment lines a string will need in order to
- *        place it in a CommentBlock.
+ * @brief Get info about SAUCE data in a file descriptor. See SAUCEInfo struct for what info is collected.
+ *        `info` will always be set appropriately, no matter the return condition.
  * 
- * @param string a null-terminated string
- * @return how many lines the string will need
+ *        The tail of the file is loaded with `SAUCE_fd_load_tail()`. If a record is found, `dataPtr` will
+ *        point to the SAUCE data inside of `buffer`, not including the eof character. The byte before
+ *        `*dataPtr` can always be written to, which leaves room for inserting an eof character.
+ *        When the tail is mapped, only the SAUCE data is copied into `buffer`.
+ * 
+ * @param fd file descriptor open for reading
+ * @param name name of the file to be used in error messages
+ * @param info SAUCEInfo struct which will be filled with info on the SAUCE data
+ * @param filesizePtr will be set to the size of the file. Can be NULL.
+ * @param buffer array of length SAUCE_MAX_TAIL_SIZE + 1 that will be filled with the tail of the file
+ * @param dataPtr will be set to the beginning of the SAUCE data in `buffer` if a record is found. Can be NULL.
+ * @return 0 on success. A success is when a record is found or a record is found along with an optional valid comment. 
+ *         On error, a negative error code is returned.
  */
-uint8_t SAUCE_num_lines(const char* string) {
-  int lines = 0;
-  int length = strlen(string);
-
-  if (length == 0) return 0; //handle empty string
-  if (length >= UINT8_MAX * SAUCE_COMMENT_LINE_LENGTH) return UINT8_MAX; // handle largest possible string
+static int SAUCE_fd_get_info(int fd, const char* name, SAUCEInfo* info, int64_t* filesizePtr, char* buffer, char** dataPtr) {
+  memset(info, 0, sizeof(SAUCEInfo));
 
-  while (length > 0) {
-    lines++;
-    length -= SAUCE_COMMENT_LINE_LENGTH;
+  // keep the first byte of buffer free
+  const char* tail = NULL;
+  uint32_t length = 0;
+  int64_t filesize = 0;
+  SAUCEMap map;
+  int res = SAUCE_fd_load_tail(fd, buffer + 1, &tail, &filesize, &length, &map);
+  if (filesizePtr != NULL) *filesizePtr = filesize;
+  if (res < 0) return SAUCE_set_tail_error(name, res);
+
+  const char* data = NULL;
+  res = SAUCE_tail_get_info(name, tail, length, filesize, info, &data);
+  if (dataPtr != NULL && info->record_exists) {
+    if (map.addr != NULL) {
+      // copy the SAUCE data out of the mapping
+      memcpy(buffer + 1, data, info->sauce_length);
+      *dataPtr = buffer + 1;
+    } else {
+      *dataPtr = buffer + 1 + (data - tail);
+    }
   }
 
-  return lines;
+  SAUCE_fd_unmap(&map);
+  return res;
 }
 
+#endif
 
 
-
-
-// Read Functions
-
 /**
- * @brief From a file, read a SAUCE record into `sauce`.
+ * @brief Get info about SAUCE data in a buffer. See SAUCEInfo struct for what info is
+ *        collected. `info` will always be set appropriately, no matter the return condition.
  * 
- * @param filepath a path to a file 
- * @param sauce a SAUCE struct that will be filled with the parsed SAUCE record
- * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
- *         to get more info on the error.
+ *        Some info will be irrelevant if certain conditions are not met.
+ *        For example, if no record exists, all other SAUCEInfo fields will be irrelevant.
+ * 
+ * @param buffer a buffer array
+ * @param n the length of the buffer
+ * @param info SAUCEInfo struct which will be filled with info on the SAUCE data
+ * @return 0 on success. A success is when a record is found or a record is found along with an optional valid comment. 
+ *         On error, a negative error code is returned.
  */
-int SAUCE_fread(const char* filepath, SAUCE* sauce) {
-  // null checks
-  if (filepath == NULL) {
-    SAUCE_SET_ERROR("Filepath was NULL");
+static int SAUCE_buffer_get_info(const char* buffer, size_t n, SAUCEInfo* info) {
+  if (info == NULL) {
+    SAUCE_SET_ERROR("SAUCEInfo struct was NULL");
     return SAUCE_ENULL;
   }
-  if (sauce == NULL) {
-    SAUCE_SET_ERROR("SAUCE struct was NULL");
+  memset(info, 0, sizeof(SAUCEInfo));
+  
+  if (buffer == NULL) {
+    SAUCE_SET_ERROR("Buffer was NULL");
     return SAUCE_ENULL;
   }
 
-  // open file
-  FILE* file = fopen(filepath, "rb");
-  if (file == NULL) {
-    SAUCE_SET_ERROR("Could not open %s", filepath);
-    return SAUCE_EFOPEN;
+  int res = SAUCE_decode_info(buffer, n, info);
+  switch (res) {
+    case SAUCE_EEMPTY:
+      SAUCE_SET_ERROR("Buffer's length is zero and cannot contain a record");
+      break;
+    case SAUCE_ESHORT:
+      if (!info->record_exists) {
+        SAUCE_SET_ERROR("Buffer's length is too short to contain a record");
+      } else {
+        SAUCE_SET_ERROR("Buffer is too short to contain a comment with %d lines", info->lines);
+      }
+      break;
+    case SAUCE_ECMISS:
+      SAUCE_SET_ERROR("Record in buffer claims that %d comment lines can be read, but the comment could not be found", info->lines);
+      break;
+    default:
+      break;
   }
 
-  // get record
-  char record[SAUCE_RECORD_SIZE + 1];
-  int32_t filesize = 0;
-  int res = SAUCE_file_find_record(file, record, &filesize);
-  fclose(file);
-  if (res == SAUCE_EEMPTY) {
-    SAUCE_SET_ERROR("%s is empty and cannot contain a record", filepath);
-    return SAUCE_EEMPTY;
-  } else if (filesize < SAUCE_RECORD_SIZE) {
-    SAUCE_SET_ERROR("%s is too short to contain a record", filepath);
-    return SAUCE_ESHORT;
-  } else if (res == SAUCE_ERMISS) {
-    SAUCE_SET_ERROR("%s does not contain a record", filepath);
-    return SAUCE_ERMISS;
-  } else if (res < 0) {
-    return res;
-  }
+  return res;
+}
 
-  // record was found, copy it into sauce
-  if (memcmp(record, SAUCE_RECORD_ID, 5) == 0) {
-    memcpy(sauce, record, SAUCE_RECORD_SIZE);
+
+
+
+/**
+ * @brief Fill a public SAUCE_Layout from the info on the SAUCE data of a file or buffer.
+ * 
+ * @param info info on the SAUCE data
+ * @param size the size of the file or buffer
+ * @param layout the layout to fill
+ */
+static void SAUCE_info_layout(const SAUCEInfo* info, int64_t size, SAUCE_Layout* layout) {
+  layout->record_exists = info->record_exists;
+  layout->comment_exists = info->comment_exists;
+  layout->eof_exists = info->eof_exists;
+  layout->lines = info->lines;
+  if (info->record_exists) {
+    layout->start = info->start;
+    layout->sauce_length = info->sauce_length;
   } else {
-    memcpy(sauce, record+1, SAUCE_RECORD_SIZE);
+    layout->start = size;
+    layout->sauce_length = 0;
   }
+  layout->content_length = layout->start - (layout->eof_exists ? 1 : 0);
+}
+
+
 
+
+/**
+ * @brief Copy a record from the end of the tail of a file into `sauce` without setting any error messages.
+ *        Only the last `SAUCE_RECORD_SIZE` bytes of the tail are needed.
+ * 
+ * @param tail the tail of the file
+ * @param length the length of the tail
+ * @param filesize the size of the file
+ * @param sauce a SAUCE struct that will be filled with the record
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_decode_record(const char* tail, uint32_t length, int64_t filesize, SAUCE* sauce) {
+  if (filesize == 0) return SAUCE_EEMPTY;
+  if (filesize < SAUCE_RECORD_SIZE || length < SAUCE_RECORD_SIZE) return SAUCE_ESHORT;
+  if (memcmp(&tail[length - SAUCE_RECORD_SIZE], SAUCE_RECORD_ID, 5) != 0) return SAUCE_ERMISS;
+
+  // record was found, copy it into sauce
+  memcpy(sauce, &tail[length - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
   return 0;
 }
 
 
+static int SAUCE_set_record_error(const char* name, int res);
+
 /**
- * @brief From a file, read at most `nLines` of a SAUCE CommentBlock into `comment`.
- *        A null character will be appended onto `comment` as well.
- * 
+ * @brief Copy a record from the tail of a file into `sauce`, setting an error message if the tail
+ *        does not end with a record.
  * 
- *        If the file does not contain a comment or the actual number of lines is less
- *        than `nLines`, then expect 0 lines or all lines to be read, respectively.
+ * @param name name of the file to be used in error messages
+ * @param tail the tail of the file, see `SAUCE_file_read_tail()`
+ * @param length the length of the tail
+ * @param filesize the size of the file
+ * @param sauce a SAUCE struct that will be filled with the record
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_tail_read_record(const char* name, const char* tail, uint32_t length, int64_t filesize, SAUCE* sauce) {
+  return SAUCE_set_record_error(name, SAUCE_decode_record(tail, length, filesize, sauce));
+}
+
+
+/**
+ * @brief Set the error message for a file whose record could not be read.
  * 
- * @param filepath a path to a file 
- * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1` that will contain the comment
- * @param nLines the number of lines to read
- * @return On success, the number of lines read. On error, a negative error code is returned. Use `SAUCE_get_error()`
- *         to get more info on the error.
+ * @param name name of the file to be used in error messages
+ * @param res the result of reading the record
+ * @return `res`
  */
-int SAUCE_Comment_fread(const char* filepath, char* comment, uint8_t nLines) {
-  if (filepath == NULL) {
-    SAUCE_SET_ERROR("Filepath was NULL");
-    return SAUCE_ENULL;
-  }
-  if (comment == NULL) {
-    SAUCE_SET_ERROR("Comment string argument was NULL");
-    return SAUCE_ENULL;
+static int SAUCE_set_record_error(const char* name, int res) {
+  switch (res) {
+    case SAUCE_EEMPTY:
+      SAUCE_SET_ERROR("%s is empty and cannot contain a record", name);
+      break;
+    case SAUCE_ESHORT:
+      SAUCE_SET_ERROR("%s is too short to contain a record", name);
+      break;
+    case SAUCE_ERMISS:
+      SAUCE_SET_ERROR("%s does not contain a record", name);
+      break;
+    default:
+      break;
   }
+  return res;
+}
 
-  if (nLines == 0) return 0;
 
-  SAUCEInfo info;
-  char* buffer = NULL;
-  int res = SAUCE_file_get_info(filepath, &info, NULL, &buffer);
-  if (res < 0) {
-    if (buffer != NULL) free(buffer);
-    return res;
-  }
-  if (!info.comment_exists) {
-    if (buffer != NULL) free(buffer);
+/**
+ * @brief Copy at most `nLines` of a comment from found SAUCE data into `comment`, followed by a null character.
+ * 
+ * @param info info on the SAUCE data
+ * @param data the SAUCE data, not including the eof character
+ * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1`
+ * @param nLines the number of lines to read
+ * @return the number of lines copied
+ */
+static int SAUCE_data_read_comment(const SAUCEInfo* info, const char* data, char* comment, uint8_t nLines) {
+  if (!info->comment_exists) {
     comment[0] = 0;
     return 0;
   }
 
-  nLines = (nLines > info.lines) ? info.lines : nLines;
+  nLines = (nLines > info->lines) ? info->lines : nLines;
 
   // copy comment to comment string
-  memcpy(comment, buffer+5, SAUCE_COMMENT_STRING_LENGTH(nLines));
+  memcpy(comment, data + 5, SAUCE_COMMENT_STRING_LENGTH(nLines));
   comment[SAUCE_COMMENT_STRING_LENGTH(nLines)] = 0;
-  if (buffer != NULL) free(buffer);
-
   return nLines;
 }
 
 
+
+
+#ifdef CACHE_IS_DEFINED
+// Cache
+
+// Identifier at the beginning of a cache file
+#define CACHE_ID              "SAUCECHE"
+
+// Version of the cache file format
+#define CACHE_VERSION         1
+
+// An entry is only trusted once its file has not changed for this long before the entry was recorded.
+// File timestamps are coarse, so a file changed in the same tick as it was read would keep its key.
+#define CACHE_RACY_NS         2000000000LL
+
+// Number of slots in the table of a new cache
+#define CACHE_MIN_CAPACITY    64
+
+#if defined(__APPLE__)
+  #define CACHE_MTIME_NS(st)  ((int64_t)(st)->st_mtimespec.tv_sec * 1000000000LL + (st)->st_mtimespec.tv_nsec)
+  #define CACHE_CTIME_NS(st)  ((int64_t)(st)->st_ctimespec.tv_sec * 1000000000LL + (st)->st_ctimespec.tv_nsec)
+#else
+  #define CACHE_MTIME_NS(st)  ((int64_t)(st)->st_mtim.tv_sec * 1000000000LL + (st)->st_mtim.tv_nsec)
+  #define CACHE_CTIME_NS(st)  ((int64_t)(st)->st_ctim.tv_sec * 1000000000LL + (st)->st_ctim.tv_nsec)
+#endif
+
+// The decoded SAUCE data of a file, keyed by the file's device, inode, size and timestamps.
+// Entries are written to cache files as they are laid out in memory.
+typedef struct SAUCECacheEntry {
+  uint64_t dev;             // device of the file
+  uint64_t ino;             // inode of the file
+  int64_t size;             // size of the file in bytes
+  int64_t mtime;            // modification time of the file in nanoseconds
+  int64_t ctime;            // status change time of the file in nanoseconds
+  int64_t recorded;         // time the file was read in nanoseconds
+  int64_t start;            // see SAUCEInfo, relative to the beginning of the file
+  uint32_t sauce_length;    // see SAUCEInfo
+  int32_t result;           // the result of decoding the file's tail with SAUCE_decode_info()
+  uint8_t record_exists;    // see SAUCEInfo
+  uint8_t comment_exists;   // see SAUCEInfo
+  uint8_t eof_exists;       // see SAUCEInfo
+  uint8_t lines;            // see SAUCEInfo
+  uint8_t used;             // true if the slot holds an entry
+  uint8_t seen;             // true if the entry was looked up or stored since the cache was opened
+  uint8_t padding[2];
+  SAUCE record;             // the record of the file, if `record_exists` is true
+} SAUCECacheEntry;
+
+SAUCE_STATIC_ASSERT(sizeof(SAUCECacheEntry) == 200, sizeof_SAUCECacheEntry_struct_must_be_200_bytes);
+
+// The beginning of a cache file, followed by `count` entries
+typedef struct SAUCECacheHeader {
+  char id[8];               // CACHE_ID, without a null character
+  uint32_t version;         // CACHE_VERSION
+  uint32_t entrySize;       // sizeof(SAUCECacheEntry)
+  uint64_t count;           // number of entries in the file
+} SAUCECacheHeader;
+
+struct SAUCE_Cache {
+  char* path;               // path of the cache file
+  SAUCECacheEntry* slots;   // open addressed table of entries
+  uint32_t capacity;        // number of slots, always a power of two
+  uint32_t count;           // number of used slots
+  pthread_mutex_t lock;     // guards the table
+};
+
+
 /**
- * @brief From the first `n` bytes of a buffer, read a SAUCE record into `sauce`.
+ * @brief Find the slot of a file in a cache's table. The table must have at least one unused slot.
  * 
- * @param buffer pointer to a buffer
- * @param n the length of the buffer
- * @param sauce a SAUCE struct that will be filled with the parsed SAUCE record
- * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
- *         to get more info on the error.
+ * @param cache the cache
+ * @param dev device of the file
+ * @param ino inode of the file
+ * @return the index of the file's slot, or of the unused slot it would be stored in
  */
-int SAUCE_read(const char* buffer, uint32_t n, SAUCE* sauce) {
-  // null checks
-  if (buffer == NULL) {
-    SAUCE_SET_ERROR("Buffer was NULL");
-    return SAUCE_ENULL;
-  }
-  if (sauce == NULL) {
-    SAUCE_SET_ERROR("SAUCE struct was NULL");
-    return SAUCE_ENULL;
-  }
-
-  if (n == 0) {
-    SAUCE_SET_ERROR("The buffer has a length of 0 and cannot contain a record");
-    return SAUCE_EEMPTY;
-  }
+static uint32_t SAUCE_cache_slot(const SAUCE_Cache* cache, uint64_t dev, uint64_t ino) {
+  uint64_t hash = (ino ^ (dev * 0x9E3779B97F4A7C15ULL)) * 0xBF58476D1CE4E5B9ULL;
+  uint32_t mask = cache->capacity - 1;
+  uint32_t index = (uint32_t)(hash >> 32) & mask;
 
-  if (n < SAUCE_RECORD_SIZE) {
-    SAUCE_SET_ERROR("The buffer length of %u is too short to contain a record", n);
-    return SAUCE_ESHORT;
+  while (cache->slots[index].used && (cache->slots[index].dev != dev || cache->slots[index].ino != ino)) {
+    index = (index + 1) & mask;
   }
+  return index;
+}
 
 
-  // find the SAUCE id
-  if (memcmp(&buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_ID, 5) != 0) {
-    SAUCE_SET_ERROR("Could not find the SAUCE id in the buffer");
-    return SAUCE_ERMISS;
+/**
+ * @brief Store an entry in a cache, replacing the entry of the same file. The table is grown to keep it
+ *        at most half full. Must be called with the cache's lock held.
+ * 
+ * @param cache the cache
+ * @param entry the entry
+ * @return 0 on success. On error, -1 is returned and the cache is unchanged.
+ */
+static int SAUCE_cache_insert(SAUCE_Cache* cache, const SAUCECacheEntry* entry) {
+  if ((cache->count + 1) * 2 > cache->capacity) {
+    if (cache->capacity > UINT32_MAX / 2) return -1;
+    uint32_t capacity = cache->capacity * 2;
+    SAUCECacheEntry* slots = SAUCE_calloc(capacity, sizeof(SAUCECacheEntry));
+    if (slots == NULL) return -1;
+
+    SAUCECacheEntry* old = cache->slots;
+    uint32_t oldCapacity = cache->capacity;
+    cache->slots = slots;
+    cache->capacity = capacity;
+    for (uint32_t i = 0; i < oldCapacity; i++) {
+      if (old[i].used) cache->slots[SAUCE_cache_slot(cache, old[i].dev, old[i].ino)] = old[i];
+    }
+    SAUCE_free(old);
   }
 
-  // copy the record
-  memcpy(sauce, &buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
-
+  SAUCECacheEntry* slot = &cache->slots[SAUCE_cache_slot(cache, entry->dev, entry->ino)];
+  if (!slot->used) cache->count++;
+  *slot = *entry;
+  slot->used = 1;
   return 0;
 }
 
 
 /**
- * @brief From the first `n` bytes of a buffer, read at most `nLines` of a SAUCE CommentBlock into `comment`.
- *        A null character will be appended onto `comment` as well.
- * 
+ * @brief Look up the entry of a file in a cache. The entry is only returned if the file's key still matches
+ *        and the entry was recorded long enough after the file last changed. See CACHE_RACY_NS.
  * 
- *        If the buffer does not contain a comment or the actual number of lines is less than nLines, 
- *        then expect 0 lines or all lines to be read, respectively.
- * 
- * @param buffer pointer to a buffer
+ * @param cache the cache
+ * @param st the status of the file
+ * @param entry will be filled with the entry on a hit
+ * @return 1 (true) on a hit; 0 (false) if otherwise
+ */
+static int SAUCE_cache_lookup(SAUCE_Cache* cache, const struct stat* st, SAUCECacheEntry* entry) {
+  int hit = 0;
+  pthread_mutex_lock(&cache->lock);
+  SAUCECacheEntry* slot = &cache->slots[SAUCE_cache_slot(cache, (uint64_t)st->st_dev, (uint64_t)st->st_ino)];
+  if (slot->used && slot->size == (int64_t)st->st_size && slot->mtime == CACHE_MTIME_NS(st) &&
+      slot->ctime == CACHE_CTIME_NS(st) && slot->ctime < slot->recorded - CACHE_RACY_NS) {
+    slot->seen = 1;
+    *entry = *slot;
+    hit = 1;
+  }
+  pthread_mutex_unlock(&cache->lock);
+  return hit;
+}
+
+
+/**
+ * @brief Get the entry of an open file from a cache. If the file is not in the cache or has changed, its
+ *        tail is read into `tail` and decoded, and the new entry is stored in the cache. No error messages
+ *        are set, so this can be called from multiple threads at once.
+ * 
+ * @param cache the cache
+ * @param fd file descriptor open for reading
+ * @param tail array of length SAUCE_MAX_TAIL_SIZE
+ * @param entry will be filled with the entry of the file
+ * @param dataPtr will be set to the beginning of the SAUCE data in `tail` if the tail was read and a record
+ *        was found, or NULL if otherwise. Can be NULL.
+ * @return 0 on success. On error, SAUCE_EFFAIL is returned if the file could not be read, and SAUCE_EOTHER
+ *         if its size cannot be represented.
+ */
+static int SAUCE_cache_fetch(SAUCE_Cache* cache, int fd, char* tail, SAUCECacheEntry* entry, const char** dataPtr) {
+  if (dataPtr != NULL) *dataPtr = NULL;
+
+  // the time is taken first, so a change made while the tail is read makes the entry racy
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+
+  struct stat st;
+  if (fstat(fd, &st) < 0) return SAUCE_EFFAIL;
+  if (SAUCE_cache_lookup(cache, &st, entry)) return 0;
+  if (st.st_size < 0 || (uint64_t)st.st_size > (uint64_t)INT64_MAX) return SAUCE_EOTHER;
+
+  int64_t size = (int64_t)st.st_size;
+  uint32_t length = (size < SAUCE_MAX_TAIL_SIZE) ? (uint32_t)size : SAUCE_MAX_TAIL_SIZE;
+  if (SAUCE_fd_pread(fd, tail, length, size - length) < 0) return SAUCE_EFFAIL;
+
+  SAUCEInfo info;
+  memset(entry, 0, sizeof(SAUCECacheEntry));
+  entry->result = SAUCE_decode_info(tail, length, &info);
+  entry->dev = (uint64_t)st.st_dev;
+  entry->ino = (uint64_t)st.st_ino;
+  entry->size = size;
+  entry->mtime = CACHE_MTIME_NS(&st);
+  entry->ctime = CACHE_CTIME_NS(&st);
+  entry->recorded = (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+  entry->start = info.start + (size - length);
+  entry->sauce_length = info.sauce_length;
+  entry->record_exists = (uint8_t)info.record_exists;
+  entry->comment_exists = (uint8_t)info.comment_exists;
+  entry->eof_exists = (uint8_t)info.eof_exists;
+  entry->lines = info.lines;
+  entry->seen = 1;
+  if (info.record_exists) {
+    memcpy(&entry->record, &tail[length - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
+    if (dataPtr != NULL) *dataPtr = &tail[info.start];
+  }
+
+  // the entry is still returned if it cannot be stored
+  pthread_mutex_lock(&cache->lock);
+  SAUCE_cache_insert(cache, entry);
+  pthread_mutex_unlock(&cache->lock);
+  return 0;
+}
+
+
+/**
+ * @brief Look up the entry of a file in a cache by its path, without opening the file.
+ * 
+ * @param cache the cache
+ * @param filepath path to the file
+ * @param entry will be filled with the entry on a hit
+ * @return 1 (true) on a hit; 0 (false) if otherwise
+ */
+static int SAUCE_cache_lookup_path(SAUCE_Cache* cache, const char* filepath, SAUCECacheEntry* entry) {
+  struct stat st;
+  if (stat(filepath, &st) < 0) return 0;
+  return SAUCE_cache_lookup(cache, &st, entry);
+}
+
+
+/**
+ * @brief Convert a cache entry to the SAUCEInfo of its file.
+ * 
+ * @param entry the entry
+ * @param info will be filled with the info, with `info->start` relative to the beginning of the file
+ */
+static void SAUCE_cache_entry_info(const SAUCECacheEntry* entry, SAUCEInfo* info) {
+  info->record_exists = entry->record_exists;
+  info->comment_exists = entry->comment_exists;
+  info->eof_exists = entry->eof_exists;
+  info->lines = entry->lines;
+  info->start = entry->start;
+  info->sauce_length = entry->sauce_length;
+}
+
+
+/**
+ * @brief Get the record of a cached file. `SAUCE_fread()` would return the same result for the file.
+ * 
+ * @param entry the entry of the file
+ * @param sauce a SAUCE struct that will be filled with the record
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_cache_entry_record(const SAUCECacheEntry* entry, SAUCE* sauce) {
+  if (!entry->record_exists) return entry->result;
+  memcpy(sauce, &entry->record, SAUCE_RECORD_SIZE);
+  return 0;
+}
+
+
+/**
+ * @brief Read at most `nLines` of the comment of a cached file into `comment`, followed by a null character.
+ *        If the comment is not already in memory, only the comment lines are read from the file.
+ * 
+ * @param fd file descriptor open for reading
+ * @param entry the entry of the file
+ * @param data the SAUCE data of the file if it was read along with the entry, or NULL
+ * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1`
+ * @param nLines the number of lines to read
+ * @return On success, the number of lines read. On error, a negative error code is returned.
+ */
+static int SAUCE_cache_entry_comment(int fd, const SAUCECacheEntry* entry, const char* data, char* comment, uint8_t nLines) {
+  if (entry->result < 0) return entry->result;
+
+  SAUCEInfo info;
+  SAUCE_cache_entry_info(entry, &info);
+  if (data != NULL || !info.comment_exists) return SAUCE_data_read_comment(&info, data, comment, nLines);
+
+  nLines = (nLines > info.lines) ? info.lines : nLines;
+  if (SAUCE_fd_pread(fd, comment, SAUCE_COMMENT_STRING_LENGTH(nLines), info.start + 5) < 0) return SAUCE_EFFAIL;
+  comment[SAUCE_COMMENT_STRING_LENGTH(nLines)] = 0;
+  return nLines;
+}
+#endif //CACHE_IS_DEFINED
+
+
+
+
+/**
+ * @brief Find the bytes that differ between the SAUCE data a file ends with and the data it will end with instead.
+ *        Both start at the same position in the file. Bytes at the end are only compared if the sizes are the same.
+ * 
+ * @param tail the new SAUCE data
+ * @param n length of `tail`
+ * @param old the current SAUCE data
+ * @param oldLen length of `old`
+ * @param from will be set to the index of the first byte of `tail` that differs
+ * @param to will be set to one past the index of the last byte of `tail` that differs
+ */
+static void SAUCE_tail_diff(const char* tail, uint32_t n, const char* old, uint32_t oldLen, uint32_t* from, uint32_t* to) {
+  uint32_t start = 0;
+  uint32_t end = n;
+  uint32_t shared = (n < oldLen) ? n : oldLen;
+  while (start < shared && tail[start] == old[start]) start++;
+  if (n == oldLen) {
+    while (end > start && tail[end - 1] == old[end - 1]) end--;
+  }
+  *from = start;
+  *to = end;
+}
+
+
+#ifdef FD_IO_IS_DEFINED
+/**
+ * @brief Close a file descriptor opened by one of the file functions. If the operation on the
+ *        file succeeded but the file could not be closed, an error will be returned instead.
+ * 
+ * @param fd file descriptor
+ * @param filepath path to the file
+ * @param res the result of the operation on the file
+ * @return `res`, or SAUCE_EFFAIL if `res` was not an error and the file failed to close
+ */
+static int SAUCE_fd_close_file(int fd, const char* filepath, int res) {
+  if (SAUCE_fd_close(fd) < 0 && res >= 0) {
+    SAUCE_SET_ERROR("Failed to close %s", filepath);
+    return SAUCE_EFFAIL;
+  }
+  return res;
+}
+
+
+/**
+ * @brief Replace the end of a file descriptor from `start` on with `n` bytes of new SAUCE data without overwriting
+ *        any of the old data until a complete copy of the new data is synced. The copy is first written past the end
+ *        of the file, where it does not overlap its final position, and synced. The file then ends with the new data,
+ *        so the bytes that differ can be written at `start`. Once they are synced, the copy is cut off and the file
+ *        is synced again.
+ * 
+ *        A crash while the copy is being written can leave part of it at the end of the file, after the old data,
+ *        so that no valid record is found until the data is written again. A crash after the copy is synced, but
+ *        before it is cut off, leaves the file ending with the new data, with what is left of the old data in front
+ *        of it. That is behind the EOF character if the file had one, and is then not part of the file's content.
+ *        When the new data adds an EOF character, the old record is left in front of it, so it reads as part of the
+ *        content until the data is written again.
+ * 
+ * @param fd file descriptor open for reading and writing
+ * @param name name of the file to be used in error messages
+ * @param tail the new SAUCE data
+ * @param n length of `tail`
+ * @param from index of the first byte of `tail` that differs from the file
+ * @param start position in the file where `tail` starts
+ * @param filesize the current size of the file
+ * @return 0 on success. On error, SAUCE_EFFAIL is returned.
+ */
+static int SAUCE_fd_move_tail(int fd, const char* name, const char* tail, uint32_t n, uint32_t from, int64_t start,
+                              int64_t filesize) {
+  int64_t staged = (start + n > filesize) ? start + n : filesize;
+  if (SAUCE_fd_store(fd, tail, n, staged, filesize) < 0 || SAUCE_fd_sync(fd) < 0) {
+    // the file still ends with its old SAUCE data, unless the copy was partly written
+    SAUCE_fd_truncate(fd, filesize);
+    SAUCE_SET_ERROR("Failed to write SAUCE data to %s", name);
+    return SAUCE_EFFAIL;
+  }
+
+  if (SAUCE_fd_store(fd, tail + from, n - from, start + from, staged + n) < 0 || SAUCE_fd_sync(fd) < 0) {
+    SAUCE_SET_ERROR("Failed to write SAUCE data to %s", name);
+    return SAUCE_EFFAIL;
+  }
+  if (SAUCE_fd_truncate(fd, start + n) < 0 || SAUCE_fd_sync(fd) < 0) {
+    SAUCE_SET_ERROR("Failed to truncate %s", name);
+    return SAUCE_EFFAIL;
+  }
+  return 0;
+}
+
+
+/**
+ * @brief Replace the end of a file descriptor from `start` on with `n` bytes of new SAUCE data. Only the bytes that
+ *        differ are written, and the file is truncated afterwards if it gets shorter.
+ * 
+ *        With a durable policy, the file is synced before returning. Changes that stay inside the record, and SAUCE
+ *        data that is only appended or cut off, are made in place with a single write or truncation. A crash can still
+ *        tear such a write where it crosses a sector or page, leaving a record with some of its new bytes. Otherwise,
+ *        the new data is moved into place with `SAUCE_fd_move_tail()`.
+ * 
+ * @param fd file descriptor open for reading and writing
+ * @param name name of the file to be used in error messages
+ * @param tail the new SAUCE data, including an EOF character if one is written
+ * @param n length of `tail`
+ * @param start position in the file where `tail` starts
+ * @param old the current bytes of the file from `start` to its end
+ * @param filesize the current size of the file
+ * @return 0 on success, or SAUCE_UNCHANGED if the file already ends with `tail`. On error, a negative error code
+ *         is returned.
+ */
+static int SAUCE_fd_replace_tail(int fd, const char* name, const char* tail, uint32_t n, int64_t start,
+                                 const char* old, int64_t filesize) {
+  uint32_t from, to;
+  SAUCE_tail_diff(tail, n, old, (uint32_t)(filesize - start), &from, &to);
+  int64_t size = start + n;
+  if (from == to && size == filesize) return SAUCE_UNCHANGED;
+
+  int durable = SAUCE_options()->durability != SAUCE_DURABLE_NONE;
+  int inRecord = size == filesize && from + SAUCE_RECORD_SIZE >= n;
+  if (durable && from < to && start + from < filesize && !inRecord) {
+    return SAUCE_fd_move_tail(fd, name, tail, n, from, start, filesize);
+  }
+
+  if (from < to && SAUCE_fd_store(fd, tail + from, to - from, start + from, filesize) < 0) {
+    SAUCE_SET_ERROR("Failed to write SAUCE data to %s", name);
+    return SAUCE_EFFAIL;
+  }
+  if (size < filesize && SAUCE_fd_truncate(fd, size) < 0) {
+    SAUCE_SET_ERROR("Failed to truncate %s", name);
+    return SAUCE_EFFAIL;
+  }
+  if (durable && SAUCE_fd_sync(fd) < 0) {
+    SAUCE_SET_ERROR("Failed to sync %s", name);
+    return SAUCE_EFFAIL;
+  }
+
+  return 0;
+}
+
+
+/**
+ * @brief Read a SAUCE record from a file descriptor into `sauce`, ignoring any CommentBlock.
+ * 
+ * @param fd file descriptor open for reading
+ * @param name name of the file to be used in error messages
+ * @param sauce a SAUCE struct that will be filled with the record
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_fd_read_record(int fd, const char* name, SAUCE* sauce) {
+  char buffer[SAUCE_MAX_TAIL_SIZE];
+  #ifdef CACHE_IS_DEFINED
+  SAUCE_Cache* cache = SAUCE_options()->cache;
+  if (cache != NULL) {
+    SAUCECacheEntry entry;
+    int res = SAUCE_cache_fetch(cache, fd, buffer, &entry, NULL);
+    if (res < 0) return SAUCE_set_tail_error(name, res);
+    return SAUCE_set_record_error(name, SAUCE_cache_entry_record(&entry, sauce));
+  }
+  #endif
+
+  const char* tail = NULL;
+  uint32_t length = 0;
+  int64_t filesize = 0;
+  SAUCEMap map;
+  int res = SAUCE_fd_load_tail(fd, buffer, &tail, &filesize, &length, &map);
+  if (res < 0) return SAUCE_set_tail_error(name, res);
+
+  res = SAUCE_tail_read_record(name, tail, length, filesize, sauce);
+  SAUCE_fd_unmap(&map);
+  return res;
+}
+
+
+/**
+ * @brief Read at most `nLines` of a SAUCE CommentBlock from a file descriptor into `comment`.
+ * 
+ * @param fd file descriptor open for reading
+ * @param name name of the file to be used in error messages
+ * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1`
+ * @param nLines the number of lines to read
+ * @return On success, the number of lines read. On error, a negative error code is returned.
+ */
+static int SAUCE_fd_read_comment(int fd, const char* name, char* comment, uint8_t nLines) {
+  SAUCEInfo info;
+  char buffer[SAUCE_MAX_TAIL_SIZE + 1];
+  #ifdef CACHE_IS_DEFINED
+  SAUCE_Cache* cache = SAUCE_options()->cache;
+  if (cache != NULL) {
+    SAUCECacheEntry entry;
+    const char* cached = NULL;
+    int res = SAUCE_cache_fetch(cache, fd, buffer, &entry, &cached);
+    if (res < 0) return SAUCE_set_tail_error(name, res);
+
+    SAUCE_cache_entry_info(&entry, &info);
+    if (SAUCE_set_info_error(name, entry.result, &info) < 0) return entry.result;
+    res = SAUCE_cache_entry_comment(fd, &entry, cached, comment, nLines);
+    if (res == SAUCE_EFFAIL) SAUCE_SET_ERROR("Failed to read the comment of %s", name);
+    return res;
+  }
+  #endif
+
+  char* data = NULL;
+  int res = SAUCE_fd_get_info(fd, name, &info, NULL, buffer, &data);
+  if (res < 0) return res;
+
+  return SAUCE_data_read_comment(&info, data, comment, nLines);
+}
+
+
+/**
+ * @brief Get info about the SAUCE data in a file descriptor, using the current cache if there is one.
+ *        See SAUCEInfo struct for what info is collected. `info` will always be set appropriately,
+ *        no matter the return condition.
+ * 
+ * @param fd file descriptor open for reading
+ * @param name name of the file to be used in error messages
+ * @param info SAUCEInfo struct which will be filled with info on the SAUCE data
+ * @param filesizePtr will be set to the size of the file. Can be NULL.
+ * @return 0 on success. A success is when a record is found or a record is found along with an optional valid comment. 
+ *         On error, a negative error code is returned.
+ */
+static int SAUCE_fd_info(int fd, const char* name, SAUCEInfo* info, int64_t* filesizePtr) {
+  char buffer[SAUCE_MAX_TAIL_SIZE + 1];
+  #ifdef CACHE_IS_DEFINED
+  SAUCE_Cache* cache = SAUCE_options()->cache;
+  if (cache != NULL) {
+    memset(info, 0, sizeof(SAUCEInfo));
+    SAUCECacheEntry entry;
+    int res = SAUCE_cache_fetch(cache, fd, buffer, &entry, NULL);
+    if (res < 0) return SAUCE_set_tail_error(name, res);
+    if (filesizePtr != NULL) *filesizePtr = entry.size;
+    SAUCE_cache_entry_info(&entry, info);
+    return SAUCE_set_info_error(name, entry.result, info);
+  }
+  #endif
+
+  return SAUCE_fd_get_info(fd, name, info, filesizePtr, buffer, NULL);
+}
+
+
+/**
+ * @brief Check if a file descriptor refers to a file that contains SAUCE data.
+ * 
+ * @param fd file descriptor open for reading
+ * @param name name of the file to be used in error messages
+ * @return 1 if the file contains valid SAUCE data, 0 if otherwise
+ */
+static int SAUCE_fd_check(int fd, const char* name) {
+  SAUCEInfo info;
+  return SAUCE_fd_info(fd, name, &info, NULL) == 0;
+}
+
+
+/**
+ * @brief Write a SAUCE record to a file descriptor, replacing the record if one already exists. Only the bytes
+ *        that change are written, with a single write.
+ * 
+ * @param fd file descriptor open for reading and writing
+ * @param name name of the file to be used in error messages
+ * @param sauce a SAUCE struct
+ * @return 0 on success, or SAUCE_UNCHANGED if the file already contained the record. On error, a negative
+ *         error code is returned.
+ */
+static int SAUCE_fd_write_record(int fd, const char* name, const SAUCE* sauce) {
+  SAUCEInfo info;
+  int64_t filesize = 0;
+  char buffer[SAUCE_MAX_TAIL_SIZE + 1];
+  char* data = NULL;
+  int res = SAUCE_fd_get_info(fd, name, &info, &filesize, buffer, &data);
+  if (res < 0 && info.record_exists) return res;
+  if (res == SAUCE_EFFAIL || res == SAUCE_EOTHER) return res;
+
+  // the new SAUCE data starts where the old data did, after an EOF character
+  char tail[SAUCE_MAX_TAIL_SIZE + 1];
+  char* ptr = tail + 1;
+  uint32_t tailLen = SAUCE_RECORD_SIZE;
+  int64_t start = filesize;
+  if (info.record_exists) {
+    // the comment in front of the record is kept
+    tailLen = info.sauce_length;
+    start = info.start;
+    memcpy(ptr, data, tailLen);
+  }
+  char* record = &ptr[tailLen - SAUCE_RECORD_SIZE];
+  memcpy(record, SAUCE_RECORD_ID, 5);
+  memcpy(record + 5, &(sauce->Version), SAUCE_RECORD_SIZE - 5);
+  ((SAUCE*)record)->Comments = (info.record_exists) ? info.lines : 0;
+
+  // write eof if needed
+  if (!info.eof_exists) {
+    ptr--;
+    ptr[0] = SAUCE_EOF_CHAR;
+    tailLen++;
+  }
+
+  return SAUCE_fd_replace_tail(fd, name, ptr, tailLen, start, data, filesize);
+}
+
+
+/**
+ * @brief Write a SAUCE CommentBlock to a file descriptor, replacing the CommentBlock if one already exists.
+ *        Only the bytes that change are written, with a single write. If the existing comment has the same
+ *        number of lines, that is only the comment lines. The file is truncated afterwards if the new SAUCE
+ *        data is shorter.
+ * 
+ * @param fd file descriptor open for reading and writing
+ * @param name name of the file to be used in error messages
+ * @param comment a comment buffer that is as least `SAUCE_COMMENT_STRING_LENGTH(lines)` bytes long
+ * @param lines the number of lines to write
+ * @return 0 on success, or SAUCE_UNCHANGED if the file already contained the comment. On error, a negative
+ *         error code is returned.
+ */
+static int SAUCE_fd_write_comment(int fd, const char* name, const char* comment, uint8_t lines) {
+  SAUCEInfo info;
+  int64_t filesize = 0;
+  char buffer[SAUCE_MAX_TAIL_SIZE + 1];
+  char* data = NULL;
+  int res = SAUCE_fd_get_info(fd, name, &info, &filesize, buffer, &data);
+  if (res < 0 && !info.record_exists) return res; // we can continue as long as the record exists
+
+  // construct new SAUCE data, leaving room for an eof character
+  char tail[SAUCE_MAX_TAIL_SIZE + 1];
+  char* ptr = tail + 1;
+  uint32_t tailLen = SAUCE_TOTAL_SIZE(lines);
+  memcpy(ptr, SAUCE_COMMENT_ID, 5);
+  memcpy(ptr + 5, comment, SAUCE_COMMENT_STRING_LENGTH(lines));
+  memcpy(ptr + SAUCE_COMMENT_BLOCK_SIZE(lines), &data[info.sauce_length - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
+  ((SAUCE*)(&ptr[SAUCE_COMMENT_BLOCK_SIZE(lines)]))->Comments = lines;
+
+  // write an eof character if needed
+  if (!info.eof_exists) {
+    ptr--;
+    ptr[0] = SAUCE_EOF_CHAR;
+    tailLen++;
+  }
+
+  return SAUCE_fd_replace_tail(fd, name, ptr, tailLen, info.start, data, filesize);
+}
+
+
+/**
+ * @brief Remove a SAUCE record, the CommentBlock and the eof character from a file descriptor
+ *        by truncating the file.
+ * 
+ * @param fd file descriptor open for reading and writing
+ * @param name name of the file to be used in error messages
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_fd_remove_record(int fd, const char* name) {
+  SAUCEInfo info;
+  int64_t filesize = 0;
+  char buffer[SAUCE_MAX_TAIL_SIZE + 1];
+  int res = SAUCE_fd_get_info(fd, name, &info, &filesize, buffer, NULL);
+  if (res < 0 && !info.record_exists) return res;
+
+  int64_t newSize = (info.eof_exists) ? info.start - 1 : info.start;
+  return SAUCE_fd_replace_tail(fd, name, NULL, 0, newSize, NULL, filesize);
+}
+
+
+/**
+ * @brief Remove a SAUCE CommentBlock from a file descriptor. The "Comments" field of the record will be set to 0.
+ *        The record is written in place of the comment and the file is then truncated.
+ * 
+ * @param fd file descriptor open for reading and writing
+ * @param name name of the file to be used in error messages
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_fd_remove_comment(int fd, const char* name) {
+  SAUCEInfo info;
+  int64_t filesize = 0;
+  char buffer[SAUCE_MAX_TAIL_SIZE + 1];
+  char* data = NULL;
+  int res = SAUCE_fd_get_info(fd, name, &info, &filesize, buffer, &data);
+  if (res < 0 && !info.record_exists) return res;
+
+  // check if comment doesn't exist
+  if (!info.comment_exists) {
+    if (info.lines == 0) {
+      SAUCE_SET_ERROR("%s contains zero comment lines, so no comment can be removed", name);
+    }
+    return SAUCE_ECMISS;
+  }
+
+  // the record moves to the beginning of the SAUCE data
+  char tail[SAUCE_RECORD_SIZE + 1];
+  char* ptr = tail + 1;
+  uint32_t tailLen = SAUCE_RECORD_SIZE;
+  memcpy(ptr, &data[info.sauce_length - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
+  ((SAUCE*)ptr)->Comments = 0;
+
+  // write an eof character if needed
+  if (!info.eof_exists) {
+    ptr--;
+    ptr[0] = SAUCE_EOF_CHAR;
+    tailLen++;
+  }
+
+  return SAUCE_fd_replace_tail(fd, name, ptr, tailLen, info.start, data, filesize);
+}
+#endif //FD_IO_IS_DEFINED
+
+
+
+// Batch reading
+
+// A batch of files whose records or comments are read by SAUCE_fread_many() or SAUCE_Comment_fread_many(),
+// whose SAUCE data is removed by SAUCE_fremove_many(), or whose records are patched by SAUCE_fpatch_many()
+typedef struct SAUCEBatch {
+  const char* const* paths;   // paths of the files
+  uint32_t count;             // number of files
+  SAUCE* records;             // records[i] will be filled with the record of paths[i]. NULL for a batch of comments.
+  char* comments;             // the comment of paths[i] will be copied to comments[i * SAUCE_COMMENT_STRING_LENGTH(nLines) + i]
+  uint8_t nLines;             // the number of comment lines to read from each file
+  int* results;               // results[i] will be set to the result of reading paths[i]
+  int strip;                  // true to remove the SAUCE data of the files instead of reading them
+  const SAUCE* patch;         // values the records of the files are patched with instead of being read, or NULL
+  uint32_t patchFields;       // the fields of `patch` to write, see SAUCE_FIELD_BIT()
+  SAUCE_Cache* cache;         // cache of the calling context, or NULL
+  enum SAUCE_Durability durability; // how the files that are stripped or patched are synced
+  uint32_t next;              // index of the next file that has not been claimed
+  #ifdef THREADS_IS_DEFINED
+  uint32_t helpers;           // number of pool threads working on the batch
+  uint32_t maxHelpers;        // largest number of pool threads that may work on the batch
+  struct SAUCEBatch* link;    // next batch in the pool's list
+  #endif
+} SAUCEBatch;
+
+
+// Number of files each thread of a batch syncs together with SAUCE_DURABLE_GROUP
+#define SYNC_GROUP_SIZE     64
+
+// How the files changed by a batch, or by SAUCE_fpatch(), are synced
+typedef struct SAUCESync {
+  enum SAUCE_Durability durability;   // how the files are synced
+  int* results;                       // results of the batch, or NULL if a single file is changed
+  uint32_t index;                     // position in the batch of the file being changed
+  uint32_t count;                     // number of files in `fds`
+  uint32_t size;                      // largest number of files kept open in `fds`, at most SYNC_GROUP_SIZE
+  int fds[SYNC_GROUP_SIZE];           // changed files that are kept open until the group is synced
+  uint32_t indexes[SYNC_GROUP_SIZE];  // positions in the batch of the files in `fds`
+} SAUCESync;
+
+
+/**
+ * @brief Get the number of files each thread of a batch may keep open in its group, so that the threads
+ *        together hold at most half of the file descriptors the process may open. The rest is left to the
+ *        files being changed and to the rest of the process.
+ * 
+ * @param threads the number of threads working on the batch
+ * @return the group size, from 0 to SYNC_GROUP_SIZE
+ */
+static uint32_t SAUCE_sync_group_size(uint32_t threads) {
+  #ifdef POSIX_IS_DEFINED
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+    // each thread also has the file it is changing open
+    rlim_t share = limit.rlim_cur / 2 / threads;
+    if (share <= 1) return 0;
+    if (share - 1 < SYNC_GROUP_SIZE) return (uint32_t)(share - 1);
+  }
+  #else
+  (void)threads;
+  #endif
+  return SYNC_GROUP_SIZE;
+}
+
+
+#ifdef FD_IO_IS_DEFINED
+/**
+ * @brief Sync and close every file waiting in a group. Since each file started writing back when it joined
+ *        the group, most of the waiting overlaps. Files that fail to sync or close have their result set to
+ *        SAUCE_EFFAIL.
+ * 
+ * @param sync the group
+ */
+static void SAUCE_sync_flush(SAUCESync* sync) {
+  for (uint32_t i = 0; i < sync->count; i++) {
+    int res = SAUCE_fd_sync(sync->fds[i]);
+    if (SAUCE_fd_close(sync->fds[i]) < 0) res = SAUCE_EFFAIL;
+    if (res < 0) sync->results[sync->indexes[i]] = SAUCE_EFFAIL;
+  }
+  sync->count = 0;
+}
+
+
+/**
+ * @brief Finish with a file that was opened to be changed. If the file was changed, it is synced as `sync`
+ *        asks before it is closed, or starts writing back and joins the group of files synced together.
+ *        The group is synced first if it is full, so a file is never synced before its result is stored.
+ * 
+ * @param sync how the file is synced
+ * @param fd file descriptor of the file
+ * @param res the result of changing the file, 0 if it was changed
+ * @return `res`, or SAUCE_EFFAIL if the file was changed but failed to sync or close
+ */
+static int SAUCE_sync_release(SAUCESync* sync, int fd, int res) {
+  if (res == 0 && sync->durability == SAUCE_DURABLE_GROUP && sync->results != NULL && sync->size > 0) {
+    SAUCE_fd_start_sync(fd);
+    if (sync->count == sync->size) SAUCE_sync_flush(sync);
+    sync->fds[sync->count] = fd;
+    sync->indexes[sync->count] = sync->index;
+    sync->count++;
+    return 0;
+  }
+
+  if (res == 0 && sync->durability != SAUCE_DURABLE_NONE && SAUCE_fd_sync(fd) < 0) res = SAUCE_EFFAIL;
+  if (SAUCE_fd_close(fd) < 0 && res >= 0) res = SAUCE_EFFAIL;
+  return res;
+}
+
+
+/**
+ * @brief Open a file to be changed. If the process is out of file descriptors, the files waiting in the
+ *        group are synced and closed, and the file is opened again.
+ * 
+ * @param sync how the file is synced
+ * @param filepath path to the file
+ * @return a file descriptor open for reading and writing. On error, a negative number is returned.
+ */
+static int SAUCE_sync_open(SAUCESync* sync, const char* filepath) {
+  int fd = SAUCE_fd_open(filepath, FD_OPEN_WRITE);
+  if (fd < 0 && sync->count > 0 && (errno == EMFILE || errno == ENFILE)) {
+    SAUCE_sync_flush(sync);
+    fd = SAUCE_fd_open(filepath, FD_OPEN_WRITE);
+  }
+  return fd;
+}
+#endif
+
+
+/**
+ * @brief Read a SAUCE record from a file into `sauce` without setting any error messages, so that it can
+ *        be called from multiple threads at once. Only the last `SAUCE_RECORD_SIZE` bytes of the file are read.
+ * 
+ * @param filepath path to file
+ * @param cache the cache of the calling context, or NULL
+ * @param sauce a SAUCE struct that will be filled with the record
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_file_fetch_record(const char* filepath, SAUCE_Cache* cache, SAUCE* sauce) {
+  if (filepath == NULL) return SAUCE_ENULL;
+
+  #ifdef CACHE_IS_DEFINED
+  if (cache != NULL) {
+    SAUCECacheEntry entry;
+    if (SAUCE_cache_lookup_path(cache, filepath, &entry)) return SAUCE_cache_entry_record(&entry, sauce);
+
+    int fd = SAUCE_fd_open(filepath, FD_OPEN_READ);
+    if (fd < 0) return SAUCE_EFOPEN;
+    char tail[SAUCE_MAX_TAIL_SIZE];
+    int res = SAUCE_cache_fetch(cache, fd, tail, &entry, NULL);
+    SAUCE_fd_close(fd);
+    return (res < 0) ? res : SAUCE_cache_entry_record(&entry, sauce);
+  }
+  #else
+  (void)cache;
+  #endif
+
+  #ifdef FD_IO_IS_DEFINED
+  int fd = SAUCE_fd_open(filepath, FD_OPEN_READ);
+  if (fd < 0) return SAUCE_EFOPEN;
+
+  char tail[SAUCE_RECORD_SIZE];
+  int64_t size = 0;
+  uint32_t toRead = 0;
+  int res = SAUCE_fd_size(fd, &size);
+  if (res == 0) {
+    toRead = (size < SAUCE_RECORD_SIZE) ? (uint32_t)size : SAUCE_RECORD_SIZE;
+    res = SAUCE_fd_pread(fd, tail, toRead, size - toRead);
+  }
+  SAUCE_fd_close(fd);
+  if (res < 0) return res;
+
+  return SAUCE_decode_record(tail, toRead, size, sauce);
+  #else
+  char tail[SAUCE_MAX_TAIL_SIZE];
+  uint32_t length = 0;
+  int64_t filesize = 0;
+  int res = SAUCE_file_read_tail(filepath, tail, &filesize, &length);
+  if (res < 0) return res;
+
+  return SAUCE_decode_record(tail, length, filesize, sauce);
+  #endif
+}
+
+
+/**
+ * @brief Read at most `nLines` of a SAUCE CommentBlock from a file into `comment` without setting any error
+ *        messages, so that it can be called from multiple threads at once.
+ * 
+ * @param filepath path to file
+ * @param cache the cache of the calling context, or NULL
+ * @param tail a scratch buffer of length SAUCE_MAX_TAIL_SIZE
+ * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1`
+ * @param nLines the number of lines to read
+ * @return On success, the number of lines read. On error, a negative error code is returned.
+ */
+static int SAUCE_file_fetch_comment(const char* filepath, SAUCE_Cache* cache, char* tail, char* comment, uint8_t nLines) {
+  if (filepath == NULL) return SAUCE_ENULL;
+  if (nLines == 0) return 0;
+  #ifndef CACHE_IS_DEFINED
+  (void)cache;
+  #endif
+
+  uint32_t length = 0;
+  int64_t filesize = 0;
+  #ifdef FD_IO_IS_DEFINED
+  int fd = SAUCE_fd_open(filepath, FD_OPEN_READ);
+  if (fd < 0) return SAUCE_EFOPEN;
+
+  #ifdef CACHE_IS_DEFINED
+  if (cache != NULL) {
+    SAUCECacheEntry entry;
+    const char* data = NULL;
+    int res = SAUCE_cache_fetch(cache, fd, tail, &entry, &data);
+    if (res == 0) res = SAUCE_cache_entry_comment(fd, &entry, data, comment, nLines);
+    SAUCE_fd_close(fd);
+    return res;
+  }
+  #endif
+
+  int res = SAUCE_fd_read_tail(fd, tail, &filesize, &length);
+  SAUCE_fd_close(fd);
+  #else
+  int res = SAUCE_file_read_tail(filepath, tail, &filesize, &length);
+  #endif
+  if (res < 0) return res;
+
+  SAUCEInfo info;
+  res = SAUCE_decode_info(tail, length, &info);
+  if (res < 0) return res;
+
+  return SAUCE_data_read_comment(&info, &tail[info.start], comment, nLines);
+}
+
+
+/**
+ * @brief Remove a SAUCE record from a file, along with the SAUCE CommentBlock and EOF character, without setting
+ *        any error messages, so that it can be called from multiple threads at once. The file is opened once, its
+ *        tail is read with a single positioned read and the same descriptor is truncated. If the cache knows that
+ *        the file has no record, the file is not opened at all.
+ * 
+ *        When file descriptors are not available, the file is copied through a temporary file like
+ *        `SAUCE_fremove()`, which may set an error message.
+ * 
+ * @param filepath path to file
+ * @param cache the cache of the calling context, or NULL
+ * @param tail a scratch buffer of length SAUCE_MAX_TAIL_SIZE
+ * @param sync how the file is synced once it is stripped
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_file_strip(const char* filepath, SAUCE_Cache* cache, char* tail, SAUCESync* sync) {
+  if (filepath == NULL) return SAUCE_ENULL;
+
+  #ifdef CACHE_IS_DEFINED
+  if (cache != NULL) {
+    SAUCECacheEntry entry;
+    if (SAUCE_cache_lookup_path(cache, filepath, &entry) && !entry.record_exists) return entry.result;
+  }
+  #else
+  (void)cache;
+  #endif
+
+  SAUCEInfo info;
+  uint32_t length = 0;
+  int64_t filesize = 0;
+  #ifdef FD_IO_IS_DEFINED
+  int fd = SAUCE_sync_open(sync, filepath);
+  if (fd < 0) return SAUCE_EFOPEN;
+
+  int res = SAUCE_fd_read_tail(fd, tail, &filesize, &length);
+  if (res == 0) {
+    res = SAUCE_decode_info(tail, length, &info);
+    if (info.record_exists) {
+      int64_t start = info.start + (filesize - length);
+      res = SAUCE_fd_truncate(fd, (info.eof_exists) ? start - 1 : start);
+    }
+  }
+  return SAUCE_sync_release(sync, fd, res);
+  #else
+  (void)sync;
+  int res = SAUCE_file_read_tail(filepath, tail, &filesize, &length);
+  if (res < 0) return res;
+
+  res = SAUCE_decode_info(tail, length, &info);
+  if (!info.record_exists) return res;
+
+  if (info.eof_exists) info.sauce_length++;
+  res = SAUCE_file_truncate(filepath, filesize, info.sauce_length, NULL);
+  return (res < 0) ? res : 0;
+  #endif
+}
+
+
+// The position of a field in a record
+typedef struct SAUCERecordField {
+  size_t offset;
+  size_t size;
+} SAUCERecordField;
+
+#define RECORD_FIELD(field)   { offsetof(SAUCE, field), sizeof(((SAUCE*)0)->field) }
+
+// Every field that can be patched, in the order of the SAUCE_Field constants
+static const SAUCERecordField record_fields[SAUCE_FIELD_TINFOS + 1] = {
+  RECORD_FIELD(DataType), RECORD_FIELD(FileType), RECORD_FIELD(Comments), RECORD_FIELD(TFlags),
+  RECORD_FIELD(TInfo1), RECORD_FIELD(TInfo2), RECORD_FIELD(TInfo3), RECORD_FIELD(TInfo4),
+  RECORD_FIELD(FileSize), RECORD_FIELD(Date), RECORD_FIELD(Title), RECORD_FIELD(Author),
+  RECORD_FIELD(Group), RECORD_FIELD(TInfoS)
+};
+
+// Mask of every field that can be patched. The Comments field describes the CommentBlock, so it is left alone.
+#define PATCH_FIELDS_MASK     (((1U << (SAUCE_FIELD_TINFOS + 1)) - 1) & ~SAUCE_FIELD_BIT(SAUCE_FIELD_COMMENTS))
+
+
+/**
+ * @brief Copy the fields in `fields` from `values` into a record.
+ * 
+ * @param record the record to patch
+ * @param values the values of the fields
+ * @param fields a mask of SAUCE_FIELD_BIT() values
+ */
+static void SAUCE_record_patch(SAUCE* record, const SAUCE* values, uint32_t fields) {
+  for (int i = 0; i <= SAUCE_FIELD_TINFOS; i++) {
+    if (fields & SAUCE_FIELD_BIT(i)) {
+      memcpy((char*)record + record_fields[i].offset, (const char*)values + record_fields[i].offset, record_fields[i].size);
+    }
+  }
+}
+
+
+/**
+ * @brief Write the fields in `fields` from `values` into the record of a file without setting any error messages,
+ *        so that it can be called from multiple threads at once. Only the record is read, with a single positioned
+ *        read, and only the bytes of the record that change are written back, with a single positioned write. If
+ *        the file has no record, an EOF character and a default record with the fields set are appended.
+ * 
+ *        When file descriptors are not available, the whole file is read to find its tail.
+ * 
+ * @param filepath path to file
+ * @param values the values of the fields
+ * @param fields a mask of SAUCE_FIELD_BIT() values
+ * @param tail a scratch buffer of length SAUCE_MAX_TAIL_SIZE
+ * @param sync how the file is synced once it is patched
+ * @return 0 on success, or SAUCE_UNCHANGED if the record already held the values. On error, a negative error
+ *         code is returned.
+ */
+static int SAUCE_file_patch(const char* filepath, const SAUCE* values, uint32_t fields, char* tail, SAUCESync* sync) {
+  if (filepath == NULL) return SAUCE_ENULL;
+
+  // read the last record sized chunk of the file
+  uint32_t length = 0;
+  int64_t filesize = 0;
+  #ifdef FD_IO_IS_DEFINED
+  int fd = SAUCE_sync_open(sync, filepath);
+  if (fd < 0) return SAUCE_EFOPEN;
+
+  int res = SAUCE_fd_size(fd, &filesize);
+  if (res == 0) {
+    length = (filesize < SAUCE_RECORD_SIZE) ? (uint32_t)filesize : SAUCE_RECORD_SIZE;
+    res = SAUCE_fd_pread(fd, tail, length, filesize - length);
+  }
+  if (res < 0) {
+    SAUCE_fd_close(fd);
+    return res;
+  }
+  #else
+  int res = SAUCE_file_read_tail(filepath, tail, &filesize, &length);
+  if (res < 0) return res;
+  if (length > SAUCE_RECORD_SIZE) {
+    memmove(tail, tail + (length - SAUCE_RECORD_SIZE), SAUCE_RECORD_SIZE);
+    length = SAUCE_RECORD_SIZE;
+  }
+  #endif
+
+  // find the bytes of the record that change, or build a record to append
+  char data[SAUCE_RECORD_SIZE + 1];
+  SAUCE* record = (SAUCE*)(data + 1);
+  const char* src = data;
+  uint32_t n = 0;
+  int64_t offset;
+  if (length == SAUCE_RECORD_SIZE && memcmp(tail, SAUCE_RECORD_ID, 5) == 0) {
+    memcpy(record, tail, SAUCE_RECORD_SIZE);
+    SAUCE_record_patch(record, values, fields);
+
+    const char* patched = data + 1;
+    uint32_t start = 0;
+    uint32_t end = SAUCE_RECORD_SIZE;
+    while (start < end && patched[start] == tail[start]) start++;
+    while (end > start && patched[end - 1] == tail[end - 1]) end--;
+    src = patched + start;
+    n = end - start;
+    offset = filesize - SAUCE_RECORD_SIZE + start;
+  } else {
+    SAUCE_set_default(record);
+    SAUCE_record_patch(record, values, fields);
+    record->Comments = 0;
+    data[0] = SAUCE_EOF_CHAR;
+    n = SAUCE_RECORD_SIZE + 1;
+    offset = filesize;
+  }
+
+  #ifdef FD_IO_IS_DEFINED
+  res = (n > 0) ? SAUCE_fd_pwrite(fd, src, n, offset) : SAUCE_UNCHANGED;
+  return SAUCE_sync_release(sync, fd, res);
+  #else
+  (void)sync;
+  if (n == 0) return SAUCE_UNCHANGED;
+  FILE* file = fopen(filepath, "r+b");
+  if (file == NULL) return SAUCE_EFOPEN;
+  if (SAUCE_file_seek(file, offset) != 0 || fwrite(src, 1, n, file) != n) res = SAUCE_EFFAIL;
+  if (fclose(file) != 0) res = SAUCE_EFFAIL;
+  return res;
+  #endif
+}
+
+
+// Changes to the SAUCE data of a file that are collected and then applied together by SAUCE_Edit_commit()
+struct SAUCE_Edit {
+  int fd;                         // file descriptor the edit is committed to, or -1 when file descriptors are not available
+  int ownsFd;                     // true if `fd` was opened by SAUCE_Edit_open() and is closed with the edit
+  const char* path;               // path of the file, or NULL if the edit was opened on a file descriptor
+  int recordSet;                  // true if the record is replaced
+  int commentSet;                 // true if the comment is replaced or removed
+  uint8_t lines;                  // number of lines of the new comment, 0 if the comment is removed
+  SAUCE record;                   // the new record
+  char comment[SAUCE_COMMENT_STRING_LENGTH(255)];   // the new comment lines
+};
+
+// Where the new SAUCE data of an edit is written
+typedef struct SAUCEEditWrite {
+  const char* src;                // the new SAUCE data, including an EOF character if one is written
+  uint32_t n;                     // length of `src`
+  int64_t offset;                 // position in the file where `src` starts
+  int64_t size;                   // size of the file once the edit is applied
+} SAUCEEditWrite;
+
+
+/**
+ * @brief Build the SAUCE data a file will end with once an edit is applied, and where it starts in the file.
+ * 
+ * @param edit the edit
+ * @param res the result of getting `info`
+ * @param info info on the file's current SAUCE data
+ * @param data the file's current SAUCE data, if it has a record
+ * @param filesize the current size of the file
+ * @param tail array of length SAUCE_MAX_TAIL_SIZE that is filled with an EOF character and the new SAUCE data
+ * @param write will be set to the write that applies the edit
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_edit_prepare(const SAUCE_Edit* edit, int res, const SAUCEInfo* info, const char* data, int64_t filesize,
+                              char* tail, SAUCEEditWrite* write) {
+  if (!info->record_exists) {
+    // only a new record can be appended to a file without one
+    if (!edit->recordSet || res == SAUCE_EFFAIL || res == SAUCE_EOTHER || res == SAUCE_EFOPEN) return res;
+  } else if (res < 0 && !edit->commentSet) {
+    return res; // the invalid comment would be kept
+  }
+
+  uint8_t lines = info->record_exists ? info->lines : 0;
+  if (edit->commentSet) lines = edit->lines;
+
+  tail[0] = SAUCE_EOF_CHAR;
+  char* ptr = tail + 1;
+  if (lines > 0) {
+    memcpy(ptr, SAUCE_COMMENT_ID, 5);
+    memcpy(ptr + 5, (edit->commentSet) ? edit->comment : data + 5, SAUCE_COMMENT_STRING_LENGTH(lines));
+    ptr += SAUCE_COMMENT_BLOCK_SIZE(lines);
+  }
+  if (edit->recordSet) {
+    memcpy(ptr, SAUCE_RECORD_ID, 5);
+    memcpy(ptr + 5, &(edit->record.Version), SAUCE_RECORD_SIZE - 5);
+  } else {
+    memcpy(ptr, &data[info->sauce_length - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
+  }
+  ((SAUCE*)ptr)->Comments = lines;
+
+  // the new SAUCE data starts where the old data did, after an EOF character
+  const char* src = tail + 1;
+  uint32_t n = SAUCE_TOTAL_SIZE(lines);
+  int64_t offset = (info->record_exists) ? info->start : filesize;
+  if (!info->eof_exists) {
+    src--;
+    n++;
+  }
+  write->size = offset + n;
+  write->src = src;
+  write->n = n;
+  write->offset = offset;
+  return 0;
+}
+
+
+#ifdef FD_IO_IS_DEFINED
+/**
+ * @brief Apply an edit to a file descriptor. The tail of the file is read once, the bytes of the SAUCE data that
+ *        change are written with a single write, and the file is truncated afterwards if the new SAUCE data is shorter.
+ * 
+ * @param fd file descriptor open for reading and writing
+ * @param name name of the file to be used in error messages
+ * @param edit the edit
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_fd_commit_edit(int fd, const char* name, const SAUCE_Edit* edit) {
+  SAUCEInfo info;
+  int64_t filesize = 0;
+  char buffer[SAUCE_MAX_TAIL_SIZE + 1];
+  char* data = NULL;
+  int res = SAUCE_fd_get_info(fd, name, &info, &filesize, buffer, &data);
+
+  char tail[SAUCE_MAX_TAIL_SIZE];
+  SAUCEEditWrite write;
+  res = SAUCE_edit_prepare(edit, res, &info, data, filesize, tail, &write);
+  if (res < 0) return res;
+  return SAUCE_fd_replace_tail(fd, name, write.src, write.n, write.offset, data, filesize);
+}
+#else
+/**
+ * @brief Apply an edit to a file with the C standard I/O functions. A file whose SAUCE data gets shorter is
+ *        truncated by copying it with `SAUCE_file_truncate()`.
+ * 
+ * @param filepath path to the file
+ * @param edit the edit
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_file_commit_edit(const char* filepath, const SAUCE_Edit* edit) {
+  SAUCEInfo info;
+  int64_t filesize = 0;
+  char buffer[SAUCE_MAX_TAIL_SIZE];
+  char* data = NULL;
+  int res = SAUCE_file_get_info(filepath, &info, &filesize, buffer, &data);
+
+  char tail[SAUCE_MAX_TAIL_SIZE];
+  SAUCEEditWrite write;
+  res = SAUCE_edit_prepare(edit, res, &info, data, filesize, tail, &write);
+  if (res < 0) return res;
+
+  // only write the bytes that change
+  uint32_t from, to;
+  SAUCE_tail_diff(write.src, write.n, data, (uint32_t)(filesize - write.offset), &from, &to);
+  if (from == to && write.size == filesize) return SAUCE_UNCHANGED;
+  write.src += from;
+  write.offset += from;
+  write.n = to - from;
+
+  FILE* file;
+  if (write.size < filesize) {
+    // cut the file off where the write starts, leaving it positioned there
+    res = SAUCE_file_truncate(filepath, filesize, (uint16_t)(filesize - write.offset), &file);
+    if (res < 0) return res;
+  } else {
+    file = fopen(filepath, "rb+");
+    if (file == NULL) {
+      SAUCE_SET_ERROR("Failed to open %s for reading and writing", filepath);
+      return SAUCE_EFOPEN;
+    }
+    if (SAUCE_file_seek(file, write.offset) < 0) {
+      fclose(file);
+      SAUCE_SET_ERROR("Failed to seek to the SAUCE data in %s", filepath);
+      return SAUCE_EFFAIL;
+    }
+  }
+
+  size_t written = fwrite(write.src, 1, write.n, file);
+  if (fclose(file) != 0 || written != write.n) {
+    SAUCE_SET_ERROR("Failed to write SAUCE data to %s", filepath);
+    return SAUCE_EFFAIL;
+  }
+  return 0;
+}
+#endif
+
+
+// Number of files claimed from a batch at once
+#define BATCH_CLAIM_SIZE    16
+
+#ifdef THREADS_IS_DEFINED
+// Largest number of threads used to read a batch, including the calling thread
+#define BATCH_MAX_THREADS   32
+
+// Threads that help read batches. The threads are started the first time a batch needs them and
+// are kept until the process exits. Each thread has its own scratch buffer for reading tails.
+typedef struct SAUCEPool {
+  pthread_mutex_t lock;       // guards every field, and the `next`, `helpers` and `link` fields of posted batches
+  pthread_cond_t work;        // signalled when a batch is posted
+  pthread_cond_t idle;        // signalled when the last helper leaves a batch
+  SAUCEBatch* batches;        // batches that are being read
+  uint32_t nThreads;          // number of threads that were started
+  int started;                // true once the threads have been started
+} SAUCEPool;
+
+static SAUCEPool batch_pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, 0, 0 };
+#endif
+
+
+/**
+ * @brief Read files from a batch until every file has been claimed. Files are claimed `BATCH_CLAIM_SIZE` at a time.
+ *        Files changed with SAUCE_DURABLE_GROUP are synced in groups of up to `SYNC_GROUP_SIZE`, sized by
+ *        `SAUCE_sync_group_size()`, and the rest once every file has been claimed.
+ * 
+ * @param batch the batch
+ * @param scratch a scratch buffer of length SAUCE_MAX_TAIL_SIZE
+ */
+static void SAUCE_batch_read(SAUCEBatch* batch, char* scratch) {
+  size_t stride = SAUCE_COMMENT_STRING_LENGTH(batch->nLines) + 1;
+  SAUCESync sync;
+  sync.durability = batch->durability;
+  sync.results = batch->results;
+  sync.count = 0;
+  #ifdef THREADS_IS_DEFINED
+  sync.size = SAUCE_sync_group_size(batch->maxHelpers + 1);
+  #else
+  sync.size = SAUCE_sync_group_size(1);
+  #endif
+
+  while (1) {
+    #ifdef THREADS_IS_DEFINED
+    pthread_mutex_lock(&batch_pool.lock);
+    #endif
+    uint32_t start = batch->next;
+    uint32_t end = (batch->count - start > BATCH_CLAIM_SIZE) ? start + BATCH_CLAIM_SIZE : batch->count;
+    batch->next = end;
+    #ifdef THREADS_IS_DEFINED
+    pthread_mutex_unlock(&batch_pool.lock);
+    #endif
+
+    if (start >= end) break;
+    for (uint32_t i = start; i < end; i++) {
+      sync.index = i;
+      if (batch->strip) {
+        batch->results[i] = SAUCE_file_strip(batch->paths[i], batch->cache, scratch, &sync);
+      } else if (batch->patch != NULL) {
+        batch->results[i] = SAUCE_file_patch(batch->paths[i], batch->patch, batch->patchFields, scratch, &sync);
+      } else if (batch->records != NULL) {
+        batch->results[i] = SAUCE_file_fetch_record(batch->paths[i], batch->cache, &batch->records[i]);
+      } else {
+        batch->results[i] = SAUCE_file_fetch_comment(batch->paths[i], batch->cache, scratch, &batch->comments[i * stride], batch->nLines);
+      }
+    }
+  }
+
+  #ifdef FD_IO_IS_DEFINED
+  SAUCE_sync_flush(&sync);
+  #endif
+}
+
+
+#ifdef THREADS_IS_DEFINED
+/**
+ * @brief Body of a pool thread. Waits for a batch that still has unclaimed files and room for
+ *        another helper, and reads from it.
+ * 
+ * @param arg unused
+ * @return never returns
+ */
+static void* SAUCE_pool_thread(void* arg) {
+  // the scratch buffer lives on the thread's stack, so pool threads never allocate
+  (void)arg;
+  char scratch[SAUCE_MAX_TAIL_SIZE];
+
+  pthread_mutex_lock(&batch_pool.lock);
+  while (1) {
+    SAUCEBatch* batch = batch_pool.batches;
+    while (batch != NULL && (batch->helpers >= batch->maxHelpers || batch->next >= batch->count)) {
+      batch = batch->link;
+    }
+    if (batch == NULL) {
+      pthread_cond_wait(&batch_pool.work, &batch_pool.lock);
+      continue;
+    }
+
+    batch->helpers++;
+    pthread_mutex_unlock(&batch_pool.lock);
+    SAUCE_batch_read(batch, scratch);
+    pthread_mutex_lock(&batch_pool.lock);
+    batch->helpers--;
+    if (batch->helpers == 0) pthread_cond_broadcast(&batch_pool.idle);
+  }
+
+  return NULL;
+}
+
+
+// The child of a fork has to start the pool and the ring over, see `SAUCE_batch_after_fork()`
+static pthread_once_t batch_fork_once = PTHREAD_ONCE_INIT;
+static void SAUCE_batch_register_fork(void);
+
+/**
+ * @brief Start the pool threads if they have not been started yet. Since the work is bound by I/O, two
+ *        threads are used per online processor, minus the calling thread.
+ * 
+ * @return the number of pool threads
+ */
+static uint32_t SAUCE_pool_start(void) {
+  pthread_mutex_lock(&batch_pool.lock);
+  if (!batch_pool.started) {
+    batch_pool.started = 1;
+    pthread_once(&batch_fork_once, SAUCE_batch_register_fork);
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t nThreads = (cpus > 0) ? (uint32_t)cpus * 2 : 2;
+    if (nThreads > BATCH_MAX_THREADS) nThreads = BATCH_MAX_THREADS;
+
+    pthread_attr_t attr;
+    int haveAttr = pthread_attr_init(&attr) == 0;
+    if (haveAttr) pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+
+    // if a thread cannot be created, the threads that were started pick up its work
+    for (uint32_t i = 1; i < nThreads; i++) {
+      pthread_t thread;
+      if (pthread_create(&thread, haveAttr ? &attr : NULL, SAUCE_pool_thread, NULL) != 0) break;
+      if (!haveAttr) pthread_detach(thread);
+      batch_pool.nThreads++;
+    }
+    if (haveAttr) pthread_attr_destroy(&attr);
+  }
+  uint32_t nThreads = batch_pool.nThreads;
+  pthread_mutex_unlock(&batch_pool.lock);
+  return nThreads;
+}
+
+
+/**
+ * @brief Read the unclaimed files of a batch with the help of the pool threads. The calling thread works as
+ *        well, and returns once every file has been read. Batches posted from several threads at once are
+ *        read at the same time.
+ * 
+ * @param batch the batch
+ * @param threads the largest number of threads to read with, including the calling thread. 0 for no limit.
+ */
+static void SAUCE_batch_read_pool(SAUCEBatch* batch, uint32_t threads) {
+  char scratch[SAUCE_MAX_TAIL_SIZE];
+
+  uint32_t helpers = 0;
+  uint32_t remaining = batch->count - batch->next;
+  if (threads != 1 && remaining > BATCH_CLAIM_SIZE) {
+    helpers = SAUCE_pool_start();
+    if (threads > 0 && helpers > threads - 1) helpers = threads - 1;
+    if (helpers > remaining / BATCH_CLAIM_SIZE) helpers = remaining / BATCH_CLAIM_SIZE;
+  }
+  batch->helpers = 0;
+  batch->maxHelpers = helpers;
+  batch->link = NULL;
+
+  if (helpers > 0) {
+    pthread_mutex_lock(&batch_pool.lock);
+    batch->link = batch_pool.batches;
+    batch_pool.batches = batch;
+    pthread_cond_broadcast(&batch_pool.work);
+    pthread_mutex_unlock(&batch_pool.lock);
+  }
+
+  SAUCE_batch_read(batch, scratch);
+
+  if (helpers > 0) {
+    // take the batch out of the list so no more helpers join, then wait for the helpers to finish
+    pthread_mutex_lock(&batch_pool.lock);
+    SAUCEBatch** ref = &batch_pool.batches;
+    while (*ref != batch) ref = &(*ref)->link;
+    *ref = batch->link;
+    while (batch->helpers > 0) pthread_cond_wait(&batch_pool.idle, &batch_pool.lock);
+    pthread_mutex_unlock(&batch_pool.lock);
+  }
+}
+#endif
+
+
+#ifdef URING_IS_DEFINED
+// Number of submission queue entries in the ring
+#define URING_ENTRIES       256
+
+// Number of files read per round trip through the ring. Each file takes up to three entries.
+#define URING_CHUNK_SIZE    (URING_ENTRIES / 3)
+
+// An io_uring instance and its mapped submission and completion queues
+typedef struct SAUCEUring {
+  int fd;
+  unsigned* sq_tail;
+  unsigned* sq_mask;
+  unsigned* sq_array;
+  unsigned* cq_head;
+  unsigned* cq_tail;
+  unsigned* cq_mask;
+  struct io_uring_sqe* sqes;
+  struct io_uring_cqe* cqes;
+  void* sq_ring;
+  size_t sq_ring_size;
+  void* cq_ring;
+  size_t cq_ring_size;
+  size_t sqes_size;
+} SAUCEUring;
+
+// Buffers for a chunk of files that are in flight
+typedef struct SAUCEUringChunk {
+  struct statx stats[URING_CHUNK_SIZE];     // stats of the paths
+  struct statx fdStats[URING_CHUNK_SIZE];   // stats of the opened files
+  char tails[URING_CHUNK_SIZE][SAUCE_RECORD_SIZE];
+  uint32_t lengths[URING_CHUNK_SIZE];
+  int reading[URING_CHUNK_SIZE];
+  int fds[URING_CHUNK_SIZE];
+  int32_t res[URING_CHUNK_SIZE * 3];
+} SAUCEUringChunk;
+
+// The ring is set up the first time a batch is read and is kept until the process exits.
+// Only one batch can use the ring at a time.
+static pthread_mutex_t uring_lock = PTHREAD_MUTEX_INITIALIZER;
+static SAUCEUring uring_ring;
+static SAUCEUringChunk* uring_chunk = NULL;
+static int uring_state = 0;   // 0 if the ring is not set up, 1 if it is ready, -1 if io_uring is not available
+
+
+/**
+ * @brief Close an io_uring instance created by `SAUCE_uring_setup()`.
+ * 
+ * @param ring the ring
+ */
+static void SAUCE_uring_teardown(SAUCEUring* ring) {
+  if (ring->sqes != NULL) munmap(ring->sqes, ring->sqes_size);
+  if (ring->cq_ring != NULL && ring->cq_ring != ring->sq_ring) munmap(ring->cq_ring, ring->cq_ring_size);
+  if (ring->sq_ring != NULL) munmap(ring->sq_ring, ring->sq_ring_size);
+  if (ring->fd >= 0) close(ring->fd);
+  ring->fd = -1;
+}
+
+
+/**
+ * @brief Check if the kernel supports every io_uring operation needed to read a batch.
+ * 
+ * @param fd io_uring file descriptor
+ * @return 1 (true) if every operation is supported; 0 (false) if otherwise
+ */
+static int SAUCE_uring_supports_ops(int fd) {
+  const unsigned nOps = 64;
+  struct io_uring_probe* probe = SAUCE_calloc(1, sizeof(struct io_uring_probe) + nOps * sizeof(struct io_uring_probe_op));
+  if (probe == NULL) return 0;
+
+  int supported = 0;
+  if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, nOps) >= 0) {
+    const unsigned ops[] = { IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ, IORING_OP_CLOSE };
+    supported = 1;
+    for (unsigned i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+      if (ops[i] > probe->last_op || !(probe->ops[ops[i]].flags & IO_URING_OP_SUPPORTED)) supported = 0;
+    }
+  }
+
+  SAUCE_free(probe);
+  return supported;
+}
+
+
+/**
+ * @brief Create an io_uring instance and map its queues. This fails if io_uring is not available at
+ *        runtime, such as on older kernels or when it is blocked by a seccomp filter.
+ * 
+ * @param ring the ring to set up
+ * @return 0 on success. On error, -1 is returned.
+ */
+static int SAUCE_uring_setup(SAUCEUring* ring) {
+  memset(ring, 0, sizeof(SAUCEUring));
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+
+  ring->fd = (int)syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+  if (ring->fd < 0) return -1;
+  if (!SAUCE_uring_supports_ops(ring->fd)) {
+    SAUCE_uring_teardown(ring);
+    return -1;
+  }
+
+  ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    if (ring->cq_ring_size > ring->sq_ring_size) ring->sq_ring_size = ring->cq_ring_size;
+    ring->cq_ring_size = ring->sq_ring_size;
+  }
+
+  void* ptr = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+  if (ptr == MAP_FAILED) {
+    SAUCE_uring_teardown(ring);
+    return -1;
+  }
+  ring->sq_ring = ptr;
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    ring->cq_ring = ring->sq_ring;
+  } else {
+    ptr = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+    if (ptr == MAP_FAILED) {
+      SAUCE_uring_teardown(ring);
+      return -1;
+    }
+    ring->cq_ring = ptr;
+  }
+
+  ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  ptr = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+  if (ptr == MAP_FAILED) {
+    SAUCE_uring_teardown(ring);
+    return -1;
+  }
+  ring->sqes = ptr;
+
+  char* sq = ring->sq_ring;
+  char* cq = ring->cq_ring;
+  ring->sq_tail = (unsigned*)(sq + params.sq_off.tail);
+  ring->sq_mask = (unsigned*)(sq + params.sq_off.ring_mask);
+  ring->sq_array = (unsigned*)(sq + params.sq_off.array);
+  ring->cq_head = (unsigned*)(cq + params.cq_off.head);
+  ring->cq_tail = (unsigned*)(cq + params.cq_off.tail);
+  ring->cq_mask = (unsigned*)(cq + params.cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+  return 0;
+}
+
+
+/**
+ * @brief Queue an operation on the submission queue. The operation is not submitted until
+ *        `SAUCE_uring_run()` is called.
+ * 
+ * @param ring the ring
+ * @param opcode an IORING_OP_* operation
+ * @param fd file descriptor, or directory file descriptor for path operations
+ * @param addr buffer or path
+ * @param len length of the buffer, or the statx mask
+ * @param off offset in the file, or the statx buffer
+ * @param opFlags open or statx flags
+ * @param sqeFlags IOSQE_* flags
+ * @param data index of the operation's result in the array given to `SAUCE_uring_run()`
+ */
+static void SAUCE_uring_queue(SAUCEUring* ring, uint8_t opcode, int fd, const void* addr, uint32_t len, uint64_t off,
+                              uint32_t opFlags, uint8_t sqeFlags, uint64_t data) {
+  unsigned tail = *ring->sq_tail;
+  unsigned index = tail & *ring->sq_mask;
+  struct io_uring_sqe* sqe = &ring->sqes[index];
+
+  memset(sqe, 0, sizeof(struct io_uring_sqe));
+  sqe->opcode = opcode;
+  sqe->flags = sqeFlags;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t)(uintptr_t)addr;
+  sqe->len = len;
+  sqe->off = off;
+  sqe->rw_flags = opFlags;
+  sqe->user_data = data;
+
+  ring->sq_array[index] = index;
+  __atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+
+/**
+ * @brief Submit `n` queued operations and wait for all of them to complete.
+ * 
+ * @param ring the ring
+ * @param n the number of queued operations
+ * @param res array where `res[data]` will be set to the result of the operation queued with `data`
+ * @return 0 on success. On error, -1 is returned.
+ */
+static int SAUCE_uring_run(SAUCEUring* ring, unsigned n, int32_t* res) {
+  unsigned submitted = 0;
+  unsigned completed = 0;
+
+  while (completed < n) {
+    long ret = syscall(__NR_io_uring_enter, ring->fd, n - submitted, n - completed, IORING_ENTER_GETEVENTS, NULL, 0);
+    if (ret < 0) {
+      if (errno == EINTR) continue;
+      return -1;
+    }
+    submitted += (unsigned)ret;
+
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+      struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cq_mask];
+      res[cqe->user_data] = cqe->res;
+      head++;
+      completed++;
+    }
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+  }
+
+  return 0;
+}
+
+
+/**
+ * @brief Close the files of a chunk that were opened but not closed by the ring. This is used when
+ *        `SAUCE_uring_run()` fails, so that the descriptors of completed opens are not leaked.
+ * 
+ * @param chunk buffers for the files
+ * @param n number of files
+ * @param closes index of the first close result in `chunk->res`, or -1 if no close was queued
+ */
+static void SAUCE_uring_close_chunk(SAUCEUringChunk* chunk, uint32_t n, int closes) {
+  for (uint32_t i = 0; i < n; i++) {
+    if (chunk->fds[i] < 0) continue;
+    // a completed close returns 0 or a negative error; either way the descriptor is gone
+    if (closes >= 0 && chunk->res[3 * i + closes] <= 0) continue;
+    close(chunk->fds[i]);
+  }
+}
+
+
+/**
+ * @brief Read the records of `n` files with two round trips through the ring. First, every file is opened
+ *        and the size of its path is requested with statx. Then, the end of every opened file is read at
+ *        that size, hard linked after a statx of the opened file and before a close of the file, so that
+ *        the file is closed even if the read fails. If the opened file's size is not the size of its
+ *        path, the path was replaced in between, and the record is read again without the ring.
+ * 
+ * @param ring the ring
+ * @param chunk buffers for the files
+ * @param batch the batch
+ * @param first index of the first file in the batch
+ * @param n number of files, at most URING_CHUNK_SIZE
+ * @return 0 on success. On error, -1 is returned.
+ */
+static int SAUCE_uring_read_chunk(SAUCEUring* ring, SAUCEUringChunk* chunk, SAUCEBatch* batch, uint32_t first, uint32_t n) {
+  const char* const* paths = &batch->paths[first];
+  int* results = &batch->results[first];
+
+  // open and stat every file
+  unsigned queued = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    chunk->fds[i] = -1;
+    chunk->res[2 * i] = -1;
+    if (paths[i] == NULL) continue;
+    SAUCE_uring_queue(ring, IORING_OP_OPENAT, AT_FDCWD, paths[i], 0, 0, O_RDONLY | O_CLOEXEC, 0, 2 * i);
+    SAUCE_uring_queue(ring, IORING_OP_STATX, AT_FDCWD, paths[i], STATX_SIZE, (uint64_t)(uintptr_t)&chunk->stats[i], 0, 0, 2 * i + 1);
+    queued += 2;
+  }
+  int failed = SAUCE_uring_run(ring, queued, chunk->res) < 0;
+
+  // the results are taken out before the second round trip reuses the array
+  for (uint32_t i = 0; i < n; i++) {
+    if (paths[i] == NULL) {
+      results[i] = SAUCE_ENULL;
+    } else if (chunk->res[2 * i] < 0) {
+      results[i] = SAUCE_EFOPEN;
+    } else {
+      chunk->fds[i] = chunk->res[2 * i];
+      results[i] = (chunk->res[2 * i + 1] < 0 || !(chunk->stats[i].stx_mask & STATX_SIZE)) ? SAUCE_EFFAIL : 0;
+    }
+  }
+  if (failed) {
+    SAUCE_uring_close_chunk(chunk, n, -1);
+    return -1;
+  }
+
+  // stat and read the end of every opened file, then close it
+  queued = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    chunk->reading[i] = 0;
+    int fd = chunk->fds[i];
+    if (fd < 0) continue;
+
+    const struct statx* info = &chunk->stats[i];
+    if (results[i] == 0) {
+      uint32_t toRead = (info->stx_size < SAUCE_RECORD_SIZE) ? (uint32_t)info->stx_size : SAUCE_RECORD_SIZE;
+      chunk->lengths[i] = toRead;
+      SAUCE_uring_queue(ring, IORING_OP_STATX, fd, "", STATX_SIZE, (uint64_t)(uintptr_t)&chunk->fdStats[i], AT_EMPTY_PATH, IOSQE_IO_HARDLINK, 3 * i);
+      queued++;
+      if (toRead > 0) {
+        SAUCE_uring_queue(ring, IORING_OP_READ, fd, chunk->tails[i], toRead, info->stx_size - toRead, 0, IOSQE_IO_HARDLINK, 3 * i + 1);
+        chunk->reading[i] = 1;
+        queued++;
+      }
+    }
+
+    chunk->res[3 * i + 2] = 1;
+    SAUCE_uring_queue(ring, IORING_OP_CLOSE, fd, NULL, 0, 0, 0, 0, 3 * i + 2);
+    queued++;
+  }
+  if (SAUCE_uring_run(ring, queued, chunk->res) < 0) {
+    SAUCE_uring_close_chunk(chunk, n, 2);
+    return -1;
+  }
+
+  // decode the records
+  for (uint32_t i = 0; i < n; i++) {
+    if (results[i] < 0) continue;
+
+    const struct statx* info = &chunk->fdStats[i];
+    int replaced = chunk->res[3 * i] < 0 || !(info->stx_mask & STATX_SIZE) || info->stx_size != chunk->stats[i].stx_size;
+    if (replaced || (chunk->reading[i] && chunk->res[3 * i + 1] != (int32_t)chunk->lengths[i])) {
+      // the path was replaced after it was opened, or the read failed or was short, so try again without the ring
+      results[i] = SAUCE_file_fetch_record(paths[i], batch->cache, &batch->records[first + i]);
+      continue;
+    }
+    results[i] = SAUCE_decode_record(chunk->tails[i], chunk->lengths[i], (int64_t)info->stx_size, &batch->records[first + i]);
+  }
+
+  return 0;
+}
+
+
+/**
+ * @brief Read the unclaimed files of a batch through io_uring. If io_uring is not available at runtime
+ *        or the ring fails, the files that were not read are left unclaimed.
+ * 
+ * @param batch the batch
+ */
+static void SAUCE_batch_read_uring(SAUCEBatch* batch) {
+  // another thread is using the ring, so this batch is read by the pool instead
+  if (pthread_mutex_trylock(&uring_lock) != 0) return;
+  pthread_once(&batch_fork_once, SAUCE_batch_register_fork);
+
+  // the chunk lives as long as the process, so it is not taken from the library's allocator
+  if (uring_chunk == NULL) uring_chunk = malloc(sizeof(SAUCEUringChunk));
+  if (uring_state == 0 && uring_chunk != NULL) {
+    uring_state = (SAUCE_uring_setup(&uring_ring) == 0) ? 1 : -1;
+  }
+
+  while (uring_state == 1 && batch->next < batch->count) {
+    uint32_t n = batch->count - batch->next;
+    if (n > URING_CHUNK_SIZE) n = URING_CHUNK_SIZE;
+    if (SAUCE_uring_read_chunk(&uring_ring, uring_chunk, batch, batch->next, n) < 0) {
+      // operations may still be in flight, so a new ring is set up for the next batch
+      SAUCE_uring_teardown(&uring_ring);
+      uring_state = 0;
+      break;
+    }
+    batch->next += n;
+  }
+
+  pthread_mutex_unlock(&uring_lock);
+}
+#endif
+
+
+#ifdef THREADS_IS_DEFINED
+/**
+ * @brief Reset the pool and the ring in the child after a fork. Only the forking thread exists in the
+ *        child, and the ring's queues are still shared with the parent, so both are started over.
+ * 
+ */
+static void SAUCE_batch_after_fork(void) {
+  pthread_mutex_init(&batch_pool.lock, NULL);
+  pthread_cond_init(&batch_pool.work, NULL);
+  pthread_cond_init(&batch_pool.idle, NULL);
+  batch_pool.batches = NULL;
+  batch_pool.nThreads = 0;
+  batch_pool.started = 0;
+
+  #ifdef URING_IS_DEFINED
+  pthread_mutex_init(&uring_lock, NULL);
+  if (uring_state == 1) SAUCE_uring_teardown(&uring_ring);
+  uring_state = 0;
+  #endif
+}
+
+
+static void SAUCE_batch_register_fork(void) {
+  pthread_atfork(NULL, NULL, SAUCE_batch_after_fork);
+}
+#endif
+
+
+
+
+
+#ifdef SCAN_IS_DEFINED
+// Tree scanning
+
+// Number of files in a directory that make up one task, so that the files of a large directory
+// can be shared between workers
+#define SCAN_TASK_FILES     64
+
+// Largest number of threads used to scan a tree
+#define SCAN_MAX_THREADS    64
+
+// Largest number of directories a scan keeps open for its queued tasks. Past that, and past a quarter of
+// the file descriptors the process may open, tasks open their directory by its path instead.
+#define SCAN_MAX_OPEN_DIRS  256
+
+// Kinds of directory entries
+#define SCAN_ENTRY_OTHER    0
+#define SCAN_ENTRY_FILE     1
+#define SCAN_ENTRY_DIR      2
+
+
+// A directory that is kept open for the tasks that are resolved against it, so that they do not have
+// to open it again by its path
+typedef struct SAUCEScanDir {
+  DIR* dir;           // the open directory
+  int fd;             // descriptor of `dir`
+  uint32_t refs;      // number of users of the directory, guarded by the scan's lock
+} SAUCEScanDir;
+
+
+// A unit of work for SAUCE_scan_tree(). A task either lists a directory, or reads a group of
+// files in a directory. The strings are allocated along with the task.
+typedef struct SAUCEScanTask {
+  char* dir;          // path of the directory
+  char* name;         // name of the directory in its parent, the last part of `dir`. NULL for the root.
+  char* names;        // names of the files, each followed by a null character. NULL if the directory has to be listed.
+  uint32_t count;     // number of names
+  SAUCEScanDir* at;   // the open parent of a directory to list, or the open directory of the files. NULL to open `dir`.
+} SAUCEScanTask;
+
+
+// The tasks owned by a worker. The owner pushes and pops tasks at the tail, so it works depth first
+// on the newest directories. Other workers steal from the head, which holds the oldest tasks that are
+// most likely to lead to large subtrees.
+typedef struct SAUCEScanDeque {
+  SAUCEScanTask** tasks;
+  size_t head;        // index of the oldest task
+  size_t tail;        // index after the newest task
+  size_t capacity;
+  pthread_mutex_t lock;
+} SAUCEScanDeque;
+
+
+// State shared by every worker of a scan
+typedef struct SAUCEScan {
+  SAUCEScanDeque* deques;       // one deque per worker
+  uint32_t nWorkers;
+  SAUCE_ScanCallback callback;
+  void* data;
+  SAUCE_ScanOptions options;
+  SAUCE_Cache* cache;           // cache of the calling context, or NULL
+
+  pthread_mutex_t lock;         // guards the fields below
+  pthread_cond_t wake;          // signaled when a task is pushed or the scan is over
+  uint64_t pending;             // number of tasks that are queued or running
+  uint64_t pushes;              // number of tasks pushed so far, used to notice new tasks
+  uint32_t idle;                // number of workers waiting for a task
+  int stop;                     // true if a callback stopped the scan or memory ran out
+  int failed;                   // true if memory ran out
+  uint64_t files;               // number of files passed to the callback
+  uint64_t skipped;             // number of directories that could not be listed
+  uint32_t openDirs;            // number of directories kept open for tasks
+  uint32_t maxOpenDirs;         // largest number of directories kept open for tasks
+  SAUCE_AllocStats allocs;      // allocations made by the worker threads
+} SAUCEScan;
+
+
+// A worker of a scan
+typedef struct SAUCEScanWorker {
+  SAUCEScan* scan;
+  uint32_t id;                  // index of the worker's deque
+  char* path;                   // buffer for the path of the current file
+  size_t pathCapacity;
+  char* names;                  // buffer for gathering the names of a task
+  size_t namesCapacity;
+  uint64_t files;
+  uint64_t skipped;
+} SAUCEScanWorker;
+
+
+/**
+ * @brief Create a task. The path of the task's directory is `dir`, or `dir` joined with `name` if `name` is not NULL.
+ * 
+ * @param dir path of a directory
+ * @param name name of an entry in `dir`, or NULL
+ * @param names names of the files to read, each followed by a null character, or NULL to list the directory
+ * @param namesLength total length of `names`
+ * @param count number of names
+ * @return the task, or NULL if it could not be allocated
+ */
+static SAUCEScanTask* SAUCE_scan_task_new(const char* dir, const char* name, const char* names, size_t namesLength, uint32_t count) {
+  size_t dirLength = strlen(dir);
+  size_t nameLength = (name != NULL) ? strlen(name) : 0;
+  size_t separator = (name != NULL && (dirLength == 0 || dir[dirLength - 1] != '/')) ? 1 : 0;
+  size_t pathLength = dirLength + separator + nameLength;
+
+  SAUCEScanTask* task = SAUCE_malloc(sizeof(SAUCEScanTask) + pathLength + 1 + namesLength);
+  if (task == NULL) return NULL;
+
+  task->dir = (char*)(task + 1);
+  memcpy(task->dir, dir, dirLength);
+  if (separator) task->dir[dirLength] = '/';
+  if (name != NULL) memcpy(task->dir + dirLength + separator, name, nameLength);
+  task->dir[pathLength] = 0;
+
+  task->name = (name != NULL) ? task->dir + dirLength + separator : NULL;
+  task->names = NULL;
+  task->count = count;
+  task->at = NULL;
+  if (names != NULL) {
+    task->names = task->dir + pathLength + 1;
+    memcpy(task->names, names, namesLength);
+  }
+  return task;
+}
+
+
+/**
+ * @brief Keep a listed directory open for the tasks that are resolved against it. Nothing is kept open once
+ *        the scan has as many directories open as it may.
+ * 
+ * @param scan the scan
+ * @param dir the open directory, which the returned SAUCEScanDir takes over
+ * @return the directory with one reference, or NULL if it cannot be kept open
+ */
+static SAUCEScanDir* SAUCE_scan_dir_keep(SAUCEScan* scan, DIR* dir) {
+  pthread_mutex_lock(&scan->lock);
+  int room = scan->openDirs < scan->maxOpenDirs;
+  if (room) scan->openDirs++;
+  pthread_mutex_unlock(&scan->lock);
+  if (!room) return NULL;
+
+  SAUCEScanDir* kept = SAUCE_malloc(sizeof(SAUCEScanDir));
+  if (kept == NULL) {
+    pthread_mutex_lock(&scan->lock);
+    scan->openDirs--;
+    pthread_mutex_unlock(&scan->lock);
+    return NULL;
+  }
+  kept->dir = dir;
+  kept->fd = dirfd(dir);
+  kept->refs = 1;
+  return kept;
+}
+
+
+/**
+ * @brief Add a reference to a kept directory.
+ * 
+ * @param scan the scan
+ * @param dir the directory, or NULL
+ * @return `dir`
+ */
+static SAUCEScanDir* SAUCE_scan_dir_ref(SAUCEScan* scan, SAUCEScanDir* dir) {
+  if (dir == NULL) return NULL;
+  pthread_mutex_lock(&scan->lock);
+  dir->refs++;
+  pthread_mutex_unlock(&scan->lock);
+  return dir;
+}
+
+
+/**
+ * @brief Drop a reference to a kept directory, and close it once it has none left.
+ * 
+ * @param scan the scan
+ * @param dir the directory, or NULL
+ */
+static void SAUCE_scan_dir_release(SAUCEScan* scan, SAUCEScanDir* dir) {
+  if (dir == NULL) return;
+  pthread_mutex_lock(&scan->lock);
+  int last = --dir->refs == 0;
+  if (last) scan->openDirs--;
+  pthread_mutex_unlock(&scan->lock);
+
+  if (last) {
+    closedir(dir->dir);
+    SAUCE_free(dir);
+  }
+}
+
+
+/**
+ * @brief Free a task, along with its reference to a kept directory.
+ * 
+ * @param scan the scan
+ * @param task the task
+ */
+static void SAUCE_scan_task_free(SAUCEScan* scan, SAUCEScanTask* task) {
+  SAUCE_scan_dir_release(scan, task->at);
+  SAUCE_free(task);
+}
+
+
+/**
+ * @brief Stop a scan because memory ran out.
+ * 
+ * @param scan the scan
+ */
+static void SAUCE_scan_fail(SAUCEScan* scan) {
+  pthread_mutex_lock(&scan->lock);
+  scan->stop = 1;
+  scan->failed = 1;
+  pthread_cond_broadcast(&scan->wake);
+  pthread_mutex_unlock(&scan->lock);
+}
+
+
+/**
+ * @brief Push a task onto the deque of a worker.
+ * 
+ * @param worker the worker
+ * @param task the task
+ * @return 0 on success. If the deque could not grow, the task is freed, the scan is stopped and -1 is returned.
+ */
+static int SAUCE_scan_push(SAUCEScanWorker* worker, SAUCEScanTask* task) {
+  SAUCEScan* scan = worker->scan;
+  SAUCEScanDeque* deque = &scan->deques[worker->id];
+
+  pthread_mutex_lock(&deque->lock);
+  if (deque->tail == deque->capacity) {
+    if (deque->head > 0) {
+      // reuse the space of stolen tasks
+      memmove(deque->tasks, &deque->tasks[deque->head], (deque->tail - deque->head) * sizeof(SAUCEScanTask*));
+      deque->tail -= deque->head;
+      deque->head = 0;
+    } else {
+      size_t capacity = (deque->capacity > 0) ? deque->capacity * 2 : 64;
+      SAUCEScanTask** tasks = SAUCE_realloc(deque->tasks, capacity * sizeof(SAUCEScanTask*));
+      if (tasks == NULL) {
+        pthread_mutex_unlock(&deque->lock);
+        SAUCE_scan_task_free(scan, task);
+        SAUCE_scan_fail(scan);
+        return -1;
+      }
+      deque->tasks = tasks;
+      deque->capacity = capacity;
+    }
+  }
+  deque->tasks[deque->tail++] = task;
+  pthread_mutex_unlock(&deque->lock);
+
+  pthread_mutex_lock(&scan->lock);
+  scan->pending++;
+  scan->pushes++;
+  if (scan->idle > 0) pthread_cond_signal(&scan->wake);
+  pthread_mutex_unlock(&scan->lock);
+  return 0;
+}
+
+
+/**
+ * @brief Take a task from a deque.
+ * 
+ * @param deque the deque
+ * @param newest true to take the newest task, as the owner does, or false to steal the oldest task
+ * @return the task, or NULL if the deque is empty
+ */
+static SAUCEScanTask* SAUCE_scan_take(SAUCEScanDeque* deque, int newest) {
+  SAUCEScanTask* task = NULL;
+
+  pthread_mutex_lock(&deque->lock);
+  if (deque->tail > deque->head) {
+    task = (newest) ? deque->tasks[--deque->tail] : deque->tasks[deque->head++];
+    if (deque->head == deque->tail) {
+      deque->head = 0;
+      deque->tail = 0;
+    }
+  }
+  pthread_mutex_unlock(&deque->lock);
+
+  return task;
+}
+
+
+/**
+ * @brief Get the next task for a worker. The worker's own deque is tried first, then the deques of the other
+ *        workers. If no task can be found, the worker waits until a task is pushed or the scan is over.
+ * 
+ * @param worker the worker
+ * @return the task, or NULL if the scan is over
+ */
+static SAUCEScanTask* SAUCE_scan_next_task(SAUCEScanWorker* worker) {
+  SAUCEScan* scan = worker->scan;
+
+  while (1) {
+    pthread_mutex_lock(&scan->lock);
+    uint64_t seen = scan->pushes;
+    int over = scan->stop || scan->pending == 0;
+    pthread_mutex_unlock(&scan->lock);
+    if (over) return NULL;
+
+    SAUCEScanTask* task = SAUCE_scan_take(&scan->deques[worker->id], 1);
+    for (uint32_t i = 1; task == NULL && i < scan->nWorkers; i++) {
+      task = SAUCE_scan_take(&scan->deques[(worker->id + i) % scan->nWorkers], 0);
+    }
+    if (task != NULL) return task;
+
+    // every task is running, wait for one of them to push more or for the scan to end
+    pthread_mutex_lock(&scan->lock);
+    while (!scan->stop && scan->pending > 0 && scan->pushes == seen) {
+      scan->idle++;
+      pthread_cond_wait(&scan->wake, &scan->lock);
+      scan->idle--;
+    }
+    pthread_mutex_unlock(&scan->lock);
+  }
+}
+
+
+/**
+ * @brief Mark a task of a scan as done. Wakes every worker if it was the last task.
+ * 
+ * @param scan the scan
+ */
+static void SAUCE_scan_finish_task(SAUCEScan* scan) {
+  pthread_mutex_lock(&scan->lock);
+  scan->pending--;
+  if (scan->pending == 0) pthread_cond_broadcast(&scan->wake);
+  pthread_mutex_unlock(&scan->lock);
+}
+
+
+/**
+ * @brief Check if a scan was stopped.
+ * 
+ * @param scan the scan
+ * @return true if the scan was stopped
+ */
+static int SAUCE_scan_stopped(SAUCEScan* scan) {
+  pthread_mutex_lock(&scan->lock);
+  int stop = scan->stop;
+  pthread_mutex_unlock(&scan->lock);
+  return stop;
+}
+
+
+/**
+ * @brief Make sure a worker's buffer can hold `size` bytes.
+ * 
+ * @param buffer the buffer
+ * @param capacity the capacity of the buffer
+ * @param size the required size
+ * @return 0 on success. On error, -1 is returned and the buffer is unchanged.
+ */
+static int SAUCE_scan_reserve(char** buffer, size_t* capacity, size_t size) {
+  if (size <= *capacity) return 0;
+
+  size_t newCapacity = (*capacity > 0) ? *capacity : 256;
+  while (newCapacity < size) newCapacity *= 2;
+  char* newBuffer = SAUCE_realloc(*buffer, newCapacity);
+  if (newBuffer == NULL) return -1;
+
+  *buffer = newBuffer;
+  *capacity = newCapacity;
+  return 0;
+}
+
+
+/**
+ * @brief Find out what kind of entry a directory entry is. The entry's type is used if the system reports it,
+ *        so most entries do not need a stat.
+ * 
+ * @param dfd file descriptor of the directory
+ * @param entry the directory entry
+ * @param followLinks true if symbolic links to regular files count as files
+ * @return SCAN_ENTRY_FILE, SCAN_ENTRY_DIR or SCAN_ENTRY_OTHER
+ */
+static int SAUCE_scan_entry_type(int dfd, const struct dirent* entry, int followLinks) {
+  #ifdef DT_DIR
+  if (entry->d_type == DT_DIR) return SCAN_ENTRY_DIR;
+  if (entry->d_type == DT_REG) return SCAN_ENTRY_FILE;
+  if (entry->d_type != DT_UNKNOWN && (entry->d_type != DT_LNK || !followLinks)) return SCAN_ENTRY_OTHER;
+  #endif
+
+  struct stat info;
+  if (fstatat(dfd, entry->d_name, &info, AT_SYMLINK_NOFOLLOW) < 0) return SCAN_ENTRY_OTHER;
+  if (S_ISDIR(info.st_mode)) return SCAN_ENTRY_DIR;
+  if (S_ISREG(info.st_mode)) return SCAN_ENTRY_FILE;
+
+  // links to directories are never followed, which keeps the scan free of cycles
+  if (S_ISLNK(info.st_mode) && followLinks && fstatat(dfd, entry->d_name, &info, 0) == 0 && S_ISREG(info.st_mode)) {
+    return SCAN_ENTRY_FILE;
+  }
+  return SCAN_ENTRY_OTHER;
+}
+
+
+#ifdef CACHE_IS_DEFINED
+/**
+ * @brief Fill a scan entry from a cache. Files without a comment are looked up with a single stat and are
+ *        only opened if they are not in the cache. The comment of a cached file is read on its own.
+ * 
+ * @param cache the cache
+ * @param dfd file descriptor of the directory containing the file, or AT_FDCWD
+ * @param name name of the file
+ * @param flags flags to open the file with
+ * @param tail array of length SAUCE_MAX_TAIL_SIZE, which the entry's comment will point into
+ * @param entry the scan entry to fill
+ */
+static void SAUCE_scan_read_cached(SAUCE_Cache* cache, int dfd, const char* name, int flags, char* tail, SAUCE_ScanEntry* entry) {
+  SAUCECacheEntry cached;
+  struct stat st;
+  int statFlags = (flags & O_NOFOLLOW) ? AT_SYMLINK_NOFOLLOW : 0;
+  int hit = fstatat(dfd, name, &st, statFlags) == 0 && SAUCE_cache_lookup(cache, &st, &cached);
+
+  const char* data = NULL;
+  const char* comment = tail;
+  if (!hit || cached.comment_exists) {
+    int fd = openat(dfd, name, flags);
+    if (fd < 0) {
+      entry->result = SAUCE_EFOPEN;
+      return;
+    }
+    int res = SAUCE_cache_fetch(cache, fd, tail, &cached, &data);
+    if (res == 0 && cached.comment_exists && data == NULL) {
+      // only the comment lines are read, into the beginning of the buffer
+      if (SAUCE_fd_pread(fd, tail, SAUCE_COMMENT_STRING_LENGTH(cached.lines), cached.start + 5) < 0) res = SAUCE_EFFAIL;
+    } else if (data != NULL) {
+      comment = data + 5;
+    }
+    SAUCE_fd_close(fd);
+    if (res < 0) {
+      entry->result = res;
+      return;
+    }
+  }
+
+  entry->result = cached.result;
+  entry->filesize = cached.size;
+  entry->record_exists = cached.record_exists;
+  if (cached.record_exists) memcpy(&entry->record, &cached.record, SAUCE_RECORD_SIZE);
+  if (cached.comment_exists) {
+    entry->comment_lines = cached.lines;
+    entry->comment = comment;
+  }
+}
+#endif
+
+
+/**
+ * @brief Fill a scan entry with the SAUCE data of a file. The file's tail is decoded like `SAUCE_check_file()`
+ *        would, without setting any error messages.
+ * 
+ * @param cache the cache of the calling context, or NULL
+ * @param dfd file descriptor of the directory containing the file, or AT_FDCWD
+ * @param name name of the file
+ * @param flags flags to open the file with
+ * @param tail array of length SAUCE_MAX_TAIL_SIZE, which the entry's comment will point into
+ * @param entry the scan entry to fill
+ */
+static void SAUCE_scan_fill_entry(SAUCE_Cache* cache, int dfd, const char* name, int flags, char* tail, SAUCE_ScanEntry* entry) {
+  #ifdef CACHE_IS_DEFINED
+  if (cache != NULL) {
+    SAUCE_scan_read_cached(cache, dfd, name, flags, tail, entry);
+    return;
+  }
+  #endif
+
+  int fd = openat(dfd, name, flags);
+  if (fd < 0) {
+    entry->result = SAUCE_EFOPEN;
+    return;
+  }
+
+  uint32_t length = 0;
+  entry->result = SAUCE_fd_read_tail(fd, tail, &entry->filesize, &length);
+  SAUCE_fd_close(fd);
+  if (entry->result < 0) return;
+
+  SAUCEInfo info;
+  entry->result = SAUCE_decode_info(tail, length, &info);
+  if (info.record_exists) {
+    entry->record_exists = 1;
+    memcpy(&entry->record, &tail[length - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
+  }
+  if (info.comment_exists) {
+    entry->comment_lines = info.lines;
+    entry->comment = &tail[info.start + 5];
+  }
+}
+
+
+/**
+ * @brief Read the SAUCE data of a file and pass it to the scan's callback. The file is opened relative to its
+ *        directory and its tail is decoded like `SAUCE_check_file()` would, without setting any error messages.
+ * 
+ * @param worker the worker
+ * @param dfd file descriptor of the directory containing the file
+ * @param dir path of the directory
+ * @param name name of the file
+ * @return 0 to continue the scan, or non-zero if the callback stopped the scan or memory ran out
+ */
+static int SAUCE_scan_read_file(SAUCEScanWorker* worker, int dfd, const char* dir, const char* name) {
+  SAUCEScan* scan = worker->scan;
+
+  // build the path of the file
+  size_t dirLength = strlen(dir);
+  size_t nameLength = strlen(name);
+  if (SAUCE_scan_reserve(&worker->path, &worker->pathCapacity, dirLength + nameLength + 2) < 0) {
+    SAUCE_scan_fail(scan);
+    return -1;
+  }
+  memcpy(worker->path, dir, dirLength);
+  if (dirLength > 0 && dir[dirLength - 1] != '/') worker->path[dirLength++] = '/';
+  memcpy(worker->path + dirLength, name, nameLength + 1);
+
+  SAUCE_ScanEntry entry;
+  memset(&entry, 0, sizeof(entry));
+  entry.path = worker->path;
+
+  char tail[SAUCE_MAX_TAIL_SIZE];
+  int flags = O_RDONLY | O_CLOEXEC;
+  if (!scan->options.follow_links) flags |= O_NOFOLLOW;
+  if (dfd < 0) entry.result = SAUCE_EFOPEN;
+  else SAUCE_scan_fill_entry(scan->cache, dfd, name, flags, tail, &entry);
+
+  worker->files++;
+  if (scan->callback(&entry, scan->data) != 0) {
+    pthread_mutex_lock(&scan->lock);
+    scan->stop = 1;
+    pthread_cond_broadcast(&scan->wake);
+    pthread_mutex_unlock(&scan->lock);
+    return 1;
+  }
+  return 0;
+}
+
+
+/**
+ * @brief Read every file of a task. The files are opened relative to their kept directory, or to their
+ *        directory opened by its path if it was not kept.
+ * 
+ * @param worker the worker
+ * @param task a task with names
+ */
+static void SAUCE_scan_read_files(SAUCEScanWorker* worker, const SAUCEScanTask* task) {
+  // the files are still reported to the callback if their directory cannot be opened
+  int dfd = (task->at != NULL) ? task->at->fd : open(task->dir, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+  const char* name = task->names;
+  for (uint32_t i = 0; i < task->count; i++) {
+    if (SAUCE_scan_stopped(worker->scan) || SAUCE_scan_read_file(worker, dfd, task->dir, name) != 0) break;
+    name += strlen(name) + 1;
+  }
+
+  if (task->at == NULL && dfd >= 0) SAUCE_fd_close(dfd);
+}
+
+
+/**
+ * @brief List the directory of a task. Every subdirectory becomes a new task, and the regular files are
+ *        gathered into tasks of `SCAN_TASK_FILES` files so that other workers can steal them. The last
+ *        files of the directory are read right away, while the directory is still open.
+ * 
+ *        The directory is opened relative to its kept parent, and is itself kept open for its new tasks, so
+ *        that they do not resolve its path again. Once the scan keeps as many directories open as it may,
+ *        directories are opened by their path, and their tasks open them again.
+ * 
+ * @param worker the worker
+ * @param task a task without names
+ */
+static void SAUCE_scan_list_dir(SAUCEScanWorker* worker, const SAUCEScanTask* task) {
+  SAUCEScan* scan = worker->scan;
+
+  int flags = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+  int fd = (task->at != NULL) ? openat(task->at->fd, task->name, flags) : open(task->dir, flags);
+  DIR* dir = (fd >= 0) ? fdopendir(fd) : NULL;
+  if (dir == NULL) {
+    if (fd >= 0) SAUCE_fd_close(fd);
+    worker->skipped++;
+    return;
+  }
+  int dfd = dirfd(dir);
+  SAUCEScanDir* kept = SAUCE_scan_dir_keep(scan, dir);
+
+  size_t namesLength = 0;
+  uint32_t count = 0;
+  struct dirent* entry;
+  while ((entry = readdir(dir)) != NULL) {
+    const char* name = entry->d_name;
+    if (name[0] == '.') {
+      if (name[1] == 0 || (name[1] == '.' && name[2] == 0)) continue;
+      if (!scan->options.include_hidden) continue;
+    }
+
+    int type = SAUCE_scan_entry_type(dfd, entry, scan->options.follow_links);
+    if (type == SCAN_ENTRY_DIR) {
+      SAUCEScanTask* subdir = SAUCE_scan_task_new(task->dir, name, NULL, 0, 0);
+      if (subdir == NULL) {
+        SAUCE_scan_fail(scan);
+        break;
+      }
+      subdir->at = SAUCE_scan_dir_ref(scan, kept);
+      if (SAUCE_scan_push(worker, subdir) < 0) break;
+    } else if (type == SCAN_ENTRY_FILE) {
+      size_t nameLength = strlen(name) + 1;
+      if (SAUCE_scan_reserve(&worker->names, &worker->namesCapacity, namesLength + nameLength) < 0) {
+        SAUCE_scan_fail(scan);
+        break;
+      }
+      memcpy(worker->names + namesLength, name, nameLength);
+      namesLength += nameLength;
+      count++;
+
+      if (count == SCAN_TASK_FILES) {
+        SAUCEScanTask* files = SAUCE_scan_task_new(task->dir, NULL, worker->names, namesLength, count);
+        if (files == NULL) {
+          SAUCE_scan_fail(scan);
+          break;
+        }
+        files->at = SAUCE_scan_dir_ref(scan, kept);
+        if (SAUCE_scan_push(worker, files) < 0) break;
+        namesLength = 0;
+        count = 0;
+      }
+    }
+  }
+
+  const char* name = worker->names;
+  for (uint32_t i = 0; i < count; i++) {
+    if (SAUCE_scan_stopped(scan) || SAUCE_scan_read_file(worker, dfd, task->dir, name) != 0) break;
+    name += strlen(name) + 1;
+  }
+
+  if (kept != NULL) SAUCE_scan_dir_release(scan, kept);
+  else closedir(dir);
+}
+
+
+/**
+ * @brief Run tasks until the scan is over.
+ * 
+ * @param arg the SAUCEScanWorker
+ * @return NULL
+ */
+static void* SAUCE_scan_worker(void* arg) {
+  SAUCEScanWorker* worker = arg;
+
+  SAUCEScanTask* task;
+  while ((task = SAUCE_scan_next_task(worker)) != NULL) {
+    if (task->names == NULL) SAUCE_scan_list_dir(worker, task);
+    else SAUCE_scan_read_files(worker, task);
+    SAUCE_scan_task_free(worker->scan, task);
+    SAUCE_scan_finish_task(worker->scan);
+  }
+
+  pthread_mutex_lock(&worker->scan->lock);
+  worker->scan->files += worker->files;
+  worker->scan->skipped += worker->skipped;
+  pthread_mutex_unlock(&worker->scan->lock);
+  return NULL;
+}
+
+
+/**
+ * @brief Add the allocations counted in `from` to `into`.
+ * 
+ * @param into the stats to add to
+ * @param from the stats to add
+ */
+static void SAUCE_scan_add_allocs(SAUCE_AllocStats* into, const SAUCE_AllocStats* from) {
+  into->allocations += from->allocations;
+  into->frees += from->frees;
+  into->bytes_allocated += from->bytes_allocated;
+  into->bytes_freed += from->bytes_freed;
+}
+
+
+/**
+ * @brief Body of a worker thread. The thread's allocations are added to the scan's, so that they
+ *        can be counted for the thread that started the scan.
+ * 
+ * @param arg the SAUCEScanWorker
+ * @return NULL
+ */
+static void* SAUCE_scan_thread(void* arg) {
+  SAUCEScanWorker* worker = arg;
+  SAUCE_scan_worker(worker);
+
+  pthread_mutex_lock(&worker->scan->lock);
+  SAUCE_scan_add_allocs(&worker->scan->allocs, &alloc_stats);
+  pthread_mutex_unlock(&worker->scan->lock);
+  return NULL;
+}
+
+
+/**
+ * @brief Scan a directory tree with a pool of workers. The calling thread works as well.
+ * 
+ * @param scan the scan, with its callback and options set
+ * @param root path of the root directory
+ * @return 0 on success. On error, -1 is returned.
+ */
+static int SAUCE_scan_run(SAUCEScan* scan, const char* root) {
+  uint32_t nWorkers = scan->options.threads;
+  if (nWorkers == 0) {
+    // the work is bound by I/O, so two threads are used per online processor
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    nWorkers = (cpus > 0) ? (uint32_t)cpus * 2 : 2;
+  }
+  if (nWorkers > SCAN_MAX_THREADS) nWorkers = SCAN_MAX_THREADS;
+
+  scan->deques = SAUCE_calloc(nWorkers, sizeof(SAUCEScanDeque));
+  SAUCEScanWorker* workers = SAUCE_calloc(nWorkers, sizeof(SAUCEScanWorker));
+  SAUCEScanTask* rootTask = SAUCE_scan_task_new(root, NULL, NULL, 0, 0);
+  if (scan->deques == NULL || workers == NULL || rootTask == NULL) {
+    SAUCE_free(scan->deques);
+    SAUCE_free(workers);
+    SAUCE_free(rootTask);
+    return -1;
+  }
+
+  // queued directories are only kept open while the process has descriptors to spare
+  scan->nWorkers = nWorkers;
+  scan->openDirs = 0;
+  scan->maxOpenDirs = SCAN_MAX_OPEN_DIRS;
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY && limit.rlim_cur / 4 < SCAN_MAX_OPEN_DIRS) {
+    scan->maxOpenDirs = (uint32_t)(limit.rlim_cur / 4);
+  }
+  pthread_mutex_init(&scan->lock, NULL);
+  pthread_cond_init(&scan->wake, NULL);
+  for (uint32_t i = 0; i < nWorkers; i++) {
+    pthread_mutex_init(&scan->deques[i].lock, NULL);
+    workers[i].scan = scan;
+    workers[i].id = i;
+  }
+
+  int res = SAUCE_scan_push(&workers[0], rootTask);
+
+  pthread_t threads[SCAN_MAX_THREADS];
+  uint32_t started = 0;
+  for (uint32_t i = 1; res == 0 && i < nWorkers; i++) {
+    // if a thread cannot be created, the other workers pick up its work
+    if (pthread_create(&threads[started], NULL, SAUCE_scan_thread, &workers[i]) != 0) break;
+    started++;
+  }
+
+  if (res == 0) SAUCE_scan_worker(&workers[0]);
+  for (uint32_t i = 0; i < started; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  SAUCE_scan_add_allocs(&alloc_stats, &scan->allocs);
+
+  // tasks are left over if the scan was stopped
+  for (uint32_t i = 0; i < nWorkers; i++) {
+    SAUCEScanDeque* deque = &scan->deques[i];
+    for (size_t j = deque->head; j < deque->tail; j++) SAUCE_scan_task_free(scan, deque->tasks[j]);
+    SAUCE_free(deque->tasks);
+    pthread_mutex_destroy(&deque->lock);
+    SAUCE_free(workers[i].path);
+    SAUCE_free(workers[i].names);
+  }
+  pthread_cond_destroy(&scan->wake);
+  pthread_mutex_destroy(&scan->lock);
+  SAUCE_free(scan->deques);
+  SAUCE_free(workers);
+
+  return (scan->failed) ? -1 : 0;
+}
+#endif //SCAN_IS_DEFINED
+
+
+
+
+#ifdef WATCH_IS_DEFINED
+// Watching
+
+// Events watched in every directory of a watched tree
+#define WATCH_MASK            (IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ONLYDIR)
+
+// Default number of milliseconds a file must go without events before it is reported
+#define WATCH_DEFAULT_DELAY   100
+
+// A path with events that have not been reported yet. Later events for the same path replace earlier ones.
+typedef struct SAUCEWatchPending {
+  char* path;                   // path of the file or directory
+  uint64_t hash;                // hash of `path`
+  int64_t due;                  // monotonic time in nanoseconds at which the path is reported
+  enum SAUCE_WatchEvent event;  // event to report
+} SAUCEWatchPending;
+
+struct SAUCE_Watcher {
+  int fd;                       // inotify file descriptor
+  char* root;                   // path of the root directory
+  SAUCE_WatchOptions options;   // options given to SAUCE_Watcher_open()
+  int64_t delay;                // options.delay_ms in nanoseconds
+  char** dirs;                  // dirs[wd] is the path of the directory watched by wd, or NULL
+  uint32_t dirsCapacity;        // length of `dirs`
+  SAUCEWatchPending* pending;   // paths waiting to be reported
+  uint32_t pendingCount;        // number of pending paths
+  uint32_t pendingCapacity;     // length of `pending`
+  uint32_t* index;              // open addressed table of indices into `pending` plus one, 0 for an unused slot
+  uint32_t indexCapacity;       // length of `index`, always a power of two larger than twice `pendingCapacity`
+};
+
+
+/**
+ * @brief Get the time of the monotonic clock in nanoseconds.
+ *
+ * @return the time
+ */
+static int64_t SAUCE_watch_now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+
+/**
+ * @brief Hash a path with FNV-1a.
+ *
+ * @param path the path
+ * @return the hash
+ */
+static uint64_t SAUCE_watch_hash(const char* path) {
+  uint64_t hash = 0xCBF29CE484222325ULL;
+  for (; *path != 0; path++) hash = (hash ^ (uint8_t)*path) * 0x100000001B3ULL;
+  return hash;
+}
+
+
+/**
+ * @brief Join a directory path and a name with a '/'.
+ *
+ * @param dir path of a directory
+ * @param name name of an entry in the directory
+ * @return the new path, which must be freed, or NULL if it could not be allocated
+ */
+static char* SAUCE_watch_join(const char* dir, const char* name) {
+  size_t dirLength = strlen(dir);
+  size_t nameLength = strlen(name);
+  char* path = SAUCE_malloc(dirLength + nameLength + 2);
+  if (path == NULL) return NULL;
+
+  memcpy(path, dir, dirLength);
+  if (dirLength > 0 && dir[dirLength - 1] != '/') path[dirLength++] = '/';
+  memcpy(path + dirLength, name, nameLength + 1);
+  return path;
+}
+
+
+/**
+ * @brief Find the slot of a path in a watcher's index.
+ *
+ * @param watcher the watcher
+ * @param path the path
+ * @param hash hash of the path
+ * @return the index of the path's slot, or of the unused slot it would be stored in
+ */
+static uint32_t SAUCE_watch_slot(const SAUCE_Watcher* watcher, const char* path, uint64_t hash) {
+  uint32_t mask = watcher->indexCapacity - 1;
+  uint32_t slot = (uint32_t)(hash >> 32) & mask;
+  while (watcher->index[slot] != 0) {
+    const SAUCEWatchPending* pending = &watcher->pending[watcher->index[slot] - 1];
+    if (pending->hash == hash && strcmp(pending->path, path) == 0) break;
+    slot = (slot + 1) & mask;
+  }
+  return slot;
+}
+
+
+/**
+ * @brief Rebuild a watcher's index after its pending paths were moved.
+ *
+ * @param watcher the watcher
+ */
+static void SAUCE_watch_reindex(SAUCE_Watcher* watcher) {
+  memset(watcher->index, 0, watcher->indexCapacity * sizeof(uint32_t));
+  for (uint32_t i = 0; i < watcher->pendingCount; i++) {
+    const SAUCEWatchPending* pending = &watcher->pending[i];
+    watcher->index[SAUCE_watch_slot(watcher, pending->path, pending->hash)] = i + 1;
+  }
+}
+
+
+/**
+ * @brief Queue an event for a path, replacing any event that is still pending for it. The path is
+ *        reported once it has gone without events for the watcher's delay.
+ *
+ * @param watcher the watcher
+ * @param path the path, which is copied
+ * @param event the event
+ * @param now the current monotonic time in nanoseconds
+ * @return 0 on success, or -1 if memory ran out
+ */
+static int SAUCE_watch_queue(SAUCE_Watcher* watcher, const char* path, enum SAUCE_WatchEvent event, int64_t now) {
+  uint64_t hash = SAUCE_watch_hash(path);
+  uint32_t slot = SAUCE_watch_slot(watcher, path, hash);
+  if (watcher->index[slot] != 0) {
+    SAUCEWatchPending* pending = &watcher->pending[watcher->index[slot] - 1];
+    pending->event = event;
+    pending->due = now + watcher->delay;
+    return 0;
+  }
+
+  if (watcher->pendingCount == watcher->pendingCapacity) {
+    uint32_t capacity = watcher->pendingCapacity * 2;
+    SAUCEWatchPending* pending = SAUCE_realloc(watcher->pending, capacity * sizeof(SAUCEWatchPending));
+    if (pending == NULL) return -1;
+    watcher->pending = pending;
+
+    uint32_t* index = SAUCE_calloc(capacity * 4, sizeof(uint32_t));
+    if (index == NULL) return -1;
+    SAUCE_free(watcher->index);
+    watcher->index = index;
+    watcher->indexCapacity = capacity * 4;
+    watcher->pendingCapacity = capacity;
+    SAUCE_watch_reindex(watcher);
+    slot = SAUCE_watch_slot(watcher, path, hash);
+  }
+
+  char* copy = SAUCE_malloc(strlen(path) + 1);
+  if (copy == NULL) return -1;
+  strcpy(copy, path);
+
+  SAUCEWatchPending* pending = &watcher->pending[watcher->pendingCount++];
+  pending->path = copy;
+  pending->hash = hash;
+  pending->due = now + watcher->delay;
+  pending->event = event;
+  watcher->index[slot] = watcher->pendingCount;
+  return 0;
+}
+
+
+/**
+ * @brief Watch a directory, replacing the path of its watch if it was already watched.
+ *
+ * @param watcher the watcher
+ * @param path path of the directory
+ * @return 0 on success. On error, SAUCE_EFOPEN if the directory cannot be watched, or SAUCE_EOTHER if
+ *         the limit of inotify watches was reached or memory ran out.
+ */
+static int SAUCE_watch_add_dir(SAUCE_Watcher* watcher, const char* path) {
+  int wd = inotify_add_watch(watcher->fd, path, WATCH_MASK);
+  if (wd < 0) return (errno == ENOSPC || errno == ENOMEM) ? SAUCE_EOTHER : SAUCE_EFOPEN;
+
+  if ((uint32_t)wd >= watcher->dirsCapacity) {
+    uint32_t capacity = watcher->dirsCapacity * 2;
+    while (capacity <= (uint32_t)wd) capacity *= 2;
+    char** dirs = SAUCE_realloc(watcher->dirs, capacity * sizeof(char*));
+    if (dirs == NULL) return SAUCE_EOTHER;
+    memset(dirs + watcher->dirsCapacity, 0, (capacity - watcher->dirsCapacity) * sizeof(char*));
+    watcher->dirs = dirs;
+    watcher->dirsCapacity = capacity;
+  }
+
+  char* copy = SAUCE_malloc(strlen(path) + 1);
+  if (copy == NULL) return SAUCE_EOTHER;
+  strcpy(copy, path);
+  SAUCE_free(watcher->dirs[wd]);
+  watcher->dirs[wd] = copy;
+  return 0;
+}
+
+
+/**
+ * @brief Watch every directory of a tree. Directories that disappear while the tree is walked are skipped.
+ *
+ * @param watcher the watcher
+ * @param root path of the root of the tree
+ * @param queueFiles true to queue a SAUCE_WATCH_CHANGED event for every file in the tree, for trees that
+ *        appeared after the watcher was opened
+ * @param now the current monotonic time in nanoseconds
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_watch_add_tree(SAUCE_Watcher* watcher, const char* root, int queueFiles, int64_t now) {
+  char* first = SAUCE_malloc(strlen(root) + 1);
+  if (first == NULL) return SAUCE_EOTHER;
+  strcpy(first, root);
+
+  // directories that still need to be watched
+  char** stack = SAUCE_malloc(sizeof(char*) * 16);
+  size_t stackCount = 1, stackCapacity = 16;
+  if (stack == NULL) {
+    SAUCE_free(first);
+    return SAUCE_EOTHER;
+  }
+  stack[0] = first;
+
+  int res = 0;
+  while (stackCount > 0 && res == 0) {
+    char* dirPath = stack[--stackCount];
+    res = SAUCE_watch_add_dir(watcher, dirPath);
+    if (res == SAUCE_EFOPEN && dirPath != first) res = 0;
+
+    DIR* dir = (res == 0) ? opendir(dirPath) : NULL;
+    struct dirent* entry;
+    while (dir != NULL && res == 0 && (entry = readdir(dir)) != NULL) {
+      const char* name = entry->d_name;
+      if (name[0] == '.') {
+        if (name[1] == 0 || (name[1] == '.' && name[2] == 0)) continue;
+        if (!watcher->options.include_hidden) continue;
+      }
+
+      int type = SAUCE_scan_entry_type(dirfd(dir), entry, watcher->options.follow_links);
+      if (type == SCAN_ENTRY_OTHER || (type == SCAN_ENTRY_FILE && !queueFiles)) continue;
+
+      char* path = SAUCE_watch_join(dirPath, name);
+      if (path == NULL) {
+        res = SAUCE_EOTHER;
+      } else if (type == SCAN_ENTRY_FILE) {
+        if (SAUCE_watch_queue(watcher, path, SAUCE_WATCH_CHANGED, now) < 0) res = SAUCE_EOTHER;
+        SAUCE_free(path);
+      } else {
+        if (stackCount == stackCapacity) {
+          char** grown = SAUCE_realloc(stack, sizeof(char*) * stackCapacity * 2);
+          if (grown == NULL) {
+            SAUCE_free(path);
+            res = SAUCE_EOTHER;
+            break;
+          }
+          stack = grown;
+          stackCapacity *= 2;
+        }
+        stack[stackCount++] = path;
+      }
+    }
+
+    if (dir != NULL) closedir(dir);
+    SAUCE_free(dirPath);
+  }
+
+  while (stackCount > 0) SAUCE_free(stack[--stackCount]);
+  SAUCE_free(stack);
+  return res;
+}
+
+
+/**
+ * @brief Stop watching a directory and every directory beneath it, after it was moved away. The tree
+ *        is watched again if it was moved to another place in the watched tree.
+ *
+ * @param watcher the watcher
+ * @param path path the directory had before it was moved
+ */
+static void SAUCE_watch_remove_tree(SAUCE_Watcher* watcher, const char* path) {
+  size_t length = strlen(path);
+  for (uint32_t wd = 0; wd < watcher->dirsCapacity; wd++) {
+    const char* dir = watcher->dirs[wd];
+    if (dir == NULL || strncmp(dir, path, length) != 0 || (dir[length] != 0 && dir[length] != '/')) continue;
+    inotify_rm_watch(watcher->fd, (int)wd);
+    SAUCE_free(watcher->dirs[wd]);
+    watcher->dirs[wd] = NULL;
+  }
+}
+
+
+/**
+ * @brief Queue the events for a single inotify event.
+ *
+ * @param watcher the watcher
+ * @param event the inotify event
+ * @param now the current monotonic time in nanoseconds
+ * @return 0 on success, or -1 if memory ran out
+ */
+static int SAUCE_watch_handle(SAUCE_Watcher* watcher, const struct inotify_event* event, int64_t now) {
+  if (event->mask & IN_Q_OVERFLOW) return SAUCE_watch_queue(watcher, watcher->root, SAUCE_WATCH_OVERFLOW, now);
+  if (event->wd < 0 || (uint32_t)event->wd >= watcher->dirsCapacity || watcher->dirs[event->wd] == NULL) return 0;
+
+  // the watch of a deleted directory is removed by the kernel
+  if (event->mask & IN_IGNORED) {
+    SAUCE_free(watcher->dirs[event->wd]);
+    watcher->dirs[event->wd] = NULL;
+    return 0;
+  }
+  if (event->len == 0 || (event->name[0] == '.' && !watcher->options.include_hidden)) return 0;
+
+  char* path = SAUCE_watch_join(watcher->dirs[event->wd], event->name);
+  if (path == NULL) return -1;
+
+  int res = 0;
+  if (event->mask & IN_ISDIR) {
+    if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+      // files written before the new directory was watched have no events of their own
+      int added = SAUCE_watch_add_tree(watcher, path, 1, now);
+      if (added == SAUCE_EOTHER) res = SAUCE_watch_queue(watcher, watcher->root, SAUCE_WATCH_OVERFLOW, now);
+    } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+      if (event->mask & IN_MOVED_FROM) SAUCE_watch_remove_tree(watcher, path);
+      res = SAUCE_watch_queue(watcher, path, SAUCE_WATCH_DIR_REMOVED, now);
+    }
+  } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+    res = SAUCE_watch_queue(watcher, path, SAUCE_WATCH_CHANGED, now);
+  } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+    res = SAUCE_watch_queue(watcher, path, SAUCE_WATCH_REMOVED, now);
+  }
+
+  SAUCE_free(path);
+  return res;
+}
+
+
+/**
+ * @brief Read and queue every inotify event that is available without blocking.
+ *
+ * @param watcher the watcher
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_watch_read_events(SAUCE_Watcher* watcher) {
+  union {
+    struct inotify_event event;
+    char bytes[16 * 1024];
+  } buffer;
+
+  while (1) {
+    ssize_t length = read(watcher->fd, buffer.bytes, sizeof(buffer.bytes));
+    if (length < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+      return SAUCE_EFFAIL;
+    }
+    if (length == 0) return 0;
+
+    int64_t now = SAUCE_watch_now();
+    for (char* next = buffer.bytes; next < buffer.bytes + length;) {
+      const struct inotify_event* event = (const struct inotify_event*)next;
+      if (SAUCE_watch_handle(watcher, event, now) < 0) return SAUCE_EOTHER;
+      next += sizeof(struct inotify_event) + event->len;
+    }
+  }
+}
+
+
+/**
+ * @brief Report every pending path that is due. Changed files are read when they are reported, so a burst
+ *        of events for the same file costs a single read.
+ *
+ * @param watcher the watcher
+ * @param now the current monotonic time in nanoseconds
+ * @param callback function called for every path
+ * @param data passed to every call of `callback`
+ * @param reported incremented for every call of `callback`
+ * @return 0 if every due path was reported, or non-zero if `callback` stopped the reporting
+ */
+static int SAUCE_watch_report(SAUCE_Watcher* watcher, int64_t now, SAUCE_WatchCallback callback, void* data, int64_t* reported) {
+  char tail[SAUCE_MAX_TAIL_SIZE];
+  int flags = O_RDONLY | O_CLOEXEC | O_NONBLOCK;
+  if (!watcher->options.follow_links) flags |= O_NOFOLLOW;
+
+  int stopped = 0;
+  uint32_t kept = 0;
+  for (uint32_t i = 0; i < watcher->pendingCount; i++) {
+    SAUCEWatchPending pending = watcher->pending[i];
+    if (stopped || pending.due > now) {
+      watcher->pending[kept++] = pending;
+      continue;
+    }
+
+    SAUCE_ScanEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.path = pending.path;
+    enum SAUCE_WatchEvent event = pending.event;
+
+    if (event == SAUCE_WATCH_CHANGED) {
+      // the file may have been replaced or removed since its last event
+      struct stat st;
+      int found = watcher->options.follow_links ? stat(pending.path, &st) : lstat(pending.path, &st);
+      if (found < 0) {
+        event = SAUCE_WATCH_REMOVED;
+      } else if (!S_ISREG(st.st_mode)) {
+        SAUCE_free(pending.path);
+        continue;
+      } else {
+        SAUCE_scan_fill_entry(SAUCE_options()->cache, AT_FDCWD, pending.path, flags, tail, &entry);
+      }
+    }
+    if (event != SAUCE_WATCH_CHANGED) entry.result = SAUCE_EFOPEN;
+
+    (*reported)++;
+    stopped = callback(event, &entry, data) != 0;
+    SAUCE_free(pending.path);
+  }
+
+  watcher->pendingCount = kept;
+  SAUCE_watch_reindex(watcher);
+  return stopped;
+}
+#endif //WATCH_IS_DEFINED
+
+
+
+
+// Columnar batches
+
+// A column of a batch
+typedef struct SAUCEBatchColumn {
+  size_t offset;                // offset of the column's pointer in SAUCE_Batch
+  size_t width;                 // size of one entry of the column in bytes
+  int isString;                 // true if the column holds strings
+} SAUCEBatchColumn;
+
+// Get the size of a field of the SAUCE struct
+#define BATCH_FIELD_WIDTH(field)    sizeof(((SAUCE*)0)->field)
+
+// Number of columns in a batch
+#define BATCH_COLUMN_COUNT          16
+
+// Every column of a batch. The first columns are in the order of the SAUCE_Field constants.
+static const SAUCEBatchColumn batch_columns[BATCH_COLUMN_COUNT] = {
+  { offsetof(SAUCE_Batch, DataType), BATCH_FIELD_WIDTH(DataType), 0 },
+  { offsetof(SAUCE_Batch, FileType), BATCH_FIELD_WIDTH(FileType), 0 },
+  { offsetof(SAUCE_Batch, Comments), BATCH_FIELD_WIDTH(Comments), 0 },
+  { offsetof(SAUCE_Batch, TFlags), BATCH_FIELD_WIDTH(TFlags), 0 },
+  { offsetof(SAUCE_Batch, TInfo1), BATCH_FIELD_WIDTH(TInfo1), 0 },
+  { offsetof(SAUCE_Batch, TInfo2), BATCH_FIELD_WIDTH(TInfo2), 0 },
+  { offsetof(SAUCE_Batch, TInfo3), BATCH_FIELD_WIDTH(TInfo3), 0 },
+  { offsetof(SAUCE_Batch, TInfo4), BATCH_FIELD_WIDTH(TInfo4), 0 },
+  { offsetof(SAUCE_Batch, FileSize), BATCH_FIELD_WIDTH(FileSize), 0 },
+  { offsetof(SAUCE_Batch, Date), sizeof(uint32_t), 0 },
+  { offsetof(SAUCE_Batch, Title), BATCH_FIELD_WIDTH(Title), 1 },
+  { offsetof(SAUCE_Batch, Author), BATCH_FIELD_WIDTH(Author), 1 },
+  { offsetof(SAUCE_Batch, Group), BATCH_FIELD_WIDTH(Group), 1 },
+  { offsetof(SAUCE_Batch, TInfoS), BATCH_FIELD_WIDTH(TInfoS), 1 },
+  { offsetof(SAUCE_Batch, DateText), BATCH_FIELD_WIDTH(Date), 1 },
+  { offsetof(SAUCE_Batch, Version), BATCH_FIELD_WIDTH(Version), 1 }
+};
+
+// Number of columns that can be filtered, one for each SAUCE_Field constant
+#define BATCH_FIELD_COUNT           (SAUCE_FIELD_TINFOS + 1)
+
+
+/**
+ * @brief Get a pointer to the column pointer of a batch.
+ *
+ * @param batch the batch
+ * @param column the column
+ * @return a pointer to the column pointer
+ */
+static char** SAUCE_batch_column(const SAUCE_Batch* batch, const SAUCEBatchColumn* column) {
+  return (char**)((char*)batch + column->offset);
+}
+
+
+/**
+ * @brief Grow every column of a batch to hold at least `capacity` records. The new entries are zeroed.
+ *
+ * @param batch the batch
+ * @param capacity the number of records to make room for
+ * @return 0 on success, or -1 if memory ran out. The batch can still be used if memory ran out.
+ */
+static int SAUCE_batch_reserve(SAUCE_Batch* batch, uint64_t capacity) {
+  if (capacity <= batch->capacity) return 0;
+  if (capacity < batch->capacity * 2) capacity = batch->capacity * 2;
+  capacity = SAUCE_BITMAP_WORDS(capacity) * 64;
+
+  for (int i = 0; i < BATCH_COLUMN_COUNT; i++) {
+    char** column = SAUCE_batch_column(batch, &batch_columns[i]);
+    size_t width = batch_columns[i].width;
+    if (capacity > SIZE_MAX / width) return -1;
+
+    // columns that were grown before memory ran out are left larger than the capacity
+    char* grown = SAUCE_realloc(*column, (size_t)capacity * width);
+    if (grown == NULL) return -1;
+    memset(grown + (size_t)batch->capacity * width, 0, (size_t)(capacity - batch->capacity) * width);
+    *column = grown;
+  }
+
+  batch->capacity = capacity;
+  return 0;
+}
+
+
+/**
+ * @brief Convert the Date field of a record into the number CCYYMMDD.
+ *
+ * @param date the 8 characters of a Date field
+ * @return the date, or 0 if the field is not 8 digits
+ */
+static uint32_t SAUCE_batch_date(const char* date) {
+  uint32_t value = 0;
+  for (int i = 0; i < 8; i++) {
+    if (date[i] < '0' || date[i] > '9') return 0;
+    value = value * 10 + (uint32_t)(date[i] - '0');
+  }
+  return value;
+}
+
+
+/**
+ * @brief Count the bits that are set in a bitmap.
+ *
+ * @param bitmap the bitmap
+ * @param words number of words in the bitmap
+ * @return the number of bits set
+ */
+static int64_t SAUCE_batch_popcount(const uint64_t* bitmap, uint64_t words) {
+  int64_t count = 0;
+  for (uint64_t w = 0; w < words; w++) {
+    #ifdef USE_ATTRIBUTE
+    count += __builtin_popcountll(bitmap[w]);
+    #else
+    for (uint64_t bits = bitmap[w]; bits != 0; bits &= bits - 1) count++;
+    #endif
+  }
+  return count;
+}
+
+
+#ifndef SSE2_IS_DEFINED
+/**
+ * @brief Select every entry of a numeric column whose value minus `min` is at most `span`, using
+ *        unsigned arithmetic. This selects the values from `min` to `min + span`.
+ *
+ * @param column the column
+ * @param width size of one entry of the column in bytes: 1, 2 or 4
+ * @param words number of bitmap words to fill. The column must hold `words * 64` entries.
+ * @param min the smallest value to select
+ * @param span the largest value to select minus `min`
+ * @param bitmap the bitmap to fill
+ */
+static void SAUCE_batch_range_scalar(const char* column, size_t width, uint64_t words, uint32_t min, uint32_t span, uint64_t* bitmap) {
+  for (uint64_t w = 0; w < words; w++) {
+    uint64_t bits = 0;
+    for (uint32_t j = 0; j < 64; j++) {
+      uint64_t i = w * 64 + j;
+      uint32_t value;
+      if (width == 1) {
+        value = ((const uint8_t*)column)[i];
+      } else if (width == 2) {
+        value = ((const uint16_t*)column)[i];
+      } else {
+        value = ((const uint32_t*)column)[i];
+      }
+      bits |= (uint64_t)((uint32_t)(value - min) <= span) << j;
+    }
+    bitmap[w] = bits;
+  }
+}
+#endif //SSE2_IS_DEFINED
+
+
+#ifdef SSE2_IS_DEFINED
+/**
+ * @brief SSE2 version of `SAUCE_batch_range_scalar()`. `min` and `span` must fit in the width of
+ *        the column. Lanes are offset by the sign bit so that signed compares act as unsigned compares.
+ *
+ * @param column the column
+ * @param width size of one entry of the column in bytes: 1, 2 or 4
+ * @param words number of bitmap words to fill. The column must hold `words * 64` entries.
+ * @param min the smallest value to select
+ * @param span the largest value to select minus `min`
+ * @param bitmap the bitmap to fill
+ */
+static void SAUCE_batch_range_sse2(const char* column, size_t width, uint64_t words, uint32_t min, uint32_t span, uint64_t* bitmap) {
+  const __m128i* next = (const __m128i*)column;
+
+  if (width == 1) {
+    __m128i vmin = _mm_set1_epi8((char)min);
+    __m128i sign = _mm_set1_epi8((char)0x80);
+    __m128i vspan = _mm_xor_si128(_mm_set1_epi8((char)span), sign);
+    for (uint64_t w = 0; w < words; w++) {
+      uint64_t outside = 0;
+      for (int k = 0; k < 4; k++) {
+        __m128i value = _mm_xor_si128(_mm_sub_epi8(_mm_loadu_si128(next++), vmin), sign);
+        outside |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpgt_epi8(value, vspan)) << (k * 16);
+      }
+      bitmap[w] = ~outside;
+    }
+  } else if (width == 2) {
+    __m128i vmin = _mm_set1_epi16((short)min);
+    __m128i sign = _mm_set1_epi16((short)0x8000);
+    __m128i vspan = _mm_xor_si128(_mm_set1_epi16((short)span), sign);
+    for (uint64_t w = 0; w < words; w++) {
+      uint64_t outside = 0;
+      for (int k = 0; k < 4; k++) {
+        __m128i low = _mm_xor_si128(_mm_sub_epi16(_mm_loadu_si128(next++), vmin), sign);
+        __m128i high = _mm_xor_si128(_mm_sub_epi16(_mm_loadu_si128(next++), vmin), sign);
+        __m128i packed = _mm_packs_epi16(_mm_cmpgt_epi16(low, vspan), _mm_cmpgt_epi16(high, vspan));
+        outside |= (uint64_t)(uint16_t)_mm_movemask_epi8(packed) << (k * 16);
+      }
+      bitmap[w] = ~outside;
+    }
+  } else {
+    __m128i vmin = _mm_set1_epi32((int)min);
+    __m128i sign = _mm_set1_epi32((int)0x80000000U);
+    __m128i vspan = _mm_xor_si128(_mm_set1_epi32((int)span), sign);
+    for (uint64_t w = 0; w < words; w++) {
+      uint64_t outside = 0;
+      for (int k = 0; k < 16; k++) {
+        __m128i value = _mm_xor_si128(_mm_sub_epi32(_mm_loadu_si128(next++), vmin), sign);
+        outside |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(value, vspan))) << (k * 4);
+      }
+      bitmap[w] = ~outside;
+    }
+  }
+}
+
+
+/**
+ * @brief Select every entry of a string column that starts with a prefix of at most 16 characters.
+ *        Each entry is compared with a single 16 byte load, so entries must be at least 16 bytes wide.
+ *
+ * @param column the column
+ * @param width size of one entry of the column in bytes
+ * @param count number of entries in the column
+ * @param prefix the prefix, padded with zeros to 16 bytes
+ * @param length length of the prefix
+ * @param bitmap the bitmap to fill
+ */
+static void SAUCE_batch_prefix_sse2(const char* column, size_t width, uint64_t count, const char* prefix, size_t length, uint64_t* bitmap) {
+  __m128i vprefix = _mm_loadu_si128((const __m128i*)prefix);
+  int mask = (int)((1U << length) - 1);
+  for (uint64_t w = 0; w < SAUCE_BITMAP_WORDS(count); w++) {
+    uint64_t bits = 0;
+    uint64_t end = (count - w * 64 < 64) ? count - w * 64 : 64;
+    for (uint64_t j = 0; j < end; j++) {
+      __m128i value = _mm_loadu_si128((const __m128i*)(column + (w * 64 + j) * width));
+      int equal = _mm_movemask_epi8(_mm_cmpeq_epi8(value, vprefix));
+      bits |= (uint64_t)((equal & mask) == mask) << j;
+    }
+    bitmap[w] = bits;
+  }
+}
+#endif //SSE2_IS_DEFINED
+
+
+#ifdef AVX2_IS_DEFINED
+/**
+ * @brief AVX2 version of `SAUCE_batch_range_sse2()`. Only call it if the processor supports AVX2.
+ *
+ * @param column the column
+ * @param width size of one entry of the column in bytes: 1, 2 or 4
+ * @param words number of bitmap words to fill. The column must hold `words * 64` entries.
+ * @param min the smallest value to select
+ * @param span the largest value to select minus `min`
+ * @param bitmap the bitmap to fill
+ */
+__attribute__((target("avx2")))
+static void SAUCE_batch_range_avx2(const char* column, size_t width, uint64_t words, uint32_t min, uint32_t span, uint64_t* bitmap) {
+  const __m256i* next = (const __m256i*)column;
+
+  if (width == 1) {
+    __m256i vmin = _mm256_set1_epi8((char)min);
+    __m256i sign = _mm256_set1_epi8((char)0x80);
+    __m256i vspan = _mm256_xor_si256(_mm256_set1_epi8((char)span), sign);
+    for (uint64_t w = 0; w < words; w++) {
+      uint64_t outside = 0;
+      for (int k = 0; k < 2; k++) {
+        __m256i value = _mm256_xor_si256(_mm256_sub_epi8(_mm256_loadu_si256(next++), vmin), sign);
+        outside |= (uint64_t)(uint32_t)_mm256_movemask_epi8(_mm256_cmpgt_epi8(value, vspan)) << (k * 32);
+      }
+      bitmap[w] = ~outside;
+    }
+  } else if (width == 2) {
+    __m256i vmin = _mm256_set1_epi16((short)min);
+    __m256i sign = _mm256_set1_epi16((short)0x8000);
+    __m256i vspan = _mm256_xor_si256(_mm256_set1_epi16((short)span), sign);
+    for (uint64_t w = 0; w < words; w++) {
+      uint64_t outside = 0;
+      for (int k = 0; k < 2; k++) {
+        __m256i low = _mm256_xor_si256(_mm256_sub_epi16(_mm256_loadu_si256(next++), vmin), sign);
+        __m256i high = _mm256_xor_si256(_mm256_sub_epi16(_mm256_loadu_si256(next++), vmin), sign);
+
+        // packing works within each 128 bit lane, so the middle quarters are swapped back into order
+        __m256i packed = _mm256_packs_epi16(_mm256_cmpgt_epi16(low, vspan), _mm256_cmpgt_epi16(high, vspan));
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        outside |= (uint64_t)(uint32_t)_mm256_movemask_epi8(packed) << (k * 32);
+      }
+      bitmap[w] = ~outside;
+    }
+  } else {
+    __m256i vmin = _mm256_set1_epi32((int)min);
+    __m256i sign = _mm256_set1_epi32((int)0x80000000U);
+    __m256i vspan = _mm256_xor_si256(_mm256_set1_epi32((int)span), sign);
+    for (uint64_t w = 0; w < words; w++) {
+      uint64_t outside = 0;
+      for (int k = 0; k < 8; k++) {
+        __m256i value = _mm256_xor_si256(_mm256_sub_epi32(_mm256_loadu_si256(next++), vmin), sign);
+        outside |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(value, vspan))) << (k * 8);
+      }
+      bitmap[w] = ~outside;
+    }
+  }
+}
+#endif //AVX2_IS_DEFINED
+
+
+/**
+ * @brief Select the records of a batch whose numeric column is between `min` and `max`, with the fastest
+ *        kernel the processor supports. Every word of the bitmap is filled, and bits past the last record are cleared.
+ *
+ * @param batch the batch
+ * @param column a numeric column
+ * @param min the smallest value to select
+ * @param max the largest value to select
+ * @param bitmap the bitmap to fill
+ * @return the number of records selected
+ */
+static int64_t SAUCE_batch_select_range(const SAUCE_Batch* batch, const SAUCEBatchColumn* column, uint32_t min, uint32_t max, uint64_t* bitmap) {
+  uint64_t words = SAUCE_BITMAP_WORDS(batch->count);
+  uint32_t largest = (column->width == 4) ? UINT32_MAX : (1U << (column->width * 8)) - 1;
+  if (max > largest) max = largest;
+  if (min > max) {
+    memset(bitmap, 0, (size_t)words * sizeof(uint64_t));
+    return 0;
+  }
+
+  // columns hold a multiple of 64 records, so the kernels only fill whole words
+  const char* data = *SAUCE_batch_column(batch, column);
+  #if defined(AVX2_IS_DEFINED)
+  if (__builtin_cpu_supports("avx2")) {
+    SAUCE_batch_range_avx2(data, column->width, words, min, max - min, bitmap);
+  } else {
+    SAUCE_batch_range_sse2(data, column->width, words, min, max - min, bitmap);
+  }
+  #elif defined(SSE2_IS_DEFINED)
+  SAUCE_batch_range_sse2(data, column->width, words, min, max - min, bitmap);
+  #else
+  SAUCE_batch_range_scalar(data, column->width, words, min, max - min, bitmap);
+  #endif
+
+  if (batch->count % 64 != 0) bitmap[words - 1] &= (1ULL << (batch->count % 64)) - 1;
+  return SAUCE_batch_popcount(bitmap, words);
+}
+
+
+/**
+ * @brief Select the records of a batch whose string column starts with a prefix. Every word of the bitmap
+ *        is filled, and bits past the last record are cleared.
+ *
+ * @param batch the batch
+ * @param column a string column
+ * @param prefix the prefix
+ * @param bitmap the bitmap to fill
+ * @return the number of records selected
+ */
+static int64_t SAUCE_batch_select_prefix(const SAUCE_Batch* batch, const SAUCEBatchColumn* column, const char* prefix, uint64_t* bitmap) {
+  uint64_t words = SAUCE_BITMAP_WORDS(batch->count);
+  size_t length = strlen(prefix);
+  if (length > column->width) {
+    memset(bitmap, 0, (size_t)words * sizeof(uint64_t));
+    return 0;
+  }
+
+  const char* data = *SAUCE_batch_column(batch, column);
+  #ifdef SSE2_IS_DEFINED
+  // every string column that can be filtered is at least 16 characters wide
+  if (length <= 16) {
+    char padded[16] = { 0 };
+    memcpy(padded, prefix, length);
+    SAUCE_batch_prefix_sse2(data, column->width, batch->count, padded, length, bitmap);
+    return SAUCE_batch_popcount(bitmap, words);
+  }
+  #endif
+
+  for (uint64_t w = 0; w < words; w++) {
+    uint64_t bits = 0;
+    uint64_t end = (batch->count - w * 64 < 64) ? batch->count - w * 64 : 64;
+    for (uint64_t j = 0; j < end; j++) {
+      bits |= (uint64_t)(memcmp(data + (w * 64 + j) * column->width, prefix, length) == 0) << j;
+    }
+    bitmap[w] = bits;
+  }
+  return SAUCE_batch_popcount(bitmap, words);
+}
+
+
+
+
+
+// Streaming
+
+// A stream of content that is parsed as it is fed. Only the last SAUCE_MAX_TAIL_SIZE bytes are kept,
+// in a ring, since no SAUCE data can start before them. Older bytes are passed to the callback.
+struct SAUCE_Stream {
+  SAUCE_StreamCallback callback;  // receives the content, or NULL
+  void* data;                     // passed to callback
+  uint64_t total;                 // number of bytes fed
+  uint64_t emitted;               // number of bytes passed to callback
+  uint32_t head;                  // index of the oldest byte in the ring
+  uint32_t held;                  // number of bytes in the ring
+  int finished;                   // true once SAUCE_Stream_finish() was called
+  int stopped;                    // true if the callback stopped the stream
+  int result;                     // the result of decoding the SAUCE data, once finished
+  SAUCEInfo info;                 // info on the SAUCE data, once finished. `start` is relative to the ring.
+  char ring[SAUCE_MAX_TAIL_SIZE]; // the last bytes fed. Once finished, the ring starts at index 0.
+};
+
+
+/**
+ * @brief Pass content to the callback of a stream.
+ * 
+ * @param stream a stream
+ * @param content the content
+ * @param n the length of the content
+ * @return 0 on success, or SAUCE_EOTHER if the callback stopped the stream
+ */
+static int SAUCE_stream_emit(SAUCE_Stream* stream, const char* content, size_t n) {
+  if (n == 0) return 0;
+  stream->emitted += n;
+  if (stream->callback != NULL && stream->callback(content, n, stream->data) != 0) {
+    stream->stopped = 1;
+    SAUCE_SET_ERROR("The stream's callback stopped the stream");
+    return SAUCE_EOTHER;
+  }
+  return 0;
+}
+
+
+/**
+ * @brief Pass the oldest `n` bytes of the ring of a stream to its callback and drop them from the ring.
+ *        The ring may wrap around, in which case the callback is called twice.
+ * 
+ * @param stream a stream
+ * @param n the number of bytes, at most `stream->held`
+ * @return 0 on success, or SAUCE_EOTHER if the callback stopped the stream
+ */
+static int SAUCE_stream_emit_ring(SAUCE_Stream* stream, uint32_t n) {
+  uint32_t first = SAUCE_MAX_TAIL_SIZE - stream->head;
+  if (first > n) first = n;
+
+  int res = SAUCE_stream_emit(stream, &stream->ring[stream->head], first);
+  if (res == 0) res = SAUCE_stream_emit(stream, stream->ring, n - first);
+
+  stream->head = (stream->head + n) % SAUCE_MAX_TAIL_SIZE;
+  stream->held -= n;
+  return res;
+}
+
+
+/**
+ * @brief Copy bytes to the end of the ring of a stream. The ring must have room for them.
+ * 
+ * @param stream a stream
+ * @param data the bytes
+ * @param n the number of bytes
+ */
+static void SAUCE_stream_push(SAUCE_Stream* stream, const char* data, uint32_t n) {
+  uint32_t tail = (stream->head + stream->held) % SAUCE_MAX_TAIL_SIZE;
+  uint32_t first = SAUCE_MAX_TAIL_SIZE - tail;
+  if (first > n) first = n;
+
+  memcpy(&stream->ring[tail], data, first);
+  memcpy(stream->ring, data + first, n - first);
+  stream->held += n;
+}
+
+
+
+// Content written to a SAUCE_Writer is passed straight through to its output, and the SAUCE data
+// is appended when it is finished, so files can be stamped without being read back
+struct SAUCE_Writer {
+  SAUCE_StreamCallback callback;  // receives the output, or NULL to write to `fd`
+  void* data;                     // passed to callback
+  int fd;                         // file descriptor written to if there is no callback
+  uint64_t written;               // number of content bytes written
+  int finished;                   // true once SAUCE_Writer_finish() was called
+  int failed;                     // true if the output failed or the callback stopped the writer
+};
+
+
+/**
+ * @brief Pass bytes to the output of a writer.
+ * 
+ * @param writer a writer
+ * @param buffer the bytes
+ * @param n the number of bytes
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_writer_output(SAUCE_Writer* writer, const char* buffer, size_t n) {
+  if (n == 0) return 0;
+  if (writer->callback != NULL) {
+    if (writer->callback(buffer, n, writer->data) == 0) return 0;
+    writer->failed = 1;
+    SAUCE_SET_ERROR("The writer's callback stopped the writer");
+    return SAUCE_EOTHER;
+  }
+
+  #ifdef FD_IO_IS_DEFINED
+  if (SAUCE_fd_write_all(writer->fd, buffer, n) == 0) return 0;
+  #endif
+  writer->failed = 1;
+  SAUCE_SET_ERROR("Failed to write to file descriptor %d", writer->fd);
+  return SAUCE_EFFAIL;
+}
+
+
+
+
+
+// Helper Functions
+
+/**
+ * @brief Get an error message about the last SAUCE error that occurred on the calling thread.
+ *        Every thread has its own error, so errors on other threads do not change it.
+ * 
+ * @return an error message, or an empty string if no SAUCE error has occurred yet. The message
+ *         is valid until the next SAUCE error on the calling thread.
+ */
+const char* SAUCE_get_error(void) {
+  SAUCEErrorState* state = SAUCE_error_state();
+  if (state->format == NULL) return "";
+  if (!state->formatted) SAUCE_error_format(state);
+  return state->message;
+}
+
+
+/**
+ * @brief Fill a SAUCE struct with the default fields. ID and Version fields will be set
+          to their required values. All other fields will be set to their defaults, which
+          is typically 0 or spaces.
+ * 
+ * @param sauce a SAUCE struct to be set
+ */
+void SAUCE_set_default(SAUCE* sauce) {
+  memset(sauce, 0, sizeof(SAUCE)); // zero everything out
+
+  memcpy(sauce->ID, SAUCE_RECORD_ID, 5);
+  memcpy(sauce->Version, "00", 2);
+
+  // set the character fields to spaces
+  memset(sauce->Title, ' ', sizeof(sauce->Title));
+  memset(sauce->Author, ' ', sizeof(sauce->Author));
+  memset(sauce->Group, ' ', sizeof(sauce->Group));
+  memset(sauce->Date, ' ', sizeof(sauce->Date));
+}
+
+
+/**
+ * @brief Determine how many comment lines a string will need in order to
+ *        place it in a CommentBlock.
+ * 
+ * @param string a null-terminated string
+ * @return how many lines the string will need
+ */
+uint8_t SAUCE_num_lines(const char* string) {
+  int lines = 0;
+  int length = strlen(string);
+
+  if (length == 0) return 0; //handle empty string
+  if (length >= UINT8_MAX * SAUCE_COMMENT_LINE_LENGTH) return UINT8_MAX; // handle largest possible string
+
+  while (length > 0) {
+    lines++;
+    length -= SAUCE_COMMENT_LINE_LENGTH;
+  }
+
+  return lines;
+}
+
+
+/**
+ * @brief Set how the file and file descriptor functions access files. By default, the end of a file
+ *        is read and written with positioned reads and writes (`SAUCE_FM_DEFAULT`).
+ * 
+ * @param mode a SAUCE_FileMode constant
+ * @return 0 on success. On error, a negative error code is returned, and the mode is not changed.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_set_file_mode(enum SAUCE_FileMode mode) {
+  switch (mode) {
+    case SAUCE_FM_DEFAULT:
+      SAUCE_options()->fileMode = mode;
+      return 0;
+    case SAUCE_FM_MMAP:
+      #ifdef MMAP_IS_DEFINED
+      SAUCE_options()->fileMode = mode;
+      return 0;
+      #else
+      SAUCE_SET_ERROR("Memory-mapped file mode is not supported on this system");
+      return SAUCE_EOTHER;
+      #endif
+    default:
+      SAUCE_SET_ERROR("%d is not a valid file mode", (int)mode);
+      return SAUCE_EOTHER;
+  }
+}
+
+
+/**
+ * @brief Get how the file and file descriptor functions access files.
+ * 
+ * @return the current SAUCE_FileMode
+ */
+enum SAUCE_FileMode SAUCE_get_file_mode(void) {
+  return SAUCE_options()->fileMode;
+}
+
+
+/**
+ * @brief Set how the file and file descriptor write and remove functions sync the files they change.
+ *        By default, nothing is synced (`SAUCE_DURABLE_NONE`).
+ * 
+ * @param durability a SAUCE_Durability constant
+ * @return 0 on success. On error, a negative error code is returned, and the durability is not changed.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_set_durability(enum SAUCE_Durability durability) {
+  switch (durability) {
+    case SAUCE_DURABLE_NONE:
+      SAUCE_options()->durability = durability;
+      return 0;
+    case SAUCE_DURABLE_FILE:
+    case SAUCE_DURABLE_GROUP:
+      #ifdef FD_IO_IS_DEFINED
+      SAUCE_options()->durability = durability;
+      return 0;
+      #else
+      SAUCE_SET_ERROR("Syncing files is not supported on this system");
+      return SAUCE_EOTHER;
+      #endif
+    default:
+      SAUCE_SET_ERROR("%d is not a valid durability", (int)durability);
+      return SAUCE_EOTHER;
+  }
+}
+
+
+/**
+ * @brief Get how the file and file descriptor write and remove functions sync files.
+ * 
+ * @return the current SAUCE_Durability
+ */
+enum SAUCE_Durability SAUCE_get_durability(void) {
+  return SAUCE_options()->durability;
+}
+
+
+/**
+ * @brief Set the cache used by the file and file descriptor read and check functions, by the batch
+ *        read functions and by `SAUCE_scan_tree()`. Not thread-safe.
+ * 
+ * @param cache a cache opened with `SAUCE_Cache_open()`, or NULL to stop using a cache
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_set_cache(SAUCE_Cache* cache) {
+  #ifdef CACHE_IS_DEFINED
+  SAUCE_options()->cache = cache;
+  return 0;
+  #else
+  if (cache == NULL) return 0;
+  SAUCE_SET_ERROR("Caching is not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
+}
+
+
+/**
+ * @brief Get the cache used by the file functions.
+ * 
+ * @return the current cache, or NULL if no cache is used
+ */
+SAUCE_Cache* SAUCE_get_cache(void) {
+  return SAUCE_options()->cache;
+}
+
+
+/**
+ * @brief Set the functions every allocation of the library goes through. Not thread-safe.
+ * 
+ * @param mallocFn allocation function, or NULL to use `malloc()`
+ * @param freeFn function that frees allocations made by `mallocFn`, or NULL to use `free()`
+ * @param user passed to `mallocFn` and `freeFn`
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_set_allocator(SAUCE_MallocFunction mallocFn, SAUCE_FreeFunction freeFn, void* user) {
+  if ((mallocFn == NULL) != (freeFn == NULL)) {
+    SAUCE_SET_ERROR("Allocation and free functions must both be given or both be NULL");
+    return SAUCE_ENULL;
+  }
+
+  allocator.malloc = (mallocFn != NULL) ? mallocFn : SAUCE_default_malloc;
+  allocator.free = (freeFn != NULL) ? freeFn : SAUCE_default_free;
+  allocator.user = (mallocFn != NULL) ? user : NULL;
+  return 0;
+}
+
+
+/**
+ * @brief Get the allocations made by the library on the calling thread since its stats were last reset.
+ * 
+ * @param stats will be set to the calling thread's stats
+ */
+void SAUCE_get_alloc_stats(SAUCE_AllocStats* stats) {
+  if (stats != NULL) *stats = alloc_stats;
+}
+
+
+/**
+ * @brief Set the calling thread's allocation stats to zero.
+ * 
+ */
+void SAUCE_reset_alloc_stats(void) {
+  memset(&alloc_stats, 0, sizeof(alloc_stats));
+}
+
+
+
+
+
+// Read Functions
+
+/**
+ * @brief From a file, read a SAUCE record into `sauce`.
+ * 
+ * @param filepath a path to a file 
+ * @param sauce a SAUCE struct that will be filled with the parsed SAUCE record
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_fread(const char* filepath, SAUCE* sauce) {
+  // null checks
+  if (filepath == NULL) {
+    SAUCE_SET_ERROR("Filepath was NULL");
+    return SAUCE_ENULL;
+  }
+  if (sauce == NULL) {
+    SAUCE_SET_ERROR("SAUCE struct was NULL");
+    return SAUCE_ENULL;
+  }
+
+  #ifdef CACHE_IS_DEFINED
+  SAUCECacheEntry entry;
+  SAUCE_Cache* cache = SAUCE_options()->cache;
+  if (cache != NULL && SAUCE_cache_lookup_path(cache, filepath, &entry)) {
+    return SAUCE_set_record_error(filepath, SAUCE_cache_entry_record(&entry, sauce));
+  }
+  #endif
+
+  #ifdef FD_IO_IS_DEFINED
+  int fd = SAUCE_fd_open(filepath, FD_OPEN_READ);
+  if (fd < 0) return SAUCE_set_tail_error(filepath, SAUCE_EFOPEN);
+  return SAUCE_fd_close_file(fd, filepath, SAUCE_fd_read_record(fd, filepath, sauce));
+  #else
+  // read the end of the file
+  char tail[SAUCE_MAX_TAIL_SIZE];
+  uint32_t length = 0;
+  int64_t filesize = 0;
+  int res = SAUCE_file_read_tail(filepath, tail, &filesize, &length);
+  if (res < 0) return SAUCE_set_tail_error(filepath, res);
+
+  return SAUCE_tail_read_record(filepath, tail, length, filesize, sauce);
+  #endif
+}
+
+
+/**
+ * @brief From a file, read at most `nLines` of a SAUCE CommentBlock into `comment`.
+ *        A null character will be appended onto `comment` as well.
+ * 
+ * 
+ *        If the file does not contain a comment or the actual number of lines is less
+ *        than `nLines`, then expect 0 lines or all lines to be read, respectively.
+ * 
+ * @param filepath a path to a file 
+ * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1` that will contain the comment
+ * @param nLines the number of lines to read
+ * @return On success, the number of lines read. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Comment_fread(const char* filepath, char* comment, uint8_t nLines) {
+  if (filepath == NULL) {
+    SAUCE_SET_ERROR("Filepath was NULL");
+    return SAUCE_ENULL;
+  }
+  if (comment == NULL) {
+    SAUCE_SET_ERROR("Comment string argument was NULL");
+    return SAUCE_ENULL;
+  }
+
+  if (nLines == 0) return 0;
+
+  #ifdef CACHE_IS_DEFINED
+  // files without a comment are answered without opening them
+  SAUCECacheEntry entry;
+  SAUCE_Cache* cache = SAUCE_options()->cache;
+  if (cache != NULL && SAUCE_cache_lookup_path(cache, filepath, &entry) && !entry.comment_exists) {
+    SAUCEInfo info;
+    SAUCE_cache_entry_info(&entry, &info);
+    if (SAUCE_set_info_error(filepath, entry.result, &info) < 0) return entry.result;
+    comment[0] = 0;
+    return 0;
+  }
+  #endif
+
+  #ifdef FD_IO_IS_DEFINED
+  int fd = SAUCE_fd_open(filepath, FD_OPEN_READ);
+  if (fd < 0) return SAUCE_set_tail_error(filepath, SAUCE_EFOPEN);
+  return SAUCE_fd_close_file(fd, filepath, SAUCE_fd_read_comment(fd, filepath, comment, nLines));
+  #else
+  SAUCEInfo info;
+  char buffer[SAUCE_MAX_TAIL_SIZE];
+  char* data = NULL;
+  int res = SAUCE_file_get_info(filepath, &info, NULL, buffer, &data);
+  if (res < 0) return res;
+
+  return SAUCE_data_read_comment(&info, data, comment, nLines);
+  #endif
+}
+
+
+/**
+ * @brief From a file descriptor, read a SAUCE record into `sauce`. The end of the file is read with
+ *        a single positioned read, so the file offset of `fd` is not changed on POSIX systems.
+ * 
+ * @param fd a file descriptor open for reading
+ * @param sauce a SAUCE struct that will be filled with the parsed SAUCE record
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_fd_read(int fd, SAUCE* sauce) {
+  if (fd < 0) {
+    SAUCE_SET_ERROR("File descriptor %d is invalid", fd);
+    return SAUCE_EFOPEN;
+  }
+  if (sauce == NULL) {
+    SAUCE_SET_ERROR("SAUCE struct was NULL");
+    return SAUCE_ENULL;
+  }
+
+  #ifdef FD_IO_IS_DEFINED
+  char name[FD_NAME_SIZE];
+  SAUCE_fd_name(fd, name);
+  return SAUCE_fd_read_record(fd, name, sauce);
+  #else
+  SAUCE_SET_ERROR("File descriptor functions are not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
+}
+
+
+/**
+ * @brief From a file descriptor, read at most `nLines` of a SAUCE CommentBlock into `comment`.
+ *        A null character will be appended onto `comment` as well. The end of the file is read with
+ *        a single positioned read, so the file offset of `fd` is not changed on POSIX systems.
+ * 
+ * 
+ *        If the file does not contain a comment or the actual number of lines is less
+ *        than `nLines`, then expect 0 lines or all lines to be read, respectively.
+ * 
+ * @param fd a file descriptor open for reading
+ * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1` that will contain the comment
+ * @param nLines the number of lines to read
+ * @return On success, the number of lines read. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Comment_fd_read(int fd, char* comment, uint8_t nLines) {
+  if (fd < 0) {
+    SAUCE_SET_ERROR("File descriptor %d is invalid", fd);
+    return SAUCE_EFOPEN;
+  }
+  if (comment == NULL) {
+    SAUCE_SET_ERROR("Comment string argument was NULL");
+    return SAUCE_ENULL;
+  }
+
+  if (nLines == 0) return 0;
+
+  #ifdef FD_IO_IS_DEFINED
+  char name[FD_NAME_SIZE];
+  SAUCE_fd_name(fd, name);
+  return SAUCE_fd_read_comment(fd, name, comment, nLines);
+  #else
+  SAUCE_SET_ERROR("File descriptor functions are not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
+}
+
+
+/**
+ * @brief Read every file of a batch. Records are read through io_uring when possible, and the files
+ *        that are left are read by the calling thread and the pool threads.
+ * 
+ * @param batch the batch
+ * @param options options for the batch, or NULL
+ * @return the number of files whose result is not an error
+ */
+static int SAUCE_batch_run(SAUCEBatch* batch, const SAUCE_BatchOptions* options) {
+  uint32_t threads = (options != NULL) ? options->threads : 0;
+  batch->next = 0;
+
+  #ifdef URING_IS_DEFINED
+  // with a cache, most files are answered by a stat, so there is little for the ring to do
+  if (batch->records != NULL && batch->cache == NULL && (options == NULL || !options->disable_uring)) {
+    SAUCE_batch_read_uring(batch);
+  }
+  #endif
+
+  #ifdef THREADS_IS_DEFINED
+  if (batch->next < batch->count) SAUCE_batch_read_pool(batch, threads);
+  #else
+  (void)threads;
+  char scratch[SAUCE_MAX_TAIL_SIZE];
+  SAUCE_batch_read(batch, scratch);
+  #endif
+
+  uint32_t read = 0;
+  for (uint32_t i = 0; i < batch->count; i++) {
+    if (batch->results[i] >= 0) read++;
+  }
+  return (int)read;
+}
+
+
+/**
+ * @brief Read the SAUCE records of many files at once. `records[i]` will be filled with the record of
+ *        `filepaths[i]`, and `results[i]` will be set to the result of reading `filepaths[i]`, which is
+ *        the same value `SAUCE_fread()` would return for that file. No per-file error messages are set,
+ *        so batches can be read from several threads at once.
+ * 
+ *        On Linux, the files are opened, stat-ed, read and closed in large batches through io_uring.
+ *        If io_uring is not available at runtime, the files are read by a pool of threads using
+ *        positioned reads. The pool is started by the first batch that needs it and is shared by
+ *        every batch. Otherwise, the files are read one at a time.
+ * 
+ * @param filepaths an array of `count` paths
+ * @param count the number of files
+ * @param records an array of `count` SAUCE structs
+ * @param results an array of `count` result codes
+ * @param options options for the batch. If NULL, every option will be 0.
+ * @return On success, the number of records that were read. On error, a negative error code is returned.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_fread_many(const char* const* filepaths, uint32_t count, SAUCE* records, int* results, const SAUCE_BatchOptions* options) {
+  if (filepaths == NULL) {
+    SAUCE_SET_ERROR("Filepaths array was NULL");
+    return SAUCE_ENULL;
+  }
+  if (records == NULL) {
+    SAUCE_SET_ERROR("SAUCE records array was NULL");
+    return SAUCE_ENULL;
+  }
+  if (results == NULL) {
+    SAUCE_SET_ERROR("Results array was NULL");
+    return SAUCE_ENULL;
+  }
+  if (count > INT32_MAX) {
+    SAUCE_SET_ERROR("Cannot read more than %d files at once", INT32_MAX);
+    return SAUCE_EOTHER;
+  }
+
+  SAUCEBatch batch;
+  memset(&batch, 0, sizeof(batch));
+  batch.paths = filepaths;
+  batch.count = count;
+  batch.records = records;
+  batch.results = results;
+  batch.cache = SAUCE_options()->cache;
+  return SAUCE_batch_run(&batch, options);
+}
+
+
+/**
+ * @brief Read at most `nLines` of the SAUCE CommentBlocks of many files at once. The comment of
+ *        `filepaths[i]` will be copied to `&comments[i * (SAUCE_COMMENT_STRING_LENGTH(nLines) + 1)]`
+ *        followed by a null character, and `results[i]` will be set to the result of reading
+ *        `filepaths[i]`, which is the same value `SAUCE_Comment_fread()` would return for that file.
+ *        No per-file error messages are set, so batches can be read from several threads at once.
+ * 
+ *        The files are read by a pool of threads using positioned reads. The pool is started by the
+ *        first batch that needs it and is shared by every batch. Otherwise, the files are read one at a time.
+ * 
+ * @param filepaths an array of `count` paths
+ * @param count the number of files
+ * @param comments a buffer of at least size `count * (SAUCE_COMMENT_STRING_LENGTH(nLines) + 1)`
+ * @param nLines the number of lines to read from each file
+ * @param results an array of `count` result codes
+ * @param options options for the batch. If NULL, every option will be 0.
+ * @return On success, the number of files whose comment was read, including files with a record but
+ *         no comment. On error, a negative error code is returned. Use `SAUCE_get_error()` to get more
+ *         info on the error.
+ */
+int SAUCE_Comment_fread_many(const char* const* filepaths, uint32_t count, char* comments, uint8_t nLines, int* results,
+                             const SAUCE_BatchOptions* options) {
+  if (filepaths == NULL) {
+    SAUCE_SET_ERROR("Filepaths array was NULL");
+    return SAUCE_ENULL;
+  }
+  if (comments == NULL) {
+    SAUCE_SET_ERROR("Comments buffer was NULL");
+    return SAUCE_ENULL;
+  }
+  if (results == NULL) {
+    SAUCE_SET_ERROR("Results array was NULL");
+    return SAUCE_ENULL;
+  }
+  if (count > INT32_MAX) {
+    SAUCE_SET_ERROR("Cannot read more than %d files at once", INT32_MAX);
+    return SAUCE_EOTHER;
+  }
+
+  SAUCEBatch batch;
+  memset(&batch, 0, sizeof(batch));
+  batch.paths = filepaths;
+  batch.count = count;
+  batch.comments = comments;
+  batch.nLines = nLines;
+  batch.results = results;
+  batch.cache = SAUCE_options()->cache;
+  return SAUCE_batch_run(&batch, options);
+}
+
+
+/**
+ * @brief Scan a directory tree and report every regular file in it to `callback`, along with the SAUCE data
+ *        found in the file. Only the tail of each file is read. Subdirectories are scanned, but symbolic links
+ *        to directories are never followed.
+ * 
+ *        The tree is walked by a pool of threads. Each thread owns a queue of directories and groups of files,
+ *        and threads that run out of work steal from the others, so large directories are shared between
+ *        threads. The calling thread works as well. `callback` is called from every thread, possibly at the
+ *        same time, so it must be thread-safe unless `options->threads` is 1. Return non-zero from `callback`
+ *        to stop the scan.
+ * 
+ * @param root path to the root directory
+ * @param callback function called for every file, with data that is only valid during the call
+ * @param data passed to every call of `callback`
+ * @param options options for the scan. If NULL, every option will be 0.
+ * @return On success, the number of files passed to `callback`. On error, a negative error code is returned.
+ *         Use `SAUCE_get_error()` to get more info on the error. Directories that cannot be read are skipped,
+ *         and an error message is set without failing the scan.
+ */
+int64_t SAUCE_scan_tree(const char* root, SAUCE_ScanCallback callback, void* data, const SAUCE_ScanOptions* options) {
+  if (root == NULL) {
+    SAUCE_SET_ERROR("Root directory path was NULL");
+    return SAUCE_ENULL;
+  }
+  if (callback == NULL) {
+    SAUCE_SET_ERROR("Scan callback was NULL");
+    return SAUCE_ENULL;
+  }
+
+  #ifdef SCAN_IS_DEFINED
+  int fd = open(root, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    SAUCE_SET_ERROR("Failed to open directory %s", root);
+    return SAUCE_EFOPEN;
+  }
+  SAUCE_fd_close(fd);
+
+  SAUCEScan scan;
+  memset(&scan, 0, sizeof(scan));
+  scan.callback = callback;
+  scan.data = data;
+  if (options != NULL) scan.options = *options;
+  scan.cache = SAUCE_options()->cache;
+
+  if (SAUCE_scan_run(&scan, root) < 0) {
+    SAUCE_SET_ERROR("Ran out of memory while scanning %s", root);
+    return SAUCE_EOTHER;
+  }
+  if (scan.skipped > 0) {
+    SAUCE_SET_ERROR("%llu directories in %s could not be read", (unsigned long long)scan.skipped, root);
+  }
+
+  return (int64_t)scan.files;
+  #else
+  (void)data;
+  (void)options;
+  SAUCE_SET_ERROR("Scanning directory trees is not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
+}
+
+
+/**
+ * @brief From the first `n` bytes of a buffer, read a SAUCE record into `sauce`.
+ * 
+ * @param buffer pointer to a buffer
+ * @param n the length of the buffer
+ * @param sauce a SAUCE struct that will be filled with the parsed SAUCE record
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_read(const char* buffer, uint32_t n, SAUCE* sauce) {
+  return SAUCE_read64(buffer, n, sauce);
+}
+
+
+/**
+ * @brief From the first `n` bytes of a buffer, read a SAUCE record into `sauce`. Same as `SAUCE_read()`,
+ *        but for buffers that may be larger than 4GB.
+ * 
+ * @param buffer pointer to a buffer
+ * @param n the length of the buffer
+ * @param sauce a SAUCE struct that will be filled with the parsed SAUCE record
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_read64(const char* buffer, size_t n, SAUCE* sauce) {
+  // null checks
+  if (buffer == NULL) {
+    SAUCE_SET_ERROR("Buffer was NULL");
+    return SAUCE_ENULL;
+  }
+  if (sauce == NULL) {
+    SAUCE_SET_ERROR("SAUCE struct was NULL");
+    return SAUCE_ENULL;
+  }
+
+  if (n == 0) {
+    SAUCE_SET_ERROR("The buffer has a length of 0 and cannot contain a record");
+    return SAUCE_EEMPTY;
+  }
+
+  if (n < SAUCE_RECORD_SIZE) {
+    SAUCE_SET_ERROR("The buffer length of %llu is too short to contain a record", (unsigned long long)n);
+    return SAUCE_ESHORT;
+  }
+
+
+  // find the SAUCE id
+  if (memcmp(&buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_ID, 5) != 0) {
+    SAUCE_SET_ERROR("Could not find the SAUCE id in the buffer");
+    return SAUCE_ERMISS;
+  }
+
+  // copy the record
+  memcpy(sauce, &buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
+
+  return 0;
+}
+
+
+/**
+ * @brief From the first `n` bytes of a buffer, read at most `nLines` of a SAUCE CommentBlock into `comment`.
+ *        A null character will be appended onto `comment` as well.
+ * 
+ * 
+ *        If the buffer does not contain a comment or the actual number of lines is less than nLines, 
+ *        then expect 0 lines or all lines to be read, respectively.
+ * 
+ * @param buffer pointer to a buffer
+ * @param n the length of the buffer
+ * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1` that will contain the comment
+ * @param nLines the number of lines to read
+ * @return On success, the number of lines read. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Comment_read(const char* buffer, uint32_t n, char* comment, uint8_t nLines) {
+  return SAUCE_Comment_read64(buffer, n, comment, nLines);
+}
+
+
+/**
+ * @brief From the first `n` bytes of a buffer, read at most `nLines` of a SAUCE CommentBlock into `comment`.
+ *        Same as `SAUCE_Comment_read()`, but for buffers that may be larger than 4GB.
+ * 
+ * @param buffer pointer to a buffer
+ * @param n the length of the buffer
+ * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1` that will contain the comment
+ * @param nLines the number of lines to read
+ * @return On success, the number of lines read. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Comment_read64(const char* buffer, size_t n, char* comment, uint8_t nLines) {
+  if (buffer == NULL) {
+    SAUCE_SET_ERROR("Buffer was null");
+    return SAUCE_ENULL;
+  }
+  if (comment == NULL) {
+    SAUCE_SET_ERROR("Comment string argment was null");
+    return SAUCE_ENULL;
+  }
+  if (n == 0) {
+    SAUCE_SET_ERROR("Buffer's length is 0, so nothing can be read");
+    return SAUCE_EEMPTY;
+  }
+  if (n < SAUCE_RECORD_SIZE) {
+    SAUCE_SET_ERROR("Buffer's length is too short to contain a record");
+    return SAUCE_ESHORT;
+  }
+
+  // find the SAUCE id
+  if (memcmp(&buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_ID, 5) != 0) {
+    SAUCE_SET_ERROR("Could not find the SAUCE id in the buffer");
+    return SAUCE_ERMISS;
+  }
+
+  // get total lines from record
+  uint8_t totalLines = ((SAUCE*)(&buffer[n - SAUCE_RECORD_SIZE]))->Comments;
+  if (totalLines > 0 && n < SAUCE_TOTAL_SIZE(totalLines)) {
+    SAUCE_SET_ERROR("Record claims that buffer contains %u comment lines, but the buffer is too short to contain that many lines", totalLines);
+    return SAUCE_ESHORT;
+  }
+
+  // determine num of lines to read
+  nLines = (totalLines > nLines) ? nLines : totalLines;
+
+  // check if no lines need to or can be read
+  if (nLines == 0) {
+    comment[0] = 0; // add null character
+    return 0;
+  }
+
+  // check for COMNT id
+  if (memcmp(&buffer[n-SAUCE_TOTAL_SIZE(totalLines)], SAUCE_COMMENT_ID, 5) != 0) {
+    SAUCE_SET_ERROR("Record in buffer indicated that %u total comment lines could be read, but the comment id could not be found", totalLines);
+    return SAUCE_ECMISS;
+  }
+
+  // retrieve the comment
+  memcpy(comment, &buffer[n-SAUCE_TOTAL_SIZE(totalLines)+5], SAUCE_COMMENT_STRING_LENGTH(nLines));
+  comment[SAUCE_COMMENT_STRING_LENGTH(nLines)] = 0;
+  return nLines;
+}
+
+
+/**
+ * @brief Find the record and comment at the end of the first `n` bytes of a buffer without copying them.
+ *        `view` is pointed at the SAUCE data inside of the buffer. Nothing is copied or allocated.
+ * 
+ *        If a record is found but its comment is invalid, `view->record` is still set and an error is returned.
+ * 
+ * @param buffer pointer to a buffer
+ * @param n the length of the buffer
+ * @param view will be set to the SAUCE data in the buffer
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_view(const char* buffer, size_t n, SAUCE_View* view) {
+  if (view == NULL) {
+    SAUCE_SET_ERROR("SAUCE_View struct was NULL");
+    return SAUCE_ENULL;
+  }
+  memset(view, 0, sizeof(SAUCE_View));
+
+  SAUCEInfo info;
+  int res = SAUCE_buffer_get_info(buffer, n, &info);
+  if (!info.record_exists) return res;
+
+  // the record always ends the SAUCE data, and the comment lines follow the COMNT id
+  const char* data = &buffer[info.start];
+  view->record = (const SAUCE*)(data + info.sauce_length - SAUCE_RECORD_SIZE);
+  if (info.comment_exists) {
+    view->comment = data + 5;
+    view->lines = info.lines;
+  }
+  return res;
+}
+
+
+/**
+ * @brief Start iterating over the comment lines of a view. An iterator over a view without a comment
+ *        returns no lines.
+ * 
+ * @param view a view set by `SAUCE_view()`
+ * @param iter the iterator to initialize
+ */
+void SAUCE_Comment_iter_init(const SAUCE_View* view, SAUCE_CommentIter* iter) {
+  if (iter == NULL) return;
+  iter->next = (view != NULL) ? view->comment : NULL;
+  iter->remaining = (iter->next != NULL) ? view->lines : 0;
+}
+
+
+/**
+ * @brief Get the next comment line of a view. `*line` is pointed at the line inside of the buffer,
+ *        and `*length` is set to its length without any trailing spaces or null characters.
+ *        The line is not null-terminated.
+ * 
+ * @param iter an iterator started with `SAUCE_Comment_iter_init()`
+ * @param line will point to the next line
+ * @param length will be set to the length of the line, at most `SAUCE_COMMENT_LINE_LENGTH`
+ * @return 1 if a line was returned, or 0 if there are no more lines. On error, a negative error code is
+ *         returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_Comment_iter_next(SAUCE_CommentIter* iter, const char** line, uint8_t* length) {
+  if (iter == NULL) {
+    SAUCE_SET_ERROR("SAUCE_CommentIter struct was NULL");
+    return SAUCE_ENULL;
+  }
+  if (line == NULL || length == NULL) {
+    SAUCE_SET_ERROR("Line or length pointer was NULL");
+    return SAUCE_ENULL;
+  }
+  if (iter->remaining == 0) return 0;
+
+  // lines are padded to their full length with spaces, or sometimes null characters
+  const char* current = iter->next;
+  uint8_t len = SAUCE_COMMENT_LINE_LENGTH;
+  while (len > 0 && (current[len - 1] == ' ' || current[len - 1] == 0)) len--;
+
+  *line = current;
+  *length = len;
+  iter->next = current + SAUCE_COMMENT_LINE_LENGTH;
+  iter->remaining--;
+  return 1;
+}
+
+
+
+
+
+// Write Functions
+
+/**
+ * @brief Write a SAUCE record to a file. If the file already contains a SAUCE record, the record will be replaced.
+ *        An EOF character will be added if the file previously did not contain a SAUCE record.
+ * 
+ * @param filepath a path to a file
+ * @param sauce a SAUCE struct
+ * @return 0 on success, or `SAUCE_UNCHANGED` if the file already contained the record and nothing was written.
+ *         On error, a negative error code is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_fwrite(const char* filepath, const SAUCE* sauce) {
+  // null checks
+  if (filepath == NULL) {
+    SAUCE_SET_ERROR("Filepath was NULL");
+    return SAUCE_ENULL;
+  }
+  if (sauce == NULL) {
+    SAUCE_SET_ERROR("SAUCE struct was NULL");
+    return SAUCE_ENULL;
+  }
+
+  #ifdef FD_IO_IS_DEFINED
+  int fd = SAUCE_fd_open(filepath, FD_OPEN_CREATE);
+  if (fd < 0) {
+    SAUCE_SET_ERROR("Failed to open %s for reading & writing", filepath);
+    return SAUCE_EFOPEN;
+  }
+  return SAUCE_fd_close_file(fd, filepath, SAUCE_fd_write_record(fd, filepath, sauce));
+  #else
+  SAUCEInfo info;
+  char buffer[SAUCE_MAX_TAIL_SIZE];
+  char* data = NULL;
+  int res = SAUCE_file_get_info(filepath, &info, NULL, buffer, &data);
+  if (res < 0 && info.record_exists) return res;
+
+  uint32_t bufLen = SAUCE_TOTAL_SIZE(info.lines);
+
+  // the new SAUCE data is built in place of the old data in `buffer`
+  char* writeBuffer;
+  if (info.record_exists) {
+    // prepare to replace record, unless it already matches
+    writeBuffer = data;
+    char* record = &writeBuffer[bufLen - SAUCE_RECORD_SIZE];
+    char updated[SAUCE_RECORD_SIZE];
+    memcpy(updated, record, 5);
+    memcpy(updated + 5, &(sauce->Version), SAUCE_RECORD_SIZE - 5);
+    ((SAUCE*)updated)->Comments = info.lines;
+    if (info.eof_exists && memcmp(updated, record, SAUCE_RECORD_SIZE) == 0) return SAUCE_UNCHANGED;
+    memcpy(record, updated, SAUCE_RECORD_SIZE);
+  } else {
+    // prepare to append record
+    writeBuffer = buffer;
+    bufLen = SAUCE_RECORD_SIZE;
+    memcpy(writeBuffer, SAUCE_RECORD_ID, 5);
+    memcpy(writeBuffer+5, &(sauce->Version), SAUCE_RECORD_SIZE-5);
+    ((SAUCE*)writeBuffer)->Comments = 0;
+  }
+
+  // prepare file for writing
+  FILE* file;
+  if (info.record_exists) {
+    // will need to replace record
+    file = fopen(filepath, "rb+");
+    if (file == NULL) {
+      SAUCE_SET_ERROR("Failed to open %s for reading & writing", filepath);
+      return SAUCE_EFOPEN;
+    }
+    if (SAUCE_file_seek(file, info.start) < 0) { // seek to beginning of SAUCE data
+      fclose(file);
+      SAUCE_SET_ERROR("Failed to seek to eof character in %s", filepath);
+      return SAUCE_EFFAIL;
+    }
+  } else {
+    // will need to append record
+    file = fopen(filepath, "ab");
+    if (file == NULL) {
+      SAUCE_SET_ERROR("Failed to open %s for appending", filepath);
+      return SAUCE_EFOPEN;
+    }
+  }
+
+  // write eof if needed
+  size_t write;
+  if (!info.eof_exists) {
+    char eof_char = SAUCE_EOF_CHAR;
+    write = fwrite(&eof_char, 1, 1, file);
+    if (write != 1) {
+      fclose(file);
+      SAUCE_SET_ERROR("Failed to write eof character to %s", filepath);
+      return SAUCE_EFFAIL;
+    }
+  }
+
+  // write the new buffer to the file
+  write = fwrite(writeBuffer, 1, bufLen, file);
+  fclose(file);
+  if (write != bufLen) {
+    SAUCE_SET_ERROR("Failed to write SAUCE data to %s", filepath);
+    return SAUCE_EFFAIL;
+  }
+
+  return 0;
+  #endif
+}
+
+
+/**
+ * @brief Check the field mask and values given to `SAUCE_fpatch()` or `SAUCE_fpatch_many()`.
+ * 
+ * @param values the values of the fields
+ * @param fields a mask of SAUCE_FIELD_BIT() values
+ * @return 0 if they can be patched. Otherwise, a negative error code is returned.
+ */
+static int SAUCE_check_patch(const SAUCE* values, uint32_t fields) {
+  if (values == NULL) {
+    SAUCE_SET_ERROR("SAUCE struct was NULL");
+    return SAUCE_ENULL;
+  }
+  if (fields & SAUCE_FIELD_BIT(SAUCE_FIELD_COMMENTS)) {
+    SAUCE_SET_ERROR("The Comments field cannot be patched");
+    return SAUCE_EOTHER;
+  }
+  if (fields & ~PATCH_FIELDS_MASK) {
+    SAUCE_SET_ERROR("Field mask 0x%x contains unknown fields", fields);
+    return SAUCE_EOTHER;
+  }
+  return 0;
+}
+
+
+/**
+ * @brief Patch fields of the SAUCE record of a file. Every field in `fields` is copied from `values` into the
+ *        record, and the other fields are left as they are. Only the last `SAUCE_RECORD_SIZE` bytes of the file
+ *        are read, and only the bytes of the record that change are written back with a single positioned write,
+ *        so any comment is never read or rewritten. If nothing changes, nothing is written.
+ * 
+ *        If the file has no record, an EOF character and a default record with the fields set are appended.
+ *        Unlike `SAUCE_fwrite()`, no EOF character is inserted in front of an existing record.
+ * 
+ * @param filepath a path to a file
+ * @param values a SAUCE struct holding the new values of the fields
+ * @param fields a mask of `SAUCE_FIELD_BIT()` values. `SAUCE_FIELD_COMMENTS` cannot be patched.
+ * @return 0 on success, or `SAUCE_UNCHANGED` if the fields already held the values and nothing was written.
+ *         On error, a negative error code is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_fpatch(const char* filepath, const SAUCE* values, uint32_t fields) {
+  if (filepath == NULL) {
+    SAUCE_SET_ERROR("Filepath was NULL");
+    return SAUCE_ENULL;
+  }
+  int res = SAUCE_check_patch(values, fields);
+  if (res < 0) return res;
+
+  char tail[SAUCE_MAX_TAIL_SIZE];
+  SAUCESync sync;
+  sync.durability = SAUCE_options()->durability;
+  sync.results = NULL;
+  sync.count = 0;
+  sync.size = 0;
+  res = SAUCE_file_patch(filepath, values, fields, tail, &sync);
+  switch (res) {
+    case SAUCE_EFOPEN:
+      SAUCE_SET_ERROR("Failed to open %s for reading & writing", filepath);
+      break;
+    case SAUCE_EFFAIL:
+      SAUCE_SET_ERROR("Failed to patch the record of %s", filepath);
+      break;
+    case SAUCE_EOTHER:
+      SAUCE_SET_ERROR("File size of %s is too large to be represented", filepath);
+      break;
+    default:
+      break;
+  }
+  return res;
+}
+
+
+/**
+ * @brief Work out how the files changed by a batch are synced, which is the stronger of the batch's `durability`
+ *        option and the durability of the calling context.
+ * 
+ * @param options options for the batch, or NULL
+ * @param durability will be set to how the files are synced
+ * @return 0 on success. On error, a negative error code is returned.
+ */
+static int SAUCE_batch_durability(const SAUCE_BatchOptions* options, enum SAUCE_Durability* durability) {
+  int value = (options != NULL) ? options->durability : SAUCE_DURABLE_NONE;
+  if (value < SAUCE_DURABLE_NONE || value > SAUCE_DURABLE_GROUP) {
+    SAUCE_SET_ERROR("%d is not a valid durability", value);
+    return SAUCE_EOTHER;
+  }
+  #ifndef FD_IO_IS_DEFINED
+  if (value != SAUCE_DURABLE_NONE) {
+    SAUCE_SET_ERROR("Syncing files is not supported on this system");
+    return SAUCE_EOTHER;
+  }
+  #endif
+
+  *durability = SAUCE_options()->durability;
+  if (value > (int)*durability) *durability = (enum SAUCE_Durability)value;
+  return 0;
+}
+
+
+/**
+ * @brief Patch fields of the SAUCE records of many files at once, like `SAUCE_fpatch()` does for one file.
+ *        `results[i]` will be set to the result of patching `filepaths[i]`, which is the same value
+ *        `SAUCE_fpatch()` would return for that file. No per-file error messages are set, so batches
+ *        can be patched from several threads at once.
+ * 
+ *        The files are patched by the pool of threads used by `SAUCE_fread_many()`. Otherwise, the files are
+ *        patched one at a time. Patched files are synced as the `durability` option asks, see `SAUCE_set_durability()`.
+ * 
+ * @param filepaths an array of `count` paths
+ * @param count the number of files
+ * @param values a SAUCE struct holding the new values of the fields
+ * @param fields a mask of `SAUCE_FIELD_BIT()` values. `SAUCE_FIELD_COMMENTS` cannot be patched.
+ * @param results an array of `count` result codes
+ * @param options options for the batch. If NULL, every option will be 0.
+ * @return On success, the number of files that were patched or already held the values. On error, a negative
+ *         error code is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_fpatch_many(const char* const* filepaths, uint32_t count, const SAUCE* values, uint32_t fields, int* results,
+                      const SAUCE_BatchOptions* options) {
+  if (filepaths == NULL) {
+    SAUCE_SET_ERROR("Filepaths array was NULL");
+    return SAUCE_ENULL;
+  }
+  if (results == NULL) {
+    SAUCE_SET_ERROR("Results array was NULL");
+    return SAUCE_ENULL;
+  }
+  int res = SAUCE_check_patch(values, fields);
+  if (res < 0) return res;
+  if (count > INT32_MAX) {
+    SAUCE_SET_ERROR("Cannot patch more than %d files at once", INT32_MAX);
+    return SAUCE_EOTHER;
+  }
+  enum SAUCE_Durability durability;
+  res = SAUCE_batch_durability(options, &durability);
+  if (res < 0) return res;
+
+  SAUCEBatch batch;
+  memset(&batch, 0, sizeof(batch));
+  batch.durability = durability;
+  batch.paths = filepaths;
+  batch.count = count;
+  batch.results = results;
+  batch.patch = values;
+  batch.patchFields = fields;
+  return SAUCE_batch_run(&batch, options);
+}
+
+
+/**
+ * @brief Write a SAUCE CommentBlock to a file, replacing a CommentBlock if one already exists.
+ *        The "Comments" field of the file's SAUCE record will be updated to `lines`.
+ * 
+ *        When the existing comment has the same number of lines, only the comment lines are rewritten.
+ *        A shorter comment is written along with the record and the file is then truncated.
+ *        
+ * 
+ * @param filepath a path to a file
+ * @param comment a comment buffer that is as least `SAUCE_COMMENT_STRING_LENGTH(lines)` bytes long
+ * @param lines the number of lines to write
+ * @return 0 on success, or `SAUCE_UNCHANGED` if the file already contained the comment and nothing was written.
+ *         On error, a negative error code is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_Comment_fwrite(const char* filepath, const char* comment, uint8_t lines) {
+  if (filepath == NULL) {
+    SAUCE_SET_ERROR("Filepath was NULL");
+    return SAUCE_ENULL;
+  }
+  if (comment == NULL) {
+    SAUCE_SET_ERROR("Comment string argument was NULL");
+    return SAUCE_ENULL;
+  }
+
+  if (lines == 0) return 0;
+
+  #ifdef FD_IO_IS_DEFINED
+  int fd = SAUCE_fd_open(filepath, FD_OPEN_WRITE);
+  if (fd < 0) {
+    SAUCE_SET_ERROR("Failed to open %s for reading & writing", filepath);
+    return SAUCE_EFOPEN;
+  }
+  return SAUCE_fd_close_file(fd, filepath, SAUCE_fd_write_comment(fd, filepath, comment, lines));
+  #else
+  SAUCEInfo info;
+  int64_t filesize = 0;
+  char buffer[SAUCE_MAX_TAIL_SIZE];
+  char* data = NULL;
+  int res = SAUCE_file_get_info(filepath, &info, &filesize, buffer, &data);
+  if (res < 0 && !info.record_exists) return res; // we can continue as long as the record exists
+
+  // the SAUCE data keeps its size, so only overwrite the comment lines
+  if (info.comment_exists && info.eof_exists && info.lines == lines) {
+    if (memcmp(data + 5, comment, SAUCE_COMMENT_STRING_LENGTH(lines)) == 0) return SAUCE_UNCHANGED;
+    FILE* file = fopen(filepath, "rb+");
+    if (file == NULL) {
+      SAUCE_SET_ERROR("Failed to open %s for reading and writing", filepath);
+      return SAUCE_EFOPEN;
+    }
+    if (SAUCE_file_seek(file, info.start + 5) < 0) {
+      fclose(file);
+      SAUCE_SET_ERROR("Failed to seek to the comment in %s", filepath);
+      return SAUCE_EFFAIL;
+    }
+    size_t write = fwrite(comment, 1, SAUCE_COMMENT_STRING_LENGTH(lines), file);
+    fclose(file);
+    if (write != SAUCE_COMMENT_STRING_LENGTH(lines)) {
+      SAUCE_SET_ERROR("Failed to write new comment to %s", filepath);
+      return SAUCE_EFFAIL;
+    }
+    return 0;
+  }
+
+  // copy record
+  char record[SAUCE_RECORD_SIZE];
+  memcpy(record, &data[info.sauce_length - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
+
+  // construct new SAUCE data over the old tail
+  uint32_t bufLen = SAUCE_TOTAL_SIZE(lines);
+  memcpy(buffer, SAUCE_COMMENT_ID, 5);
+  memcpy(buffer+5, comment, SAUCE_COMMENT_STRING_LENGTH(lines));
+  memcpy(buffer+SAUCE_COMMENT_BLOCK_SIZE(lines), record, SAUCE_RECORD_SIZE);
+  ((SAUCE*)(&buffer[SAUCE_COMMENT_BLOCK_SIZE(lines)]))->Comments = lines;
+
+  // prep file for writing
+  FILE* file;
+  if (info.comment_exists && info.lines > lines) {
+    // file will be shorter, truncate it
+    res = SAUCE_file_truncate(filepath, filesize, info.sauce_length, &file);
+    if (res < 0) {
+      return res;
+    }
+  } else {
+    file = fopen(filepath, "rb+");
+    if (file == NULL) {
+      SAUCE_SET_ERROR("Failed to open %s for reading and writing", filepath);
+      return SAUCE_EFOPEN;
+    }
+    if (SAUCE_file_seek(file, filesize - info.sauce_length) < 0) {
+      fclose(file);
+      SAUCE_SET_ERROR("Failed to seek to beginning of original SAUCE data in %s", filepath);
+      return SAUCE_EFFAIL;
+    }
+  }
+
+  // write an eof character if needed
+  size_t write;
+  if (!info.eof_exists) {
+    char eof_char = SAUCE_EOF_CHAR;
+    write = fwrite(&eof_char, 1, 1, file);
+    if (write != 1) {
+      fclose(file);
+      SAUCE_SET_ERROR("Failed to write eof character to %s", filepath);
+      return SAUCE_EFFAIL;
+    }
+  }
+
+  // write buffer to file
+  res = fwrite(buffer, 1, bufLen, file);
+  fclose(file);
+  if (res != bufLen) {
+    SAUCE_SET_ERROR("Failed to write new comment and record to %s", filepath);
+    return SAUCE_EFFAIL;
+  }
+
+  return 0;
+  #endif
+}
+
+
+/**
+ * @brief Write a SAUCE record to a file descriptor. If the file already contains a SAUCE record, then it will
+ *        be replaced. If the file does not contain a SAUCE record, then the record will be appended
+ *        to the end of the file along with an EOF character.
+ * 
+ *        The new data is written with positioned writes, so the file offset of `fd` is not changed
+ *        on POSIX systems.
+ * 
+ * @param fd a file descriptor open for reading and writing
+ * @param sauce the SAUCE record to write
+ * @return 0 on success, or `SAUCE_UNCHANGED` if the file already contained the record and nothing was written.
+ *         On error, a negative error code is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_fd_write(int fd, const SAUCE* sauce) {
+  if (fd < 0) {
+    SAUCE_SET_ERROR("File descriptor %d is invalid", fd);
+    return SAUCE_EFOPEN;
+  }
+  if (sauce == NULL) {
+    SAUCE_SET_ERROR("SAUCE struct was NULL");
+    return SAUCE_ENULL;
+  }
+
+  #ifdef FD_IO_IS_DEFINED
+  char name[FD_NAME_SIZE];
+  SAUCE_fd_name(fd, name);
+  return SAUCE_fd_write_record(fd, name, sauce);
+  #else
+  SAUCE_SET_ERROR("File descriptor functions are not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
+}
+
+
+/**
+ * @brief Write a comment to a file descriptor. The file must already contain a SAUCE record.
+ *        If the file already contains a comment, it will be replaced. The "Comments" field of the SAUCE
+ *        record will be updated to contain the new number of comment lines.
+ * 
+ *        The new data is written with positioned writes, so the file offset of `fd` is not changed
+ *        on POSIX systems.
+ * 
+ * @param fd a file descriptor open for reading and writing
+ * @param comment the comment to write
+ * @param lines the number of lines to write
+ * @return 0 on success, or `SAUCE_UNCHANGED` if the file already contained the comment and nothing was written.
+ *         On error, a negative error code is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_Comment_fd_write(int fd, const char* comment, uint8_t lines) {
+  if (fd < 0) {
+    SAUCE_SET_ERROR("File descriptor %d is invalid", fd);
+    return SAUCE_EFOPEN;
+  }
+  if (comment == NULL) {
+    SAUCE_SET_ERROR("Comment string argument was NULL");
+    return SAUCE_ENULL;
+  }
+
+  if (lines == 0) return 0;
+
+  #ifdef FD_IO_IS_DEFINED
+  char name[FD_NAME_SIZE];
+  SAUCE_fd_name(fd, name);
+  return SAUCE_fd_write_comment(fd, name, comment, lines);
+  #else
+  SAUCE_SET_ERROR("File descriptor functions are not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
+}
+
+
+/**
+ * @brief Write a SAUCE record to a buffer. 
+ * 
+ * 
+ *        If the last 128 bytes of the buffer (bytes `n-1` to `n-128`)
+ *        contain a SAUCE record, the buffer's SAUCE record will be replaced. Otherwise, an EOF character and
+ *        the new SAUCE record will be appended to the buffer at index `n`.
+ *        Important! - To prevent a buffer overflow error when appending a new record, 
+ *        the buffer's actual size must be at least n + 129 bytes (the size of a SAUCE record including an EOF character).
+ * 
+ * @param buffer pointer to buffer
+ * @param n the length of the buffer
+ * @param sauce a SAUCE struct
+ * @return On success, the new length of the buffer is returned. On error, a negative error code
+ *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_write(char* buffer, uint32_t n, const SAUCE* sauce) {
+  return (int)SAUCE_write64(buffer, n, sauce);
+}
+
+
+/**
+ * @brief Write a SAUCE record to a buffer. Same as `SAUCE_write()`, but for buffers that may be larger than 4GB.
+ *        The buffer's actual size must be at least n + 129 bytes.
+ * 
+ * @param buffer pointer to buffer
+ * @param n the length of the buffer
+ * @param sauce a SAUCE struct
+ * @return On success, the new length of the buffer is returned. On error, a negative error code
+ *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_write64(char* buffer, size_t n, const SAUCE* sauce) {
+  // null checks
+  if (buffer == NULL) {
+    SAUCE_SET_ERROR("Buffer was NULL");
+    return SAUCE_ENULL;
+  }
+  if (sauce == NULL) {
+    SAUCE_SET_ERROR("SAUCE struct was NULL");
+    return SAUCE_ENULL;
+  }
+
+  size_t len = n;
+
+  // check the size of the buffer
+  if (n >= SAUCE_RECORD_SIZE) {
+    // look for SAUCE id
+    if (memcmp(&buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_ID, 5) == 0) {
+      goto replace; // there is a record, replace it
+    }
+    goto append; // there is no record, append the new record
+  } else {
+    goto append; // buffer to short to have record, append the new record
+  }
+
+
+  // ===== Append a new record =====
+  append: {
+    // add eof
+    buffer[len] = SAUCE_EOF_CHAR;
+    len++;
+
+    memcpy(&buffer[len], SAUCE_RECORD_ID, 5);
+    len += 5;
+    memcpy(&buffer[len], ((uint8_t*)sauce)+5, SAUCE_RECORD_SIZE - 5);
+    len += (SAUCE_RECORD_SIZE - 5);
+
+    // set the Comments field to 0
+    ((SAUCE*)(&buffer[len-SAUCE_RECORD_SIZE]))->Comments = 0;
+
+    return len;
+  }
+  // ===== end of append section =====
+
+  // ===== Replace the record =====
+  replace: {
+    // save Comments field
+    uint8_t lines = ((SAUCE*)(&buffer[len-SAUCE_RECORD_SIZE]))->Comments;
+
+    // replace the record
+    memcpy(&buffer[len - SAUCE_RECORD_SIZE], SAUCE_RECORD_ID, 5);
+    memcpy(&buffer[len - SAUCE_RECORD_SIZE + 5], ((uint8_t*)sauce)+5, SAUCE_RECORD_SIZE - 5);
+    
+    // set comments to original value
+    ((SAUCE*)(&buffer[len-SAUCE_RECORD_SIZE]))->Comments = lines;
+
+    // attempt to insert an EOF character
+    len = insert_eof_char(buffer, len, lines);
+
+    return len;
+  }
+  // ===== end of replace section =====
+}
+
+
+/**
+ * @brief Write a SAUCE CommentBlock to a buffer, replacing a CommentBlock if one already exists.
+ *        The "Comments" field of the buffer's SAUCE record will be updated to `lines`.
+ * 
+ * 
+ *        If the last 128 bytes of the buffer (bytes `n-1` to `n-128`)
+ *        contain a SAUCE record, the CommentBlock will be written. Otherwise, an
+ *        error will be returned. 
+ *        Important! - To prevent a buffer overflow error when writing a new comment, 
+ *        the buffer's actual size must be at least `n` + `SAUCE_COMMENT_BLOCK_SIZE(number of comment lines)`.
+ * 
+ * @param buffer pointer to buffer
+ * @param n the length of the buffer
+ * @param comment a comment buffer that is as least `SAUCE_COMMENT_STRING_LENGTH(lines)` bytes long
+ * @param lines the number of lines to write
+ * @return On success, the new length of the buffer is returned. On error, a negative error code
+ *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_Comment_write(char* buffer, uint32_t n, const char* comment, uint8_t lines) {
+  return (int)SAUCE_Comment_write64(buffer, n, comment, lines);
+}
+
+
+/**
+ * @brief Write a SAUCE CommentBlock to a buffer, replacing a CommentBlock if one already exists.
+ *        Same as `SAUCE_Comment_write()`, but for buffers that may be larger than 4GB. The buffer's
+ *        actual size must be at least `n` + `SAUCE_COMMENT_BLOCK_SIZE(number of comment lines)`.
+ * 
+ * @param buffer pointer to buffer
+ * @param n the length of the buffer
+ * @param comment a comment buffer that is as least `SAUCE_COMMENT_STRING_LENGTH(lines)` bytes long
+ * @param lines the number of lines to write
+ * @return On success, the new length of the buffer is returned. On error, a negative error code
+ *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_Comment_write64(char* buffer, size_t n, const char* comment, uint8_t lines) {
+  if (buffer == NULL) {
+    SAUCE_SET_ERROR("Buffer was NULL");
+    return SAUCE_ENULL;
+  }
+  if (comment == NULL) {
+    SAUCE_SET_ERROR("Comment string argument was NULL");
+    return SAUCE_ENULL;
+  }
+
+  if (n == 0) {
+    SAUCE_SET_ERROR("Buffer's length is zero and cannot contain a record");
+    return SAUCE_EEMPTY;
+  }
+  if (n < SAUCE_RECORD_SIZE) {
+    SAUCE_SET_ERROR("Buffer's length is too short to contain a record");
+    return SAUCE_ESHORT;
+  }
+
+  // find record
+  if (memcmp(&buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_ID, 5) != 0) {
+    SAUCE_SET_ERROR("Buffer does not contain a record");
+    return SAUCE_ERMISS;
+  }
+
+  // return immediately if lines is 0
+  if (lines == 0) return n;
+
+  // check if there is already an EOF character before record
+  int eof_exists = 0;
+  if (n > SAUCE_RECORD_SIZE && buffer[n - SAUCE_RECORD_SIZE - 1] == SAUCE_EOF_CHAR) eof_exists = 1;
+
+  // determine if there is a comment and if so, if there is an eof before the comment
+  uint8_t totalLines = ((SAUCE*)(&buffer[n - SAUCE_RECORD_SIZE]))->Comments;
+  int comment_exists = 1; // first assume comment exists
+  if (totalLines == 0) {
+    comment_exists = 0;
+  } else {
+    // comment could already exist
+    eof_exists = 0;
+    
+    // look for comment
+    if (n < SAUCE_TOTAL_SIZE(totalLines)) {
+      comment_exists = 0;
+    } else if (memcmp(&buffer[n - SAUCE_TOTAL_SIZE(totalLines)], SAUCE_COMMENT_ID, 5) != 0) {
+      comment_exists = 0;
+    }
+
+    // look for eof char
+    if (comment_exists && n > SAUCE_TOTAL_SIZE(totalLines)) {
+      if (buffer[n - SAUCE_TOTAL_SIZE(totalLines) - 1] == SAUCE_EOF_CHAR) eof_exists = 1;
+    }
+  }
+
+  // determine where to write
+  size_t write_index = 0;
+  if (comment_exists)
+    write_index = (eof_exists) ? n - SAUCE_TOTAL_SIZE(totalLines) - 1 : n - SAUCE_TOTAL_SIZE(totalLines);
+  else
+    write_index = (eof_exists) ? n - SAUCE_RECORD_SIZE - 1 : n - SAUCE_RECORD_SIZE;
+
+  // move record
+  memmove(&buffer[write_index+1+SAUCE_COMMENT_BLOCK_SIZE(lines)], &buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
+
+  // add eof
+  buffer[write_index] = SAUCE_EOF_CHAR;  
+
+  // write comment
+  memcpy(&buffer[write_index+1], SAUCE_COMMENT_ID, 5);
+  memcpy(&buffer[write_index+6], comment, SAUCE_COMMENT_STRING_LENGTH(lines));
+
+  // update comments field
+  ((SAUCE*)(&buffer[write_index+1+SAUCE_COMMENT_BLOCK_SIZE(lines)]))->Comments = lines;
+
+  return write_index + 1 + SAUCE_TOTAL_SIZE(lines);
+}
+
+
+
+
+
+// Remove Functions
+
+/**
+ * @brief Remove a SAUCE record from a file, along with the SAUCE CommentBlock if one exists.
+ *        The EOF character will be removed as well.
+ * 
+ * @param filepath a path to a file
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_fremove(const char* filepath) {
+  if (filepath == NULL) {
+    SAUCE_SET_ERROR("Filepath was NULL");
+    return SAUCE_ENULL;
+  }
+
+  #ifdef FD_IO_IS_DEFINED
+  int fd = SAUCE_fd_open(filepath, FD_OPEN_WRITE);
+  if (fd < 0) {
+    SAUCE_SET_ERROR("Failed to open %s for reading & writing", filepath);
+    return SAUCE_EFOPEN;
+  }
+  return SAUCE_fd_close_file(fd, filepath, SAUCE_fd_remove_record(fd, filepath));
+  #else
+  SAUCEInfo info;
+  int64_t filesize;
+  char buffer[SAUCE_MAX_TAIL_SIZE];
+  int res = SAUCE_file_get_info(filepath, &info, &filesize, buffer, NULL);
+  if (res < 0 && !info.record_exists) return res;
+
+  if (info.eof_exists) info.sauce_length++;
+  res = SAUCE_file_truncate(filepath, filesize, info.sauce_length, NULL);
+  if (res < 0) return res;
+  return 0;
+  #endif
+}
+
+
+/**
+ * @brief Remove the SAUCE data of many files at once. `results[i]` will be set to the result of removing the
+ *        SAUCE data of `filepaths[i]`, which is the same value `SAUCE_fremove()` would return for that file.
+ *        No per-file error messages are set, so batches can be stripped from several threads at once.
+ * 
+ *        The files are stripped by the pool of threads used by `SAUCE_fread_many()`. Each file is opened once,
+ *        its tail is read with a single positioned read, and the same descriptor is truncated. If a cache is set,
+ *        files that the cache knows to have no record are not opened. Otherwise, the files are stripped one at a time.
+ *        Stripped files are synced as the `durability` option asks, see `SAUCE_set_durability()`.
+ * 
+ * @param filepaths an array of `count` paths
+ * @param count the number of files
+ * @param results an array of `count` result codes
+ * @param options options for the batch. If NULL, every option will be 0.
+ * @return On success, the number of files whose SAUCE data was removed. On error, a negative error code is returned.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_fremove_many(const char* const* filepaths, uint32_t count, int* results, const SAUCE_BatchOptions* options) {
+  if (filepaths == NULL) {
+    SAUCE_SET_ERROR("Filepaths array was NULL");
+    return SAUCE_ENULL;
+  }
+  if (results == NULL) {
+    SAUCE_SET_ERROR("Results array was NULL");
+    return SAUCE_ENULL;
+  }
+  if (count > INT32_MAX) {
+    SAUCE_SET_ERROR("Cannot remove from more than %d files at once", INT32_MAX);
+    return SAUCE_EOTHER;
+  }
+  enum SAUCE_Durability durability;
+  int res = SAUCE_batch_durability(options, &durability);
+  if (res < 0) return res;
+
+  SAUCEBatch batch;
+  memset(&batch, 0, sizeof(batch));
+  batch.durability = durability;
+  batch.paths = filepaths;
+  batch.count = count;
+  batch.results = results;
+  batch.strip = 1;
+  batch.cache = SAUCE_options()->cache;
+  return SAUCE_batch_run(&batch, options);
+}
+
+
+/**
+ * @brief Remove a SAUCE CommentBlock from a file. The "Comments" field of the file's SAUCE
+ *        record will be set to 0.
+ * 
+ * @param filepath a path to a file
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Comment_fremove(const char* filepath) {
+  if (filepath == NULL) {
+    SAUCE_SET_ERROR("Filepath was NULL");
+    return SAUCE_ENULL;
+  }
+
+  #ifdef FD_IO_IS_DEFINED
+  int fd = SAUCE_fd_open(filepath, FD_OPEN_WRITE);
+  if (fd < 0) {
+    SAUCE_SET_ERROR("Failed to open %s for reading & writing", filepath);
+    return SAUCE_EFOPEN;
+  }
+  return SAUCE_fd_close_file(fd, filepath, SAUCE_fd_remove_comment(fd, filepath));
+  #else
+  SAUCEInfo info;
+  int64_t filesize;
+  char buffer[SAUCE_MAX_TAIL_SIZE];
+  char* data = NULL;
+  int res = SAUCE_file_get_info(filepath, &info, &filesize, buffer, &data);
+  if (res < 0 && !info.record_exists) return res;
+
+  // check if comment doesn't exist
+  if (!info.comment_exists) {
+    if (info.lines == 0) {
+      SAUCE_SET_ERROR("%s contains zero comment lines, so no comment can be removed", filepath);
+    }
+    return SAUCE_ECMISS;
+  }
+
+  // copy record
+  char record[SAUCE_RECORD_SIZE];
+  memcpy(record, &data[info.sauce_length - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
+  ((SAUCE*)record)->Comments = 0;
+
+  // prep file for writing
+  FILE* file;
+  res = SAUCE_file_truncate(filepath, filesize, info.sauce_length, &file);
+  if (res < 0) return res;
+
+  // write an eof character if needed
+  size_t write;
+  if (!info.eof_exists) {
+    char eof_char = SAUCE_EOF_CHAR;
+    write = fwrite(&eof_char, 1, 1, file);
+    if (write != 1) {
+      fclose(file);
+      SAUCE_SET_ERROR("Failed to write eof character to %s", filepath);
+      return SAUCE_EFFAIL;
+    }
+  }
+
+  // write buffer to file
+  res = fwrite(record, 1, SAUCE_RECORD_SIZE, file);
+  fclose(file);
+  if (res != SAUCE_RECORD_SIZE) {
+    SAUCE_SET_ERROR("Failed to write updated record to %s", filepath);
+    return SAUCE_EFFAIL;
+  }
+
+  return 0;
+  #endif
+}
+
+
+/**
+ * @brief Remove SAUCE data (record and comments) from a file descriptor. The file is truncated
+ *        in place.
+ * 
+ * @param fd a file descriptor open for reading and writing
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_fd_remove(int fd) {
+  if (fd < 0) {
+    SAUCE_SET_ERROR("File descriptor %d is invalid", fd);
+    return SAUCE_EFOPEN;
+  }
+
+  #ifdef FD_IO_IS_DEFINED
+  char name[FD_NAME_SIZE];
+  SAUCE_fd_name(fd, name);
+  return SAUCE_fd_remove_record(fd, name);
+  #else
+  SAUCE_SET_ERROR("File descriptor functions are not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
+}
+
+
+/**
+ * @brief Remove a SAUCE CommentBlock from a file descriptor. The "Comments" field of the file's SAUCE
+ *        record will be set to 0.
+ * 
+ * @param fd a file descriptor open for reading and writing
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Comment_fd_remove(int fd) {
+  if (fd < 0) {
+    SAUCE_SET_ERROR("File descriptor %d is invalid", fd);
+    return SAUCE_EFOPEN;
+  }
+
+  #ifdef FD_IO_IS_DEFINED
+  char name[FD_NAME_SIZE];
+  SAUCE_fd_name(fd, name);
+  return SAUCE_fd_remove_comment(fd, name);
+  #else
+  SAUCE_SET_ERROR("File descriptor functions are not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
+}
+
+
+/**
+ * @brief Remove a SAUCE record from the first `n` bytes of a buffer, 
+ *        along with the SAUCE CommentBlock if it exists. The EOF character will be
+ *        removed as well.
+ * 
+ * @param buffer pointer to buffer
+ * @param n the length of the buffer
+ * @return On success, the new length of the buffer is returned. On error, a negative error code
+ *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_remove(char* buffer, uint32_t n) {
+  return (int)SAUCE_remove64(buffer, n);
+}
+
+
+/**
+ * @brief Remove a SAUCE record from the first `n` bytes of a buffer, along with the SAUCE CommentBlock
+ *        if it exists. Same as `SAUCE_remove()`, but for buffers that may be larger than 4GB.
+ * 
+ * @param buffer pointer to buffer
+ * @param n the length of the buffer
+ * @return On success, the new length of the buffer is returned. On error, a negative error code
+ *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_remove64(char* buffer, size_t n) {
+  SAUCEInfo info;
+  int res = SAUCE_buffer_get_info(buffer, n, &info);
+  if (res < 0 && !info.record_exists) return res;
+
+  // erase SAUCE data
+  memset(&buffer[info.start], 0, info.sauce_length);
+  if (info.eof_exists) {
+    buffer[info.start - 1] = 0;
+    return n - info.sauce_length - 1;
+  }
+  return n - info.sauce_length;
+}
+
+
+/**
+ * @brief Remove a SAUCE CommentBlock from the first `n` bytes of a buffer.
+ *        The "Comments" field of the buffer's SAUCE record will be set to 0.
+ * 
+ * @param buffer pointer to buffer
+ * @param n the length of the buffer
+ * @return On success, the new length of the buffer is returned. On error, a negative error code
+ *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_Comment_remove(char* buffer, uint32_t n) {
+  return (int)SAUCE_Comment_remove64(buffer, n);
+}
+
+
+/**
+ * @brief Remove a SAUCE CommentBlock from the first `n` bytes of a buffer. Same as `SAUCE_Comment_remove()`,
+ *        but for buffers that may be larger than 4GB.
+ * 
+ * @param buffer pointer to buffer
+ * @param n the length of the buffer
+ * @return On success, the new length of the buffer is returned. On error, a negative error code
+ *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_Comment_remove64(char* buffer, size_t n) {
+  SAUCEInfo info;
+  int res = SAUCE_buffer_get_info(buffer, n, &info);
+  if (res < 0 && !info.record_exists) return res;
+
+  // check info on comment
+  if (info.lines > 0 && !info.comment_exists) {
+    return SAUCE_ECMISS;
+  } else if (!info.comment_exists) {
+    SAUCE_SET_ERROR("Buffer contains zero comment lines, so no comment can be removed");
+    return SAUCE_ECMISS;
+  }
+  
+  // move record in place of comment
+  if (info.eof_exists) {
+    memmove(&buffer[info.start], &buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
+    ((SAUCE*)(&buffer[info.start]))->Comments = 0;
+    return n - SAUCE_COMMENT_BLOCK_SIZE(info.lines);
+  }
+
+  // move record in place of comment and add eof
+  buffer[info.start] = SAUCE_EOF_CHAR;
+  memmove(&buffer[info.start+1], &buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
+  ((SAUCE*)(&buffer[info.start+1]))->Comments = 0;
+  return n - SAUCE_COMMENT_BLOCK_SIZE(info.lines) + 1;
+}
+
+
+
+
+
+// Functions for performing checks
+
+/**
+ * @brief Check if a file contains SAUCE data.
+ * 
+ * @param filepath path to a file
+ * @return 1 (true) if the file contains valid SAUCE data; 0 (false) if the file does not contain valid
+ *         SAUCE data. If 0 is returned, you can call `SAUCE_get_error()` to learn more about
+ *         why the check failed.
+ */
+int SAUCE_check_file(const char* filepath) {
+  #ifdef FD_IO_IS_DEFINED
+  if (filepath == NULL) {
+    SAUCE_SET_ERROR("Filepath was NULL");
+    return 0;
+  }
+
+  #ifdef CACHE_IS_DEFINED
+  SAUCECacheEntry entry;
+  SAUCE_Cache* cache = SAUCE_options()->cache;
+  if (cache != NULL && SAUCE_cache_lookup_path(cache, filepath, &entry)) {
+    SAUCEInfo info;
+    SAUCE_cache_entry_info(&entry, &info);
+    return SAUCE_set_info_error(filepath, entry.result, &info) == 0;
+  }
+  #endif
+
+  int fd = SAUCE_fd_open(filepath, FD_OPEN_READ);
+  if (fd < 0) {
+    SAUCE_set_tail_error(filepath, SAUCE_EFOPEN);
+    return 0;
+  }
+  int res = SAUCE_fd_check(fd, filepath);
+  SAUCE_fd_close(fd);
+  return res;
+  #else
+  SAUCEInfo info;
+  char buffer[SAUCE_MAX_TAIL_SIZE];
+  int res = SAUCE_file_get_info(filepath, &info, NULL, buffer, NULL);
+  if (res < 0) return 0;
+  return 1;
+  #endif
+}
+
+
+/**
+ * @brief Check if a file descriptor refers to a file that contains SAUCE data.
+ * 
+ * @param fd a file descriptor open for reading
+ * @return 1 (true) if the file contains valid SAUCE data; 0 (false) if the file does not contain valid
+ *         SAUCE data. If 0 is returned, you can call `SAUCE_get_error()` to learn more about
+ *         why the check failed.
+ */
+int SAUCE_check_fd(int fd) {
+  if (fd < 0) {
+    SAUCE_SET_ERROR("File descriptor %d is invalid", fd);
+    return 0;
+  }
+
+  #ifdef FD_IO_IS_DEFINED
+  char name[FD_NAME_SIZE];
+  SAUCE_fd_name(fd, name);
+  return SAUCE_fd_check(fd, name);
+  #else
+  SAUCE_SET_ERROR("File descriptor functions are not supported on this system");
+  return 0;
+  #endif
+}
+
+
+/**
+ * @brief Check if the first `n` bytes of a buffer contain SAUCE data.
+ * 
+ * @param buffer pointer to a buffer
  * @param n the length of the buffer
- * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1` that will contain the comment
- * @param nLines the number of lines to read
- * @return On success, the number of lines read. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ * @return 1 (true) if the buffer contains valid SAUCE data; 0 (false) if the buffer does not contain valid
+ *         SAUCE data. If 0 is returned, you can call `SAUCE_get_error()` to learn more about
+ *         why the check failed.
+ */
+int SAUCE_check_buffer(const char* buffer, uint32_t n) {
+  return SAUCE_check_buffer64(buffer, n);
+}
+
+
+/**
+ * @brief Check if the first `n` bytes of a buffer contain SAUCE data. Same as `SAUCE_check_buffer()`,
+ *        but for buffers that may be larger than 4GB.
+ * 
+ * @param buffer pointer to a buffer
+ * @param n the length of the buffer
+ * @return 1 (true) if the buffer contains valid SAUCE data; 0 (false) if the buffer does not contain valid
+ *         SAUCE data. If 0 is returned, you can call `SAUCE_get_error()` to learn more about
+ *         why the check failed.
+ */
+int SAUCE_check_buffer64(const char* buffer, size_t n) {
+  SAUCEInfo info;
+  int res = SAUCE_buffer_get_info(buffer, n, &info);
+  if (res < 0) return 0;
+  return 1;
+}
+
+
+/**
+ * @brief Get the layout of the SAUCE data at the end of a file: whether a record, comment and eof character
+ *        exist, and where the SAUCE data starts. Uses the current cache, if there is one.
+ * 
+ * @param filepath path to a file
+ * @param layout will be set to the layout of the file. It is always set, no matter the return condition.
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_flayout(const char* filepath, SAUCE_Layout* layout) {
+  if (layout == NULL) {
+    SAUCE_SET_ERROR("SAUCE_Layout struct was NULL");
+    return SAUCE_ENULL;
+  }
+  memset(layout, 0, sizeof(SAUCE_Layout));
+  if (filepath == NULL) {
+    SAUCE_SET_ERROR("Filepath was NULL");
+    return SAUCE_ENULL;
+  }
+
+  SAUCEInfo info;
+  int64_t filesize = 0;
+  #ifdef FD_IO_IS_DEFINED
+  #ifdef CACHE_IS_DEFINED
+  SAUCECacheEntry entry;
+  SAUCE_Cache* cache = SAUCE_options()->cache;
+  if (cache != NULL && SAUCE_cache_lookup_path(cache, filepath, &entry)) {
+    SAUCE_cache_entry_info(&entry, &info);
+    SAUCE_info_layout(&info, entry.size, layout);
+    return SAUCE_set_info_error(filepath, entry.result, &info);
+  }
+  #endif
+
+  int fd = SAUCE_fd_open(filepath, FD_OPEN_READ);
+  if (fd < 0) return SAUCE_set_tail_error(filepath, SAUCE_EFOPEN);
+  int res = SAUCE_fd_info(fd, filepath, &info, &filesize);
+  SAUCE_fd_close(fd);
+  #else
+  char buffer[SAUCE_MAX_TAIL_SIZE];
+  int res = SAUCE_file_get_info(filepath, &info, &filesize, buffer, NULL);
+  #endif
+
+  SAUCE_info_layout(&info, filesize, layout);
+  return res;
+}
+
+
+/**
+ * @brief Get the layout of the SAUCE data at the end of a file descriptor. See `SAUCE_flayout()`.
+ * 
+ * @param fd a file descriptor open for reading
+ * @param layout will be set to the layout of the file. It is always set, no matter the return condition.
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_fd_layout(int fd, SAUCE_Layout* layout) {
+  if (layout == NULL) {
+    SAUCE_SET_ERROR("SAUCE_Layout struct was NULL");
+    return SAUCE_ENULL;
+  }
+  memset(layout, 0, sizeof(SAUCE_Layout));
+  if (fd < 0) {
+    SAUCE_SET_ERROR("File descriptor %d is invalid", fd);
+    return SAUCE_EFOPEN;
+  }
+
+  #ifdef FD_IO_IS_DEFINED
+  char name[FD_NAME_SIZE];
+  SAUCE_fd_name(fd, name);
+
+  SAUCEInfo info;
+  int64_t filesize = 0;
+  int res = SAUCE_fd_info(fd, name, &info, &filesize);
+  SAUCE_info_layout(&info, filesize, layout);
+  return res;
+  #else
+  SAUCE_SET_ERROR("File descriptor functions are not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
+}
+
+
+/**
+ * @brief Get the layout of the SAUCE data at the end of the first `n` bytes of a buffer. See `SAUCE_flayout()`.
+ * 
+ * @param buffer pointer to a buffer
+ * @param n the length of the buffer
+ * @param layout will be set to the layout of the buffer. It is always set, no matter the return condition.
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_layout(const char* buffer, size_t n, SAUCE_Layout* layout) {
+  if (layout == NULL) {
+    SAUCE_SET_ERROR("SAUCE_Layout struct was NULL");
+    return SAUCE_ENULL;
+  }
+  memset(layout, 0, sizeof(SAUCE_Layout));
+
+  SAUCEInfo info;
+  int res = SAUCE_buffer_get_info(buffer, n, &info);
+  if (res == SAUCE_ENULL) return res;
+  SAUCE_info_layout(&info, (int64_t)n, layout);
+  return res;
+}
+
+
+/**
+ * @brief Check two SAUCE records for equality. SAUCE records are equal if
+ *        each field between the SAUCE records match.
+ * 
+ * @param first the first SAUCE struct
+ * @param second the second SAUCE struct
+ * @return 1 (true) if the records are equal; 0 (false) if the records are not equal
+ */
+int SAUCE_equal(const SAUCE* first, const SAUCE* second) {
+  if (first == second) return 1;
+
+  if (memcmp(first->ID, second->ID, 5) != 0) return 0;
+  if (memcmp(first->Version, second->Version, 2) != 0) return 0;
+  if (memcmp(first->Title, second->Title, 35) != 0) return 0;
+  if (memcmp(first->Author, second->Author, 20) != 0) return 0;
+  if (memcmp(first->Group, second->Group, 20) != 0) return 0;
+  if (memcmp(first->Date, second->Date, 8) != 0) return 0;
+  
+  if (strncmp(first->TInfoS, second->TInfoS, 22) != 0) return 0;
+
+  return first->FileSize == second->FileSize &&
+         first->DataType == second->DataType &&
+         first->FileType == second->FileType &&
+         first->TInfo1 == second->TInfo1 &&
+         first->TInfo2 == second->TInfo2 &&
+         first->TInfo3 == second->TInfo3 &&
+         first->TInfo4 == second->TInfo4 &&
+         first->Comments == second->Comments &&
+         first->TFlags == second->TFlags;
+}
+
+
+/**
+ * @brief Determine if two SAUCE comments are equal. 
+ * 
+ * 
+ *        Both comments must be at least `SAUCE_COMMENT_STRING_LENGTH(lines)` bytes long. 
+ *        Anything beyond the given number of lines, including any terminating null 
+ *        characters after the last line, will be not compared or read.
+ * 
+ * @param first the first comment
+ * @param second the second comment
+ * @param lines the maximum number of lines to compare
+ * @return 1 (i.e. true) if the comments are equal; 0 (i.e. false) if the comments are not equal
+ */
+int SAUCE_Comment_equal(const char* first_comment, const char* second_comment, uint8_t lines) {
+  return memcmp(first_comment, second_comment, SAUCE_COMMENT_STRING_LENGTH(lines)) == 0;
+}
+
+
+
+
+
+// Edit Functions
+
+/**
+ * @brief Open an edit of a file's SAUCE data. Changes made with `SAUCE_Edit_set_record()`, `SAUCE_Edit_set_comment()`
+ *        and `SAUCE_Edit_remove_comment()` are only collected, and are applied together by `SAUCE_Edit_commit()`.
+ *        The file stays open until the edit is closed.
+ * 
+ * @param filepath a path to a file
+ * @param edit will be set to the new edit
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Edit_open(const char* filepath, SAUCE_Edit** edit) {
+  if (filepath == NULL || edit == NULL) {
+    SAUCE_SET_ERROR("Filepath or edit pointer was NULL");
+    return SAUCE_ENULL;
+  }
+
+  #ifdef FD_IO_IS_DEFINED
+  int fd = SAUCE_fd_open(filepath, FD_OPEN_WRITE);
+  if (fd < 0) {
+    SAUCE_SET_ERROR("Failed to open %s for reading & writing", filepath);
+    return SAUCE_EFOPEN;
+  }
+  #else
+  // the file is opened again when the edit is committed
+  int fd = -1;
+  FILE* file = fopen(filepath, "rb+");
+  if (file == NULL) {
+    SAUCE_SET_ERROR("Failed to open %s for reading & writing", filepath);
+    return SAUCE_EFOPEN;
+  }
+  fclose(file);
+  #endif
+
+  // the path is kept right after the edit
+  size_t length = strlen(filepath) + 1;
+  SAUCE_Edit* e = SAUCE_calloc(1, sizeof(SAUCE_Edit) + length);
+  if (e == NULL) {
+    #ifdef FD_IO_IS_DEFINED
+    SAUCE_fd_close(fd);
+    #endif
+    SAUCE_SET_ERROR("Ran out of memory opening an edit of %s", filepath);
+    return SAUCE_EOTHER;
+  }
+  memcpy(e + 1, filepath, length);
+  e->path = (const char*)(e + 1);
+  e->fd = fd;
+  e->ownsFd = (fd >= 0);
+  *edit = e;
+  return 0;
+}
+
+
+/**
+ * @brief Open an edit of the SAUCE data of a file descriptor. Behaves like `SAUCE_Edit_open()`, except that the
+ *        file descriptor is not closed by the edit. The new data is written with positioned writes, so the file
+ *        offset of `fd` is not changed on POSIX systems.
+ * 
+ * @param fd a file descriptor open for reading and writing
+ * @param edit will be set to the new edit
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Edit_fd_open(int fd, SAUCE_Edit** edit) {
+  if (edit == NULL) {
+    SAUCE_SET_ERROR("Edit pointer was NULL");
+    return SAUCE_ENULL;
+  }
+  if (fd < 0) {
+    SAUCE_SET_ERROR("File descriptor %d is invalid", fd);
+    return SAUCE_EFOPEN;
+  }
+
+  #ifdef FD_IO_IS_DEFINED
+  SAUCE_Edit* e = SAUCE_calloc(1, sizeof(SAUCE_Edit));
+  if (e == NULL) {
+    SAUCE_SET_ERROR("Ran out of memory opening an edit");
+    return SAUCE_EOTHER;
+  }
+  e->fd = fd;
+  *edit = e;
+  return 0;
+  #else
+  SAUCE_SET_ERROR("File descriptor functions are not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
+}
+
+
+/**
+ * @brief Replace the record of a file when an edit is committed. If the file has no record, an EOF character and
+ *        the record are appended. The "Comments" field is ignored and is set from the comment the file ends up with.
+ * 
+ * @param edit an edit
+ * @param sauce the new record. It is copied, so it does not need to outlive the call.
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
  *         to get more info on the error.
  */
-int SAUCE_Comment_read(const char* buffer, uint32_t n, char* comment, uint8_t nLines) {
-  if (buffer == NULL) {
-    SAUCE_SET_ERROR("Buffer was null");
+int SAUCE_Edit_set_record(SAUCE_Edit* edit, const SAUCE* sauce) {
+  if (edit == NULL || sauce == NULL) {
+    SAUCE_SET_ERROR("Edit or SAUCE struct was NULL");
     return SAUCE_ENULL;
   }
-  if (comment == NULL) {
-    SAUCE_SET_ERROR("Comment string argment was null");
+
+  edit->record = *sauce;
+  edit->recordSet = 1;
+  return 0;
+}
+
+
+/**
+ * @brief Replace the comment of a file when an edit is committed. Setting a comment of 0 lines removes the comment.
+ * 
+ * @param edit an edit
+ * @param comment a comment buffer that is as least `SAUCE_COMMENT_STRING_LENGTH(lines)` bytes long. It is copied,
+ *                so it does not need to outlive the call.
+ * @param lines the number of lines to write
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Edit_set_comment(SAUCE_Edit* edit, const char* comment, uint8_t lines) {
+  if (edit == NULL || (comment == NULL && lines > 0)) {
+    SAUCE_SET_ERROR("Edit or comment string was NULL");
     return SAUCE_ENULL;
   }
-  if (n == 0) {
-    SAUCE_SET_ERROR("Buffer's length is 0, so nothing can be read");
-    return SAUCE_EEMPTY;
+
+  if (lines > 0) memcpy(edit->comment, comment, SAUCE_COMMENT_STRING_LENGTH(lines));
+  edit->lines = lines;
+  edit->commentSet = 1;
+  return 0;
+}
+
+
+/**
+ * @brief Remove the comment of a file when an edit is committed. It is not an error if the file has no comment.
+ * 
+ * @param edit an edit
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Edit_remove_comment(SAUCE_Edit* edit) {
+  return SAUCE_Edit_set_comment(edit, NULL, 0);
+}
+
+
+/**
+ * @brief Apply the changes collected by an edit. The tail of the file is read once, and the new SAUCE data is
+ *        written with a single write, followed by a truncate if it is shorter than the old data. Bytes of the SAUCE
+ *        data that do not change are not written again. Once committed, the edit has no changes left and can
+ *        collect new ones.
+ * 
+ *        A comment can only be set or removed if the file has a record or a record is set. If the file's comment
+ *        is invalid, it must be set or removed as well.
+ * 
+ * @param edit an edit
+ * @return 0 on success, or `SAUCE_UNCHANGED` if the file already matched the edit and nothing was written.
+ *         On error, a negative error code is returned and the file is left unchanged. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Edit_commit(SAUCE_Edit* edit) {
+  if (edit == NULL) {
+    SAUCE_SET_ERROR("Edit was NULL");
+    return SAUCE_ENULL;
   }
-  if (n < SAUCE_RECORD_SIZE) {
-    SAUCE_SET_ERROR("Buffer's length is too short to contain a record");
-    return SAUCE_ESHORT;
+  if (!edit->recordSet && !edit->commentSet) return SAUCE_UNCHANGED;
+
+  #ifdef FD_IO_IS_DEFINED
+  char name[FD_NAME_SIZE];
+  const char* path = edit->path;
+  if (path == NULL) {
+    SAUCE_fd_name(edit->fd, name);
+    path = name;
   }
+  int res = SAUCE_fd_commit_edit(edit->fd, path, edit);
+  #else
+  int res = SAUCE_file_commit_edit(edit->path, edit);
+  #endif
+  if (res < 0) return res;
 
-  // find the SAUCE id
-  if (memcmp(&buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_ID, 5) != 0) {
-    SAUCE_SET_ERROR("Could not find the SAUCE id in the buffer");
-    return SAUCE_ERMISS;
+  edit->recordSet = 0;
+  edit->commentSet = 0;
+  return res;
+}
+
+
+/**
+ * @brief Free an edit, closing its file if it was opened by `SAUCE_Edit_open()`. Changes that were not
+ *        committed are dropped.
+ * 
+ * @param edit an edit, or NULL
+ */
+void SAUCE_Edit_close(SAUCE_Edit* edit) {
+  if (edit == NULL) return;
+  #ifdef FD_IO_IS_DEFINED
+  if (edit->ownsFd) SAUCE_fd_close(edit->fd);
+  #endif
+  SAUCE_free(edit);
+}
+
+
+
+
+
+// Cache Functions
+
+/**
+ * @brief Open a cache and load the entries saved in `filepath`. If the file does not exist, or was
+ *        written by a different version of SauceTool or on a different platform, the cache starts
+ *        out empty. The file is not changed until `SAUCE_Cache_save()` is called.
+ * 
+ * @param filepath path to the cache file
+ * @param cache will be set to the new cache
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Cache_open(const char* filepath, SAUCE_Cache** cache) {
+  if (filepath == NULL) {
+    SAUCE_SET_ERROR("Cache filepath was NULL");
+    return SAUCE_ENULL;
+  }
+  if (cache == NULL) {
+    SAUCE_SET_ERROR("Cache pointer was NULL");
+    return SAUCE_ENULL;
   }
+  *cache = NULL;
 
-  // get total lines from record
-  uint8_t totalLines = ((SAUCE*)(&buffer[n - SAUCE_RECORD_SIZE]))->Comments;
-  if (totalLines > 0 && n < SAUCE_TOTAL_SIZE(totalLines)) {
-    SAUCE_SET_ERROR("Record claims that buffer contains %u comment lines, but the buffer is too short to contain that many lines", totalLines);
-    return SAUCE_ESHORT;
+  #ifdef CACHE_IS_DEFINED
+  SAUCE_Cache* newCache = SAUCE_calloc(1, sizeof(SAUCE_Cache));
+  if (newCache == NULL) {
+    SAUCE_SET_ERROR("Failed to allocate a cache for %s", filepath);
+    return SAUCE_EOTHER;
+  }
+  newCache->path = SAUCE_malloc(strlen(filepath) + 1);
+  newCache->capacity = CACHE_MIN_CAPACITY;
+  newCache->slots = SAUCE_calloc(CACHE_MIN_CAPACITY, sizeof(SAUCECacheEntry));
+  if (newCache->path == NULL || newCache->slots == NULL || pthread_mutex_init(&newCache->lock, NULL) != 0) {
+    SAUCE_free(newCache->path);
+    SAUCE_free(newCache->slots);
+    SAUCE_free(newCache);
+    SAUCE_SET_ERROR("Failed to allocate a cache for %s", filepath);
+    return SAUCE_EOTHER;
   }
+  strcpy(newCache->path, filepath);
 
-  // determine num of lines to read
-  nLines = (totalLines > nLines) ? nLines : totalLines;
+  FILE* file = fopen(filepath, "rb");
+  if (file == NULL && errno != ENOENT) {
+    SAUCE_Cache_close(newCache);
+    SAUCE_SET_ERROR("Failed to open cache file %s", filepath);
+    return SAUCE_EFOPEN;
+  }
 
-  // check if no lines need to or can be read
-  if (nLines == 0) {
-    comment[0] = 0; // add null character
-    return 0;
+  // a file that cannot be used is replaced on the next save
+  SAUCECacheHeader header;
+  if (file != NULL && fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.id, CACHE_ID, sizeof(header.id)) == 0 &&
+      header.version == CACHE_VERSION && header.entrySize == sizeof(SAUCECacheEntry)) {
+    SAUCECacheEntry entry;
+    for (uint64_t i = 0; i < header.count && fread(&entry, sizeof(entry), 1, file) == 1; i++) {
+      if (!entry.used) continue;
+      entry.seen = 0;
+      if (SAUCE_cache_insert(newCache, &entry) < 0) break;
+    }
   }
+  if (file != NULL) fclose(file);
 
-  // check for COMNT id
-  if (memcmp(&buffer[n-SAUCE_TOTAL_SIZE(totalLines)], SAUCE_COMMENT_ID, 5) != 0) {
-    SAUCE_SET_ERROR("Record in buffer indicated that %u total comment lines could be read, but the comment id could not be found", totalLines);
-    return SAUCE_ECMISS;
+  *cache = newCache;
+  return 0;
+  #else
+  SAUCE_SET_ERROR("Caching is not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
+}
+
+
+/**
+ * @brief Write every entry of a cache to its file. The entries are written to a temporary file
+ *        that then replaces the cache file, so the file is never left half written.
+ * 
+ * @param cache a cache
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Cache_save(SAUCE_Cache* cache) {
+  if (cache == NULL) {
+    SAUCE_SET_ERROR("Cache was NULL");
+    return SAUCE_ENULL;
   }
 
-  // retrieve the comment
-  memcpy(comment, &buffer[n-SAUCE_TOTAL_SIZE(totalLines)+5], SAUCE_COMMENT_STRING_LENGTH(nLines));
-  comment[SAUCE_COMMENT_STRING_LENGTH(nLines)] = 0;
-  return nLines;
+  #ifdef CACHE_IS_DEFINED
+  size_t length = strlen(cache->path);
+  char* tempPath = SAUCE_malloc(length + 5);
+  if (tempPath == NULL) {
+    SAUCE_SET_ERROR("Failed to allocate a path for saving %s", cache->path);
+    return SAUCE_EOTHER;
+  }
+  memcpy(tempPath, cache->path, length);
+  memcpy(tempPath + length, ".tmp", 5);
+
+  FILE* file = fopen(tempPath, "wb");
+  if (file == NULL) {
+    SAUCE_free(tempPath);
+    SAUCE_SET_ERROR("Failed to open a temporary file for saving %s", cache->path);
+    return SAUCE_EFOPEN;
+  }
+
+  SAUCECacheHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.id, CACHE_ID, sizeof(header.id));
+  header.version = CACHE_VERSION;
+  header.entrySize = sizeof(SAUCECacheEntry);
+
+  pthread_mutex_lock(&cache->lock);
+  header.count = cache->count;
+  int written = fwrite(&header, sizeof(header), 1, file) == 1;
+  for (uint32_t i = 0; written && i < cache->capacity; i++) {
+    if (cache->slots[i].used) written = fwrite(&cache->slots[i], sizeof(SAUCECacheEntry), 1, file) == 1;
+  }
+  pthread_mutex_unlock(&cache->lock);
+
+  if (fclose(file) != 0) written = 0;
+  if (!written || rename(tempPath, cache->path) != 0) {
+    remove(tempPath);
+    SAUCE_free(tempPath);
+    SAUCE_SET_ERROR("Failed to write cache file %s", cache->path);
+    return SAUCE_EFFAIL;
+  }
+
+  SAUCE_free(tempPath);
+  return 0;
+  #else
+  SAUCE_SET_ERROR("Caching is not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
 }
 
 
+/**
+ * @brief Remove the entries of every file that was not read or looked up since the cache was opened.
+ * 
+ * @param cache a cache
+ * @return On success, the number of entries removed. On error, a negative error code is returned.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_Cache_prune(SAUCE_Cache* cache) {
+  if (cache == NULL) {
+    SAUCE_SET_ERROR("Cache was NULL");
+    return SAUCE_ENULL;
+  }
+
+  #ifdef CACHE_IS_DEFINED
+  pthread_mutex_lock(&cache->lock);
+  SAUCECacheEntry* slots = SAUCE_calloc(cache->capacity, sizeof(SAUCECacheEntry));
+  if (slots == NULL) {
+    pthread_mutex_unlock(&cache->lock);
+    SAUCE_SET_ERROR("Failed to allocate a table for pruning %s", cache->path);
+    return SAUCE_EOTHER;
+  }
 
+  // move the entries that were seen into a new table
+  SAUCECacheEntry* old = cache->slots;
+  uint32_t oldCount = cache->count;
+  cache->slots = slots;
+  cache->count = 0;
+  for (uint32_t i = 0; i < cache->capacity; i++) {
+    if (old[i].used && old[i].seen) {
+      cache->slots[SAUCE_cache_slot(cache, old[i].dev, old[i].ino)] = old[i];
+      cache->count++;
+    }
+  }
+  int64_t removed = (int64_t)oldCount - cache->count;
+  pthread_mutex_unlock(&cache->lock);
 
+  SAUCE_free(old);
+  return removed;
+  #else
+  SAUCE_SET_ERROR("Caching is not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
+}
 
-// Write Functions
 
 /**
- * @brief Write a SAUCE record to a file. If the file already contains a SAUCE record, the record will be replaced.
- *        An EOF character will be added if the file previously did not contain a SAUCE record.
+ * @brief Free a cache without saving it. If it is the cache used by the file functions, they
+ *        stop using a cache. Other contexts using the cache must stop using it first.
  * 
- * @param filepath a path to a file
- * @param sauce a SAUCE struct
+ * @param cache a cache, or NULL
+ */
+void SAUCE_Cache_close(SAUCE_Cache* cache) {
+  #ifdef CACHE_IS_DEFINED
+  if (cache == NULL) return;
+  if (default_options.cache == cache) default_options.cache = NULL;
+  if (current_context != NULL && current_context->options.cache == cache) current_context->options.cache = NULL;
+
+  pthread_mutex_destroy(&cache->lock);
+  SAUCE_free(cache->slots);
+  SAUCE_free(cache->path);
+  SAUCE_free(cache);
+  #else
+  (void)cache;
+  #endif
+}
+
+
+
+
+
+// Watch Functions
+
+/**
+ * @brief Start watching a directory tree for files that are written, moved, or deleted. Directories that
+ *        are created in the tree are watched as well.
+ * 
+ * @param root path to the root directory
+ * @param options options for the watcher. If NULL, every option will be 0.
+ * @param watcher will be set to the new watcher
  * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
  *         to get more info on the error.
  */
-int SAUCE_fwrite(const char* filepath, const SAUCE* sauce) {
-  // null checks
-  if (filepath == NULL) {
-    SAUCE_SET_ERROR("Filepath was NULL");
+int SAUCE_Watcher_open(const char* root, const SAUCE_WatchOptions* options, SAUCE_Watcher** watcher) {
+  if (root == NULL) {
+    SAUCE_SET_ERROR("Root directory was NULL");
     return SAUCE_ENULL;
   }
-  if (sauce == NULL) {
-    SAUCE_SET_ERROR("SAUCE struct was NULL");
+  if (watcher == NULL) {
+    SAUCE_SET_ERROR("Watcher pointer was NULL");
     return SAUCE_ENULL;
   }
+  *watcher = NULL;
 
-  SAUCEInfo info;
-  char* buffer = NULL; // Note: if allocated, will be freed by free(writeBuffer) call
-  int res = SAUCE_file_get_info(filepath, &info, NULL, &buffer);
-  if (res < 0 && info.record_exists) return res;
+  #ifdef WATCH_IS_DEFINED
+  SAUCE_Watcher* newWatcher = SAUCE_calloc(1, sizeof(SAUCE_Watcher));
+  if (newWatcher == NULL) {
+    SAUCE_SET_ERROR("Failed to allocate a watcher for %s", root);
+    return SAUCE_EOTHER;
+  }
+  newWatcher->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (options != NULL) newWatcher->options = *options;
+  uint32_t delay = (newWatcher->options.delay_ms > 0) ? newWatcher->options.delay_ms : WATCH_DEFAULT_DELAY;
+  newWatcher->delay = (int64_t)delay * 1000000;
+
+  newWatcher->root = SAUCE_malloc(strlen(root) + 1);
+  newWatcher->dirsCapacity = 64;
+  newWatcher->dirs = SAUCE_calloc(newWatcher->dirsCapacity, sizeof(char*));
+  newWatcher->pendingCapacity = 16;
+  newWatcher->pending = SAUCE_malloc(newWatcher->pendingCapacity * sizeof(SAUCEWatchPending));
+  newWatcher->indexCapacity = 64;
+  newWatcher->index = SAUCE_calloc(newWatcher->indexCapacity, sizeof(uint32_t));
+  if (newWatcher->fd < 0 || newWatcher->root == NULL || newWatcher->dirs == NULL || newWatcher->pending == NULL ||
+      newWatcher->index == NULL) {
+    int noInotify = newWatcher->fd < 0;
+    SAUCE_Watcher_close(newWatcher);
+    if (noInotify) {
+      SAUCE_SET_ERROR("Failed to create an inotify instance for %s", root);
+    } else {
+      SAUCE_SET_ERROR("Failed to allocate a watcher for %s", root);
+    }
+    return SAUCE_EOTHER;
+  }
+  strcpy(newWatcher->root, root);
 
-  uint32_t bufLen = SAUCE_TOTAL_SIZE(info.lines);
+  int res = SAUCE_watch_add_tree(newWatcher, root, 0, SAUCE_watch_now());
+  if (res < 0) {
+    SAUCE_Watcher_close(newWatcher);
+    if (res == SAUCE_EFOPEN) {
+      SAUCE_SET_ERROR("Failed to watch directory %s", root);
+    } else {
+      SAUCE_SET_ERROR("Ran out of inotify watches or memory while watching %s", root);
+    }
+    return res;
+  }
 
-  char* writeBuffer;
-  if (info.record_exists) {
-    // prepare to replace record
-    writeBuffer = buffer;
-    memcpy(writeBuffer + (bufLen - SAUCE_RECORD_SIZE + 5), &(sauce->Version), SAUCE_RECORD_SIZE-5);
-    ((SAUCE*)(&writeBuffer[bufLen - SAUCE_RECORD_SIZE]))->Comments = info.lines;
-  } else {
-    // prepare to append record
-    if (buffer != NULL) free(buffer);
-    writeBuffer = malloc(SAUCE_RECORD_SIZE);
-    bufLen = SAUCE_RECORD_SIZE;
-    memcpy(writeBuffer, SAUCE_RECORD_ID, 5);
-    memcpy(writeBuffer+5, &(sauce->Version), SAUCE_RECORD_SIZE-5);
-    ((SAUCE*)writeBuffer)->Comments = 0;
+  *watcher = newWatcher;
+  return 0;
+  #else
+  (void)options;
+  SAUCE_SET_ERROR("Watching directory trees is not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
+}
+
+
+/**
+ * @brief Wait for files in a watched tree to change, and report them to `callback`. Events for the same file
+ *        are coalesced, and a file is only read once it has gone without events for the watcher's delay.
+ * 
+ * @param watcher a watcher
+ * @param timeout_ms the longest time to wait in milliseconds, or a negative value to wait without a limit
+ * @param callback function called for every event
+ * @param data passed to every call of `callback`
+ * @return On success, the number of events reported. 0 is returned if the timeout passed or a signal
+ *         interrupted the wait. On error, a negative error code is returned. Use `SAUCE_get_error()` to get
+ *         more info on the error.
+ */
+int64_t SAUCE_Watcher_poll(SAUCE_Watcher* watcher, int timeout_ms, SAUCE_WatchCallback callback, void* data) {
+  if (watcher == NULL) {
+    SAUCE_SET_ERROR("Watcher was NULL");
+    return SAUCE_ENULL;
+  }
+  if (callback == NULL) {
+    SAUCE_SET_ERROR("Callback was NULL");
+    return SAUCE_ENULL;
   }
 
-  // prepare file for writing
-  FILE* file;
-  if (info.record_exists) {
-    // will need to replace record
-    file = fopen(filepath, "rb+");
-    if (file == NULL) {
-      free(writeBuffer);
-      SAUCE_SET_ERROR("Failed to open %s for reading & writing", filepath);
-      return SAUCE_EFOPEN;
+  #ifdef WATCH_IS_DEFINED
+  int64_t deadline = (timeout_ms >= 0) ? SAUCE_watch_now() + (int64_t)timeout_ms * 1000000 : -1;
+  int64_t reported = 0;
+
+  while (1) {
+    int res = SAUCE_watch_read_events(watcher);
+    if (res < 0) {
+      if (res == SAUCE_EFFAIL) {
+        SAUCE_SET_ERROR("Failed to read the events of %s", watcher->root);
+      } else {
+        SAUCE_SET_ERROR("Ran out of memory while watching %s", watcher->root);
+      }
+      return res;
     }
-    if (fseek(file, info.start, SEEK_SET) < 0) { // seek to beginning of SAUCE data
-      fclose(file);
-      free(writeBuffer);
-      SAUCE_SET_ERROR("Failed to seek to eof character in %s", filepath);
-      return SAUCE_EFFAIL;
+
+    int64_t now = SAUCE_watch_now();
+    if (SAUCE_watch_report(watcher, now, callback, data, &reported) != 0 || reported > 0) return reported;
+
+    // sleep until the next event, the next pending path is due, or the timeout passes
+    int64_t wait = -1;
+    for (uint32_t i = 0; i < watcher->pendingCount; i++) {
+      int64_t untilDue = watcher->pending[i].due - now;
+      if (wait < 0 || untilDue < wait) wait = untilDue;
     }
-  } else {
-    // will need to append record
-    file = fopen(filepath, "ab");
-    if (file == NULL) {
-      free(writeBuffer);
-      SAUCE_SET_ERROR("Failed to open %s for appending", filepath);
-      return SAUCE_EFOPEN;
+    if (deadline >= 0) {
+      if (now >= deadline) return 0;
+      if (wait < 0 || deadline - now < wait) wait = deadline - now;
     }
-  }
 
-  // write eof if needed
-  size_t write;
-  if (!info.eof_exists) {
-    char eof_char = SAUCE_EOF_CHAR;
-    write = fwrite(&eof_char, 1, 1, file);
-    if (write != 1) {
-      fclose(file);
-      free(writeBuffer);
-      SAUCE_SET_ERROR("Failed to write eof character to %s", filepath);
+    struct pollfd pfd;
+    pfd.fd = watcher->fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    int64_t waitMs = (wait < 0) ? -1 : (wait + 999999) / 1000000;
+    if (waitMs > INT_MAX) waitMs = INT_MAX;
+    if (poll(&pfd, 1, (int)waitMs) < 0) {
+      if (errno == EINTR) return 0;
+      SAUCE_SET_ERROR("Failed to wait for the events of %s", watcher->root);
       return SAUCE_EFFAIL;
     }
   }
+  #else
+  (void)timeout_ms;
+  (void)data;
+  SAUCE_SET_ERROR("Watching directory trees is not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
+}
 
-  // write the new buffer to the file
-  write = fwrite(writeBuffer, 1, bufLen, file);
-  fclose(file);
-  free(writeBuffer);
-  if (write != bufLen) {
-    SAUCE_SET_ERROR("Failed to write SAUCE data to %s", filepath);
-    return SAUCE_EFFAIL;
+
+/**
+ * @brief Get the file descriptor a watcher receives events on, which becomes readable when files change.
+ * 
+ * @param watcher a watcher
+ * @return the file descriptor, or a negative error code on error
+ */
+int SAUCE_Watcher_fd(const SAUCE_Watcher* watcher) {
+  if (watcher == NULL) {
+    SAUCE_SET_ERROR("Watcher was NULL");
+    return SAUCE_ENULL;
   }
 
-  return 0;
+  #ifdef WATCH_IS_DEFINED
+  return watcher->fd;
+  #else
+  SAUCE_SET_ERROR("Watching directory trees is not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
 }
 
 
 /**
- * @brief Write a SAUCE CommentBlock to a file, replacing a CommentBlock if one already exists.
- *        The "Comments" field of the file's SAUCE record will be updated to `lines`.
- *        
+ * @brief Stop watching a tree and free the watcher. Events that were not reported are discarded.
  * 
- * @param filepath a path to a file
- * @param comment a comment buffer that is as least `SAUCE_COMMENT_STRING_LENGTH(lines)` bytes long
- * @param lines the number of lines to write
+ * @param watcher a watcher, or NULL
+ */
+void SAUCE_Watcher_close(SAUCE_Watcher* watcher) {
+  #ifdef WATCH_IS_DEFINED
+  if (watcher == NULL) return;
+
+  if (watcher->fd >= 0) SAUCE_fd_close(watcher->fd);
+  for (uint32_t i = 0; watcher->dirs != NULL && i < watcher->dirsCapacity; i++) SAUCE_free(watcher->dirs[i]);
+  for (uint32_t i = 0; i < watcher->pendingCount; i++) SAUCE_free(watcher->pending[i].path);
+  SAUCE_free(watcher->dirs);
+  SAUCE_free(watcher->pending);
+  SAUCE_free(watcher->index);
+  SAUCE_free(watcher->root);
+  SAUCE_free(watcher);
+  #else
+  (void)watcher;
+  #endif
+}
+
+
+
+
+
+// Batch Functions
+
+/**
+ * @brief Create an empty columnar batch of records.
+ * 
+ * @param capacity the number of records to make room for. The batch grows as records are appended.
+ * @param batch will be set to the new batch
  * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
  *         to get more info on the error.
  */
-int SAUCE_Comment_fwrite(const char* filepath, const char* comment, uint8_t lines) {
-  if (filepath == NULL) {
-    SAUCE_SET_ERROR("Filepath was NULL");
-    return SAUCE_ENULL;
-  }
-  if (comment == NULL) {
-    SAUCE_SET_ERROR("Comment string argument was NULL");
+int SAUCE_Batch_create(uint64_t capacity, SAUCE_Batch** batch) {
+  if (batch == NULL) {
+    SAUCE_SET_ERROR("Batch pointer was NULL");
     return SAUCE_ENULL;
   }
+  *batch = NULL;
 
-  if (lines == 0) return 0;
-
-  SAUCEInfo info;
-  int32_t filesize = 0;
-  char* buffer = NULL;
-  int res = SAUCE_file_get_info(filepath, &info, &filesize, &buffer);
-  if (res < 0 && !info.record_exists) return res; // we can continue as long as the record exists
+  SAUCE_Batch* newBatch = SAUCE_calloc(1, sizeof(SAUCE_Batch));
+  if (newBatch == NULL || SAUCE_batch_reserve(newBatch, (capacity > 0) ? capacity : 64) < 0) {
+    SAUCE_Batch_free(newBatch);
+    SAUCE_SET_ERROR("Failed to allocate a batch of %llu records", (unsigned long long)capacity);
+    return SAUCE_EOTHER;
+  }
 
-  // copy record
-  char record[SAUCE_RECORD_SIZE];
-  memcpy(record, &buffer[info.sauce_length - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
+  *batch = newBatch;
+  return 0;
+}
 
-  // construct new SAUCE data
-  uint32_t bufLen = SAUCE_TOTAL_SIZE(lines);
-  free(buffer);
-  buffer = malloc(bufLen);
-  memcpy(buffer, SAUCE_COMMENT_ID, 5);
-  memcpy(buffer+5, comment, SAUCE_COMMENT_STRING_LENGTH(lines));
-  memcpy(buffer+SAUCE_COMMENT_BLOCK_SIZE(lines), record, SAUCE_RECORD_SIZE);
-  ((SAUCE*)(&buffer[SAUCE_COMMENT_BLOCK_SIZE(lines)]))->Comments = lines;
 
-  // prep file for writing
-  FILE* file;
-  if (info.comment_exists && info.lines > lines) {
-    // file will be shorter, truncate it
-    res = SAUCE_file_truncate(filepath, filesize, info.sauce_length, &file);
-    if (res < 0) {
-      free(buffer);
-      return res;
-    }
-  } else {
-    file = fopen(filepath, "rb+");
-    if (file == NULL) {
-      free(buffer);
-      SAUCE_SET_ERROR("Failed to open %s for reading and writing", filepath);
-      return SAUCE_EFOPEN;
-    }
-    if (fseek(file, filesize - info.sauce_length, SEEK_SET) < 0) {
-      fclose(file);
-      free(buffer);
-      SAUCE_SET_ERROR("Failed to seek to beginning of original SAUCE data in %s", filepath);
-      return SAUCE_EFFAIL;
-    }
+/**
+ * @brief Append records to the end of a batch, splitting each record into the batch's columns.
+ * 
+ * @param batch a batch
+ * @param records an array of `count` records
+ * @param count the number of records to append
+ * @return 0 on success. On error, a negative error code is returned and the batch is not changed.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int SAUCE_Batch_append(SAUCE_Batch* batch, const SAUCE* records, uint64_t count) {
+  if (batch == NULL) {
+    SAUCE_SET_ERROR("Batch was NULL");
+    return SAUCE_ENULL;
   }
-
-  // write an eof character if needed
-  size_t write;
-  if (!info.eof_exists) {
-    char eof_char = SAUCE_EOF_CHAR;
-    write = fwrite(&eof_char, 1, 1, file);
-    if (write != 1) {
-      fclose(file);
-      free(buffer);
-      SAUCE_SET_ERROR("Failed to write eof character to %s", filepath);
-      return SAUCE_EFFAIL;
-    }
+  if (records == NULL && count > 0) {
+    SAUCE_SET_ERROR("Records were NULL");
+    return SAUCE_ENULL;
   }
-
-  // write buffer to file
-  res = fwrite(buffer, 1, bufLen, file);
-  fclose(file);
-  free(buffer);
-  if (res != bufLen) {
-    SAUCE_SET_ERROR("Failed to write new comment and record to %s", filepath);
-    return SAUCE_EFFAIL;
+  if (count > UINT64_MAX - batch->count || SAUCE_batch_reserve(batch, batch->count + count) < 0) {
+    SAUCE_SET_ERROR("Failed to grow a batch of %llu records by %llu records", (unsigned long long)batch->count,
+                    (unsigned long long)count);
+    return SAUCE_EOTHER;
   }
 
+  for (uint64_t i = 0; i < count; i++) {
+    const SAUCE* sauce = &records[i];
+    uint64_t at = batch->count + i;
+    batch->DataType[at] = sauce->DataType;
+    batch->FileType[at] = sauce->FileType;
+    batch->Comments[at] = sauce->Comments;
+    batch->TFlags[at] = sauce->TFlags;
+    batch->TInfo1[at] = sauce->TInfo1;
+    batch->TInfo2[at] = sauce->TInfo2;
+    batch->TInfo3[at] = sauce->TInfo3;
+    batch->TInfo4[at] = sauce->TInfo4;
+    batch->FileSize[at] = sauce->FileSize;
+    batch->Date[at] = SAUCE_batch_date(sauce->Date);
+    memcpy(batch->DateText + at * sizeof(sauce->Date), sauce->Date, sizeof(sauce->Date));
+    memcpy(batch->Version + at * sizeof(sauce->Version), sauce->Version, sizeof(sauce->Version));
+    memcpy(batch->Title + at * sizeof(sauce->Title), sauce->Title, sizeof(sauce->Title));
+    memcpy(batch->Author + at * sizeof(sauce->Author), sauce->Author, sizeof(sauce->Author));
+    memcpy(batch->Group + at * sizeof(sauce->Group), sauce->Group, sizeof(sauce->Group));
+    memcpy(batch->TInfoS + at * sizeof(sauce->TInfoS), sauce->TInfoS, sizeof(sauce->TInfoS));
+  }
+  batch->count += count;
   return 0;
 }
 
 
 /**
- * @brief Write a SAUCE record to a buffer. 
- * 
- * 
- *        If the last 128 bytes of the buffer (bytes `n-1` to `n-128`)
- *        contain a SAUCE record, the buffer's SAUCE record will be replaced. Otherwise, an EOF character and
- *        the new SAUCE record will be appended to the buffer at index `n`.
- *        Important! - To prevent a buffer overflow error when appending a new record, 
- *        the buffer's actual size must be at least n + 129 bytes (the size of a SAUCE record including an EOF character).
+ * @brief Gather a record of a batch back into a SAUCE struct. The ID is set to `SAUCE_RECORD_ID`.
  * 
- * @param buffer pointer to buffer
- * @param n the length of the buffer
- * @param sauce a SAUCE struct
- * @return On success, the new length of the buffer is returned. On error, a negative error code
- *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ * @param batch a batch
+ * @param index the index of the record
+ * @param sauce a SAUCE struct that will be filled with the record
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
  */
-int SAUCE_write(char* buffer, uint32_t n, const SAUCE* sauce) {
-  // null checks
-  if (buffer == NULL) {
-    SAUCE_SET_ERROR("Buffer was NULL");
+int SAUCE_Batch_get(const SAUCE_Batch* batch, uint64_t index, SAUCE* sauce) {
+  if (batch == NULL) {
+    SAUCE_SET_ERROR("Batch was NULL");
     return SAUCE_ENULL;
   }
   if (sauce == NULL) {
-    SAUCE_SET_ERROR("SAUCE struct was NULL");
+    SAUCE_SET_ERROR("SAUCE struct pointer was NULL");
     return SAUCE_ENULL;
   }
-
-  uint32_t len = n;
-
-  // check the size of the buffer
-  if (n >= SAUCE_RECORD_SIZE) {
-    // look for SAUCE id
-    if (memcmp(&buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_ID, 5) == 0) {
-      goto replace; // there is a record, replace it
-    }
-    goto append; // there is no record, append the new record
-  } else {
-    goto append; // buffer to short to have record, append the new record
+  if (index >= batch->count) {
+    SAUCE_SET_ERROR("Index %llu is past the %llu records of the batch", (unsigned long long)index,
+                    (unsigned long long)batch->count);
+    return SAUCE_EOTHER;
   }
 
+  memcpy(sauce->ID, SAUCE_RECORD_ID, sizeof(sauce->ID));
+  memcpy(sauce->Version, batch->Version + index * sizeof(sauce->Version), sizeof(sauce->Version));
+  memcpy(sauce->Title, batch->Title + index * sizeof(sauce->Title), sizeof(sauce->Title));
+  memcpy(sauce->Author, batch->Author + index * sizeof(sauce->Author), sizeof(sauce->Author));
+  memcpy(sauce->Group, batch->Group + index * sizeof(sauce->Group), sizeof(sauce->Group));
+  memcpy(sauce->Date, batch->DateText + index * sizeof(sauce->Date), sizeof(sauce->Date));
+  sauce->FileSize = batch->FileSize[index];
+  sauce->DataType = batch->DataType[index];
+  sauce->FileType = batch->FileType[index];
+  sauce->TInfo1 = batch->TInfo1[index];
+  sauce->TInfo2 = batch->TInfo2[index];
+  sauce->TInfo3 = batch->TInfo3[index];
+  sauce->TInfo4 = batch->TInfo4[index];
+  sauce->Comments = batch->Comments[index];
+  sauce->TFlags = batch->TFlags[index];
+  memcpy(sauce->TInfoS, batch->TInfoS + index * sizeof(sauce->TInfoS), sizeof(sauce->TInfoS));
+  return 0;
+}
 
-  // ===== Append a new record =====
-  append: {
-    // add eof
-    buffer[len] = SAUCE_EOF_CHAR;
-    len++;
 
-    memcpy(&buffer[len], SAUCE_RECORD_ID, 5);
-    len += 5;
-    memcpy(&buffer[len], ((uint8_t*)sauce)+5, SAUCE_RECORD_SIZE - 5);
-    len += (SAUCE_RECORD_SIZE - 5);
+/**
+ * @brief Select the records of a batch whose numeric `field` is equal to `value`. Bit `i % 64` of
+ *        `bitmap[i / 64]` is set if record `i` is selected, and every other bit is cleared.
+ * 
+ * @param batch a batch
+ * @param field a numeric SAUCE_Field
+ * @param value the value to compare with
+ * @param bitmap an array of at least `SAUCE_BITMAP_WORDS(batch->count)` words
+ * @return On success, the number of records selected. On error, a negative error code is returned.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_Batch_select_equal(const SAUCE_Batch* batch, enum SAUCE_Field field, uint32_t value, uint64_t* bitmap) {
+  return SAUCE_Batch_select_range(batch, field, value, value, bitmap);
+}
 
-    // set the Comments field to 0
-    ((SAUCE*)(&buffer[len-SAUCE_RECORD_SIZE]))->Comments = 0;
 
-    return len;
+/**
+ * @brief Select the records of a batch whose numeric `field` is between `min` and `max`, inclusive.
+ * 
+ * @param batch a batch
+ * @param field a numeric SAUCE_Field
+ * @param min the smallest value to select
+ * @param max the largest value to select
+ * @param bitmap an array of at least `SAUCE_BITMAP_WORDS(batch->count)` words
+ * @return On success, the number of records selected. On error, a negative error code is returned.
+ *         Use `SAUCE_get_error()` to get more info on the error.
+ */
+int64_t SAUCE_Batch_select_range(const SAUCE_Batch* batch, enum SAUCE_Field field, uint32_t min, uint32_t max, uint64_t* bitmap) {
+  if (batch == NULL) {
+    SAUCE_SET_ERROR("Batch was NULL");
+    return SAUCE_ENULL;
   }
-  // ===== end of append section =====
-
-  // ===== Replace the record =====
-  replace: {
-    // save Comments field
-    uint8_t lines = ((SAUCE*)(&buffer[len-SAUCE_RECORD_SIZE]))->Comments;
-
-    // replace the record
-    memcpy(&buffer[len - SAUCE_RECORD_SIZE], SAUCE_RECORD_ID, 5);
-    memcpy(&buffer[len - SAUCE_RECORD_SIZE + 5], ((uint8_t*)sauce)+5, SAUCE_RECORD_SIZE - 5);
-    
-    // set comments to original value
-    ((SAUCE*)(&buffer[len-SAUCE_RECORD_SIZE]))->Comments = lines;
-
-    // attempt to insert an EOF character
-    len = insert_eof_char(buffer, len, lines);
-
-    return len;
+  if (bitmap == NULL) {
+    SAUCE_SET_ERROR("Bitmap was NULL");
+    return SAUCE_ENULL;
   }
-  // ===== end of replace section =====
+  if ((int)field < 0 || (int)field >= BATCH_FIELD_COUNT || batch_columns[field].isString) {
+    SAUCE_SET_ERROR("Field %d is not a numeric field", (int)field);
+    return SAUCE_EOTHER;
+  }
+
+  return SAUCE_batch_select_range(batch, &batch_columns[field], min, max, bitmap);
 }
 
 
 /**
- * @brief Write a SAUCE CommentBlock to a buffer, replacing a CommentBlock if one already exists.
- *        The "Comments" field of the buffer's SAUCE record will be updated to `lines`.
- * 
- * 
- *        If the last 128 bytes of the buffer (bytes `n-1` to `n-128`)
- *        contain a SAUCE record, the CommentBlock will be written. Otherwise, an
- *        error will be returned. 
- *        Important! - To prevent a buffer overflow error when writing a new comment, 
- *        the buffer's actual size must be at least `n` + `SAUCE_COMMENT_BLOCK_SIZE(number of comment lines)`.
+ * @brief Select the records of a batch whose string `field` starts with `prefix`.
  * 
- * @param buffer pointer to buffer
- * @param n the length of the buffer
- * @param comment a comment buffer that is as least `SAUCE_COMMENT_STRING_LENGTH(lines)` bytes long
- * @param lines the number of lines to write
- * @return On success, the new length of the buffer is returned. On error, a negative error code
- *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ * @param batch a batch
+ * @param field a string SAUCE_Field
+ * @param prefix a null-terminated string
+ * @param bitmap an array of at least `SAUCE_BITMAP_WORDS(batch->count)` words
+ * @return On success, the number of records selected. On error, a negative error code is returned.
+ *         Use `SAUCE_get_error()` to get more info on the error.
  */
-int SAUCE_Comment_write(char* buffer, uint32_t n, const char* comment, uint8_t lines) {
-  if (buffer == NULL) {
-    SAUCE_SET_ERROR("Buffer was NULL");
+int64_t SAUCE_Batch_select_prefix(const SAUCE_Batch* batch, enum SAUCE_Field field, const char* prefix, uint64_t* bitmap) {
+  if (batch == NULL) {
+    SAUCE_SET_ERROR("Batch was NULL");
     return SAUCE_ENULL;
   }
-  if (comment == NULL) {
-    SAUCE_SET_ERROR("Comment string argument was NULL");
+  if (prefix == NULL) {
+    SAUCE_SET_ERROR("Prefix was NULL");
     return SAUCE_ENULL;
   }
-
-  if (n == 0) {
-    SAUCE_SET_ERROR("Buffer's length is zero and cannot contain a record");
-    return SAUCE_EEMPTY;
-  }
-  if (n < SAUCE_RECORD_SIZE) {
-    SAUCE_SET_ERROR("Buffer's length is too short to contain a record");
-    return SAUCE_ESHORT;
+  if (bitmap == NULL) {
+    SAUCE_SET_ERROR("Bitmap was NULL");
+    return SAUCE_ENULL;
   }
-
-  // find record
-  if (memcmp(&buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_ID, 5) != 0) {
-    SAUCE_SET_ERROR("Buffer does not contain a record");
-    return SAUCE_ERMISS;
+  if ((int)field < 0 || (int)field >= BATCH_FIELD_COUNT || !batch_columns[field].isString) {
+    SAUCE_SET_ERROR("Field %d is not a string field", (int)field);
+    return SAUCE_EOTHER;
   }
 
-  // return immediately if lines is 0
-  if (lines == 0) return n;
+  return SAUCE_batch_select_prefix(batch, &batch_columns[field], prefix, bitmap);
+}
 
-  // check if there is already an EOF character before record
-  int eof_exists = 0;
-  if (n > SAUCE_RECORD_SIZE && buffer[n - SAUCE_RECORD_SIZE - 1] == SAUCE_EOF_CHAR) eof_exists = 1;
 
-  // determine if there is a comment and if so, if there is an eof before the comment
-  uint8_t totalLines = ((SAUCE*)(&buffer[n - SAUCE_RECORD_SIZE]))->Comments;
-  int comment_exists = 1; // first assume comment exists
-  if (totalLines == 0) {
-    comment_exists = 0;
-  } else {
-    // comment could already exist
-    eof_exists = 0;
-    
-    // look for comment
-    if (n < SAUCE_TOTAL_SIZE(totalLines)) {
-      comment_exists = 0;
-    } else if (memcmp(&buffer[n - SAUCE_TOTAL_SIZE(totalLines)], SAUCE_COMMENT_ID, 5) != 0) {
-      comment_exists = 0;
-    }
+/**
+ * @brief Free a batch and its columns.
+ * 
+ * @param batch a batch, or NULL
+ */
+void SAUCE_Batch_free(SAUCE_Batch* batch) {
+  if (batch == NULL) return;
 
-    // look for eof char
-    if (comment_exists && n > SAUCE_TOTAL_SIZE(totalLines)) {
-      if (buffer[n - SAUCE_TOTAL_SIZE(totalLines) - 1] == SAUCE_EOF_CHAR) eof_exists = 1;
-    }
+  for (int i = 0; i < BATCH_COLUMN_COUNT; i++) {
+    SAUCE_free(*SAUCE_batch_column(batch, &batch_columns[i]));
   }
+  SAUCE_free(batch);
+}
 
-  // determine where to write
-  uint32_t write_index = 0;
-  if (comment_exists)
-    write_index = (eof_exists) ? n - SAUCE_TOTAL_SIZE(totalLines) - 1 : n - SAUCE_TOTAL_SIZE(totalLines);
-  else
-    write_index = (eof_exists) ? n - SAUCE_RECORD_SIZE - 1 : n - SAUCE_RECORD_SIZE;
-
-  // move record
-  memmove(&buffer[write_index+1+SAUCE_COMMENT_BLOCK_SIZE(lines)], &buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
 
-  // add eof
-  buffer[write_index] = SAUCE_EOF_CHAR;  
 
-  // write comment
-  memcpy(&buffer[write_index+1], SAUCE_COMMENT_ID, 5);
-  memcpy(&buffer[write_index+6], comment, SAUCE_COMMENT_STRING_LENGTH(lines));
+// Stream Functions
 
-  // update comments field
-  ((SAUCE*)(&buffer[write_index+1+SAUCE_COMMENT_BLOCK_SIZE(lines)]))->Comments = lines;
+/**
+ * @brief Open a stream that parses SAUCE data from content fed to it in chunks, such as content read from
+ *        a pipe or a socket. Only the last `SAUCE_MAX_TAIL_SIZE` bytes are kept. Content is passed on to
+ *        `callback` once it is too far from the end to be SAUCE data, so it is delayed by at most
+ *        `SAUCE_MAX_TAIL_SIZE` bytes. When the stream is finished, the rest of the content is passed on,
+ *        without the EOF character and SAUCE data.
+ * 
+ * @param callback receives the content of the stream in order, or NULL
+ * @param data passed to `callback`
+ * @param stream will be set to the new stream
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Stream_open(SAUCE_StreamCallback callback, void* data, SAUCE_Stream** stream) {
+  if (stream == NULL) {
+    SAUCE_SET_ERROR("Stream pointer was NULL");
+    return SAUCE_ENULL;
+  }
 
-  return write_index + 1 + SAUCE_TOTAL_SIZE(lines);
+  SAUCE_Stream* s = SAUCE_malloc(sizeof(SAUCE_Stream));
+  if (s == NULL) {
+    SAUCE_SET_ERROR("Ran out of memory opening a stream");
+    return SAUCE_EOTHER;
+  }
+  memset(s, 0, offsetof(SAUCE_Stream, ring));
+  s->callback = callback;
+  s->data = data;
+  *stream = s;
+  return 0;
 }
 
 
+/**
+ * @brief Feed the next chunk of content to a stream. Content that can no longer be SAUCE data is passed
+ *        to the stream's callback before returning. Bytes that are passed on are not copied.
+ * 
+ * @param stream a stream
+ * @param data the next chunk of content
+ * @param n the length of the chunk
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Stream_feed(SAUCE_Stream* stream, const char* data, size_t n) {
+  if (stream == NULL) {
+    SAUCE_SET_ERROR("Stream was NULL");
+    return SAUCE_ENULL;
+  }
+  if (data == NULL && n > 0) {
+    SAUCE_SET_ERROR("Data was NULL");
+    return SAUCE_ENULL;
+  }
+  if (stream->finished || stream->stopped) {
+    SAUCE_SET_ERROR("Cannot feed a stream that has finished or was stopped");
+    return SAUCE_EOTHER;
+  }
+  stream->total += n;
+
+  // everything but the last SAUCE_MAX_TAIL_SIZE bytes is content, oldest first
+  if ((uint64_t)stream->held + n > SAUCE_MAX_TAIL_SIZE) {
+    size_t excess = stream->held + n - SAUCE_MAX_TAIL_SIZE;
+    uint32_t fromRing = (excess < stream->held) ? (uint32_t)excess : stream->held;
+    if (SAUCE_stream_emit_ring(stream, fromRing) < 0) return SAUCE_EOTHER;
+
+    size_t fromData = excess - fromRing;
+    if (SAUCE_stream_emit(stream, data, fromData) < 0) return SAUCE_EOTHER;
+    data += fromData;
+    n -= fromData;
+  }
 
+  SAUCE_stream_push(stream, data, (uint32_t)n);
+  return 0;
+}
 
 
-// Remove Functions
-
 /**
- * @brief Remove a SAUCE record from a file, along with the SAUCE CommentBlock if one exists.
- *        The EOF character will be removed as well.
+ * @brief End a stream. The SAUCE data at the end of the stream is decoded, and the rest of the content,
+ *        not including the EOF character and SAUCE data, is passed to the stream's callback. Afterwards,
+ *        the record and comment can be read with `SAUCE_Stream_read()` and `SAUCE_Stream_Comment_read()`.
  * 
- * @param filepath a path to a file
+ *        If the stream contains no record, all of it is content.
+ * 
+ * @param stream a stream
+ * @param layout will be set to the layout of the stream, where `layout->content_length` is the number
+ *               of bytes passed to the callback. Can be NULL.
  * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
  *         to get more info on the error.
  */
-int SAUCE_fremove(const char* filepath) {
-  if (filepath == NULL) {
-    SAUCE_SET_ERROR("Filepath was NULL");
+int SAUCE_Stream_finish(SAUCE_Stream* stream, SAUCE_Layout* layout) {
+  if (layout != NULL) memset(layout, 0, sizeof(SAUCE_Layout));
+  if (stream == NULL) {
+    SAUCE_SET_ERROR("Stream was NULL");
     return SAUCE_ENULL;
   }
+  if (stream->finished || stream->stopped) {
+    SAUCE_SET_ERROR("Cannot finish a stream that has finished or was stopped");
+    return SAUCE_EOTHER;
+  }
+  stream->finished = 1;
+
+  // move the ring to the beginning of the buffer so that it can be decoded in place
+  if (stream->head != 0) {
+    char linear[SAUCE_MAX_TAIL_SIZE];
+    uint32_t first = SAUCE_MAX_TAIL_SIZE - stream->head;
+    if (first > stream->held) first = stream->held;
+    memcpy(linear, &stream->ring[stream->head], first);
+    memcpy(linear + first, stream->ring, stream->held - first);
+    memcpy(stream->ring, linear, stream->held);
+    stream->head = 0;
+  }
 
-  SAUCEInfo info;
-  int32_t filesize;
-  int res = SAUCE_file_get_info(filepath, &info, &filesize, NULL);
-  if (res < 0 && !info.record_exists) return res;
+  SAUCEInfo* info = &stream->info;
+  stream->result = SAUCE_set_info_error("The stream", SAUCE_decode_info(stream->ring, stream->held, info), info);
+  uint32_t content = stream->held;
+  if (info->record_exists) content = (uint32_t)info->start - (info->eof_exists ? 1 : 0);
 
-  if (info.eof_exists) info.sauce_length++;
-  res = SAUCE_file_truncate(filepath, filesize, info.sauce_length, NULL);
+  if (layout != NULL) {
+    SAUCE_info_layout(info, (int64_t)stream->held, layout);
+    int64_t offset = (int64_t)(stream->total - stream->held);
+    layout->start += offset;
+    layout->content_length += offset;
+  }
+
+  // the ring keeps its bytes so that the SAUCE data can still be read
+  int res = SAUCE_stream_emit(stream, stream->ring, content);
   if (res < 0) return res;
-  return 0;
+  return stream->result;
 }
 
 
 /**
- * @brief Remove a SAUCE CommentBlock from a file. The "Comments" field of the file's SAUCE
- *        record will be set to 0.
+ * @brief Read the record of a finished stream into `sauce`.
  * 
- * @param filepath a path to a file
+ * @param stream a stream finished with `SAUCE_Stream_finish()`
+ * @param sauce a SAUCE struct that will be filled with the record
  * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
  *         to get more info on the error.
  */
-int SAUCE_Comment_fremove(const char* filepath) {
-  SAUCEInfo info;
-  int32_t filesize;
-  char* buffer = NULL;
-  int res = SAUCE_file_get_info(filepath, &info, &filesize, &buffer);
-  if (res < 0 && !info.record_exists) return res;
-
-  // check if comment doesn't exist
-  if (!info.comment_exists) {
-    free(buffer);
-    if (info.lines == 0) {
-      SAUCE_SET_ERROR("%s contains zero comment lines, so no comment can be removed", filepath);
-    }
-    return SAUCE_ECMISS;
+int SAUCE_Stream_read(const SAUCE_Stream* stream, SAUCE* sauce) {
+  if (stream == NULL || sauce == NULL) {
+    SAUCE_SET_ERROR("Stream or SAUCE struct was NULL");
+    return SAUCE_ENULL;
+  }
+  if (!stream->finished) {
+    SAUCE_SET_ERROR("The stream has not finished");
+    return SAUCE_EOTHER;
   }
 
-  // copy record
-  char record[SAUCE_RECORD_SIZE];
-  memcpy(record, &buffer[info.sauce_length - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
-  free(buffer);
-  ((SAUCE*)record)->Comments = 0;
+  const SAUCEInfo* info = &stream->info;
+  if (!info->record_exists) return SAUCE_set_info_error("The stream", stream->result, info);
+  memcpy(sauce, &stream->ring[stream->held - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
+  return 0;
+}
 
-  // prep file for writing
-  FILE* file;
-  res = SAUCE_file_truncate(filepath, filesize, info.sauce_length, &file);
-  if (res < 0) return res;
 
-  // write an eof character if needed
-  size_t write;
-  if (!info.eof_exists) {
-    char eof_char = SAUCE_EOF_CHAR;
-    write = fwrite(&eof_char, 1, 1, file);
-    if (write != 1) {
-      fclose(file);
-      SAUCE_SET_ERROR("Failed to write eof character to %s", filepath);
-      return SAUCE_EFFAIL;
-    }
+/**
+ * @brief Read at most `nLines` of the comment of a finished stream into `comment`, followed by a null character.
+ * 
+ * @param stream a stream finished with `SAUCE_Stream_finish()`
+ * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(nLines) + 1` that will contain the comment
+ * @param nLines the number of lines to read
+ * @return On success, the number of lines read. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Stream_Comment_read(const SAUCE_Stream* stream, char* comment, uint8_t nLines) {
+  if (stream == NULL || comment == NULL) {
+    SAUCE_SET_ERROR("Stream or comment string was NULL");
+    return SAUCE_ENULL;
   }
-
-  // write buffer to file
-  res = fwrite(record, 1, SAUCE_RECORD_SIZE, file);
-  fclose(file);
-  if (res != SAUCE_RECORD_SIZE) {
-    SAUCE_SET_ERROR("Failed to write updated record to %s", filepath);
-    return SAUCE_EFFAIL;
+  if (!stream->finished) {
+    SAUCE_SET_ERROR("The stream has not finished");
+    return SAUCE_EOTHER;
   }
 
-  return 0;
+  const SAUCEInfo* info = &stream->info;
+  if (stream->result < 0) return SAUCE_set_info_error("The stream", stream->result, info);
+  return SAUCE_data_read_comment(info, &stream->ring[info->start], comment, nLines);
 }
 
 
 /**
- * @brief Remove a SAUCE record from the first `n` bytes of a buffer, 
- *        along with the SAUCE CommentBlock if it exists. The EOF character will be
- *        removed as well.
+ * @brief Free a stream. Content that was not passed to the callback yet is dropped.
  * 
- * @param buffer pointer to buffer
- * @param n the length of the buffer
- * @return On success, the new length of the buffer is returned. On error, a negative error code
- *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ * @param stream a stream, or NULL
  */
-int SAUCE_remove(char* buffer, uint32_t n) {
-  SAUCEInfo info;
-  int res = SAUCE_buffer_get_info(buffer, n, &info);
-  if (res < 0 && !info.record_exists) return res;
+void SAUCE_Stream_close(SAUCE_Stream* stream) {
+  SAUCE_free(stream);
+}
 
-  // erase SAUCE data
-  memset(&buffer[info.start], 0, info.sauce_length);
-  if (info.eof_exists) {
-    buffer[info.start - 1] = 0;
-    return n - info.sauce_length - 1;
+
+/**
+ * @brief Open a writer that passes content through to `callback` and appends SAUCE data when it is finished.
+ *        See `SAUCE_Writer_finish()`.
+ * 
+ * @param callback receives everything written, in order
+ * @param data passed to `callback`
+ * @param writer will be set to the new writer
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Writer_open(SAUCE_StreamCallback callback, void* data, SAUCE_Writer** writer) {
+  if (writer == NULL || callback == NULL) {
+    SAUCE_SET_ERROR("Writer pointer or callback was NULL");
+    return SAUCE_ENULL;
   }
-  return n - info.sauce_length;
+
+  SAUCE_Writer* w = SAUCE_calloc(1, sizeof(SAUCE_Writer));
+  if (w == NULL) {
+    SAUCE_SET_ERROR("Ran out of memory opening a writer");
+    return SAUCE_EOTHER;
+  }
+  w->callback = callback;
+  w->data = data;
+  w->fd = -1;
+  *writer = w;
+  return 0;
 }
 
 
 /**
- * @brief Remove a SAUCE CommentBlock from the first `n` bytes of a buffer.
- *        The "Comments" field of the buffer's SAUCE record will be set to 0.
+ * @brief Open a writer that writes content to a file descriptor and appends SAUCE data when it is finished.
+ *        The content is written at the file descriptor's current offset, so it can be a pipe or a socket.
+ *        The file descriptor is not closed by the writer.
  * 
- * @param buffer pointer to buffer
- * @param n the length of the buffer
- * @return On success, the new length of the buffer is returned. On error, a negative error code
- *         is returned. Use `SAUCE_get_error()` to get more info on the error.
+ * @param fd a file descriptor open for writing
+ * @param writer will be set to the new writer
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
  */
-int SAUCE_Comment_remove(char* buffer, uint32_t n) {
-  SAUCEInfo info;
-  int res = SAUCE_buffer_get_info(buffer, n, &info);
-  if (res < 0 && !info.record_exists) return res;
-
-  // check info on comment
-  if (info.lines > 0 && !info.comment_exists) {
-    return SAUCE_ECMISS;
-  } else if (!info.comment_exists) {
-    SAUCE_SET_ERROR("Buffer contains zero comment lines, so no comment can be removed");
-    return SAUCE_ECMISS;
+int SAUCE_Writer_fd_open(int fd, SAUCE_Writer** writer) {
+  if (writer == NULL) {
+    SAUCE_SET_ERROR("Writer pointer was NULL");
+    return SAUCE_ENULL;
   }
-  
-  // move record in place of comment
-  if (info.eof_exists) {
-    memmove(&buffer[info.start], &buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
-    ((SAUCE*)(&buffer[info.start]))->Comments = 0;
-    return n - SAUCE_COMMENT_BLOCK_SIZE(info.lines);
+  if (fd < 0) {
+    SAUCE_SET_ERROR("File descriptor %d is invalid", fd);
+    return SAUCE_EFOPEN;
   }
 
-  // move record in place of comment and add eof
-  buffer[info.start] = SAUCE_EOF_CHAR;
-  memmove(&buffer[info.start+1], &buffer[n - SAUCE_RECORD_SIZE], SAUCE_RECORD_SIZE);
-  ((SAUCE*)(&buffer[info.start+1]))->Comments = 0;
-  return n - SAUCE_COMMENT_BLOCK_SIZE(info.lines) + 1;
+  #ifdef FD_IO_IS_DEFINED
+  SAUCE_Writer* w = SAUCE_calloc(1, sizeof(SAUCE_Writer));
+  if (w == NULL) {
+    SAUCE_SET_ERROR("Ran out of memory opening a writer");
+    return SAUCE_EOTHER;
+  }
+  w->fd = fd;
+  *writer = w;
+  return 0;
+  #else
+  SAUCE_SET_ERROR("File descriptor functions are not supported on this system");
+  return SAUCE_EOTHER;
+  #endif
 }
 
 
+/**
+ * @brief Write the next chunk of content through a writer. The content is passed on without being copied.
+ * 
+ * @param writer a writer
+ * @param data the content
+ * @param n the length of the content
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
+ */
+int SAUCE_Writer_write(SAUCE_Writer* writer, const char* data, size_t n) {
+  if (writer == NULL) {
+    SAUCE_SET_ERROR("Writer was NULL");
+    return SAUCE_ENULL;
+  }
+  if (data == NULL && n > 0) {
+    SAUCE_SET_ERROR("Data was NULL");
+    return SAUCE_ENULL;
+  }
+  if (writer->finished || writer->failed) {
+    SAUCE_SET_ERROR("Cannot write to a writer that has finished or failed");
+    return SAUCE_EOTHER;
+  }
 
+  int res = SAUCE_writer_output(writer, data, n);
+  if (res == 0) writer->written += n;
+  return res;
+}
 
 
-// Functions for performing checks
-
 /**
- * @brief Check if a file contains SAUCE data.
+ * @brief Finish a writer by writing an EOF character, an optional CommentBlock and a record after the content,
+ *        all in a single write. The record is copied from `sauce`, except that its "FileSize" field is set
+ *        to the number of content bytes written, and its "Comments" field is set to `lines`. "FileSize" is
+ *        set to 0 if the content is too large to be represented.
  * 
- * @param filepath path to a file
- * @return 1 (true) if the file contains valid SAUCE data; 0 (false) if the file does not contain valid
- *         SAUCE data. If 0 is returned, you can call `SAUCE_get_error()` to learn more about
- *         why the check failed.
+ * @param writer a writer
+ * @param sauce the record to write
+ * @param comment a buffer of at least size `SAUCE_COMMENT_STRING_LENGTH(lines)`, or NULL if `lines` is 0
+ * @param lines the number of comment lines to write
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
  */
-int SAUCE_check_file(const char* filepath) {
-  SAUCEInfo info;
-  int res = SAUCE_file_get_info(filepath, &info, NULL, NULL);
-  if (res < 0) return 0;
-  return 1;
+int SAUCE_Writer_finish(SAUCE_Writer* writer, const SAUCE* sauce, const char* comment, uint8_t lines) {
+  if (writer == NULL || sauce == NULL) {
+    SAUCE_SET_ERROR("Writer or SAUCE struct was NULL");
+    return SAUCE_ENULL;
+  }
+  if (comment == NULL && lines > 0) {
+    SAUCE_SET_ERROR("Comment was NULL");
+    return SAUCE_ENULL;
+  }
+  if (writer->finished || writer->failed) {
+    SAUCE_SET_ERROR("Cannot finish a writer that has finished or failed");
+    return SAUCE_EOTHER;
+  }
+  writer->finished = 1;
+
+  char data[SAUCE_MAX_TAIL_SIZE];
+  data[0] = SAUCE_EOF_CHAR;
+  char* ptr = data + 1;
+  if (lines > 0) {
+    memcpy(ptr, SAUCE_COMMENT_ID, 5);
+    memcpy(ptr + 5, comment, SAUCE_COMMENT_STRING_LENGTH(lines));
+    ptr += SAUCE_COMMENT_BLOCK_SIZE(lines);
+  }
+
+  SAUCE* record = (SAUCE*)ptr;
+  memcpy(ptr, SAUCE_RECORD_ID, 5);
+  memcpy(ptr + 5, &(sauce->Version), SAUCE_RECORD_SIZE - 5);
+  record->FileSize = (writer->written > UINT32_MAX) ? 0 : (uint32_t)writer->written;
+  record->Comments = lines;
+
+  return SAUCE_writer_output(writer, data, 1 + SAUCE_TOTAL_SIZE(lines));
 }
 
 
 /**
- * @brief Check if the first `n` bytes of a buffer contain SAUCE data.
+ * @brief Free a writer. A writer that was not finished does not write any SAUCE data.
  * 
- * @param buffer pointer to a buffer
- * @param n the length of the buffer
- * @return 1 (true) if the buffer contains valid SAUCE data; 0 (false) if the buffer does not contain valid
- *         SAUCE data. If 0 is returned, you can call `SAUCE_get_error()` to learn more about
- *         why the check failed.
+ * @param writer a writer, or NULL
  */
-int SAUCE_check_buffer(const char* buffer, uint32_t n) {
-  SAUCEInfo info;
-  int res = SAUCE_buffer_get_info(buffer, n, &info);
-  if (res < 0) return 0;
-  return 1;
+void SAUCE_Writer_close(SAUCE_Writer* writer) {
+  SAUCE_free(writer);
 }
 
 
+
+// Context Functions
+
 /**
- * @brief Check two SAUCE records for equality. SAUCE records are equal if
- *        each field between the SAUCE records match.
+ * @brief Create a context. A context has its own last error, file mode and cache, so that threads
+ *        can each use their own context and never see each other's errors or options. A new context
+ *        uses `SAUCE_FM_DEFAULT` and no cache.
  * 
- * @param first the first SAUCE struct
- * @param second the second SAUCE struct
- * @return 1 (true) if the records are equal; 0 (false) if the records are not equal
+ * @param ctx will be set to the new context
+ * @return 0 on success. On error, a negative error code is returned. Use `SAUCE_get_error()`
+ *         to get more info on the error.
  */
-int SAUCE_equal(const SAUCE* first, const SAUCE* second) {
-  if (first == second) return 1;
-
-  if (memcmp(first->ID, second->ID, 5) != 0) return 0;
-  if (memcmp(first->Version, second->Version, 2) != 0) return 0;
-  if (memcmp(first->Title, second->Title, 35) != 0) return 0;
-  if (memcmp(first->Author, second->Author, 20) != 0) return 0;
-  if (memcmp(first->Group, second->Group, 20) != 0) return 0;
-  if (memcmp(first->Date, second->Date, 8) != 0) return 0;
-  
-  if (strncmp(first->TInfoS, second->TInfoS, 22) != 0) return 0;
+int SAUCE_Context_create(SAUCE_Context** ctx) {
+  if (ctx == NULL) {
+    SAUCE_SET_ERROR("Context pointer was NULL");
+    return SAUCE_ENULL;
+  }
 
-  return first->FileSize == second->FileSize &&
-         first->DataType == second->DataType &&
-         first->FileType == second->FileType &&
-         first->TInfo1 == second->TInfo1 &&
-         first->TInfo2 == second->TInfo2 &&
-         first->TInfo3 == second->TInfo3 &&
-         first->TInfo4 == second->TInfo4 &&
-         first->Comments == second->Comments &&
-         first->TFlags == second->TFlags;
+  SAUCE_Context* context = SAUCE_calloc(1, sizeof(SAUCE_Context));
+  if (context == NULL) {
+    SAUCE_SET_ERROR("Ran out of memory creating a context");
+    return SAUCE_EOTHER;
+  }
+  context->options.fileMode = SAUCE_FM_DEFAULT;
+  context->options.cache = NULL;
+  context->options.durability = SAUCE_DURABLE_NONE;
+  *ctx = context;
+  return 0;
 }
 
 
 /**
- * @brief Determine if two SAUCE comments are equal. 
- * 
- * 
- *        Both comments must be at least `SAUCE_COMMENT_STRING_LENGTH(lines)` bytes long. 
- *        Anything beyond the given number of lines, including any terminating null 
- *        characters after the last line, will be not compared or read.
+ * @brief Free a context. It must not be in use by another thread.
  * 
- * @param first the first comment
- * @param second the second comment
- * @param lines the maximum number of lines to compare
- * @return 1 (i.e. true) if the comments are equal; 0 (i.e. false) if the comments are not equal
+ * @param ctx a context, or NULL
  */
-int SAUCE_Comment_equal(const char* first_comment, const char* second_comment, uint8_t lines) {
-  return memcmp(first_comment, second_comment, SAUCE_COMMENT_STRING_LENGTH(lines)) == 0;
-}
\ No newline at end of file
+void SAUCE_Context_free(SAUCE_Context* ctx) {
+  SAUCE_free(ctx);
+}
+
+
+// Define the `_ctx` variant of a function, which calls the function with `ctx` as the calling thread's
+// current context. The previous context is restored so that `_ctx` calls made by callbacks nest.
+#define SAUCE_CTX_FUNCTION(type, name, params, args)  \
+  type name##_ctx params {                            \
+    SAUCE_Context* previous = current_context;        \
+    current_context = ctx;                            \
+    type res = name args;                             \
+    current_context = previous;                       \
+    return res;                                       \
+  }
+
+#define SAUCE_CTX_VOID_FUNCTION(name, params, args)   \
+  void name##_ctx params {                            \
+    SAUCE_Context* previous = current_context;        \
+    current_context = ctx;                            \
+    name args;                                        \
+    current_context = previous;                       \
+  }
+
+SAUCE_CTX_FUNCTION(const char*, SAUCE_get_error, (SAUCE_Context* ctx), ())
+SAUCE_CTX_VOID_FUNCTION(SAUCE_clear_error, (SAUCE_Context* ctx), ())
+SAUCE_CTX_FUNCTION(int, SAUCE_set_file_mode, (SAUCE_Context* ctx, enum SAUCE_FileMode mode), (mode))
+SAUCE_CTX_FUNCTION(enum SAUCE_FileMode, SAUCE_get_file_mode, (SAUCE_Context* ctx), ())
+SAUCE_CTX_FUNCTION(int, SAUCE_set_cache, (SAUCE_Context* ctx, SAUCE_Cache* cache), (cache))
+SAUCE_CTX_FUNCTION(SAUCE_Cache*, SAUCE_get_cache, (SAUCE_Context* ctx), ())
+SAUCE_CTX_FUNCTION(int, SAUCE_set_durability, (SAUCE_Context* ctx, enum SAUCE_Durability durability), (durability))
+SAUCE_CTX_FUNCTION(enum SAUCE_Durability, SAUCE_get_durability, (SAUCE_Context* ctx), ())
+SAUCE_CTX_FUNCTION(int, SAUCE_fread, (SAUCE_Context* ctx, const char* filepath, SAUCE* sauce), (filepath, sauce))
+SAUCE_CTX_FUNCTION(int, SAUCE_Comment_fread, (SAUCE_Context* ctx, const char* filepath, char* comment, uint8_t nLines), (filepath, comment, nLines))
+SAUCE_CTX_FUNCTION(int, SAUCE_fd_read, (SAUCE_Context* ctx, int fd, SAUCE* sauce), (fd, sauce))
+SAUCE_CTX_FUNCTION(int, SAUCE_Comment_fd_read, (SAUCE_Context* ctx, int fd, char* comment, uint8_t nLines), (fd, comment, nLines))
+SAUCE_CTX_FUNCTION(int, SAUCE_fread_many, (SAUCE_Context* ctx, const char* const* filepaths, uint32_t count, SAUCE* records, int* results, const SAUCE_BatchOptions* options), (filepaths, count, records, results, options))
+SAUCE_CTX_FUNCTION(int, SAUCE_Comment_fread_many, (SAUCE_Context* ctx, const char* const* filepaths, uint32_t count, char* comments, uint8_t nLines, int* results, const SAUCE_BatchOptions* options), (filepaths, count, comments, nLines, results, options))
+SAUCE_CTX_FUNCTION(int64_t, SAUCE_scan_tree, (SAUCE_Context* ctx, const char* root, SAUCE_ScanCallback callback, void* data, const SAUCE_ScanOptions* options), (root, callback, data, options))
+SAUCE_CTX_FUNCTION(int, SAUCE_read, (SAUCE_Context* ctx, const char* buffer, uint32_t n, SAUCE* sauce), (buffer, n, sauce))
+SAUCE_CTX_FUNCTION(int, SAUCE_read64, (SAUCE_Context* ctx, const char* buffer, size_t n, SAUCE* sauce), (buffer, n, sauce))
+SAUCE_CTX_FUNCTION(int, SAUCE_Comment_read, (SAUCE_Context* ctx, const char* buffer, uint32_t n, char* comment, uint8_t nLines), (buffer, n, comment, nLines))
+SAUCE_CTX_FUNCTION(int, SAUCE_Comment_read64, (SAUCE_Context* ctx, const char* buffer, size_t n, char* comment, uint8_t nLines), (buffer, n, comment, nLines))
+SAUCE_CTX_FUNCTION(int, SAUCE_view, (SAUCE_Context* ctx, const char* buffer, size_t n, SAUCE_View* view), (buffer, n, view))
+SAUCE_CTX_FUNCTION(int, SAUCE_Comment_iter_next, (SAUCE_Context* ctx, SAUCE_CommentIter* iter, const char** line, uint8_t* length), (iter, line, length))
+SAUCE_CTX_FUNCTION(int, SAUCE_fwrite, (SAUCE_Context* ctx, const char* filepath, const SAUCE* sauce), (filepath, sauce))
+SAUCE_CTX_FUNCTION(int, SAUCE_fpatch, (SAUCE_Context* ctx, const char* filepath, const SAUCE* values, uint32_t fields), (filepath, values, fields))
+SAUCE_CTX_FUNCTION(int, SAUCE_fpatch_many, (SAUCE_Context* ctx, const char* const* filepaths, uint32_t count, const SAUCE* values, uint32_t fields, int* results, const SAUCE_BatchOptions* options), (filepaths, count, values, fields, results, options))
+SAUCE_CTX_FUNCTION(int, SAUCE_Comment_fwrite, (SAUCE_Context* ctx, const char* filepath, const char* comment, uint8_t lines), (filepath, comment, lines))
+SAUCE_CTX_FUNCTION(int, SAUCE_fd_write, (SAUCE_Context* ctx, int fd, const SAUCE* sauce), (fd, sauce))
+SAUCE_CTX_FUNCTION(int, SAUCE_Comment_fd_write, (SAUCE_Context* ctx, int fd, const char* comment, uint8_t lines), (fd, comment, lines))
+SAUCE_CTX_FUNCTION(int, SAUCE_write, (SAUCE_Context* ctx, char* buffer, uint32_t n, const SAUCE* sauce), (buffer, n, sauce))
+SAUCE_CTX_FUNCTION(int64_t, SAUCE_write64, (SAUCE_Context* ctx, char* buffer, size_t n, const SAUCE* sauce), (buffer, n, sauce))
+SAUCE_CTX_FUNCTION(int, SAUCE_Comment_write, (SAUCE_Context* ctx, char* buffer, uint32_t n, const char* comment, uint8_t lines), (buffer, n, comment, lines))
+SAUCE_CTX_FUNCTION(int64_t, SAUCE_Comment_write64, (SAUCE_Context* ctx, char* buffer, size_t n, const char* comment, uint8_t lines), (buffer, n, comment, lines))
+SAUCE_CTX_FUNCTION(int, SAUCE_fremove, (SAUCE_Context* ctx, const char* filepath), (filepath))
+SAUCE_CTX_FUNCTION(int, SAUCE_fremove_many, (SAUCE_Context* ctx, const char* const* filepaths, uint32_t count, int* results, const SAUCE_BatchOptions* options), (filepaths, count, results, options))
+SAUCE_CTX_FUNCTION(int, SAUCE_Comment_fremove, (SAUCE_Context* ctx, const char* filepath), (filepath))
+SAUCE_CTX_FUNCTION(int, SAUCE_fd_remove, (SAUCE_Context* ctx, int fd), (fd))
+SAUCE_CTX_FUNCTION(int, SAUCE_Comment_fd_remove, (SAUCE_Context* ctx, int fd), (fd))
+SAUCE_CTX_FUNCTION(int, SAUCE_remove, (SAUCE_Context* ctx, char* buffer, uint32_t n), (buffer, n))
+SAUCE_CTX_FUNCTION(int64_t, SAUCE_remove64, (SAUCE_Context* ctx, char* buffer, size_t n), (buffer, n))
+SAUCE_CTX_FUNCTION(int, SAUCE_Comment_remove, (SAUCE_Context* ctx, char* buffer, uint32_t n), (buffer, n))
+SAUCE_CTX_FUNCTION(int64_t, SAUCE_Comment_remove64, (SAUCE_Context* ctx, char* buffer, size_t n), (buffer, n))
+SAUCE_CTX_FUNCTION(int, SAUCE_check_file, (SAUCE_Context* ctx, const char* filepath), (filepath))
+SAUCE_CTX_FUNCTION(int, SAUCE_check_fd, (SAUCE_Context* ctx, int fd), (fd))
+SAUCE_CTX_FUNCTION(int, SAUCE_check_buffer, (SAUCE_Context* ctx, const char* buffer, uint32_t n), (buffer, n))
+SAUCE_CTX_FUNCTION(int, SAUCE_check_buffer64, (SAUCE_Context* ctx, const char* buffer, size_t n), (buffer, n))
+SAUCE_CTX_FUNCTION(int, SAUCE_flayout, (SAUCE_Context* ctx, const char* filepath, SAUCE_Layout* layout), (filepath, layout))
+SAUCE_CTX_FUNCTION(int, SAUCE_fd_layout, (SAUCE_Context* ctx, int fd, SAUCE_Layout* layout), (fd, layout))
+SAUCE_CTX_FUNCTION(int, SAUCE_layout, (SAUCE_Context* ctx, const char* buffer, size_t n, SAUCE_Layout* layout), (buffer, n, layout))
+SAUCE_CTX_FUNCTION(int, SAUCE_Edit_open, (SAUCE_Context* ctx, const char* filepath, SAUCE_Edit** edit), (filepath, edit))
+SAUCE_CTX_FUNCTION(int, SAUCE_Edit_fd_open, (SAUCE_Context* ctx, int fd, SAUCE_Edit** edit), (fd, edit))
+SAUCE_CTX_FUNCTION(int, SAUCE_Edit_set_record, (SAUCE_Context* ctx, SAUCE_Edit* edit, const SAUCE* sauce), (edit, sauce))
+SAUCE_CTX_FUNCTION(int, SAUCE_Edit_set_comment, (SAUCE_Context* ctx, SAUCE_Edit* edit, const char* comment, uint8_t lines), (edit, comment, lines))
+SAUCE_CTX_FUNCTION(int, SAUCE_Edit_remove_comment, (SAUCE_Context* ctx, SAUCE_Edit* edit), (edit))
+SAUCE_CTX_FUNCTION(int, SAUCE_Edit_commit, (SAUCE_Context* ctx, SAUCE_Edit* edit), (edit))
+SAUCE_CTX_FUNCTION(int, SAUCE_Cache_open, (SAUCE_Context* ctx, const char* filepath, SAUCE_Cache** cache), (filepath, cache))
+SAUCE_CTX_FUNCTION(int, SAUCE_Cache_save, (SAUCE_Context* ctx, SAUCE_Cache* cache), (cache))
+SAUCE_CTX_FUNCTION(int64_t, SAUCE_Cache_prune, (SAUCE_Context* ctx, SAUCE_Cache* cache), (cache))
+SAUCE_CTX_FUNCTION(int, SAUCE_Watcher_open, (SAUCE_Context* ctx, const char* root, const SAUCE_WatchOptions* options, SAUCE_Watcher** watcher), (root, options, watcher))
+SAUCE_CTX_FUNCTION(int64_t, SAUCE_Watcher_poll, (SAUCE_Context* ctx, SAUCE_Watcher* watcher, int timeout_ms, SAUCE_WatchCallback callback, void* data), (watcher, timeout_ms, callback, data))
+SAUCE_CTX_FUNCTION(int, SAUCE_Watcher_fd, (SAUCE_Context* ctx, const SAUCE_Watcher* watcher), (watcher))
+SAUCE_CTX_FUNCTION(int, SAUCE_Batch_create, (SAUCE_Context* ctx, uint64_t capacity, SAUCE_Batch** batch), (capacity, batch))
+SAUCE_CTX_FUNCTION(int, SAUCE_Batch_append, (SAUCE_Context* ctx, SAUCE_Batch* batch, const SAUCE* records, uint64_t count), (batch, records, count))
+SAUCE_CTX_FUNCTION(int, SAUCE_Batch_get, (SAUCE_Context* ctx, const SAUCE_Batch* batch, uint64_t index, SAUCE* sauce), (batch, index, sauce))
+SAUCE_CTX_FUNCTION(int64_t, SAUCE_Batch_select_equal, (SAUCE_Context* ctx, const SAUCE_Batch* batch, enum SAUCE_Field field, uint32_t value, uint64_t* bitmap), (batch, field, value, bitmap))
+SAUCE_CTX_FUNCTION(int64_t, SAUCE_Batch_select_range, (SAUCE_Context* ctx, const SAUCE_Batch* batch, enum SAUCE_Field field, uint32_t min, uint32_t max, uint64_t* bitmap), (batch, field, min, max, bitmap))
+SAUCE_CTX_FUNCTION(int64_t, SAUCE_Batch_select_prefix, (SAUCE_Context* ctx, const SAUCE_Batch* batch, enum SAUCE_Field field, const char* prefix, uint64_t* bitmap), (batch, field, prefix, bitmap))
+SAUCE_CTX_FUNCTION(int, SAUCE_Stream_open, (SAUCE_Context* ctx, SAUCE_StreamCallback callback, void* data, SAUCE_Stream** stream), (callback, data, stream))
+SAUCE_CTX_FUNCTION(int, SAUCE_Stream_feed, (SAUCE_Context* ctx, SAUCE_Stream* stream, const char* data, size_t n), (stream, data, n))
+SAUCE_CTX_FUNCTION(int, SAUCE_Stream_finish, (SAUCE_Context* ctx, SAUCE_Stream* stream, SAUCE_Layout* layout), (stream, layout))
+SAUCE_CTX_FUNCTION(int, SAUCE_Stream_read, (SAUCE_Context* ctx, const SAUCE_Stream* stream, SAUCE* sauce), (stream, sauce))
+SAUCE_CTX_FUNCTION(int, SAUCE_Stream_Comment_read, (SAUCE_Context* ctx, const SAUCE_Stream* stream, char* comment, uint8_t nLines), (stream, comment, nLines))
+SAUCE_CTX_FUNCTION(int, SAUCE_Writer_open, (SAUCE_Context* ctx, SAUCE_StreamCallback callback, void* data, SAUCE_Writer** writer), (callback, data, writer))
+SAUCE_CTX_FUNCTION(int, SAUCE_Writer_fd_open, (SAUCE_Context* ctx, int fd, SAUCE_Writer** writer), (fd, writer))
+SAUCE_CTX_FUNCTION(int, SAUCE_Writer_write, (SAUCE_Context* ctx, SAUCE_Writer* writer, const char* data, size_t n), (writer, data, n))
+SAUCE_CTX_FUNCTION(int, SAUCE_Writer_finish, (SAUCE_Context* ctx, SAUCE_Writer* writer, const SAUCE* sauce, const char* comment, uint8_t lines), (writer, sauce, comment, lines))
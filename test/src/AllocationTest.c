@@ -0,0 +1,155 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+  #include <fcntl.h>
+  #include <unistd.h>
+  #define TEST_FD
+#endif
+
+// AllocationTest, tests that reading and writing files does not allocate memory
+
+
+#ifdef TEST_WRAP_ALLOCATOR
+// The allocator is wrapped with the linker's --wrap option, so calls made by the library land here
+static long allocations = 0;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+  allocations++;
+  return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+  allocations++;
+  return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+  allocations++;
+  return __real_realloc(ptr, size);
+}
+#endif
+
+
+static SAUCE sauce;
+static char commentStr[SAUCE_COMMENT_STRING_LENGTH(255) + 1];
+static SAUCE_Layout layout;
+
+
+void setUp() {
+  #ifndef TEST_WRAP_ALLOCATOR
+  TEST_IGNORE_MESSAGE("Allocations are not counted on this system");
+  #endif
+  memset(&sauce, 0, sizeof(sauce));
+  memset(commentStr, 0, sizeof(commentStr));
+  TEST_ASSERT_EQUAL(0, copy_file(SAUCE_TESTFILE1_PATH, SAUCE_ALLOCATION_ACTUAL_PATH));
+}
+
+void tearDown() {}
+
+
+// Number of allocations made since the last call
+static long allocations_since() {
+  #ifdef TEST_WRAP_ALLOCATOR
+  long count = allocations;
+  allocations = 0;
+  return count;
+  #else
+  return 0;
+  #endif
+}
+
+
+
+
+// Successful tests
+
+void should_NotAllocate_when_FileIsRead() {
+  allocations_since();
+  TEST_ASSERT_EQUAL(0, SAUCE_fread(SAUCE_ALLOCATION_ACTUAL_PATH, &sauce));
+  TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, SAUCE_Comment_fread(SAUCE_ALLOCATION_ACTUAL_PATH, commentStr, 255));
+  TEST_ASSERT_EQUAL(0, SAUCE_flayout(SAUCE_ALLOCATION_ACTUAL_PATH, &layout));
+  TEST_ASSERT_TRUE(SAUCE_check_file(SAUCE_ALLOCATION_ACTUAL_PATH));
+  TEST_ASSERT_EQUAL(0, allocations_since());
+}
+
+
+void should_NotAllocate_when_FileIsWritten() {
+  SAUCE_set_default(&sauce);
+  allocations_since();
+  TEST_ASSERT_EQUAL(0, SAUCE_fwrite(SAUCE_ALLOCATION_ACTUAL_PATH, &sauce));
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fwrite(SAUCE_ALLOCATION_ACTUAL_PATH, test_get_testfile1_expected_comment(), 1));
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fwrite(SAUCE_ALLOCATION_ACTUAL_PATH, test_get_testfile1_expected_comment(),
+                                            TESTFILE1_EXPECTED_LINES));
+  TEST_ASSERT_EQUAL(0, allocations_since());
+}
+
+
+void should_NotAllocate_when_DataIsRemoved() {
+  allocations_since();
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fremove(SAUCE_ALLOCATION_ACTUAL_PATH));
+  TEST_ASSERT_EQUAL(0, SAUCE_fremove(SAUCE_ALLOCATION_ACTUAL_PATH));
+  TEST_ASSERT_EQUAL(0, SAUCE_fwrite(SAUCE_ALLOCATION_ACTUAL_PATH, test_get_testfile1_expected_record()));
+  TEST_ASSERT_EQUAL(0, allocations_since());
+}
+
+
+void should_NotAllocate_when_FileDescriptorIsUsed() {
+  #ifdef TEST_FD
+  int fd = open(SAUCE_ALLOCATION_ACTUAL_PATH, O_RDWR);
+  TEST_ASSERT_TRUE(fd >= 0);
+  allocations_since();
+  int res = SAUCE_fd_read(fd, &sauce);
+  if (res == 0) res = (SAUCE_fd_write(fd, &sauce) == SAUCE_UNCHANGED) ? 0 : -1;
+  if (res == 0) res = SAUCE_Comment_fd_read(fd, commentStr, 255) == TESTFILE1_EXPECTED_LINES ? 0 : -1;
+  long count = allocations_since();
+  close(fd);
+
+  if (res == SAUCE_EOTHER) TEST_IGNORE_MESSAGE("File descriptor functions are not supported on this system");
+  TEST_ASSERT_EQUAL(0, res);
+  TEST_ASSERT_EQUAL(0, count);
+  #else
+  TEST_IGNORE_MESSAGE("File descriptors are not available on this system");
+  #endif
+}
+
+
+
+
+// Failure tests
+
+void should_NotAllocate_when_OperationFails() {
+  allocations_since();
+  TEST_ASSERT_EQUAL(SAUCE_ERMISS, SAUCE_fread(SAUCE_NOSAUCE_PATH, &sauce));
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, SAUCE_fread("expect/DoesNotExist.ans", &sauce));
+  TEST_ASSERT_EQUAL(SAUCE_ECMISS, SAUCE_Comment_fremove(SAUCE_TESTFILE2_PATH));
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, SAUCE_fwrite("expect/DoesNotExist/File.ans", &sauce));
+  TEST_ASSERT_EQUAL(0, allocations_since());
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_NotAllocate_when_FileIsRead);
+  RUN_TEST(should_NotAllocate_when_FileIsWritten);
+  RUN_TEST(should_NotAllocate_when_DataIsRemoved);
+  RUN_TEST(should_NotAllocate_when_FileDescriptorIsUsed);
+  RUN_TEST(should_NotAllocate_when_OperationFails);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
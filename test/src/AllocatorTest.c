@@ -0,0 +1,194 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// AllocatorTest, tests allocating through a custom allocator and counting allocations
+
+
+// Calls made to the test allocator
+typedef struct TestAllocator {
+  long mallocs;
+  long frees;
+  int fail;                     // true to fail every allocation
+} TestAllocator;
+
+static TestAllocator counts;
+static SAUCE_AllocStats stats;
+
+
+static void* test_malloc(size_t size, void* user) {
+  TestAllocator* allocator = user;
+  if (allocator->fail) return NULL;
+  allocator->mallocs++;
+  return malloc(size);
+}
+
+static void test_free(void* ptr, void* user) {
+  TestAllocator* allocator = user;
+  allocator->frees++;
+  free(ptr);
+}
+
+
+static int ignore_content(const char* content, size_t n, void* data) {
+  (void)content;
+  (void)n;
+  (void)data;
+  return 0;
+}
+
+static int ignore_entry(const SAUCE_ScanEntry* entry, void* data) {
+  (void)entry;
+  (void)data;
+  return 0;
+}
+
+
+void setUp() {
+  memset(&counts, 0, sizeof(counts));
+  memset(&stats, 0xFF, sizeof(stats));
+  TEST_ASSERT_EQUAL(0, SAUCE_set_allocator(test_malloc, test_free, &counts));
+  SAUCE_reset_alloc_stats();
+}
+
+void tearDown() {
+  SAUCE_set_allocator(NULL, NULL, NULL);
+}
+
+
+
+
+// Successful tests
+
+void should_UseAllocator_when_StreamIsOpened() {
+  SAUCE_Stream* stream = NULL;
+  TEST_ASSERT_EQUAL(0, SAUCE_Stream_open(ignore_content, NULL, &stream));
+  TEST_ASSERT_EQUAL(1, counts.mallocs);
+  SAUCE_Stream_close(stream);
+  TEST_ASSERT_EQUAL(1, counts.frees);
+
+  SAUCE_get_alloc_stats(&stats);
+  TEST_ASSERT_EQUAL(1, stats.allocations);
+  TEST_ASSERT_EQUAL(1, stats.frees);
+  TEST_ASSERT_TRUE(stats.bytes_allocated > 0);
+  TEST_ASSERT_EQUAL(stats.bytes_allocated, stats.bytes_freed);
+}
+
+
+void should_CountEveryAllocation_when_BatchGrows() {
+  SAUCE_Batch* batch = NULL;
+  TEST_ASSERT_EQUAL(0, SAUCE_Batch_create(1, &batch));
+  for (int i = 0; i < 100; i++) {
+    TEST_ASSERT_EQUAL(0, SAUCE_Batch_append(batch, test_get_testfile1_expected_record(), 1));
+  }
+  SAUCE_Batch_free(batch);
+
+  SAUCE_get_alloc_stats(&stats);
+  TEST_ASSERT_EQUAL(counts.mallocs, stats.allocations);
+  TEST_ASSERT_EQUAL(counts.frees, stats.frees);
+  TEST_ASSERT_EQUAL(stats.allocations, stats.frees);
+  TEST_ASSERT_EQUAL(stats.bytes_allocated, stats.bytes_freed);
+}
+
+
+void should_NotAllocate_when_FilesAreReadAndWritten() {
+  SAUCE sauce;
+  char comment[SAUCE_COMMENT_STRING_LENGTH(255) + 1];
+  TEST_ASSERT_EQUAL(0, copy_file(SAUCE_TESTFILE1_PATH, SAUCE_ALLOCATION_ACTUAL_PATH));
+  SAUCE_reset_alloc_stats();
+
+  TEST_ASSERT_EQUAL(0, SAUCE_fread(SAUCE_ALLOCATION_ACTUAL_PATH, &sauce));
+  TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, SAUCE_Comment_fread(SAUCE_ALLOCATION_ACTUAL_PATH, comment, 255));
+  TEST_ASSERT_EQUAL(SAUCE_UNCHANGED, SAUCE_fwrite(SAUCE_ALLOCATION_ACTUAL_PATH, &sauce));
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fremove(SAUCE_ALLOCATION_ACTUAL_PATH));
+  TEST_ASSERT_EQUAL(SAUCE_ERMISS, SAUCE_fread(SAUCE_NOSAUCE_PATH, &sauce));
+
+  SAUCE_get_alloc_stats(&stats);
+  TEST_ASSERT_EQUAL(0, stats.allocations);
+  TEST_ASSERT_EQUAL(0, counts.mallocs);
+}
+
+
+void should_CountWorkerAllocations_when_TreeIsScanned() {
+  // the allocator is called from the worker threads, so the default one is used
+  SAUCE_set_allocator(NULL, NULL, NULL);
+  SAUCE_reset_alloc_stats();
+
+  SAUCE_ScanOptions options;
+  memset(&options, 0, sizeof(options));
+  options.threads = 4;
+  int64_t res = SAUCE_scan_tree("expect", ignore_entry, NULL, &options);
+  if (res == SAUCE_EOTHER) TEST_IGNORE_MESSAGE("SAUCE_scan_tree is not supported on this system");
+  TEST_ASSERT_TRUE(res > 0);
+
+  SAUCE_get_alloc_stats(&stats);
+  TEST_ASSERT_TRUE(stats.allocations > 0);
+  TEST_ASSERT_EQUAL(stats.allocations, stats.frees);
+  TEST_ASSERT_EQUAL(stats.bytes_allocated, stats.bytes_freed);
+}
+
+
+void should_ZeroStats_when_StatsAreReset() {
+  SAUCE_Stream* stream = NULL;
+  TEST_ASSERT_EQUAL(0, SAUCE_Stream_open(NULL, NULL, &stream));
+  SAUCE_Stream_close(stream);
+
+  SAUCE_reset_alloc_stats();
+  SAUCE_get_alloc_stats(&stats);
+  TEST_ASSERT_EQUAL(0, stats.allocations);
+  TEST_ASSERT_EQUAL(0, stats.frees);
+  TEST_ASSERT_EQUAL(0, stats.bytes_allocated);
+  TEST_ASSERT_EQUAL(0, stats.bytes_freed);
+}
+
+
+
+
+// Failure tests
+
+void should_FailToOpen_when_AllocatorFails() {
+  counts.fail = 1;
+  SAUCE_Stream* stream = NULL;
+  SAUCE_Writer* writer = NULL;
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Stream_open(NULL, NULL, &stream));
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Writer_open(ignore_content, NULL, &writer));
+
+  SAUCE_get_alloc_stats(&stats);
+  TEST_ASSERT_EQUAL(0, stats.allocations);
+}
+
+
+void should_FailToSetAllocator_when_OnlyOneFunctionIsGiven() {
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_set_allocator(test_malloc, NULL, &counts));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_set_allocator(NULL, test_free, &counts));
+
+  // the allocator is left unchanged
+  SAUCE_Stream* stream = NULL;
+  TEST_ASSERT_EQUAL(0, SAUCE_Stream_open(NULL, NULL, &stream));
+  SAUCE_Stream_close(stream);
+  TEST_ASSERT_EQUAL(1, counts.mallocs);
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_UseAllocator_when_StreamIsOpened);
+  RUN_TEST(should_CountEveryAllocation_when_BatchGrows);
+  RUN_TEST(should_NotAllocate_when_FilesAreReadAndWritten);
+  RUN_TEST(should_CountWorkerAllocations_when_TreeIsScanned);
+  RUN_TEST(should_ZeroStats_when_StatsAreReset);
+  RUN_TEST(should_FailToOpen_when_AllocatorFails);
+  RUN_TEST(should_FailToSetAllocator_when_OnlyOneFunctionIsGiven);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
@@ -0,0 +1,263 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+  #include <pthread.h>
+  #define TEST_THREADS
+#endif
+
+// BatchReadTest, tests reading many files at once
+
+
+// Number of files in the large batch, enough to need several round trips
+#define LARGE_BATCH_SIZE    1000
+
+// Number of threads reading batches at the same time
+#define CONCURRENT_BATCHES  4
+
+// Length of each comment in a batch of comments
+#define COMMENT_STRIDE      (SAUCE_COMMENT_STRING_LENGTH(TESTFILE1_EXPECTED_LINES) + 1)
+
+static SAUCE records[LARGE_BATCH_SIZE];
+static int results[LARGE_BATCH_SIZE];
+static char comments[LARGE_BATCH_SIZE * COMMENT_STRIDE];
+
+static const char* largePaths[LARGE_BATCH_SIZE];
+
+
+void setUp() {
+  memset(records, 0, sizeof(records));
+  memset(results, 1, sizeof(results));
+  memset(comments, 'x', sizeof(comments));
+
+  const char* files[] = { SAUCE_TESTFILE1_PATH, SAUCE_TESTFILE2_PATH, SAUCE_NOSAUCE_PATH, SAUCE_INVALIDCOMMENT_PATH };
+  for (int i = 0; i < LARGE_BATCH_SIZE; i++) largePaths[i] = files[i % 4];
+}
+
+
+// Check that every result and record of a large batch matches SAUCE_fread()
+static void assert_matches_fread(const SAUCE* actualRecords, const int* actualResults, int res) {
+  int expectedRead = 0;
+  for (int i = 0; i < LARGE_BATCH_SIZE; i++) {
+    SAUCE expected;
+    int expectedRes = SAUCE_fread(largePaths[i], &expected);
+    TEST_ASSERT_EQUAL(expectedRes, actualResults[i]);
+    if (expectedRes == 0) {
+      TEST_ASSERT_TRUE(SAUCE_equal(&expected, &actualRecords[i]));
+      expectedRead++;
+    }
+  }
+  TEST_ASSERT_EQUAL(expectedRead, res);
+}
+
+void tearDown() {}
+
+
+
+
+// Success cases
+
+void should_ReadEveryRecord_when_FilesContainRecords() {
+  const char* paths[] = { SAUCE_TESTFILE1_PATH, SAUCE_TESTFILE2_PATH, SAUCE_TESTFILE3_PATH, SAUCE_SAUCEBUTNOEOF_PATH };
+
+  int res = SAUCE_fread_many(paths, 4, records, results, NULL);
+  TEST_ASSERT_EQUAL(4, res);
+
+  for (int i = 0; i < 4; i++) {
+    TEST_ASSERT_EQUAL(0, results[i]);
+  }
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile1_expected_record(), &records[0]));
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile2_expected_record(), &records[1]));
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile3_expected_record(), &records[2]));
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile1_expected_record(), &records[3]));
+}
+
+
+void should_SetEachResult_when_SomeFilesCannotBeRead() {
+  const char* paths[] = {
+    SAUCE_TESTFILE1_PATH,
+    SAUCE_NOSAUCE_PATH,
+    SAUCE_SHORTFILE_PATH,
+    SAUCE_EMPTYFILE_PATH,
+    "expect/FILEDOESNOTEXIST.mp4",
+    NULL,
+    SAUCE_ONLYRECORD_PATH,
+  };
+
+  int res = SAUCE_fread_many(paths, 7, records, results, NULL);
+  TEST_ASSERT_EQUAL(2, res);
+
+  TEST_ASSERT_EQUAL(0, results[0]);
+  TEST_ASSERT_EQUAL(SAUCE_ERMISS, results[1]);
+  TEST_ASSERT_EQUAL(SAUCE_ESHORT, results[2]);
+  TEST_ASSERT_EQUAL(SAUCE_EEMPTY, results[3]);
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, results[4]);
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, results[5]);
+  TEST_ASSERT_EQUAL(0, results[6]);
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile2_expected_record(), &records[6]));
+}
+
+
+void should_MatchFread_when_BatchIsLarge() {
+  int res = SAUCE_fread_many(largePaths, LARGE_BATCH_SIZE, records, results, NULL);
+  assert_matches_fread(records, results, res);
+}
+
+
+void should_MatchFread_when_BatchIsReadByThreadPool() {
+  SAUCE_BatchOptions options;
+  memset(&options, 0, sizeof(options));
+  options.disable_uring = 1;
+
+  int res = SAUCE_fread_many(largePaths, LARGE_BATCH_SIZE, records, results, &options);
+  assert_matches_fread(records, results, res);
+
+  // only the calling thread
+  memset(results, 1, sizeof(results));
+  options.threads = 1;
+  res = SAUCE_fread_many(largePaths, LARGE_BATCH_SIZE, records, results, &options);
+  assert_matches_fread(records, results, res);
+}
+
+
+#ifdef TEST_THREADS
+typedef struct ConcurrentBatch {
+  SAUCE records[LARGE_BATCH_SIZE];
+  int results[LARGE_BATCH_SIZE];
+  int res;
+} ConcurrentBatch;
+
+static void* read_concurrent_batch(void* arg) {
+  ConcurrentBatch* batch = arg;
+  SAUCE_BatchOptions options;
+  memset(&options, 0, sizeof(options));
+  options.disable_uring = 1;
+  batch->res = SAUCE_fread_many(largePaths, LARGE_BATCH_SIZE, batch->records, batch->results, &options);
+  return NULL;
+}
+#endif
+
+void should_MatchFread_when_BatchesAreReadConcurrently() {
+  #ifdef TEST_THREADS
+  static ConcurrentBatch batches[CONCURRENT_BATCHES];
+  pthread_t threads[CONCURRENT_BATCHES];
+  for (int i = 0; i < CONCURRENT_BATCHES; i++) {
+    TEST_ASSERT_EQUAL(0, pthread_create(&threads[i], NULL, read_concurrent_batch, &batches[i]));
+  }
+  for (int i = 0; i < CONCURRENT_BATCHES; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  for (int i = 0; i < CONCURRENT_BATCHES; i++) {
+    assert_matches_fread(batches[i].records, batches[i].results, batches[i].res);
+  }
+  #else
+  TEST_IGNORE_MESSAGE("Threads are not available on this system");
+  #endif
+}
+
+
+void should_ReadEveryComment_when_FilesContainComments() {
+  const char* paths[] = { SAUCE_TESTFILE1_PATH, SAUCE_TESTFILE2_PATH, SAUCE_SAUCEBUTNOEOF_PATH };
+
+  int res = SAUCE_Comment_fread_many(paths, 3, comments, TESTFILE1_EXPECTED_LINES, results, NULL);
+  TEST_ASSERT_EQUAL(3, res);
+
+  TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, results[0]);
+  TEST_ASSERT_EQUAL_STRING(test_get_testfile1_expected_comment(), &comments[0]);
+
+  // TestFile2 only contains a record
+  TEST_ASSERT_EQUAL(0, results[1]);
+  TEST_ASSERT_EQUAL_STRING("", &comments[COMMENT_STRIDE]);
+
+  TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, results[2]);
+  TEST_ASSERT_EQUAL_STRING(test_get_testfile1_expected_comment(), &comments[2 * COMMENT_STRIDE]);
+}
+
+
+void should_MatchCommentFread_when_CommentBatchIsLarge() {
+  int res = SAUCE_Comment_fread_many(largePaths, LARGE_BATCH_SIZE, comments, TESTFILE1_EXPECTED_LINES, results, NULL);
+
+  int expectedRead = 0;
+  char expected[COMMENT_STRIDE];
+  for (int i = 0; i < LARGE_BATCH_SIZE; i++) {
+    int expectedRes = SAUCE_Comment_fread(largePaths[i], expected, TESTFILE1_EXPECTED_LINES);
+    TEST_ASSERT_EQUAL(expectedRes, results[i]);
+    if (expectedRes >= 0) {
+      TEST_ASSERT_EQUAL_STRING(expected, &comments[i * COMMENT_STRIDE]);
+      expectedRead++;
+    }
+  }
+  TEST_ASSERT_EQUAL(expectedRead, res);
+}
+
+
+void should_SetEachResult_when_SomeCommentsCannotBeRead() {
+  const char* paths[] = { SAUCE_NOSAUCE_PATH, SAUCE_INVALIDCOMMENT_PATH, "expect/FILEDOESNOTEXIST.mp4", NULL };
+
+  int res = SAUCE_Comment_fread_many(paths, 4, comments, TESTFILE1_EXPECTED_LINES, results, NULL);
+  TEST_ASSERT_EQUAL(0, res);
+
+  TEST_ASSERT_EQUAL(SAUCE_ERMISS, results[0]);
+  TEST_ASSERT_EQUAL(SAUCE_Comment_fread(SAUCE_INVALIDCOMMENT_PATH, comments, TESTFILE1_EXPECTED_LINES), results[1]);
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, results[2]);
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, results[3]);
+}
+
+
+void should_ReadNothing_when_CountIsZero() {
+  const char* paths[] = { SAUCE_TESTFILE1_PATH };
+  int res = SAUCE_fread_many(paths, 0, records, results, NULL);
+  TEST_ASSERT_EQUAL(0, res);
+}
+
+
+
+
+// Failure cases
+
+void should_FailToRead_when_ArraysAreNULL() {
+  const char* paths[] = { SAUCE_TESTFILE1_PATH };
+
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_fread_many(NULL, 1, records, results, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_fread_many(paths, 1, NULL, results, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_fread_many(paths, 1, records, NULL, NULL));
+}
+
+
+void should_FailToReadComments_when_ArraysAreNULL() {
+  const char* paths[] = { SAUCE_TESTFILE1_PATH };
+
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Comment_fread_many(NULL, 1, comments, 1, results, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Comment_fread_many(paths, 1, NULL, 1, results, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Comment_fread_many(paths, 1, comments, 1, NULL, NULL));
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_ReadEveryRecord_when_FilesContainRecords);
+  RUN_TEST(should_SetEachResult_when_SomeFilesCannotBeRead);
+  RUN_TEST(should_MatchFread_when_BatchIsLarge);
+  RUN_TEST(should_MatchFread_when_BatchIsReadByThreadPool);
+  RUN_TEST(should_MatchFread_when_BatchesAreReadConcurrently);
+  RUN_TEST(should_ReadEveryComment_when_FilesContainComments);
+  RUN_TEST(should_MatchCommentFread_when_CommentBatchIsLarge);
+  RUN_TEST(should_SetEachResult_when_SomeCommentsCannotBeRead);
+  RUN_TEST(should_ReadNothing_when_CountIsZero);
+  RUN_TEST(should_FailToRead_when_ArraysAreNULL);
+  RUN_TEST(should_FailToReadComments_when_ArraysAreNULL);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
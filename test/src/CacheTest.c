@@ -0,0 +1,275 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+  #include <sys/stat.h>
+  #include <time.h>
+  #include <unistd.h>
+  #define TEST_STAT
+#endif
+
+// CacheTest, tests reading files through a SAUCE_Cache
+
+
+// Number of files read by the tests
+#define CACHE_TEST_FILES    12
+
+// Number of seconds a file must go unchanged before its cache entry is used
+#define CACHE_RACY_SECONDS  2
+
+static const char* paths[CACHE_TEST_FILES] = {
+  SAUCE_TESTFILE1_PATH, SAUCE_TESTFILE2_PATH, SAUCE_TESTFILE3_PATH, SAUCE_NOSAUCE_PATH,
+  SAUCE_SHORTFILE_PATH, SAUCE_SAUCEBUTNOEOF_PATH, SAUCE_COMMENTBUTNORECORD_PATH, SAUCE_INVALIDCOMMENT_PATH,
+  SAUCE_LONGNOSAUCE_PATH, SAUCE_ONLYRECORD_PATH, SAUCE_NOSAUCEWITHEOF_PATH, SAUCE_EMPTYFILE_PATH
+};
+
+static SAUCE_Cache* cache;
+static SAUCE expected, actual;
+static char expectedComment[SAUCE_COMMENT_STRING_LENGTH(255) + 1];
+static char actualComment[SAUCE_COMMENT_STRING_LENGTH(255) + 1];
+
+
+void setUp() {
+  memset(&expected, 0, sizeof(expected));
+  memset(&actual, 0, sizeof(actual));
+  remove(SAUCE_CACHE_PATH);
+
+  // every cache test is ignored if the system does not support caching
+  cache = NULL;
+  if (SAUCE_Cache_open(SAUCE_CACHE_PATH, &cache) == SAUCE_EOTHER) {
+    TEST_IGNORE_MESSAGE("SAUCE_Cache is not supported on this system");
+  }
+}
+
+void tearDown() {
+  SAUCE_Cache_close(cache);
+  TEST_ASSERT_NULL(SAUCE_get_cache());
+}
+
+
+// Check that every file reads the same with and without the cache
+static void assert_matches_uncached() {
+  for (int i = 0; i < CACHE_TEST_FILES; i++) {
+    SAUCE_set_cache(NULL);
+    int expectedRes = SAUCE_fread(paths[i], &expected);
+    int expectedLines = SAUCE_Comment_fread(paths[i], expectedComment, 255);
+    int expectedCheck = SAUCE_check_file(paths[i]);
+
+    SAUCE_set_cache(cache);
+    TEST_ASSERT_EQUAL_MESSAGE(expectedRes, SAUCE_fread(paths[i], &actual), paths[i]);
+    if (expectedRes == 0) TEST_ASSERT_TRUE_MESSAGE(SAUCE_equal(&expected, &actual), paths[i]);
+
+    TEST_ASSERT_EQUAL_MESSAGE(expectedLines, SAUCE_Comment_fread(paths[i], actualComment, 255), paths[i]);
+    if (expectedLines >= 0) TEST_ASSERT_EQUAL_STRING_MESSAGE(expectedComment, actualComment, paths[i]);
+
+    TEST_ASSERT_EQUAL_MESSAGE(expectedCheck, SAUCE_check_file(paths[i]), paths[i]);
+  }
+}
+
+
+#ifdef TEST_STAT
+// Wait until a file has gone unchanged long enough for its cache entry to be used
+static void wait_until_not_racy(const char* filepath) {
+  struct stat st;
+  TEST_ASSERT_EQUAL(0, stat(filepath, &st));
+  time_t age = time(NULL) - st.st_ctime;
+  if (age <= CACHE_RACY_SECONDS) sleep((unsigned)(CACHE_RACY_SECONDS + 1 - age));
+}
+#endif
+
+
+// Get the number of read system calls made by the process. Return -1 if they are not counted.
+static long long read_syscalls() {
+  FILE* file = fopen("/proc/self/io", "r");
+  if (file == NULL) return -1;
+
+  char line[128];
+  long long count = -1;
+  while (fgets(line, sizeof(line), file) != NULL) {
+    if (sscanf(line, "syscr: %lld", &count) == 1) break;
+  }
+  fclose(file);
+  return count;
+}
+
+
+static int count_callback(const SAUCE_ScanEntry* entry, void* data) {
+  if (strcmp(entry->path, SAUCE_TESTFILE1_PATH) == 0) {
+    TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile1_expected_record(), &entry->record));
+    TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, entry->comment_lines);
+    TEST_ASSERT_EQUAL_MEMORY(test_get_testfile1_expected_comment(), entry->comment,
+                             SAUCE_COMMENT_STRING_LENGTH(TESTFILE1_EXPECTED_LINES));
+  }
+  __atomic_fetch_add((int64_t*)data, 1, __ATOMIC_RELAXED);
+  return 0;
+}
+
+
+
+
+// Success cases
+
+void should_OpenEmptyCache_when_FileDoesNotExist() {
+  TEST_ASSERT_NOT_NULL(cache);
+  TEST_ASSERT_EQUAL(0, SAUCE_Cache_prune(cache));
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Cache_save(cache));
+  FILE* file = fopen(SAUCE_CACHE_PATH, "rb");
+  TEST_ASSERT_NOT_NULL(file);
+  fclose(file);
+}
+
+
+void should_UseCache_when_CacheIsSet() {
+  TEST_ASSERT_NULL(SAUCE_get_cache());
+  TEST_ASSERT_EQUAL(0, SAUCE_set_cache(cache));
+  TEST_ASSERT_EQUAL_PTR(cache, SAUCE_get_cache());
+
+  TEST_ASSERT_EQUAL(0, SAUCE_set_cache(NULL));
+  TEST_ASSERT_NULL(SAUCE_get_cache());
+}
+
+
+void should_ReadSameData_when_CacheIsSet() {
+  // the first pass fills the cache and the second reads from it
+  assert_matches_uncached();
+  assert_matches_uncached();
+}
+
+
+void should_ReadSameData_when_CacheIsReopened() {
+  SAUCE_set_cache(cache);
+  for (int i = 0; i < CACHE_TEST_FILES; i++) SAUCE_fread(paths[i], &actual);
+  TEST_ASSERT_EQUAL(0, SAUCE_Cache_save(cache));
+  SAUCE_Cache_close(cache);
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Cache_open(SAUCE_CACHE_PATH, &cache));
+  assert_matches_uncached();
+}
+
+
+void should_NotReadFile_when_FileIsUnchanged() {
+  #ifdef TEST_STAT
+  wait_until_not_racy(SAUCE_TESTFILE1_PATH);
+  SAUCE_set_cache(cache);
+  TEST_ASSERT_EQUAL(0, SAUCE_fread(SAUCE_TESTFILE1_PATH, &actual));
+
+  long long before = read_syscalls();
+  long long overhead = read_syscalls() - before;
+  before = read_syscalls();
+  TEST_ASSERT_EQUAL(0, SAUCE_fread(SAUCE_TESTFILE1_PATH, &actual));
+  long long reads = read_syscalls() - before - overhead;
+  if (before < 0) TEST_IGNORE_MESSAGE("Read system calls are not counted on this system");
+
+  TEST_ASSERT_EQUAL(0, reads);
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile1_expected_record(), &actual));
+  #else
+  TEST_IGNORE_MESSAGE("File times cannot be checked on this system");
+  #endif
+}
+
+
+void should_ReadNewRecord_when_FileChanges() {
+  TEST_ASSERT_EQUAL(0, copy_file(SAUCE_TESTFILE1_PATH, SAUCE_CACHE_ACTUAL_PATH));
+  SAUCE_set_cache(cache);
+  TEST_ASSERT_EQUAL(0, SAUCE_fread(SAUCE_CACHE_ACTUAL_PATH, &actual));
+
+  // the record is replaced without changing the size of the file
+  expected = actual;
+  memcpy(expected.Title, "Changed", 7);
+  TEST_ASSERT_EQUAL(0, SAUCE_fwrite(SAUCE_CACHE_ACTUAL_PATH, &expected));
+
+  TEST_ASSERT_EQUAL(0, SAUCE_fread(SAUCE_CACHE_ACTUAL_PATH, &actual));
+  TEST_ASSERT_TRUE(SAUCE_equal(&expected, &actual));
+
+  // the comment is removed, changing the size
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fremove(SAUCE_CACHE_ACTUAL_PATH));
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fread(SAUCE_CACHE_ACTUAL_PATH, actualComment, 255));
+  TEST_ASSERT_EQUAL_STRING("", actualComment);
+}
+
+
+void should_RemoveUnseenEntries_when_CacheIsPruned() {
+  SAUCE_set_cache(cache);
+  for (int i = 0; i < 4; i++) SAUCE_fread(paths[i], &actual);
+  TEST_ASSERT_EQUAL(0, SAUCE_Cache_save(cache));
+  SAUCE_Cache_close(cache);
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Cache_open(SAUCE_CACHE_PATH, &cache));
+  SAUCE_set_cache(cache);
+  SAUCE_fread(paths[0], &actual);
+  TEST_ASSERT_EQUAL(3, SAUCE_Cache_prune(cache));
+  TEST_ASSERT_EQUAL(0, SAUCE_Cache_prune(cache));
+}
+
+
+void should_ReadSameData_when_BatchAndScanUseCache() {
+  SAUCE records[CACHE_TEST_FILES];
+  int results[CACHE_TEST_FILES];
+  SAUCE_set_cache(cache);
+
+  for (int pass = 0; pass < 2; pass++) {
+    SAUCE_fread_many(paths, CACHE_TEST_FILES, records, results, NULL);
+    for (int i = 0; i < CACHE_TEST_FILES; i++) {
+      SAUCE_set_cache(NULL);
+      TEST_ASSERT_EQUAL_MESSAGE(SAUCE_fread(paths[i], &expected), results[i], paths[i]);
+      if (results[i] == 0) TEST_ASSERT_TRUE_MESSAGE(SAUCE_equal(&expected, &records[i]), paths[i]);
+      SAUCE_set_cache(cache);
+    }
+
+    int64_t count = 0;
+    int64_t res = SAUCE_scan_tree("expect", count_callback, &count, NULL);
+    if (res == SAUCE_EOTHER) continue;
+    TEST_ASSERT_GREATER_THAN(0, res);
+    TEST_ASSERT_EQUAL(res, count);
+  }
+}
+
+
+
+
+// Failure cases
+
+void should_FailToOpenCache_when_ArgumentsAreNULL() {
+  SAUCE_Cache* other = NULL;
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Cache_open(NULL, &other));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Cache_open(SAUCE_CACHE_PATH, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Cache_save(NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Cache_prune(NULL));
+  SAUCE_Cache_close(NULL);
+}
+
+
+void should_IgnoreCacheFile_when_FileIsNotACache() {
+  SAUCE_Cache_close(cache);
+  TEST_ASSERT_EQUAL(0, SAUCE_Cache_open(SAUCE_TESTFILE1_PATH, &cache));
+  TEST_ASSERT_EQUAL(0, SAUCE_Cache_prune(cache));
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_OpenEmptyCache_when_FileDoesNotExist);
+  RUN_TEST(should_UseCache_when_CacheIsSet);
+  RUN_TEST(should_ReadSameData_when_CacheIsSet);
+  RUN_TEST(should_ReadSameData_when_CacheIsReopened);
+  RUN_TEST(should_NotReadFile_when_FileIsUnchanged);
+  RUN_TEST(should_ReadNewRecord_when_FileChanges);
+  RUN_TEST(should_RemoveUnseenEntries_when_CacheIsPruned);
+  RUN_TEST(should_ReadSameData_when_BatchAndScanUseCache);
+  RUN_TEST(should_FailToOpenCache_when_ArgumentsAreNULL);
+  RUN_TEST(should_IgnoreCacheFile_when_FileIsNotACache);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
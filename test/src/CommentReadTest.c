@@ -6,7 +6,7 @@
 
 
 
-static char commentStr[UINT8_MAX * SAUCE_COMMENT_LINE_LENGTH];
+static char commentStr[UINT8_MAX * SAUCE_COMMENT_LINE_LENGTH + 1];
 static char buffer[1024];
 
 
@@ -57,6 +57,37 @@ void should_ReadFullCommentFromFile_when_MoreLinesRequestedThanAvailable() {
 }
 
 
+void should_ReadComment_when_FileCommentFillsEntireTail() {
+  // create a file longer than SAUCE_MAX_TAIL_SIZE with the largest possible comment
+  FILE* file = fopen(SAUCE_COMMENT_READ_ACTUAL_PATH, "wb");
+  if (file == NULL) {
+    TEST_FAIL_MESSAGE("Failed to open comment_read_actual.ans");
+    return;
+  }
+  char content[1024];
+  memset(content, 'x', sizeof(content));
+  for (int i = 0; i < 20; i++) fwrite(content, 1, sizeof(content), file);
+  fclose(file);
+
+  static char expected[SAUCE_COMMENT_STRING_LENGTH(255) + 1];
+  for (int i = 0; i < SAUCE_COMMENT_STRING_LENGTH(255); i++) expected[i] = (char)('A' + (i % 26));
+  expected[SAUCE_COMMENT_STRING_LENGTH(255)] = 0;
+
+  if (SAUCE_fwrite(SAUCE_COMMENT_READ_ACTUAL_PATH, test_get_testfile2_expected_record()) != 0 ||
+      SAUCE_Comment_fwrite(SAUCE_COMMENT_READ_ACTUAL_PATH, expected, 255) != 0) {
+    TEST_FAIL_MESSAGE("Failed to write SAUCE data to comment_read_actual.ans");
+    return;
+  }
+
+  int res = SAUCE_Comment_fread(SAUCE_COMMENT_READ_ACTUAL_PATH, commentStr, 255);
+  TEST_ASSERT_EQUAL(255, res);
+  TEST_ASSERT_TRUE(SAUCE_Comment_equal(commentStr, expected, 255));
+  TEST_ASSERT_EQUAL(0, commentStr[SAUCE_COMMENT_STRING_LENGTH(255)]); // check for null char
+
+  TEST_ASSERT_TRUE(SAUCE_check_file(SAUCE_COMMENT_READ_ACTUAL_PATH));
+}
+
+
 
 
 // Buffer success cases
@@ -241,6 +272,7 @@ int main(int argc, char** argv) {
   RUN_TEST(should_ReadComment_when_FileContainsComment);
   RUN_TEST(should_ReadNothing_when_FileContainsNoComment);
   RUN_TEST(should_ReadFullCommentFromFile_when_MoreLinesRequestedThanAvailable);
+  RUN_TEST(should_ReadComment_when_FileCommentFillsEntireTail);
   RUN_TEST(should_ReadComment_when_BufferContainsComment);
   RUN_TEST(should_ReadNothing_when_BufferContainsNoComment);
   RUN_TEST(should_ReadFullCommentFromBuffer_when_MoreLinesRequestedThanAvailable);
@@ -5,6 +5,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+  #include <fcntl.h>
+  #include <sys/stat.h>
+  #define TEST_STAT
+#endif
+
 #define SHORT_COMMENT_MSG   "This is the short comment message. Simple, right!"
 
 #define SHORT_COMMENT_LINES   1
@@ -41,7 +47,10 @@ void setUp() {
   fclose(file);
 }
 
-void tearDown() {}
+void tearDown() {
+  // reset the durability set by a test, even if it failed
+  SAUCE_set_durability(SAUCE_DURABLE_NONE);
+}
 
 
 
@@ -119,6 +128,99 @@ void should_ReplaceCommentInFile_when_NewCommentIsSameSize() {
 
 
 
+void should_ShrinkFile_when_NewCommentHasFewerLines() {
+  // Replace TestFile1.ans comment with longComment, then shrink it back to a 2 line shortComment
+  if (copy_file(SAUCE_TESTFILE1_PATH, SAUCE_COMMENT_WRITE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Failed to copy TestFile1.ans to comment_write_actual.txt");
+    return;
+  }
+
+  int res = SAUCE_Comment_fwrite(SAUCE_COMMENT_WRITE_ACTUAL_PATH, longComment, LONG_COMMENT_LINES);
+  TEST_ASSERT_EQUAL(0, res);
+  res = SAUCE_Comment_fwrite(SAUCE_COMMENT_WRITE_ACTUAL_PATH, shortComment, 2);
+  TEST_ASSERT_EQUAL(0, res);
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_COMMENT_WRITE_ACTUAL_PATH, SAUCE_SAMECOMMENTLENGTH_PATH));
+}
+
+
+void should_KeepRecord_when_NewCommentIsSameSize() {
+  if (copy_file(SAUCE_TESTFILE1_PATH, SAUCE_COMMENT_WRITE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Failed to copy TestFile1.ans to comment_write_actual.txt");
+    return;
+  }
+
+  SAUCE before, after;
+  TEST_ASSERT_EQUAL(0, SAUCE_fread(SAUCE_COMMENT_WRITE_ACTUAL_PATH, &before));
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fwrite(SAUCE_COMMENT_WRITE_ACTUAL_PATH, shortComment, TESTFILE1_EXPECTED_LINES));
+  TEST_ASSERT_EQUAL(0, SAUCE_fread(SAUCE_COMMENT_WRITE_ACTUAL_PATH, &after));
+  TEST_ASSERT_EQUAL_MEMORY(&before, &after, sizeof(SAUCE));
+
+  char comment[SAUCE_COMMENT_LINE_LENGTH * TESTFILE1_EXPECTED_LINES + 1];
+  TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, SAUCE_Comment_fread(SAUCE_COMMENT_WRITE_ACTUAL_PATH, comment, TESTFILE1_EXPECTED_LINES));
+  TEST_ASSERT_EQUAL_MEMORY(shortComment, comment, SAUCE_COMMENT_LINE_LENGTH * TESTFILE1_EXPECTED_LINES);
+}
+
+
+void should_ReplaceComment_when_FileDurabilityIsSet() {
+  if (SAUCE_set_durability(SAUCE_DURABLE_FILE) != 0) {
+    TEST_IGNORE_MESSAGE("Syncing files is not supported on this system");
+  }
+  if (copy_file(SAUCE_TESTFILE1_PATH, SAUCE_COMMENT_WRITE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Failed to copy TestFile1.ans to comment_write_actual.txt");
+    return;
+  }
+
+  // the comment grows, shrinks and is then rewritten with the same size
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fwrite(SAUCE_COMMENT_WRITE_ACTUAL_PATH, longComment, LONG_COMMENT_LINES));
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_COMMENT_WRITE_ACTUAL_PATH, SAUCE_REPLACEEXISTINGCOMMENT_PATH));
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fwrite(SAUCE_COMMENT_WRITE_ACTUAL_PATH, test_get_testfile1_expected_comment(), TESTFILE1_EXPECTED_LINES));
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_COMMENT_WRITE_ACTUAL_PATH, SAUCE_TESTFILE1_PATH));
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fwrite(SAUCE_COMMENT_WRITE_ACTUAL_PATH, shortComment, 2));
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_COMMENT_WRITE_ACTUAL_PATH, SAUCE_SAMECOMMENTLENGTH_PATH));
+}
+
+
+#ifdef TEST_STAT
+// Set the modification time of a file far in the past, so that any write to it would change the time
+static void set_old_mtime(const char* filepath, struct stat* st) {
+  struct timespec times[2] = { { 1000000000, 0 }, { 1000000000, 0 } };
+  TEST_ASSERT_EQUAL(0, utimensat(AT_FDCWD, filepath, times, 0));
+  TEST_ASSERT_EQUAL(0, stat(filepath, st));
+}
+
+
+// Assert that a file was not written to since `before` was taken
+static void assert_not_modified(const char* filepath, const struct stat* before) {
+  struct stat after;
+  TEST_ASSERT_EQUAL(0, stat(filepath, &after));
+  TEST_ASSERT_EQUAL(before->st_mtime, after.st_mtime);
+  TEST_ASSERT_EQUAL(before->st_size, after.st_size);
+}
+#endif
+
+
+void should_ReportUnchanged_when_FileAlreadyContainsComment() {
+  if (copy_file(SAUCE_TESTFILE1_PATH, SAUCE_COMMENT_WRITE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Failed to copy TestFile1.ans to comment_write_actual.txt");
+    return;
+  }
+
+  #ifdef TEST_STAT
+  struct stat before;
+  set_old_mtime(SAUCE_COMMENT_WRITE_ACTUAL_PATH, &before);
+  #endif
+
+  int res = SAUCE_Comment_fwrite(SAUCE_COMMENT_WRITE_ACTUAL_PATH, test_get_testfile1_expected_comment(), TESTFILE1_EXPECTED_LINES);
+  TEST_ASSERT_EQUAL(SAUCE_UNCHANGED, res);
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_COMMENT_WRITE_ACTUAL_PATH, SAUCE_TESTFILE1_PATH));
+  #ifdef TEST_STAT
+  assert_not_modified(SAUCE_COMMENT_WRITE_ACTUAL_PATH, &before);
+  #endif
+}
+
+
+
 
 // Buffer success cases
 
@@ -353,6 +455,10 @@ int main(int argc, char** argv) {
   RUN_TEST(should_AddCommentAndEOF_when_FileContainsRecordButNoEOF);
   RUN_TEST(should_ReplaceCommentAndAddEOF_when_FileContainsCommentButNoEOF);
   RUN_TEST(should_ReplaceCommentInFile_when_NewCommentIsSameSize);
+  RUN_TEST(should_ShrinkFile_when_NewCommentHasFewerLines);
+  RUN_TEST(should_KeepRecord_when_NewCommentIsSameSize);
+  RUN_TEST(should_ReplaceComment_when_FileDurabilityIsSet);
+  RUN_TEST(should_ReportUnchanged_when_FileAlreadyContainsComment);
   RUN_TEST(should_AddComment_when_BufferContainsRecord);
   RUN_TEST(should_ReplaceComment_when_BufferContainsComment);
   RUN_TEST(should_AddCommentAndEOF_when_BufferContainsRecordButNoEOF);
@@ -0,0 +1,221 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+  #include <pthread.h>
+  #define TEST_THREADS
+#endif
+
+// ContextTest, tests that contexts keep their own errors and options
+
+
+// Number of threads using their own context at the same time
+#define CONCURRENT_CONTEXTS   4
+
+// Number of reads done by each thread
+#define CONCURRENT_READS      2000
+
+
+static SAUCE_Context* first;
+static SAUCE_Context* second;
+static SAUCE sauce;
+
+
+void setUp() {
+  first = NULL;
+  second = NULL;
+  TEST_ASSERT_EQUAL(0, SAUCE_Context_create(&first));
+  TEST_ASSERT_EQUAL(0, SAUCE_Context_create(&second));
+  SAUCE_clear_error();
+  memset(&sauce, 0, sizeof(sauce));
+}
+
+void tearDown() {
+  SAUCE_Context_free(first);
+  SAUCE_Context_free(second);
+  SAUCE_set_file_mode(SAUCE_FM_DEFAULT);
+  SAUCE_set_durability(SAUCE_DURABLE_NONE);
+}
+
+
+
+
+// Successful tests
+
+void should_HaveDefaultOptions_when_ContextIsCreated() {
+  TEST_ASSERT_EQUAL(SAUCE_FM_DEFAULT, SAUCE_get_file_mode_ctx(first));
+  TEST_ASSERT_NULL(SAUCE_get_cache_ctx(first));
+  TEST_ASSERT_EQUAL(SAUCE_DURABLE_NONE, SAUCE_get_durability_ctx(first));
+  TEST_ASSERT_EQUAL_STRING("", SAUCE_get_error_ctx(first));
+}
+
+
+void should_ReadRecord_when_ReadWithContext() {
+  int res = SAUCE_fread_ctx(first, SAUCE_TESTFILE1_PATH, &sauce);
+  TEST_ASSERT_EQUAL(0, res);
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile1_expected_record(), &sauce));
+}
+
+
+void should_SetOnlyContextError_when_ReadWithContextFails() {
+  int res = SAUCE_fread_ctx(first, SAUCE_NOSAUCE_PATH, &sauce);
+  TEST_ASSERT_EQUAL(SAUCE_ERMISS, res);
+
+  TEST_ASSERT_NOT_EQUAL(0, strlen(SAUCE_get_error_ctx(first)));
+  TEST_ASSERT_EQUAL_STRING("", SAUCE_get_error_ctx(second));
+  TEST_ASSERT_EQUAL_STRING("", SAUCE_get_error());
+}
+
+
+void should_KeepContextError_when_OtherContextFails() {
+  SAUCE_fread_ctx(first, SAUCE_NOSAUCE_PATH, &sauce);
+  char message[512];
+  snprintf(message, sizeof(message), "%s", SAUCE_get_error_ctx(first));
+
+  char buffer[16];
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_read_ctx(second, NULL, sizeof(buffer), &sauce));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_read(NULL, sizeof(buffer), &sauce));
+
+  TEST_ASSERT_EQUAL_STRING(message, SAUCE_get_error_ctx(first));
+  TEST_ASSERT_EQUAL_STRING(SAUCE_get_error(), SAUCE_get_error_ctx(second));
+}
+
+
+void should_ClearOnlyContextError_when_ContextErrorIsCleared() {
+  SAUCE_fread_ctx(first, SAUCE_NOSAUCE_PATH, &sauce);
+  SAUCE_fread_ctx(second, SAUCE_NOSAUCE_PATH, &sauce);
+
+  SAUCE_clear_error_ctx(first);
+  TEST_ASSERT_EQUAL_STRING("", SAUCE_get_error_ctx(first));
+  TEST_ASSERT_NOT_EQUAL(0, strlen(SAUCE_get_error_ctx(second)));
+}
+
+
+void should_UseDefaultContext_when_ContextIsNULL() {
+  TEST_ASSERT_EQUAL(SAUCE_ERMISS, SAUCE_fread_ctx(NULL, SAUCE_NOSAUCE_PATH, &sauce));
+  TEST_ASSERT_NOT_EQUAL(0, strlen(SAUCE_get_error()));
+  TEST_ASSERT_EQUAL_STRING(SAUCE_get_error(), SAUCE_get_error_ctx(NULL));
+  TEST_ASSERT_EQUAL_STRING("", SAUCE_get_error_ctx(first));
+}
+
+
+void should_KeepContextFileMode_when_OtherModeIsSet() {
+  if (SAUCE_set_file_mode_ctx(first, SAUCE_FM_MMAP) != 0) {
+    TEST_IGNORE_MESSAGE("SAUCE_FM_MMAP is not supported on this system");
+  }
+
+  TEST_ASSERT_EQUAL(SAUCE_FM_MMAP, SAUCE_get_file_mode_ctx(first));
+  TEST_ASSERT_EQUAL(SAUCE_FM_DEFAULT, SAUCE_get_file_mode_ctx(second));
+  TEST_ASSERT_EQUAL(SAUCE_FM_DEFAULT, SAUCE_get_file_mode());
+
+  TEST_ASSERT_EQUAL(0, SAUCE_fread_ctx(first, SAUCE_TESTFILE1_PATH, &sauce));
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile1_expected_record(), &sauce));
+}
+
+
+void should_KeepContextDurability_when_OtherDurabilityIsSet() {
+  if (SAUCE_set_durability_ctx(first, SAUCE_DURABLE_GROUP) != 0) {
+    TEST_IGNORE_MESSAGE("Syncing files is not supported on this system");
+  }
+
+  TEST_ASSERT_EQUAL(SAUCE_DURABLE_GROUP, SAUCE_get_durability_ctx(first));
+  TEST_ASSERT_EQUAL(SAUCE_DURABLE_NONE, SAUCE_get_durability_ctx(second));
+  TEST_ASSERT_EQUAL(SAUCE_DURABLE_NONE, SAUCE_get_durability());
+
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_set_durability_ctx(first, (enum SAUCE_Durability)7));
+  TEST_ASSERT_EQUAL(SAUCE_DURABLE_GROUP, SAUCE_get_durability_ctx(first));
+}
+
+
+#ifdef TEST_THREADS
+typedef struct ContextThread {
+  SAUCE_Context* ctx;
+  const char* path;
+  int expected;
+  int failures;
+} ContextThread;
+
+static void* read_with_context(void* arg) {
+  ContextThread* thread = arg;
+  SAUCE record;
+  for (int i = 0; i < CONCURRENT_READS; i++) {
+    int res = SAUCE_fread_ctx(thread->ctx, thread->path, &record);
+    const char* error = SAUCE_get_error_ctx(thread->ctx);
+
+    // a successful read leaves the context's error empty, since it is never set
+    int hasError = strlen(error) != 0;
+    if (res != thread->expected || hasError != (thread->expected != 0)) thread->failures++;
+  }
+  return NULL;
+}
+#endif
+
+void should_KeepErrorsSeparate_when_ContextsAreUsedConcurrently() {
+  #ifdef TEST_THREADS
+  ContextThread threads[CONCURRENT_CONTEXTS];
+  pthread_t ids[CONCURRENT_CONTEXTS];
+  for (int i = 0; i < CONCURRENT_CONTEXTS; i++) {
+    TEST_ASSERT_EQUAL(0, SAUCE_Context_create(&threads[i].ctx));
+    threads[i].path = (i % 2 == 0) ? SAUCE_TESTFILE1_PATH : SAUCE_NOSAUCE_PATH;
+    threads[i].expected = (i % 2 == 0) ? 0 : SAUCE_ERMISS;
+    threads[i].failures = 0;
+  }
+
+  for (int i = 0; i < CONCURRENT_CONTEXTS; i++) {
+    TEST_ASSERT_EQUAL(0, pthread_create(&ids[i], NULL, read_with_context, &threads[i]));
+  }
+  for (int i = 0; i < CONCURRENT_CONTEXTS; i++) {
+    pthread_join(ids[i], NULL);
+  }
+
+  for (int i = 0; i < CONCURRENT_CONTEXTS; i++) {
+    TEST_ASSERT_EQUAL(0, threads[i].failures);
+    SAUCE_Context_free(threads[i].ctx);
+  }
+  #else
+  TEST_IGNORE_MESSAGE("Threads are not available on this system");
+  #endif
+}
+
+
+
+
+// Failure tests
+
+void should_FailToCreate_when_ContextPointerIsNULL() {
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Context_create(NULL));
+}
+
+
+void should_DoNothing_when_FreeingNULLContext() {
+  SAUCE_Context_free(NULL);
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_HaveDefaultOptions_when_ContextIsCreated);
+  RUN_TEST(should_ReadRecord_when_ReadWithContext);
+  RUN_TEST(should_SetOnlyContextError_when_ReadWithContextFails);
+  RUN_TEST(should_KeepContextError_when_OtherContextFails);
+  RUN_TEST(should_ClearOnlyContextError_when_ContextErrorIsCleared);
+  RUN_TEST(should_UseDefaultContext_when_ContextIsNULL);
+  RUN_TEST(should_KeepContextFileMode_when_OtherModeIsSet);
+  RUN_TEST(should_KeepContextDurability_when_OtherDurabilityIsSet);
+  RUN_TEST(should_KeepErrorsSeparate_when_ContextsAreUsedConcurrently);
+  RUN_TEST(should_FailToCreate_when_ContextPointerIsNULL);
+  RUN_TEST(should_DoNothing_when_FreeingNULLContext);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
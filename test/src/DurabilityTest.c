@@ -0,0 +1,224 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
+// DurabilityTest, tests that a file written with SAUCE_DURABLE_FILE holds either its old or its new
+// SAUCE data when one of the syncs of the write fails
+
+#define SHORT_COMMENT_MSG   "This is the short comment message. Simple, right!"
+
+#define SHORT_COMMENT_LINES   1
+#define LONG_COMMENT_LINES    25
+
+
+#ifdef TEST_WRAP_SYNC
+// The syncs are wrapped with the linker's --wrap option, so calls made by the library land here.
+// The failAt'th sync fails as if the system stopped there, and nothing after it is synced.
+#include <errno.h>
+
+static int syncs = 0;
+static int failAt = 0;
+
+int __real_fsync(int fd);
+int __real_fdatasync(int fd);
+
+static int sync_fails() {
+  syncs++;
+  if (failAt != 0 && syncs >= failAt) {
+    errno = EIO;
+    return 1;
+  }
+  return 0;
+}
+
+int __wrap_fsync(int fd) {
+  return sync_fails() ? -1 : __real_fsync(fd);
+}
+
+int __wrap_fdatasync(int fd) {
+  return sync_fails() ? -1 : __real_fdatasync(fd);
+}
+#endif
+
+
+static char shortComment[SAUCE_COMMENT_LINE_LENGTH * 2];
+static char longComment[SAUCE_COMMENT_LINE_LENGTH * 25];
+static char actualBuffer[4096];
+static char originalBuffer[4096];
+
+
+void setUp() {
+  #ifndef TEST_WRAP_SYNC
+  TEST_IGNORE_MESSAGE("Syncs are not counted on this system");
+  #else
+  failAt = 0;
+  syncs = 0;
+  #endif
+
+  memset(shortComment, ' ', sizeof(shortComment));
+  memcpy(shortComment, SHORT_COMMENT_MSG, sizeof(SHORT_COMMENT_MSG) - 1);
+
+  memset(longComment, ' ', sizeof(longComment));
+  TEST_ASSERT_GREATER_THAN(0, copy_file_into_buffer(SAUCE_LONGNOSAUCE_PATH, longComment));
+
+  if (SAUCE_set_durability(SAUCE_DURABLE_FILE) != 0) {
+    TEST_IGNORE_MESSAGE("Syncing files is not supported on this system");
+  }
+}
+
+void tearDown() {
+  SAUCE_set_durability(SAUCE_DURABLE_NONE);
+  #ifdef TEST_WRAP_SYNC
+  failAt = 0;
+  #endif
+}
+
+
+#ifdef TEST_WRAP_SYNC
+
+// Assert that the file at path holds the contents of original with the SAUCE data of either original or expected
+static void assert_old_or_new(const char* path, const char* original, const char* expected) {
+  if (test_file_matches_expected(path, original)) return;
+
+  TEST_ASSERT_TRUE(SAUCE_check_file(path));
+
+  SAUCE actualRecord, expectedRecord;
+  TEST_ASSERT_EQUAL(0, SAUCE_fread(path, &actualRecord));
+  TEST_ASSERT_EQUAL(0, SAUCE_fread(expected, &expectedRecord));
+  TEST_ASSERT_TRUE(SAUCE_equal(&expectedRecord, &actualRecord));
+
+  static char actualComment[SAUCE_COMMENT_STRING_LENGTH(255) + 1];
+  static char expectedComment[SAUCE_COMMENT_STRING_LENGTH(255) + 1];
+  memset(actualComment, 0, sizeof(actualComment));
+  memset(expectedComment, 0, sizeof(expectedComment));
+  int lines = SAUCE_Comment_fread(expected, expectedComment, 255);
+  TEST_ASSERT_EQUAL(lines, SAUCE_Comment_fread(path, actualComment, 255));
+  TEST_ASSERT_EQUAL_STRING(expectedComment, actualComment);
+
+  // the contents before the old SAUCE data are never touched
+  SAUCE_Layout layout;
+  TEST_ASSERT_EQUAL(0, SAUCE_flayout(original, &layout));
+  TEST_ASSERT_GREATER_OR_EQUAL(layout.content_length, copy_file_into_buffer(path, actualBuffer));
+  TEST_ASSERT_GREATER_OR_EQUAL(layout.content_length, copy_file_into_buffer(original, originalBuffer));
+  TEST_ASSERT_EQUAL_MEMORY(originalBuffer, actualBuffer, layout.content_length);
+}
+
+// Copy original to SAUCE_DURABILITY_ACTUAL_PATH and run write on it, failing each sync in turn
+// until write finishes. The file must hold the old or new SAUCE data after every failure.
+static void run_failing_each_sync(const char* original, const char* expected, int (*write)(const char* path)) {
+  for (failAt = 1; ; failAt++) {
+    TEST_ASSERT_EQUAL(0, copy_file(original, SAUCE_DURABILITY_ACTUAL_PATH));
+    syncs = 0;
+    int res = write(SAUCE_DURABILITY_ACTUAL_PATH);
+
+    if (syncs < failAt) {
+      // every sync succeeded
+      TEST_ASSERT_EQUAL(0, res);
+      TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_DURABILITY_ACTUAL_PATH, expected));
+      break;
+    }
+
+    TEST_ASSERT_EQUAL(SAUCE_EFFAIL, res);
+    assert_old_or_new(SAUCE_DURABILITY_ACTUAL_PATH, original, expected);
+  }
+
+  // the write must have been split into more than one synced step
+  TEST_ASSERT_GREATER_THAN(2, failAt);
+}
+
+
+static int write_long_comment(const char* path) {
+  return SAUCE_Comment_fwrite(path, longComment, LONG_COMMENT_LINES);
+}
+
+static int write_short_comment(const char* path) {
+  return SAUCE_Comment_fwrite(path, shortComment, SHORT_COMMENT_LINES);
+}
+
+static int remove_comment(const char* path) {
+  return SAUCE_Comment_fremove(path);
+}
+
+static int fd_write_short_comment(const char* path) {
+  int fd = open(path, O_RDWR);
+  TEST_ASSERT_NOT_EQUAL(-1, fd);
+  int res = SAUCE_Comment_fd_write(fd, shortComment, SHORT_COMMENT_LINES);
+  close(fd);
+  return res;
+}
+
+#endif
+
+
+
+// Sync failure cases
+
+void should_KeepOldOrNewData_when_GrowingCommentFails() {
+  #ifdef TEST_WRAP_SYNC
+  run_failing_each_sync(SAUCE_TESTFILE1_PATH, SAUCE_REPLACEEXISTINGCOMMENT_PATH, write_long_comment);
+  #endif
+}
+
+void should_KeepOldOrNewData_when_RemovingCommentFails() {
+  #ifdef TEST_WRAP_SYNC
+  run_failing_each_sync(SAUCE_TESTFILE1_PATH, SAUCE_REMOVECOMMENT_PATH, remove_comment);
+  #endif
+}
+
+void should_KeepOldOrNewData_when_AddingEOFFails() {
+  #ifdef TEST_WRAP_SYNC
+  run_failing_each_sync(SAUCE_SAUCEBUTNOEOF_PATH, SAUCE_REPLACECOMMENTANDADDEOF_PATH, write_short_comment);
+  #endif
+}
+
+void should_KeepOldOrNewData_when_AddingEOFThroughFileDescriptorFails() {
+  #ifdef TEST_WRAP_SYNC
+  run_failing_each_sync(SAUCE_SAUCEBUTNOEOF_PATH, SAUCE_REPLACECOMMENTANDADDEOF_PATH, fd_write_short_comment);
+  #endif
+}
+
+
+
+
+
+// File identity cases
+
+void should_KeepHardLinks_when_AddingEOF() {
+  #ifdef TEST_WRAP_SYNC
+  TEST_ASSERT_EQUAL(0, copy_file(SAUCE_SAUCEBUTNOEOF_PATH, SAUCE_DURABILITY_ACTUAL_PATH));
+  unlink(SAUCE_DURABILITY_LINK_PATH);
+  TEST_ASSERT_EQUAL(0, link(SAUCE_DURABILITY_ACTUAL_PATH, SAUCE_DURABILITY_LINK_PATH));
+
+  // the file is changed in place, so both of its names see the change
+  int res = write_short_comment(SAUCE_DURABILITY_ACTUAL_PATH);
+  int linked = test_file_matches_expected(SAUCE_DURABILITY_LINK_PATH, SAUCE_REPLACECOMMENTANDADDEOF_PATH);
+  unlink(SAUCE_DURABILITY_LINK_PATH);
+  TEST_ASSERT_EQUAL(0, res);
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_DURABILITY_ACTUAL_PATH, SAUCE_REPLACECOMMENTANDADDEOF_PATH));
+  TEST_ASSERT_TRUE(linked);
+  #endif
+}
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_KeepOldOrNewData_when_GrowingCommentFails);
+  RUN_TEST(should_KeepOldOrNewData_when_RemovingCommentFails);
+  RUN_TEST(should_KeepOldOrNewData_when_AddingEOFFails);
+  RUN_TEST(should_KeepOldOrNewData_when_AddingEOFThroughFileDescriptorFails);
+  RUN_TEST(should_KeepHardLinks_when_AddingEOF);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
@@ -0,0 +1,224 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// EditTest, tests collecting changes to a file's SAUCE data with a SAUCE_Edit and committing them together
+
+#define SHORT_COMMENT_MSG   "This is the short comment message. Simple, right!"
+
+#define SHORT_COMMENT_LINES   1
+#define LONG_COMMENT_LINES    25
+
+
+static char shortComment[SAUCE_COMMENT_LINE_LENGTH * 2];
+static char longComment[SAUCE_COMMENT_LINE_LENGTH * LONG_COMMENT_LINES];
+static SAUCE record;
+static SAUCE_Edit* edit;
+
+
+// Copy `src` to both the actual file, which is edited, and the expected file, which is changed
+// with the functions that write a record or a comment on their own.
+static void copy_actual_and_expected(const char* src) {
+  if (copy_file(src, SAUCE_EDIT_ACTUAL_PATH) != 0 || copy_file(src, SAUCE_EDIT_EXPECTED_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Failed to copy a test file to edit_actual.ans and edit_expected.ans");
+  }
+}
+
+
+void setUp() {
+  memset(shortComment, ' ', sizeof(shortComment));
+  memcpy(shortComment, SHORT_COMMENT_MSG, sizeof(SHORT_COMMENT_MSG) - 1);
+
+  memset(longComment, ' ', sizeof(longComment));
+  if (copy_file_into_buffer(SAUCE_LONGNOSAUCE_PATH, longComment) <= 0) {
+    fprintf(stderr, "Failed to write %s to longComment string", SAUCE_LONGNOSAUCE_PATH);
+    exit(-1);
+  }
+
+  SAUCE_set_default(&record);
+  memcpy(record.Title, "Edited", 6);
+  memcpy(record.Author, "EditTest", 8);
+  memcpy(record.Date, "20240229", 8);
+  record.DataType = SAUCE_DT_CHARACTER;
+  record.TInfo1 = 80;
+  record.Comments = 77; // always replaced by the number of comment lines
+
+  edit = NULL;
+}
+
+void tearDown() {
+  SAUCE_Edit_close(edit);
+  edit = NULL;
+}
+
+
+
+
+// Successful edits
+
+void should_WriteRecordAndComment_when_BothAreSet() {
+  copy_actual_and_expected(SAUCE_TESTFILE1_PATH);
+  TEST_ASSERT_EQUAL(0, SAUCE_fwrite(SAUCE_EDIT_EXPECTED_PATH, &record));
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fwrite(SAUCE_EDIT_EXPECTED_PATH, longComment, LONG_COMMENT_LINES));
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_open(SAUCE_EDIT_ACTUAL_PATH, &edit));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_record(edit, &record));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_comment(edit, longComment, LONG_COMMENT_LINES));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_commit(edit));
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_EDIT_ACTUAL_PATH, SAUCE_EDIT_EXPECTED_PATH));
+}
+
+
+void should_ShrinkFile_when_CommentGetsShorter() {
+  copy_actual_and_expected(SAUCE_TESTFILE1_PATH);
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fwrite(SAUCE_EDIT_ACTUAL_PATH, longComment, LONG_COMMENT_LINES));
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fwrite(SAUCE_EDIT_EXPECTED_PATH, longComment, LONG_COMMENT_LINES));
+  TEST_ASSERT_EQUAL(0, SAUCE_fwrite(SAUCE_EDIT_EXPECTED_PATH, &record));
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fwrite(SAUCE_EDIT_EXPECTED_PATH, shortComment, 2));
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_open(SAUCE_EDIT_ACTUAL_PATH, &edit));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_comment(edit, shortComment, 2));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_record(edit, &record));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_commit(edit));
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_EDIT_ACTUAL_PATH, SAUCE_EDIT_EXPECTED_PATH));
+}
+
+
+void should_RemoveComment_when_CommentIsRemoved() {
+  copy_actual_and_expected(SAUCE_TESTFILE1_PATH);
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_open(SAUCE_EDIT_ACTUAL_PATH, &edit));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_remove_comment(edit));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_commit(edit));
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_EDIT_ACTUAL_PATH, SAUCE_REMOVECOMMENT_PATH));
+}
+
+
+void should_AddCommentAndEOF_when_FileContainsRecordButNoEOF() {
+  copy_actual_and_expected(SAUCE_ONLYRECORD_PATH);
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_open(SAUCE_EDIT_ACTUAL_PATH, &edit));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_comment(edit, shortComment, SHORT_COMMENT_LINES));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_commit(edit));
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_EDIT_ACTUAL_PATH, SAUCE_ADDCOMMENTANDEOFTORECORD_PATH));
+}
+
+
+void should_AppendRecordAndComment_when_FileHasNoSAUCE() {
+  copy_actual_and_expected(SAUCE_NOSAUCE_PATH);
+  TEST_ASSERT_EQUAL(0, SAUCE_fwrite(SAUCE_EDIT_EXPECTED_PATH, &record));
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fwrite(SAUCE_EDIT_EXPECTED_PATH, shortComment, 2));
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_open(SAUCE_EDIT_ACTUAL_PATH, &edit));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_record(edit, &record));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_comment(edit, shortComment, 2));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_commit(edit));
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_EDIT_ACTUAL_PATH, SAUCE_EDIT_EXPECTED_PATH));
+}
+
+
+void should_ApplyNewChanges_when_EditIsCommittedTwice() {
+  copy_actual_and_expected(SAUCE_TESTFILE2_PATH);
+  TEST_ASSERT_EQUAL(0, SAUCE_fwrite(SAUCE_EDIT_EXPECTED_PATH, &record));
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_fwrite(SAUCE_EDIT_EXPECTED_PATH, longComment, LONG_COMMENT_LINES));
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_open(SAUCE_EDIT_ACTUAL_PATH, &edit));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_record(edit, &record));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_commit(edit));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_comment(edit, longComment, LONG_COMMENT_LINES));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_commit(edit));
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_EDIT_ACTUAL_PATH, SAUCE_EDIT_EXPECTED_PATH));
+}
+
+
+void should_LeaveFileUnchanged_when_EditMatchesFile() {
+  copy_actual_and_expected(SAUCE_TESTFILE1_PATH);
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_open(SAUCE_EDIT_ACTUAL_PATH, &edit));
+  TEST_ASSERT_EQUAL(SAUCE_UNCHANGED, SAUCE_Edit_commit(edit));
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_EDIT_ACTUAL_PATH, SAUCE_TESTFILE1_PATH));
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_record(edit, test_get_testfile1_expected_record()));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_comment(edit, test_get_testfile1_expected_comment(), TESTFILE1_EXPECTED_LINES));
+  TEST_ASSERT_EQUAL(SAUCE_UNCHANGED, SAUCE_Edit_commit(edit));
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_EDIT_ACTUAL_PATH, SAUCE_TESTFILE1_PATH));
+}
+
+
+
+
+// Failure cases
+
+void should_FailToOpen_when_FileDoesNotExist() {
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, SAUCE_Edit_open("expect/FILEDOESNOTEXIST.ans", &edit));
+}
+
+
+void should_FailToEdit_when_ArgumentsAreNull() {
+  copy_actual_and_expected(SAUCE_TESTFILE1_PATH);
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Edit_open(NULL, &edit));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Edit_open(SAUCE_EDIT_ACTUAL_PATH, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Edit_set_record(NULL, &record));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Edit_commit(NULL));
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_open(SAUCE_EDIT_ACTUAL_PATH, &edit));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Edit_set_record(edit, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Edit_set_comment(edit, NULL, 1));
+}
+
+
+void should_FailToCommit_when_CommentIsSetButFileHasNoRecord() {
+  copy_actual_and_expected(SAUCE_NOSAUCE_PATH);
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_open(SAUCE_EDIT_ACTUAL_PATH, &edit));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_comment(edit, shortComment, SHORT_COMMENT_LINES));
+  TEST_ASSERT_EQUAL(SAUCE_ERMISS, SAUCE_Edit_commit(edit));
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_EDIT_ACTUAL_PATH, SAUCE_NOSAUCE_PATH));
+}
+
+
+void should_FailToCommit_when_InvalidCommentIsKept() {
+  copy_actual_and_expected(SAUCE_INVALIDCOMMENT_PATH);
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_open(SAUCE_EDIT_ACTUAL_PATH, &edit));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_record(edit, &record));
+  TEST_ASSERT_EQUAL(SAUCE_ECMISS, SAUCE_Edit_commit(edit));
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_EDIT_ACTUAL_PATH, SAUCE_INVALIDCOMMENT_PATH));
+
+  // replacing the invalid comment lets the edit be committed
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_comment(edit, shortComment, SHORT_COMMENT_LINES));
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_commit(edit));
+  TEST_ASSERT_EQUAL(SHORT_COMMENT_LINES, SAUCE_Comment_fread(SAUCE_EDIT_ACTUAL_PATH, longComment, SHORT_COMMENT_LINES));
+  TEST_ASSERT_EQUAL_MEMORY(shortComment, longComment, SAUCE_COMMENT_LINE_LENGTH);
+}
+
+
+
+
+int main() {
+  UNITY_BEGIN();
+  RUN_TEST(should_WriteRecordAndComment_when_BothAreSet);
+  RUN_TEST(should_ShrinkFile_when_CommentGetsShorter);
+  RUN_TEST(should_RemoveComment_when_CommentIsRemoved);
+  RUN_TEST(should_AddCommentAndEOF_when_FileContainsRecordButNoEOF);
+  RUN_TEST(should_AppendRecordAndComment_when_FileHasNoSAUCE);
+  RUN_TEST(should_ApplyNewChanges_when_EditIsCommittedTwice);
+  RUN_TEST(should_LeaveFileUnchanged_when_EditMatchesFile);
+  RUN_TEST(should_FailToOpen_when_FileDoesNotExist);
+  RUN_TEST(should_FailToEdit_when_ArgumentsAreNull);
+  RUN_TEST(should_FailToCommit_when_CommentIsSetButFileHasNoRecord);
+  RUN_TEST(should_FailToCommit_when_InvalidCommentIsKept);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
@@ -0,0 +1,317 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _MSC_VER
+  #define fileno _fileno
+#endif
+
+// FileDescriptorTest, tests all SAUCE file descriptor functions
+
+#define SHORT_COMMENT_MSG   "This is the short comment message. Simple, right!"
+
+#define SHORT_COMMENT_LINES   1
+
+
+static char shortComment[SAUCE_COMMENT_LINE_LENGTH * 2];
+static FILE* file = NULL;
+
+
+// Copy `src` to the fd_actual file and open it for reading & writing.
+// Return the file descriptor of the opened file, or -1 on failure.
+static int open_actual(const char* src) {
+  if (copy_file(src, SAUCE_FD_ACTUAL_PATH) != 0) return -1;
+
+  file = fopen(SAUCE_FD_ACTUAL_PATH, "r+b");
+  if (file == NULL) return -1;
+  return fileno(file);
+}
+
+
+// Check whether the library was built with the file descriptor functions
+static int fd_functions_supported() {
+  FILE* probe = fopen(SAUCE_TESTFILE1_PATH, "rb");
+  if (probe == NULL) return 1;
+  SAUCE sauce;
+  int res = SAUCE_fd_read(fileno(probe), &sauce);
+  fclose(probe);
+  SAUCE_clear_error();
+  return res != SAUCE_EOTHER;
+}
+
+
+void setUp() {
+  memset(shortComment, ' ', SAUCE_COMMENT_LINE_LENGTH * 2);
+  memcpy(shortComment, SHORT_COMMENT_MSG, sizeof(SHORT_COMMENT_MSG) - 1);
+  file = NULL;
+
+  // every test is ignored if the library was built with SAUCE_USE_STDIO
+  if (!fd_functions_supported()) {
+    TEST_IGNORE_MESSAGE("File descriptor functions are not supported on this system");
+  }
+}
+
+void tearDown() {
+  if (file != NULL) fclose(file);
+  file = NULL;
+}
+
+
+
+
+// Read tests
+
+void should_ReadRecord_when_FdContainsRecord() {
+  int fd = open_actual(SAUCE_TESTFILE1_PATH);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Could not copy and open TestFile1.ans");
+    return;
+  }
+
+  SAUCE sauce;
+  int res = SAUCE_fd_read(fd, &sauce);
+  TEST_ASSERT_EQUAL(0, res);
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile1_expected_record(), &sauce));
+}
+
+
+void should_ReadComment_when_FdContainsComment() {
+  int fd = open_actual(SAUCE_TESTFILE1_PATH);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Could not copy and open TestFile1.ans");
+    return;
+  }
+
+  char comment[SAUCE_COMMENT_STRING_LENGTH(TESTFILE1_EXPECTED_LINES) + 1];
+  int res = SAUCE_Comment_fd_read(fd, comment, TESTFILE1_EXPECTED_LINES);
+  TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, res);
+  TEST_ASSERT_EQUAL_STRING(test_get_testfile1_expected_comment(), comment);
+}
+
+
+void should_FailToReadRecord_when_FdDoesNotContainRecord() {
+  int fd = open_actual(SAUCE_NOSAUCE_PATH);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Could not copy and open NoSauce.ans");
+    return;
+  }
+
+  SAUCE sauce;
+  int res = SAUCE_fd_read(fd, &sauce);
+  TEST_ASSERT_EQUAL(SAUCE_ERMISS, res);
+}
+
+
+void should_FailToReadRecord_when_FdIsInvalid() {
+  SAUCE sauce;
+  int res = SAUCE_fd_read(-1, &sauce);
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, res);
+}
+
+
+
+
+// Write tests
+
+void should_AppendRecord_when_FdContainsContent() {
+  int fd = open_actual(SAUCE_NOSAUCE_PATH);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Could not copy and open NoSauce.ans");
+    return;
+  }
+
+  int res = SAUCE_fd_write(fd, test_get_testfile3_expected_record());
+  TEST_ASSERT_EQUAL(0, res);
+
+  SAUCE sauce;
+  res = SAUCE_fd_read(fd, &sauce);
+  TEST_ASSERT_EQUAL(0, res);
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile3_expected_record(), &sauce));
+}
+
+
+void should_AddComment_when_FdContainsRecord() {
+  int fd = open_actual(SAUCE_TESTFILE2_PATH);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Could not copy and open TestFile2.ans");
+    return;
+  }
+
+  int res = SAUCE_Comment_fd_write(fd, shortComment, SHORT_COMMENT_LINES);
+  TEST_ASSERT_EQUAL(0, res);
+
+  fclose(file);
+  file = NULL;
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_FD_ACTUAL_PATH, SAUCE_ADDCOMMENTTORECORD_PATH));
+}
+
+
+void should_ReplaceCommentAndAddEOF_when_FdDoesNotContainEOF() {
+  int fd = open_actual(SAUCE_SAUCEBUTNOEOF_PATH);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Could not copy and open SauceButNoEOF.ans");
+    return;
+  }
+
+  int res = SAUCE_Comment_fd_write(fd, shortComment, SHORT_COMMENT_LINES);
+  TEST_ASSERT_EQUAL(0, res);
+
+  fclose(file);
+  file = NULL;
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_FD_ACTUAL_PATH, SAUCE_REPLACECOMMENTANDADDEOF_PATH));
+}
+
+
+void should_FailToWriteComment_when_FdDoesNotContainRecord() {
+  int fd = open_actual(SAUCE_NOSAUCE_PATH);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Could not copy and open NoSauce.ans");
+    return;
+  }
+
+  int res = SAUCE_Comment_fd_write(fd, shortComment, SHORT_COMMENT_LINES);
+  TEST_ASSERT_EQUAL(SAUCE_ERMISS, res);
+}
+
+
+void should_FailToWriteRecord_when_SAUCEIsNULL() {
+  int fd = open_actual(SAUCE_NOSAUCE_PATH);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Could not copy and open NoSauce.ans");
+    return;
+  }
+
+  int res = SAUCE_fd_write(fd, NULL);
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, res);
+}
+
+
+void should_ReplaceCommentAndAddEOF_when_FdIsEdited() {
+  int fd = open_actual(SAUCE_SAUCEBUTNOEOF_PATH);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Could not copy and open SauceButNoEOF.ans");
+    return;
+  }
+
+  SAUCE_Edit* edit = NULL;
+  int res = SAUCE_Edit_fd_open(fd, &edit);
+  TEST_ASSERT_EQUAL(0, res);
+  TEST_ASSERT_EQUAL(0, SAUCE_Edit_set_comment(edit, shortComment, SHORT_COMMENT_LINES));
+  res = SAUCE_Edit_commit(edit);
+  SAUCE_Edit_close(edit);
+  TEST_ASSERT_EQUAL(0, res);
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_FD_ACTUAL_PATH, SAUCE_REPLACECOMMENTANDADDEOF_PATH));
+}
+
+
+
+
+// Remove tests
+
+void should_RemoveRecordAndComment_when_FdContainsBoth() {
+  int fd = open_actual(SAUCE_TESTFILE1_PATH);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Could not copy and open TestFile1.ans");
+    return;
+  }
+
+  int res = SAUCE_fd_remove(fd);
+  TEST_ASSERT_EQUAL(0, res);
+
+  fclose(file);
+  file = NULL;
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_FD_ACTUAL_PATH, SAUCE_REMOVE_RECORD_AND_COMMENT_PATH));
+}
+
+
+void should_RemoveComment_when_FdContainsComment() {
+  int fd = open_actual(SAUCE_TESTFILE1_PATH);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Could not copy and open TestFile1.ans");
+    return;
+  }
+
+  int res = SAUCE_Comment_fd_remove(fd);
+  TEST_ASSERT_EQUAL(0, res);
+
+  fclose(file);
+  file = NULL;
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_FD_ACTUAL_PATH, SAUCE_REMOVECOMMENT_PATH));
+}
+
+
+void should_FailToRemove_when_FdDoesNotContainRecord() {
+  int fd = open_actual(SAUCE_NOSAUCE_PATH);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Could not copy and open NoSauce.ans");
+    return;
+  }
+
+  int res = SAUCE_fd_remove(fd);
+  TEST_ASSERT_EQUAL(SAUCE_ERMISS, res);
+}
+
+
+
+
+// Check tests
+
+void should_PassCheck_when_FdContainsRecordAndComment() {
+  int fd = open_actual(SAUCE_TESTFILE1_PATH);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Could not copy and open TestFile1.ans");
+    return;
+  }
+
+  TEST_ASSERT_TRUE(SAUCE_check_fd(fd));
+}
+
+
+void should_FailCheck_when_FdContainsInvalidComment() {
+  int fd = open_actual(SAUCE_INVALIDCOMMENT_PATH);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Could not copy and open InvalidComment.ans");
+    return;
+  }
+
+  TEST_ASSERT_FALSE(SAUCE_check_fd(fd));
+}
+
+
+void should_FailCheck_when_FdIsInvalid() {
+  TEST_ASSERT_FALSE(SAUCE_check_fd(-1));
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_ReadRecord_when_FdContainsRecord);
+  RUN_TEST(should_ReadComment_when_FdContainsComment);
+  RUN_TEST(should_FailToReadRecord_when_FdDoesNotContainRecord);
+  RUN_TEST(should_FailToReadRecord_when_FdIsInvalid);
+  RUN_TEST(should_AppendRecord_when_FdContainsContent);
+  RUN_TEST(should_AddComment_when_FdContainsRecord);
+  RUN_TEST(should_ReplaceCommentAndAddEOF_when_FdDoesNotContainEOF);
+  RUN_TEST(should_FailToWriteComment_when_FdDoesNotContainRecord);
+  RUN_TEST(should_FailToWriteRecord_when_SAUCEIsNULL);
+  RUN_TEST(should_ReplaceCommentAndAddEOF_when_FdIsEdited);
+  RUN_TEST(should_RemoveRecordAndComment_when_FdContainsBoth);
+  RUN_TEST(should_RemoveComment_when_FdContainsComment);
+  RUN_TEST(should_FailToRemove_when_FdDoesNotContainRecord);
+  RUN_TEST(should_PassCheck_when_FdContainsRecordAndComment);
+  RUN_TEST(should_FailCheck_when_FdContainsInvalidComment);
+  RUN_TEST(should_FailCheck_when_FdIsInvalid);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
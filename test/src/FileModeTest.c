@@ -0,0 +1,263 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// FileModeTest, tests the file functions in each SAUCE_FileMode
+
+#define SHORT_COMMENT_MSG   "This is the short comment message. Simple, right!"
+
+#define SHORT_COMMENT_LINES   1
+
+
+static SAUCE sauce;
+static char shortComment[SAUCE_COMMENT_LINE_LENGTH * 2];
+static char commentStr[SAUCE_COMMENT_STRING_LENGTH(255) + 1];
+
+
+// The record written to the expected write files
+void set_sauce(SAUCE* sauce) {
+  SAUCE_set_default(sauce);
+
+  memcpy(sauce->Title, "WriteFile", 9);
+  memcpy(sauce->Author, "testauthor", 10);
+  memcpy(sauce->Group, "NoGroup", 7);
+  memcpy(sauce->Date, "20000101", 8);
+  memcpy(sauce->TInfoS, "FontName", 8);
+
+  sauce->DataType = 2;
+  sauce->FileType = 1;
+  sauce->TInfo1 = 99;
+  sauce->TInfo2 = 45;
+  sauce->TInfo3 = 129;
+  sauce->TInfo4 = UINT16_MAX;
+  sauce->Comments = 1;
+  sauce->TFlags = 0x02;
+}
+
+
+void setUp() {
+  set_sauce(&sauce);
+
+  memset(shortComment, ' ', SAUCE_COMMENT_LINE_LENGTH * 2);
+  memcpy(shortComment, SHORT_COMMENT_MSG, sizeof(SHORT_COMMENT_MSG) - 1);
+  memset(commentStr, 0, sizeof(commentStr));
+
+  // clear the file_mode_actual file
+  FILE* file = fopen(SAUCE_FILE_MODE_ACTUAL_PATH, "w");
+  if (file == NULL) {
+    fprintf(stderr, "Failed to open %s", SAUCE_FILE_MODE_ACTUAL_PATH);
+    exit(1);
+  }
+  fclose(file);
+
+  // every mmap test is ignored if the system does not support the mode
+  if (SAUCE_set_file_mode(SAUCE_FM_MMAP) != 0) {
+    TEST_IGNORE_MESSAGE("SAUCE_FM_MMAP is not supported on this system");
+  }
+}
+
+void tearDown() {
+  SAUCE_set_file_mode(SAUCE_FM_DEFAULT);
+}
+
+
+
+
+// Mode tests
+
+void should_UseMmapMode_when_ModeIsSet() {
+  TEST_ASSERT_EQUAL(SAUCE_FM_MMAP, SAUCE_get_file_mode());
+
+  TEST_ASSERT_EQUAL(0, SAUCE_set_file_mode(SAUCE_FM_DEFAULT));
+  TEST_ASSERT_EQUAL(SAUCE_FM_DEFAULT, SAUCE_get_file_mode());
+}
+
+
+void should_FailToSetMode_when_ModeIsInvalid() {
+  int res = SAUCE_set_file_mode((enum SAUCE_FileMode)99);
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, res);
+
+  // the mode is unchanged
+  TEST_ASSERT_EQUAL(SAUCE_FM_MMAP, SAUCE_get_file_mode());
+}
+
+
+
+
+// Mmap read tests
+
+void should_ReadRecordAndComment_when_FileIsMapped() {
+  SAUCE actual;
+  int res = SAUCE_fread(SAUCE_TESTFILE1_PATH, &actual);
+  TEST_ASSERT_EQUAL(0, res);
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile1_expected_record(), &actual));
+
+  res = SAUCE_Comment_fread(SAUCE_TESTFILE1_PATH, commentStr, TESTFILE1_EXPECTED_LINES);
+  TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, res);
+  TEST_ASSERT_EQUAL_STRING(test_get_testfile1_expected_comment(), commentStr);
+}
+
+
+void should_ReadComment_when_MappedCommentSpansPages() {
+  // create a file longer than SAUCE_MAX_TAIL_SIZE with the largest possible comment
+  FILE* file = fopen(SAUCE_FILE_MODE_ACTUAL_PATH, "wb");
+  if (file == NULL) {
+    TEST_FAIL_MESSAGE("Failed to open file_mode_actual.ans");
+    return;
+  }
+  char content[1000];
+  memset(content, 'x', sizeof(content));
+  for (int i = 0; i < 21; i++) fwrite(content, 1, sizeof(content), file);
+  fclose(file);
+
+  static char expected[SAUCE_COMMENT_STRING_LENGTH(255) + 1];
+  for (int i = 0; i < SAUCE_COMMENT_STRING_LENGTH(255); i++) expected[i] = (char)('A' + (i % 26));
+  expected[SAUCE_COMMENT_STRING_LENGTH(255)] = 0;
+
+  if (SAUCE_fwrite(SAUCE_FILE_MODE_ACTUAL_PATH, test_get_testfile2_expected_record()) != 0 ||
+      SAUCE_Comment_fwrite(SAUCE_FILE_MODE_ACTUAL_PATH, expected, 255) != 0) {
+    TEST_FAIL_MESSAGE("Failed to write SAUCE data to file_mode_actual.ans");
+    return;
+  }
+
+  int res = SAUCE_Comment_fread(SAUCE_FILE_MODE_ACTUAL_PATH, commentStr, 255);
+  TEST_ASSERT_EQUAL(255, res);
+  TEST_ASSERT_TRUE(SAUCE_Comment_equal(commentStr, expected, 255));
+  TEST_ASSERT_TRUE(SAUCE_check_file(SAUCE_FILE_MODE_ACTUAL_PATH));
+}
+
+
+void should_FailToRead_when_MappedFileIsEmpty() {
+  SAUCE actual;
+  int res = SAUCE_fread(SAUCE_EMPTYFILE_PATH, &actual);
+  TEST_ASSERT_EQUAL(SAUCE_EEMPTY, res);
+}
+
+
+void should_FailCheck_when_MappedFileContainsInvalidComment() {
+  TEST_ASSERT_FALSE(SAUCE_check_file(SAUCE_INVALIDCOMMENT_PATH));
+}
+
+
+
+
+// Mmap write tests
+
+void should_WriteRecord_when_MappedFileIsEmpty() {
+  int res = SAUCE_fwrite(SAUCE_FILE_MODE_ACTUAL_PATH, &sauce);
+  TEST_ASSERT_EQUAL(0, res);
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_FILE_MODE_ACTUAL_PATH, SAUCE_WRITETOEMPTY_PATH));
+}
+
+
+void should_AppendRecord_when_MappedFileContainsContent() {
+  if (copy_file(SAUCE_NOSAUCE_PATH, SAUCE_FILE_MODE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Could not copy NoSauce.ans to file_mode_actual.ans");
+    return;
+  }
+
+  int res = SAUCE_fwrite(SAUCE_FILE_MODE_ACTUAL_PATH, &sauce);
+  TEST_ASSERT_EQUAL(0, res);
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_FILE_MODE_ACTUAL_PATH, SAUCE_APPEND_PATH));
+}
+
+
+void should_ReplaceRecord_when_MappedFileContainsRecord() {
+  if (copy_file(SAUCE_TESTFILE1_PATH, SAUCE_FILE_MODE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Could not copy TestFile1.ans to file_mode_actual.ans");
+    return;
+  }
+
+  int res = SAUCE_fwrite(SAUCE_FILE_MODE_ACTUAL_PATH, &sauce);
+  TEST_ASSERT_EQUAL(0, res);
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_FILE_MODE_ACTUAL_PATH, SAUCE_REPLACE_PATH));
+}
+
+
+void should_AddComment_when_MappedFileContainsRecord() {
+  if (copy_file(SAUCE_TESTFILE2_PATH, SAUCE_FILE_MODE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Could not copy TestFile2.ans to file_mode_actual.ans");
+    return;
+  }
+
+  int res = SAUCE_Comment_fwrite(SAUCE_FILE_MODE_ACTUAL_PATH, shortComment, SHORT_COMMENT_LINES);
+  TEST_ASSERT_EQUAL(0, res);
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_FILE_MODE_ACTUAL_PATH, SAUCE_ADDCOMMENTTORECORD_PATH));
+}
+
+
+void should_ReplaceCommentAndAddEOF_when_MappedFileContainsCommentButNoEOF() {
+  if (copy_file(SAUCE_SAUCEBUTNOEOF_PATH, SAUCE_FILE_MODE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Could not copy SauceButNoEOF.ans to file_mode_actual.ans");
+    return;
+  }
+
+  int res = SAUCE_Comment_fwrite(SAUCE_FILE_MODE_ACTUAL_PATH, shortComment, SHORT_COMMENT_LINES);
+  TEST_ASSERT_EQUAL(0, res);
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_FILE_MODE_ACTUAL_PATH, SAUCE_REPLACECOMMENTANDADDEOF_PATH));
+}
+
+
+
+
+// Mmap remove tests
+
+void should_RemoveRecordAndComment_when_FileIsMapped() {
+  if (copy_file(SAUCE_TESTFILE1_PATH, SAUCE_FILE_MODE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Could not copy TestFile1.ans to file_mode_actual.ans");
+    return;
+  }
+
+  int res = SAUCE_fremove(SAUCE_FILE_MODE_ACTUAL_PATH);
+  TEST_ASSERT_EQUAL(0, res);
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_FILE_MODE_ACTUAL_PATH, SAUCE_REMOVE_RECORD_AND_COMMENT_PATH));
+}
+
+
+void should_RemoveCommentAndAddEOF_when_MappedFileContainsCommentButNoEOF() {
+  if (copy_file(SAUCE_SAUCEBUTNOEOF_PATH, SAUCE_FILE_MODE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Could not copy SauceButNoEOF.ans to file_mode_actual.ans");
+    return;
+  }
+
+  int res = SAUCE_Comment_fremove(SAUCE_FILE_MODE_ACTUAL_PATH);
+  TEST_ASSERT_EQUAL(0, res);
+
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_FILE_MODE_ACTUAL_PATH, SAUCE_REMOVECOMMENTANDADDEOF_PATH));
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_UseMmapMode_when_ModeIsSet);
+  RUN_TEST(should_FailToSetMode_when_ModeIsInvalid);
+  RUN_TEST(should_ReadRecordAndComment_when_FileIsMapped);
+  RUN_TEST(should_ReadComment_when_MappedCommentSpansPages);
+  RUN_TEST(should_FailToRead_when_MappedFileIsEmpty);
+  RUN_TEST(should_FailCheck_when_MappedFileContainsInvalidComment);
+  RUN_TEST(should_WriteRecord_when_MappedFileIsEmpty);
+  RUN_TEST(should_AppendRecord_when_MappedFileContainsContent);
+  RUN_TEST(should_ReplaceRecord_when_MappedFileContainsRecord);
+  RUN_TEST(should_AddComment_when_MappedFileContainsRecord);
+  RUN_TEST(should_ReplaceCommentAndAddEOF_when_MappedFileContainsCommentButNoEOF);
+  RUN_TEST(should_RemoveRecordAndComment_when_FileIsMapped);
+  RUN_TEST(should_RemoveCommentAndAddEOF_when_MappedFileContainsCommentButNoEOF);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
@@ -85,6 +85,47 @@ void SAUCE_set_default_test_should_SetSAUCEStructToCorrectValues() {
 
 
 
+// SAUCE_get_error tests
+
+void SAUCE_get_error_test_should_ReturnEmptyString_when_ErrorIsCleared() {
+  SAUCE sauce;
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, SAUCE_fread("expect/DOESNOTEXIST.ans", &sauce));
+  SAUCE_clear_error();
+  TEST_ASSERT_EQUAL_STRING("", SAUCE_get_error());
+}
+
+
+void SAUCE_get_error_test_should_FormatArguments_when_ErrorIsRead() {
+  SAUCE sauce;
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, SAUCE_fread("expect/DOESNOTEXIST.ans", &sauce));
+  TEST_ASSERT_EQUAL_STRING("Failed to open expect/DOESNOTEXIST.ans for reading", SAUCE_get_error());
+
+  // reading the message twice gives the same message
+  TEST_ASSERT_EQUAL_STRING("Failed to open expect/DOESNOTEXIST.ans for reading", SAUCE_get_error());
+
+  SAUCE_Batch* batch = NULL;
+  TEST_ASSERT_EQUAL(0, SAUCE_Batch_create(0, &batch));
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Batch_get(batch, 12345678901ULL, &sauce));
+  TEST_ASSERT_EQUAL_STRING("Index 12345678901 is past the 0 records of the batch", SAUCE_get_error());
+  SAUCE_Batch_free(batch);
+}
+
+
+void SAUCE_get_error_test_should_CutPathShort_when_PathIsLong() {
+  char path[8192];
+  memset(path, 'a', sizeof(path) - 1);
+  path[sizeof(path) - 1] = 0;
+
+  SAUCE sauce;
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, SAUCE_fread(path, &sauce));
+  const char* error = SAUCE_get_error();
+  TEST_ASSERT_EQUAL_MEMORY("Failed to open aaaa", error, 19);
+  TEST_ASSERT_LESS_THAN(sizeof(path), strlen(error));
+}
+
+
+
+
 // Main test fixture
 int main(int argc, char** argv) {
   UNITY_BEGIN();
@@ -100,6 +141,11 @@ int main(int argc, char** argv) {
   // SAUCE_set_default() tests
   RUN_TEST(SAUCE_set_default_test_should_SetSAUCEStructToCorrectValues);
 
+  // SAUCE_get_error() tests
+  RUN_TEST(SAUCE_get_error_test_should_ReturnEmptyString_when_ErrorIsCleared);
+  RUN_TEST(SAUCE_get_error_test_should_FormatArguments_when_ErrorIsRead);
+  RUN_TEST(SAUCE_get_error_test_should_CutPathShort_when_PathIsLong);
+
   SAUCE_clear_error();
   return UNITY_END();
 }
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined(__unix__) || (defined(__APPLE__) && defined(__MACH__))
+  #include <unistd.h>
+  #include <sys/types.h>
+  #include <sys/stat.h>
+  #include <sys/mman.h>
+  #include <fcntl.h>
+  #define LARGE_FILES_POSIX
+#elif defined(_WIN32)
+  #include <io.h>
+  #include <fcntl.h>
+  #include <sys/stat.h>
+  #define LARGE_FILES_WINDOWS
+#endif
+
+// LargeFileTest, tests files and buffers larger than 4GB
+
+
+// Size of the content of the large file, just over 4GB
+#define LARGE_CONTENT_SIZE    ((int64_t)UINT32_MAX + 4096)
+
+#define SHORT_COMMENT_MSG     "This is the short comment message. Simple, right!"
+
+#define SHORT_COMMENT_LINES   1
+
+
+static char shortComment[SAUCE_COMMENT_LINE_LENGTH * 2];
+
+
+// Set the size of the large_actual file. Return 0 on success, or -1 if large files cannot be created.
+static int resize_actual(int64_t size) {
+  #if defined(LARGE_FILES_POSIX)
+  if (sizeof(off_t) < sizeof(int64_t)) return -1;
+  return truncate(SAUCE_LARGE_ACTUAL_PATH, (off_t)size);
+  #elif defined(LARGE_FILES_WINDOWS)
+  int fd = _open(SAUCE_LARGE_ACTUAL_PATH, _O_RDWR | _O_BINARY);
+  if (fd < 0) return -1;
+  int res = (_chsize_s(fd, size) == 0) ? 0 : -1;
+  _close(fd);
+  return res;
+  #else
+  (void)size;
+  return -1;
+  #endif
+}
+
+
+// Get the size of the large_actual file, or -1 on failure
+static int64_t actual_size() {
+  #if defined(LARGE_FILES_POSIX)
+  struct stat info;
+  if (stat(SAUCE_LARGE_ACTUAL_PATH, &info) < 0) return -1;
+  return (int64_t)info.st_size;
+  #elif defined(LARGE_FILES_WINDOWS)
+  struct _stat64 info;
+  if (_stat64(SAUCE_LARGE_ACTUAL_PATH, &info) < 0) return -1;
+  return (int64_t)info.st_size;
+  #else
+  return -1;
+  #endif
+}
+
+
+void setUp() {
+  memset(shortComment, ' ', SAUCE_COMMENT_LINE_LENGTH * 2);
+  memcpy(shortComment, SHORT_COMMENT_MSG, sizeof(SHORT_COMMENT_MSG) - 1);
+
+  // start every test with a large file that has no SAUCE data
+  FILE* file = fopen(SAUCE_LARGE_ACTUAL_PATH, "wb");
+  if (file == NULL) {
+    fprintf(stderr, "Failed to open %s", SAUCE_LARGE_ACTUAL_PATH);
+    exit(1);
+  }
+  fclose(file);
+
+  if (resize_actual(LARGE_CONTENT_SIZE) != 0) {
+    TEST_IGNORE_MESSAGE("Files larger than 4GB cannot be created on this system");
+  }
+}
+
+void tearDown() {
+  // don't leave a large file behind
+  FILE* file = fopen(SAUCE_LARGE_ACTUAL_PATH, "wb");
+  if (file != NULL) fclose(file);
+}
+
+
+
+
+// File tests
+
+void should_WriteAndReadRecord_when_FileIsLargerThan4GB() {
+  int res = SAUCE_fwrite(SAUCE_LARGE_ACTUAL_PATH, test_get_testfile2_expected_record());
+  TEST_ASSERT_EQUAL(0, res);
+  TEST_ASSERT_EQUAL_INT64(LARGE_CONTENT_SIZE + 1 + SAUCE_RECORD_SIZE, actual_size());
+
+  SAUCE actual;
+  res = SAUCE_fread(SAUCE_LARGE_ACTUAL_PATH, &actual);
+  TEST_ASSERT_EQUAL(0, res);
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile2_expected_record(), &actual));
+  TEST_ASSERT_TRUE(SAUCE_check_file(SAUCE_LARGE_ACTUAL_PATH));
+}
+
+
+void should_WriteAndReadComment_when_FileIsLargerThan4GB() {
+  if (SAUCE_fwrite(SAUCE_LARGE_ACTUAL_PATH, test_get_testfile2_expected_record()) != 0) {
+    TEST_FAIL_MESSAGE("Failed to write a record to large_actual.ans");
+    return;
+  }
+
+  int res = SAUCE_Comment_fwrite(SAUCE_LARGE_ACTUAL_PATH, shortComment, SHORT_COMMENT_LINES);
+  TEST_ASSERT_EQUAL(0, res);
+  TEST_ASSERT_EQUAL_INT64(LARGE_CONTENT_SIZE + 1 + SAUCE_TOTAL_SIZE(SHORT_COMMENT_LINES), actual_size());
+
+  char comment[SAUCE_COMMENT_STRING_LENGTH(SHORT_COMMENT_LINES) + 1];
+  res = SAUCE_Comment_fread(SAUCE_LARGE_ACTUAL_PATH, comment, SHORT_COMMENT_LINES);
+  TEST_ASSERT_EQUAL(SHORT_COMMENT_LINES, res);
+  TEST_ASSERT_TRUE(SAUCE_Comment_equal(shortComment, comment, SHORT_COMMENT_LINES));
+}
+
+
+void should_RemoveRecordAndComment_when_FileIsLargerThan4GB() {
+  if (SAUCE_fwrite(SAUCE_LARGE_ACTUAL_PATH, test_get_testfile2_expected_record()) != 0 ||
+      SAUCE_Comment_fwrite(SAUCE_LARGE_ACTUAL_PATH, shortComment, SHORT_COMMENT_LINES) != 0) {
+    TEST_FAIL_MESSAGE("Failed to write SAUCE data to large_actual.ans");
+    return;
+  }
+
+  int res = SAUCE_Comment_fremove(SAUCE_LARGE_ACTUAL_PATH);
+  TEST_ASSERT_EQUAL(0, res);
+  TEST_ASSERT_EQUAL_INT64(LARGE_CONTENT_SIZE + 1 + SAUCE_RECORD_SIZE, actual_size());
+
+  res = SAUCE_fremove(SAUCE_LARGE_ACTUAL_PATH);
+  TEST_ASSERT_EQUAL(0, res);
+  TEST_ASSERT_EQUAL_INT64(LARGE_CONTENT_SIZE, actual_size());
+}
+
+
+void should_ReadManyRecords_when_FilesAreLargerThan4GB() {
+  if (SAUCE_fwrite(SAUCE_LARGE_ACTUAL_PATH, test_get_testfile3_expected_record()) != 0) {
+    TEST_FAIL_MESSAGE("Failed to write a record to large_actual.ans");
+    return;
+  }
+
+  const char* paths[] = { SAUCE_LARGE_ACTUAL_PATH, SAUCE_TESTFILE1_PATH };
+  SAUCE records[2];
+  int results[2];
+  int res = SAUCE_fread_many(paths, 2, records, results, NULL);
+  TEST_ASSERT_EQUAL(2, res);
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile3_expected_record(), &records[0]));
+}
+
+
+
+
+// Buffer tests
+
+void should_ReadRecordAndComment_when_MappedBufferIsLargerThan4GB() {
+  #if defined(LARGE_FILES_POSIX) && defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+  if (sizeof(size_t) < sizeof(int64_t)) {
+    TEST_IGNORE_MESSAGE("Buffers larger than 4GB cannot be mapped on this system");
+  }
+  if (SAUCE_fwrite(SAUCE_LARGE_ACTUAL_PATH, test_get_testfile2_expected_record()) != 0 ||
+      SAUCE_Comment_fwrite(SAUCE_LARGE_ACTUAL_PATH, shortComment, SHORT_COMMENT_LINES) != 0) {
+    TEST_FAIL_MESSAGE("Failed to write SAUCE data to large_actual.ans");
+    return;
+  }
+
+  int64_t size = actual_size();
+  int fd = open(SAUCE_LARGE_ACTUAL_PATH, O_RDONLY);
+  if (fd < 0) {
+    TEST_FAIL_MESSAGE("Failed to open large_actual.ans");
+    return;
+  }
+  char* buffer = mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (buffer == MAP_FAILED) {
+    TEST_IGNORE_MESSAGE("large_actual.ans could not be mapped");
+  }
+
+  SAUCE actual;
+  char comment[SAUCE_COMMENT_STRING_LENGTH(SHORT_COMMENT_LINES) + 1];
+  int recordRes = SAUCE_read64(buffer, (size_t)size, &actual);
+  int commentRes = SAUCE_Comment_read64(buffer, (size_t)size, comment, SHORT_COMMENT_LINES);
+  int checkRes = SAUCE_check_buffer64(buffer, (size_t)size);
+  munmap(buffer, (size_t)size);
+
+  // writing the comment updated the "Comments" field of the record
+  SAUCE expected = *test_get_testfile2_expected_record();
+  expected.Comments = SHORT_COMMENT_LINES;
+  TEST_ASSERT_EQUAL(0, recordRes);
+  TEST_ASSERT_TRUE(SAUCE_equal(&expected, &actual));
+  TEST_ASSERT_EQUAL(SHORT_COMMENT_LINES, commentRes);
+  TEST_ASSERT_TRUE(SAUCE_Comment_equal(shortComment, comment, SHORT_COMMENT_LINES));
+  TEST_ASSERT_TRUE(checkRes);
+  #else
+  TEST_IGNORE_MESSAGE("Buffers larger than 4GB cannot be mapped on this system");
+  #endif
+}
+
+
+void should_MatchBufferFunctions_when_Using64BitLengths() {
+  char buffer[1024];
+  char buffer64[1024];
+  memset(buffer, 'x', sizeof(buffer));
+  memset(buffer64, 'x', sizeof(buffer64));
+
+  int len = SAUCE_write(buffer, 100, test_get_testfile1_expected_record());
+  int64_t len64 = SAUCE_write64(buffer64, 100, test_get_testfile1_expected_record());
+  TEST_ASSERT_EQUAL_INT64(len, len64);
+
+  len = SAUCE_Comment_write(buffer, (uint32_t)len, shortComment, SHORT_COMMENT_LINES);
+  len64 = SAUCE_Comment_write64(buffer64, (size_t)len64, shortComment, SHORT_COMMENT_LINES);
+  TEST_ASSERT_EQUAL_INT64(len, len64);
+  TEST_ASSERT_EQUAL_MEMORY(buffer, buffer64, sizeof(buffer));
+  TEST_ASSERT_TRUE(SAUCE_check_buffer64(buffer64, (size_t)len64));
+
+  len = SAUCE_Comment_remove(buffer, (uint32_t)len);
+  len64 = SAUCE_Comment_remove64(buffer64, (size_t)len64);
+  TEST_ASSERT_EQUAL_INT64(len, len64);
+  TEST_ASSERT_EQUAL_MEMORY(buffer, buffer64, sizeof(buffer));
+
+  len = SAUCE_remove(buffer, (uint32_t)len);
+  len64 = SAUCE_remove64(buffer64, (size_t)len64);
+  TEST_ASSERT_EQUAL_INT64(100, len64);
+  TEST_ASSERT_EQUAL_INT64(len, len64);
+  TEST_ASSERT_EQUAL_MEMORY(buffer, buffer64, sizeof(buffer));
+}
+
+
+void should_FailToRead_when_64BitBufferIsNULL() {
+  SAUCE actual;
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_read64(NULL, 128, &actual));
+  TEST_ASSERT_EQUAL_INT64(SAUCE_ENULL, SAUCE_remove64(NULL, 128));
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_WriteAndReadRecord_when_FileIsLargerThan4GB);
+  RUN_TEST(should_WriteAndReadComment_when_FileIsLargerThan4GB);
+  RUN_TEST(should_RemoveRecordAndComment_when_FileIsLargerThan4GB);
+  RUN_TEST(should_ReadManyRecords_when_FilesAreLargerThan4GB);
+  RUN_TEST(should_ReadRecordAndComment_when_MappedBufferIsLargerThan4GB);
+  RUN_TEST(should_MatchBufferFunctions_when_Using64BitLengths);
+  RUN_TEST(should_FailToRead_when_64BitBufferIsNULL);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
@@ -0,0 +1,185 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+  #include <fcntl.h>
+  #include <unistd.h>
+  #define TEST_FD
+#endif
+
+// LayoutTest, tests getting the layout of the SAUCE data of files and buffers
+
+
+static char buffer[2048];
+static SAUCE_Layout layout;
+
+
+void setUp() {
+  memset(buffer, 0, sizeof(buffer));
+  memset(&layout, 0xFF, sizeof(layout));
+}
+
+void tearDown() {}
+
+
+// Assert that a layout matches the layout of TestFile1.ans
+static void assert_testfile1_layout(const SAUCE_Layout* layout) {
+  TEST_ASSERT_TRUE(layout->record_exists);
+  TEST_ASSERT_TRUE(layout->comment_exists);
+  TEST_ASSERT_TRUE(layout->eof_exists);
+  TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, layout->lines);
+  TEST_ASSERT_EQUAL(286 - SAUCE_TOTAL_SIZE(TESTFILE1_EXPECTED_LINES), layout->start);
+  TEST_ASSERT_EQUAL(SAUCE_TOTAL_SIZE(TESTFILE1_EXPECTED_LINES), layout->sauce_length);
+  TEST_ASSERT_EQUAL(layout->start - 1, layout->content_length);
+}
+
+
+
+
+// Successful tests
+
+void should_DescribeRecordAndComment_when_FileContainsBoth() {
+  TEST_ASSERT_EQUAL(0, SAUCE_flayout(SAUCE_TESTFILE1_PATH, &layout));
+  assert_testfile1_layout(&layout);
+}
+
+
+void should_DescribeRecordAndComment_when_BufferContainsBoth() {
+  int length = copy_file_into_buffer(SAUCE_TESTFILE1_PATH, buffer);
+  TEST_ASSERT_EQUAL(0, SAUCE_layout(buffer, length, &layout));
+  assert_testfile1_layout(&layout);
+}
+
+
+void should_DescribeRecordAndComment_when_FileDescriptorContainsBoth() {
+  #ifdef TEST_FD
+  int fd = open(SAUCE_TESTFILE1_PATH, O_RDONLY);
+  TEST_ASSERT_TRUE(fd >= 0);
+  int res = SAUCE_fd_layout(fd, &layout);
+  close(fd);
+  if (res == SAUCE_EOTHER) TEST_IGNORE_MESSAGE("SAUCE_fd_layout is not supported on this system");
+  TEST_ASSERT_EQUAL(0, res);
+  assert_testfile1_layout(&layout);
+  #else
+  TEST_IGNORE_MESSAGE("File descriptors are not available on this system");
+  #endif
+}
+
+
+void should_HaveNoContent_when_FileIsOnlyEOFAndRecord() {
+  TEST_ASSERT_EQUAL(0, SAUCE_flayout(SAUCE_TESTFILE2_PATH, &layout));
+  TEST_ASSERT_TRUE(layout.record_exists);
+  TEST_ASSERT_FALSE(layout.comment_exists);
+  TEST_ASSERT_TRUE(layout.eof_exists);
+  TEST_ASSERT_EQUAL(0, layout.lines);
+  TEST_ASSERT_EQUAL(1, layout.start);
+  TEST_ASSERT_EQUAL(SAUCE_RECORD_SIZE, layout.sauce_length);
+  TEST_ASSERT_EQUAL(0, layout.content_length);
+}
+
+
+void should_CountContentUpToSauce_when_FileHasNoEOF() {
+  TEST_ASSERT_EQUAL(0, SAUCE_flayout(SAUCE_SAUCEBUTNOEOF_PATH, &layout));
+  TEST_ASSERT_TRUE(layout.comment_exists);
+  TEST_ASSERT_FALSE(layout.eof_exists);
+  TEST_ASSERT_EQUAL(285 - SAUCE_TOTAL_SIZE(TESTFILE1_EXPECTED_LINES), layout.start);
+  TEST_ASSERT_EQUAL(layout.start, layout.content_length);
+}
+
+
+void should_UseCache_when_CacheIsSet() {
+  SAUCE_Cache* cache = NULL;
+  if (SAUCE_Cache_open(SAUCE_CACHE_PATH, &cache) != 0) {
+    TEST_IGNORE_MESSAGE("Caching is not supported on this system");
+  }
+  SAUCE_set_cache(cache);
+
+  // the second layout is answered by the cache
+  TEST_ASSERT_EQUAL(0, SAUCE_flayout(SAUCE_TESTFILE1_PATH, &layout));
+  assert_testfile1_layout(&layout);
+  memset(&layout, 0xFF, sizeof(layout));
+  TEST_ASSERT_EQUAL(0, SAUCE_flayout(SAUCE_TESTFILE1_PATH, &layout));
+  assert_testfile1_layout(&layout);
+
+  SAUCE_Cache_close(cache);
+}
+
+
+
+
+// Failure tests
+
+void should_DescribeWholeFileAsContent_when_FileHasNoRecord() {
+  TEST_ASSERT_EQUAL(SAUCE_ERMISS, SAUCE_flayout(SAUCE_NOSAUCE_PATH, &layout));
+  TEST_ASSERT_FALSE(layout.record_exists);
+  TEST_ASSERT_FALSE(layout.comment_exists);
+  TEST_ASSERT_EQUAL(528, layout.start);
+  TEST_ASSERT_EQUAL(0, layout.sauce_length);
+  TEST_ASSERT_EQUAL(528, layout.content_length);
+}
+
+
+void should_DescribeOnlyRecord_when_CommentIsInvalid() {
+  int length = copy_file_into_buffer(SAUCE_INVALIDCOMMENT_PATH, buffer);
+  TEST_ASSERT_EQUAL(SAUCE_ECMISS, SAUCE_layout(buffer, length, &layout));
+  TEST_ASSERT_TRUE(layout.record_exists);
+  TEST_ASSERT_FALSE(layout.comment_exists);
+  TEST_ASSERT_EQUAL(length - SAUCE_RECORD_SIZE, layout.start);
+  TEST_ASSERT_EQUAL(SAUCE_RECORD_SIZE, layout.sauce_length);
+}
+
+
+void should_FailToGetLayout_when_FileDoesNotExist() {
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, SAUCE_flayout("expect/DoesNotExist.ans", &layout));
+  TEST_ASSERT_FALSE(layout.record_exists);
+}
+
+
+void should_FailToGetLayout_when_FileIsEmpty() {
+  TEST_ASSERT_EQUAL(SAUCE_EEMPTY, SAUCE_flayout(SAUCE_EMPTYFILE_PATH, &layout));
+  TEST_ASSERT_EQUAL(0, layout.content_length);
+}
+
+
+void should_FailToGetLayout_when_ArgumentsAreNull() {
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_flayout(NULL, &layout));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_flayout(SAUCE_TESTFILE1_PATH, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_layout(NULL, sizeof(buffer), &layout));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_layout(buffer, sizeof(buffer), NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_fd_layout(0, NULL));
+}
+
+
+void should_FailToGetLayout_when_FileDescriptorIsInvalid() {
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, SAUCE_fd_layout(-1, &layout));
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_DescribeRecordAndComment_when_FileContainsBoth);
+  RUN_TEST(should_DescribeRecordAndComment_when_BufferContainsBoth);
+  RUN_TEST(should_DescribeRecordAndComment_when_FileDescriptorContainsBoth);
+  RUN_TEST(should_HaveNoContent_when_FileIsOnlyEOFAndRecord);
+  RUN_TEST(should_CountContentUpToSauce_when_FileHasNoEOF);
+  RUN_TEST(should_UseCache_when_CacheIsSet);
+  RUN_TEST(should_DescribeWholeFileAsContent_when_FileHasNoRecord);
+  RUN_TEST(should_DescribeOnlyRecord_when_CommentIsInvalid);
+  RUN_TEST(should_FailToGetLayout_when_FileDoesNotExist);
+  RUN_TEST(should_FailToGetLayout_when_FileIsEmpty);
+  RUN_TEST(should_FailToGetLayout_when_ArgumentsAreNull);
+  RUN_TEST(should_FailToGetLayout_when_FileDescriptorIsInvalid);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
@@ -0,0 +1,226 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// RecordBatchTest, tests splitting records into a columnar SAUCE_Batch and filtering its columns
+
+
+// Number of generated records, which is not a multiple of 64 so that the last bitmap word is partial
+#define BATCH_TEST_RECORDS    1000
+
+// Number of bitmap words needed for the generated records
+#define BATCH_TEST_WORDS      SAUCE_BITMAP_WORDS(BATCH_TEST_RECORDS)
+
+static SAUCE_Batch* batch;
+static SAUCE records[BATCH_TEST_RECORDS];
+static uint64_t bitmap[BATCH_TEST_WORDS + 1];
+static uint32_t seed;
+
+
+// A small deterministic random number generator
+static uint32_t next_random() {
+  seed = seed * 1103515245U + 12345U;
+  return seed >> 8;
+}
+
+
+// Fill `records` with generated records that have few distinct values in every field
+static void generate_records() {
+  static const char* titles[] = { "Acid", "ACiD Productions", "iCE", "Blocktronics", "Fire", "A" };
+  seed = 42;
+  for (int i = 0; i < BATCH_TEST_RECORDS; i++) {
+    SAUCE* sauce = &records[i];
+    SAUCE_set_default(sauce);
+    sauce->DataType = (uint8_t)(next_random() % 9);
+    sauce->FileType = (uint8_t)(next_random() % 4);
+    sauce->TFlags = (uint8_t)(next_random() % 256);
+    sauce->TInfo1 = (uint16_t)(next_random() % 3 * 40000);
+    sauce->FileSize = next_random() % 4 == 0 ? 0xFFFFFFF0U : next_random() % 100000;
+
+    char date[9];
+    snprintf(date, sizeof(date), "%04u%02u%02u", 1990 + next_random() % 30, 1 + next_random() % 12, 1 + next_random() % 28);
+    memcpy(sauce->Date, date, sizeof(sauce->Date));
+
+    const char* title = titles[next_random() % 6];
+    memcpy(sauce->Title, title, strlen(title));
+  }
+}
+
+
+// Check that `bitmap` selects exactly the records `expected` returns true for
+static void assert_bitmap(int64_t selected, int (*expected)(const SAUCE* sauce)) {
+  int64_t count = 0;
+  for (int i = 0; i < BATCH_TEST_RECORDS; i++) {
+    int bit = (bitmap[i / 64] >> (i % 64)) & 1;
+    TEST_ASSERT_EQUAL_MESSAGE(expected(&records[i]), bit, "Record selection does not match");
+    count += bit;
+  }
+  TEST_ASSERT_EQUAL_INT64(count, selected);
+
+  // bits past the last record are cleared
+  TEST_ASSERT_EQUAL_UINT64(0, bitmap[BATCH_TEST_WORDS - 1] >> (BATCH_TEST_RECORDS % 64));
+}
+
+
+static int is_character(const SAUCE* sauce) { return sauce->DataType == SAUCE_DT_CHARACTER; }
+static int is_tflags_range(const SAUCE* sauce) { return sauce->TFlags >= 100 && sauce->TFlags <= 200; }
+static int is_tinfo1_large(const SAUCE* sauce) { return sauce->TInfo1 >= 40000; }
+static int is_filesize_large(const SAUCE* sauce) { return sauce->FileSize >= 0x80000000U; }
+static int is_nineties(const SAUCE* sauce) { return memcmp(sauce->Date, "1990", 4) >= 0 && memcmp(sauce->Date, "1999", 4) <= 0; }
+static int is_acid_prefix(const SAUCE* sauce) { return memcmp(sauce->Title, "Acid", 4) == 0; }
+static int is_long_prefix(const SAUCE* sauce) { return memcmp(sauce->Title, "ACiD Productions", 16) == 0; }
+static int is_longer_prefix(const SAUCE* sauce) { return memcmp(sauce->Title, "ACiD Productions ", 17) == 0; }
+static int is_any(const SAUCE* sauce) { (void)sauce; return 1; }
+
+
+void setUp() {
+  generate_records();
+  memset(bitmap, 0xFF, sizeof(bitmap));
+  batch = NULL;
+  TEST_ASSERT_EQUAL(0, SAUCE_Batch_create(0, &batch));
+  TEST_ASSERT_EQUAL(0, SAUCE_Batch_append(batch, records, BATCH_TEST_RECORDS));
+}
+
+void tearDown() {
+  SAUCE_Batch_free(batch);
+}
+
+
+
+
+// Success cases
+
+void should_SplitRecordsIntoColumns() {
+  TEST_ASSERT_EQUAL_UINT64(BATCH_TEST_RECORDS, batch->count);
+  TEST_ASSERT_EQUAL_UINT64(0, batch->capacity % 64);
+  TEST_ASSERT_TRUE(batch->capacity >= BATCH_TEST_RECORDS);
+
+  for (int i = 0; i < BATCH_TEST_RECORDS; i++) {
+    TEST_ASSERT_EQUAL(records[i].DataType, batch->DataType[i]);
+    TEST_ASSERT_EQUAL(records[i].FileSize, batch->FileSize[i]);
+    TEST_ASSERT_EQUAL_MEMORY(records[i].Title, batch->Title + i * sizeof(records[i].Title), sizeof(records[i].Title));
+  }
+}
+
+
+void should_GetSameRecord_when_RecordIsAppended() {
+  const SAUCE* expected = test_get_testfile1_expected_record();
+  TEST_ASSERT_EQUAL(0, SAUCE_Batch_append(batch, expected, 1));
+
+  SAUCE actual;
+  TEST_ASSERT_EQUAL(0, SAUCE_Batch_get(batch, BATCH_TEST_RECORDS, &actual));
+  TEST_ASSERT_TRUE(SAUCE_equal(expected, &actual));
+  TEST_ASSERT_EQUAL_UINT32(20240625, batch->Date[BATCH_TEST_RECORDS]);
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Batch_get(batch, 0, &actual));
+  TEST_ASSERT_TRUE(SAUCE_equal(&records[0], &actual));
+}
+
+
+void should_SelectRecords_when_FieldIsEqual() {
+  int64_t res = SAUCE_Batch_select_equal(batch, SAUCE_FIELD_DATATYPE, SAUCE_DT_CHARACTER, bitmap);
+  TEST_ASSERT_GREATER_THAN(0, res);
+  assert_bitmap(res, is_character);
+}
+
+
+void should_SelectRecords_when_FieldIsInRange() {
+  assert_bitmap(SAUCE_Batch_select_range(batch, SAUCE_FIELD_TFLAGS, 100, 200, bitmap), is_tflags_range);
+  assert_bitmap(SAUCE_Batch_select_range(batch, SAUCE_FIELD_TINFO1, 40000, UINT32_MAX, bitmap), is_tinfo1_large);
+  assert_bitmap(SAUCE_Batch_select_range(batch, SAUCE_FIELD_FILESIZE, 0x80000000U, UINT32_MAX, bitmap), is_filesize_large);
+  assert_bitmap(SAUCE_Batch_select_range(batch, SAUCE_FIELD_DATE, 19900101, 19991231, bitmap), is_nineties);
+  assert_bitmap(SAUCE_Batch_select_range(batch, SAUCE_FIELD_DATATYPE, 0, 1000, bitmap), is_any);
+}
+
+
+void should_SelectNothing_when_RangeIsEmpty() {
+  TEST_ASSERT_EQUAL_INT64(0, SAUCE_Batch_select_range(batch, SAUCE_FIELD_FILESIZE, 10, 9, bitmap));
+  TEST_ASSERT_EQUAL_INT64(0, SAUCE_Batch_select_range(batch, SAUCE_FIELD_DATATYPE, 256, 1000, bitmap));
+  for (uint64_t w = 0; w < BATCH_TEST_WORDS; w++) TEST_ASSERT_EQUAL_UINT64(0, bitmap[w]);
+
+  // the word after the bitmap is not written
+  TEST_ASSERT_EQUAL_UINT64(UINT64_MAX, bitmap[BATCH_TEST_WORDS]);
+}
+
+
+void should_SelectRecords_when_FieldStartsWithPrefix() {
+  assert_bitmap(SAUCE_Batch_select_prefix(batch, SAUCE_FIELD_TITLE, "Acid", bitmap), is_acid_prefix);
+  assert_bitmap(SAUCE_Batch_select_prefix(batch, SAUCE_FIELD_TITLE, "ACiD Productions", bitmap), is_long_prefix);
+  assert_bitmap(SAUCE_Batch_select_prefix(batch, SAUCE_FIELD_TITLE, "ACiD Productions ", bitmap), is_longer_prefix);
+  assert_bitmap(SAUCE_Batch_select_prefix(batch, SAUCE_FIELD_AUTHOR, "", bitmap), is_any);
+}
+
+
+void should_SelectNothing_when_PrefixIsLongerThanField() {
+  TEST_ASSERT_EQUAL_INT64(0, SAUCE_Batch_select_prefix(batch, SAUCE_FIELD_AUTHOR, "012345678901234567890", bitmap));
+}
+
+
+void should_SelectNothing_when_BatchIsEmpty() {
+  SAUCE_Batch* empty = NULL;
+  TEST_ASSERT_EQUAL(0, SAUCE_Batch_create(10, &empty));
+  TEST_ASSERT_EQUAL(0, SAUCE_Batch_append(empty, NULL, 0));
+  TEST_ASSERT_EQUAL_INT64(0, SAUCE_Batch_select_equal(empty, SAUCE_FIELD_DATATYPE, 0, bitmap));
+  TEST_ASSERT_EQUAL_INT64(0, SAUCE_Batch_select_prefix(empty, SAUCE_FIELD_TITLE, "", bitmap));
+  SAUCE_Batch_free(empty);
+}
+
+
+
+
+// Failure cases
+
+void should_FailToSelect_when_FieldHasWrongType() {
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Batch_select_equal(batch, SAUCE_FIELD_TITLE, 0, bitmap));
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Batch_select_prefix(batch, SAUCE_FIELD_DATE, "1996", bitmap));
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Batch_select_range(batch, (enum SAUCE_Field)100, 0, 1, bitmap));
+}
+
+
+void should_FailToGet_when_IndexIsPastCount() {
+  SAUCE actual;
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Batch_get(batch, BATCH_TEST_RECORDS, &actual));
+}
+
+
+void should_FailToUseBatch_when_ArgumentsAreNULL() {
+  SAUCE actual;
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Batch_create(0, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Batch_append(NULL, records, 1));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Batch_append(batch, NULL, 1));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Batch_get(NULL, 0, &actual));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Batch_get(batch, 0, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Batch_select_equal(NULL, SAUCE_FIELD_DATATYPE, 0, bitmap));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Batch_select_range(batch, SAUCE_FIELD_DATATYPE, 0, 1, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Batch_select_prefix(batch, SAUCE_FIELD_TITLE, NULL, bitmap));
+  SAUCE_Batch_free(NULL);
+  TEST_ASSERT_EQUAL_UINT64(BATCH_TEST_RECORDS, batch->count);
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_SplitRecordsIntoColumns);
+  RUN_TEST(should_GetSameRecord_when_RecordIsAppended);
+  RUN_TEST(should_SelectRecords_when_FieldIsEqual);
+  RUN_TEST(should_SelectRecords_when_FieldIsInRange);
+  RUN_TEST(should_SelectNothing_when_RangeIsEmpty);
+  RUN_TEST(should_SelectRecords_when_FieldStartsWithPrefix);
+  RUN_TEST(should_SelectNothing_when_PrefixIsLongerThanField);
+  RUN_TEST(should_SelectNothing_when_BatchIsEmpty);
+  RUN_TEST(should_FailToSelect_when_FieldHasWrongType);
+  RUN_TEST(should_FailToGet_when_IndexIsPastCount);
+  RUN_TEST(should_FailToUseBatch_when_ArgumentsAreNULL);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
@@ -5,9 +5,27 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+  #include <sys/resource.h>
+  #include <sys/stat.h>
+  #include <time.h>
+  #include <unistd.h>
+  #define TEST_RLIMIT
+  #define TEST_STAT
+#endif
+
 
 #define REMOVE_BOTH_EXPECTED_LEN  24
 
+// Files changed this many seconds or less before they were cached are read again
+#define CACHE_RACY_SECONDS        2
+
+// Number of files the process may open in the low file limit test, fewer than a batch remove keeps open without a limit
+#define REMOVE_MANY_FILE_LIMIT    32
+
+// Number of files in a batch remove, enough to be shared between threads
+#define REMOVE_MANY_COUNT         48
+
 // Global test buffer
 char buffer[1024];
 
@@ -24,7 +42,68 @@ void setUp() {
   memset(buffer, 0, 1024);
 }
 
-void tearDown() {}
+void tearDown() {
+  // reset the durability, so a failed test cannot leave it set for the next one
+  SAUCE_set_durability(SAUCE_DURABLE_NONE);
+}
+
+
+// Files copied into a batch remove, the result of removing their SAUCE data, and the file they should match afterwards
+static const char* removeManySources[] = { SAUCE_TESTFILE1_PATH, SAUCE_TESTFILE3_PATH, SAUCE_INVALIDCOMMENT_PATH, SAUCE_NOSAUCE_PATH };
+static const int removeManyResults[] = { 0, 0, 0, SAUCE_ERMISS };
+static const char* removeManyExpected[] = { SAUCE_REMOVE_RECORD_AND_COMMENT_PATH, SAUCE_REMOVE_ONLY_RECORD_PATH,
+                                            SAUCE_REMOVE_INVALID_COMMENT_PATH, SAUCE_NOSAUCE_PATH };
+
+static char removeManyNames[REMOVE_MANY_COUNT][64];
+static const char* removeManyPaths[REMOVE_MANY_COUNT];
+
+
+// Copy the test files of a batch remove into the remove_many directory
+static void copy_remove_many_files() {
+  for (int i = 0; i < REMOVE_MANY_COUNT; i++) {
+    snprintf(removeManyNames[i], sizeof(removeManyNames[i]), "%s/file%d.ans", SAUCE_REMOVE_MANY_ACTUAL_DIR, i);
+    removeManyPaths[i] = removeManyNames[i];
+    if (copy_file(removeManySources[i % 4], removeManyNames[i]) != 0) {
+      TEST_FAIL_MESSAGE("Could not copy a test file into the remove_many directory");
+    }
+  }
+}
+
+
+#ifdef TEST_STAT
+// Wait until a file has gone unchanged long enough for its cache entry to be used
+static void wait_until_not_racy(const char* filepath) {
+  struct stat st;
+  TEST_ASSERT_EQUAL(0, stat(filepath, &st));
+  time_t age = time(NULL) - st.st_ctime;
+  if (age <= CACHE_RACY_SECONDS) sleep((unsigned)(CACHE_RACY_SECONDS + 1 - age));
+}
+#endif
+
+
+// Get the number of read system calls made by the process. Return -1 if they are not counted.
+static long long read_syscalls() {
+  FILE* file = fopen("/proc/self/io", "r");
+  if (file == NULL) return -1;
+
+  char line[128];
+  long long count = -1;
+  while (fgets(line, sizeof(line), file) != NULL) {
+    if (sscanf(line, "syscr: %lld", &count) == 1) break;
+  }
+  fclose(file);
+  return count;
+}
+
+
+// Check that every file of a batch remove was stripped like SAUCE_fremove() would have
+static void assert_remove_many_matches(const int* results, int res) {
+  for (int i = 0; i < REMOVE_MANY_COUNT; i++) {
+    TEST_ASSERT_EQUAL(removeManyResults[i % 4], results[i]);
+    TEST_ASSERT_TRUE(test_file_matches_expected(removeManyPaths[i], removeManyExpected[i % 4]));
+  }
+  TEST_ASSERT_EQUAL(REMOVE_MANY_COUNT / 4 * 3, res);
+}
 
 
 
@@ -138,6 +217,108 @@ void should_RemoveFromFile_when_FileContainsInvalidComment() {
 }
 
 
+void should_RemoveFromEveryFile_when_ManyFilesAreGiven() {
+  int results[REMOVE_MANY_COUNT];
+  copy_remove_many_files();
+
+  int res = SAUCE_fremove_many(removeManyPaths, REMOVE_MANY_COUNT, results, NULL);
+  assert_remove_many_matches(results, res);
+}
+
+
+void should_RemoveFromEveryFile_when_ManyFilesAreGivenWithOneThread() {
+  int results[REMOVE_MANY_COUNT];
+  SAUCE_BatchOptions options = { 1, 0 };
+  copy_remove_many_files();
+
+  int res = SAUCE_fremove_many(removeManyPaths, REMOVE_MANY_COUNT, results, &options);
+  assert_remove_many_matches(results, res);
+}
+
+
+void should_RemoveFromEveryFile_when_GroupDurabilityIsGiven() {
+  int results[REMOVE_MANY_COUNT];
+  SAUCE_BatchOptions options = { 0, 0, SAUCE_DURABLE_GROUP };
+  copy_remove_many_files();
+
+  int res = SAUCE_fremove_many(removeManyPaths, REMOVE_MANY_COUNT, results, &options);
+  if (res == SAUCE_EOTHER) {
+    TEST_IGNORE_MESSAGE("Syncing files is not supported on this system");
+  }
+  assert_remove_many_matches(results, res);
+}
+
+
+void should_RemoveFromEveryFile_when_GroupDurabilityIsGivenWithLowFileLimit() {
+  #ifdef TEST_RLIMIT
+  struct rlimit limit;
+  TEST_ASSERT_EQUAL(0, getrlimit(RLIMIT_NOFILE, &limit));
+  rlim_t previous = limit.rlim_cur;
+  if (limit.rlim_max != RLIM_INFINITY && limit.rlim_max < REMOVE_MANY_FILE_LIMIT) {
+    TEST_IGNORE_MESSAGE("The file limit is already too low");
+  }
+
+  int results[REMOVE_MANY_COUNT];
+  SAUCE_BatchOptions options = { 0, 0, SAUCE_DURABLE_GROUP };
+  copy_remove_many_files();
+
+  // each thread must sync its group before the limit is reached, instead of failing to open files
+  limit.rlim_cur = REMOVE_MANY_FILE_LIMIT;
+  TEST_ASSERT_EQUAL(0, setrlimit(RLIMIT_NOFILE, &limit));
+  int res = SAUCE_fremove_many(removeManyPaths, REMOVE_MANY_COUNT, results, &options);
+  limit.rlim_cur = previous;
+  TEST_ASSERT_EQUAL(0, setrlimit(RLIMIT_NOFILE, &limit));
+
+  if (res == SAUCE_EOTHER) {
+    TEST_IGNORE_MESSAGE("Syncing files is not supported on this system");
+  }
+  assert_remove_many_matches(results, res);
+  #else
+  TEST_IGNORE_MESSAGE("The file limit cannot be changed on this system");
+  #endif
+}
+
+
+void should_RemoveFromEveryFile_when_CacheIsSet() {
+  #ifdef TEST_STAT
+  SAUCE_Cache* cache = NULL;
+  if (SAUCE_Cache_open(SAUCE_CACHE_PATH, &cache) != 0) {
+    TEST_IGNORE_MESSAGE("Caching is not supported on this system");
+  }
+
+  // fill the cache before stripping, once the files are old enough for their entries to be trusted
+  int results[REMOVE_MANY_COUNT];
+  SAUCE records[REMOVE_MANY_COUNT];
+  copy_remove_many_files();
+  wait_until_not_racy(removeManyPaths[REMOVE_MANY_COUNT - 1]);
+  SAUCE_set_cache(cache);
+  SAUCE_fread_many(removeManyPaths, REMOVE_MANY_COUNT, records, results, NULL);
+
+  // the files without a record are answered by the cache, and are not read
+  const char* noRecordPaths[REMOVE_MANY_COUNT / 4];
+  int noRecordResults[REMOVE_MANY_COUNT / 4];
+  for (int i = 0; i < REMOVE_MANY_COUNT / 4; i++) noRecordPaths[i] = removeManyPaths[i * 4 + 3];
+  long long before = read_syscalls();
+  long long overhead = read_syscalls() - before;
+  before = read_syscalls();
+  int noRecordRes = SAUCE_fremove_many(noRecordPaths, REMOVE_MANY_COUNT / 4, noRecordResults, NULL);
+  long long reads = read_syscalls() - before - overhead;
+
+  int res = SAUCE_fremove_many(removeManyPaths, REMOVE_MANY_COUNT, results, NULL);
+  SAUCE_set_cache(NULL);
+  SAUCE_Cache_close(cache);
+
+  TEST_ASSERT_EQUAL(0, noRecordRes);
+  for (int i = 0; i < REMOVE_MANY_COUNT / 4; i++) TEST_ASSERT_EQUAL(SAUCE_ERMISS, noRecordResults[i]);
+  assert_remove_many_matches(results, res);
+  if (before < 0) TEST_IGNORE_MESSAGE("Read system calls are not counted on this system");
+  TEST_ASSERT_EQUAL(0, reads);
+  #else
+  TEST_IGNORE_MESSAGE("File times cannot be checked on this system");
+  #endif
+}
+
+
 
 
 // Successful buffer remove tests
@@ -279,6 +460,29 @@ void should_FailToRemoveFromFile_when_FilePathIsNULL() {
 }
 
 
+void should_FailToRemoveFromManyFiles_when_ArgumentsAreNULL() {
+  int results[2];
+  const char* paths[] = { SAUCE_REMOVE_ACTUAL_PATH, NULL };
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_fremove_many(NULL, 2, results, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_fremove_many(paths, 2, NULL, NULL));
+
+  // a NULL path only fails its own file
+  TEST_ASSERT_EQUAL(0, SAUCE_fremove_many(paths, 2, results, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_EEMPTY, results[0]);
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, results[1]);
+}
+
+
+void should_FailToRemoveFromManyFiles_when_DurabilityIsInvalid() {
+  int results[REMOVE_MANY_COUNT];
+  SAUCE_BatchOptions options = { 0, 0, 7 };
+  copy_remove_many_files();
+
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_fremove_many(removeManyPaths, REMOVE_MANY_COUNT, results, &options));
+  TEST_ASSERT_TRUE(test_file_matches_expected(removeManyPaths[0], removeManySources[0]));
+}
+
+
 
 
 
@@ -350,6 +554,11 @@ int main(int argc, char** argv) {
   RUN_TEST(should_RemoveFromFile_when_FileOnlyContainsRecordAndEOF);
   RUN_TEST(should_RemoveFromFile_when_FileOnlyContainsRecordWithNoEOF);
   RUN_TEST(should_RemoveFromFile_when_FileContainsInvalidComment);
+  RUN_TEST(should_RemoveFromEveryFile_when_ManyFilesAreGiven);
+  RUN_TEST(should_RemoveFromEveryFile_when_ManyFilesAreGivenWithOneThread);
+  RUN_TEST(should_RemoveFromEveryFile_when_GroupDurabilityIsGiven);
+  RUN_TEST(should_RemoveFromEveryFile_when_GroupDurabilityIsGivenWithLowFileLimit);
+  RUN_TEST(should_RemoveFromEveryFile_when_CacheIsSet);
   RUN_TEST(should_RemoveFromBuffer_when_BufferContainsRecord);
   RUN_TEST(should_RemoveFromBuffer_when_BufferContainsCommentAndRecord);
   RUN_TEST(should_RemoveFromBuffer_when_BufferContainsCommentAndRecordButNoEOF);
@@ -361,6 +570,8 @@ int main(int argc, char** argv) {
   RUN_TEST(should_FailToRemoveFromFile_when_FileIsTooShort);
   RUN_TEST(should_FailToRemoveFromFile_when_FileIsEmpty);
   RUN_TEST(should_FailToRemoveFromFile_when_FilePathIsNULL);
+  RUN_TEST(should_FailToRemoveFromManyFiles_when_ArgumentsAreNULL);
+  RUN_TEST(should_FailToRemoveFromManyFiles_when_DurabilityIsInvalid);
   RUN_TEST(should_FailToRemoveFromBuf_when_SAUCEIsMissing);
   RUN_TEST(should_FailToRemoveFromBuf_when_BufferIsTooShort);
   RUN_TEST(should_FailToRemoveFromBuf_when_BufferIsEmpty);
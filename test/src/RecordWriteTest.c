@@ -5,6 +5,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+  #include <fcntl.h>
+  #include <sys/stat.h>
+  #define TEST_STAT
+#endif
+
 // RecordWriteTest, tests all SAUCE record write functions
 
 
@@ -31,6 +37,13 @@ void set_sauce(SAUCE* sauce) {
 
 static SAUCE sauce;
 static char buffer[1024];
+static char expected[1024];
+
+// Number of files in a batch patch, enough to be shared between threads
+#define PATCH_MANY_COUNT  48
+
+// Fields written by the patch tests
+#define PATCH_FIELDS      (SAUCE_FIELD_BIT(SAUCE_FIELD_GROUP) | SAUCE_FIELD_BIT(SAUCE_FIELD_TINFO1))
 
 void setUp() {
   set_sauce(&sauce);
@@ -48,6 +61,25 @@ void setUp() {
 }
 
 void tearDown() {
+  // reset the durability set by a test, even if it failed
+  SAUCE_set_durability(SAUCE_DURABLE_NONE);
+}
+
+
+// Copy a file into `expected` and write the patched fields of `sauce` into its record, which is at the end
+static int patch_expected(const char* filepath) {
+  int length = copy_file_into_buffer(filepath, expected);
+  SAUCE* record = (SAUCE*)&expected[length - SAUCE_RECORD_SIZE];
+  memcpy(record->Group, sauce.Group, sizeof(record->Group));
+  record->TInfo1 = sauce.TInfo1;
+  return length;
+}
+
+
+// Assert that a file matches the first `length` bytes of `expected`
+static void assert_file_matches_patched(const char* filepath, int length) {
+  TEST_ASSERT_EQUAL(length, copy_file_into_buffer(filepath, buffer));
+  TEST_ASSERT_EQUAL_MEMORY(expected, buffer, length);
 }
 
 
@@ -159,6 +191,144 @@ void should_ReplaceSAUCEAndAddEOF_when_FileOnlyContainsRecordWithNoEOF() {
 
 
 
+#ifdef TEST_STAT
+// Set the modification time of a file far in the past, so that any write to it would change the time
+static void set_old_mtime(const char* filepath, struct stat* st) {
+  struct timespec times[2] = { { 1000000000, 0 }, { 1000000000, 0 } };
+  TEST_ASSERT_EQUAL(0, utimensat(AT_FDCWD, filepath, times, 0));
+  TEST_ASSERT_EQUAL(0, stat(filepath, st));
+}
+
+
+// Assert that a file was not written to since `before` was taken
+static void assert_not_modified(const char* filepath, const struct stat* before) {
+  struct stat after;
+  TEST_ASSERT_EQUAL(0, stat(filepath, &after));
+  TEST_ASSERT_EQUAL(before->st_mtime, after.st_mtime);
+  TEST_ASSERT_EQUAL(before->st_size, after.st_size);
+}
+#endif
+
+
+void should_ReportUnchanged_when_FileAlreadyContainsRecord() {
+  if (copy_file(SAUCE_TESTFILE1_PATH, SAUCE_WRITE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Could not copy TestFile1.ans to write_actual.ans");
+    return;
+  }
+
+  #ifdef TEST_STAT
+  struct stat before;
+  set_old_mtime(SAUCE_WRITE_ACTUAL_PATH, &before);
+  #endif
+
+  int res = SAUCE_fwrite(SAUCE_WRITE_ACTUAL_PATH, test_get_testfile1_expected_record());
+  TEST_ASSERT_EQUAL(SAUCE_UNCHANGED, res);
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_WRITE_ACTUAL_PATH, SAUCE_TESTFILE1_PATH));
+  #ifdef TEST_STAT
+  assert_not_modified(SAUCE_WRITE_ACTUAL_PATH, &before);
+  #endif
+}
+
+
+void should_PatchOnlyGivenFields_when_FileContainsSAUCE() {
+  if (copy_file(SAUCE_TESTFILE1_PATH, SAUCE_WRITE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Could not copy TestFile1.ans to write_actual.ans");
+    return;
+  }
+
+  // the comment, the EOF character and every other field are left as they are
+  int res = SAUCE_fpatch(SAUCE_WRITE_ACTUAL_PATH, &sauce, PATCH_FIELDS);
+  TEST_ASSERT_EQUAL(0, res);
+  assert_file_matches_patched(SAUCE_WRITE_ACTUAL_PATH, patch_expected(SAUCE_TESTFILE1_PATH));
+}
+
+
+void should_LeaveFileUnchanged_when_PatchChangesNothing() {
+  if (copy_file(SAUCE_TESTFILE1_PATH, SAUCE_WRITE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Could not copy TestFile1.ans to write_actual.ans");
+    return;
+  }
+
+  int res = SAUCE_fpatch(SAUCE_WRITE_ACTUAL_PATH, test_get_testfile1_expected_record(), PATCH_FIELDS);
+  TEST_ASSERT_EQUAL(SAUCE_UNCHANGED, res);
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_WRITE_ACTUAL_PATH, SAUCE_TESTFILE1_PATH));
+}
+
+
+void should_AppendDefaultRecordWithFields_when_FileHasNoSAUCE() {
+  if (copy_file(SAUCE_NOSAUCE_PATH, SAUCE_WRITE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Could not copy NoSauce.ans to write_actual.ans");
+    return;
+  }
+
+  int res = SAUCE_fpatch(SAUCE_WRITE_ACTUAL_PATH, &sauce, PATCH_FIELDS);
+  TEST_ASSERT_EQUAL(0, res);
+
+  // the content is followed by an EOF character and a default record with the fields set
+  int length = copy_file_into_buffer(SAUCE_NOSAUCE_PATH, expected);
+  expected[length] = SAUCE_EOF_CHAR;
+  SAUCE record;
+  SAUCE_set_default(&record);
+  memcpy(record.Group, sauce.Group, sizeof(record.Group));
+  record.TInfo1 = sauce.TInfo1;
+  memcpy(&expected[length + 1], &record, SAUCE_RECORD_SIZE);
+  assert_file_matches_patched(SAUCE_WRITE_ACTUAL_PATH, length + 1 + SAUCE_RECORD_SIZE);
+}
+
+
+// Copy the test files of a batch patch into the write_many directory
+static void copy_patch_many_files(char names[][64], const char** paths) {
+  for (int i = 0; i < PATCH_MANY_COUNT; i++) {
+    snprintf(names[i], 64, "%s/file%d.ans", SAUCE_WRITE_MANY_ACTUAL_DIR, i);
+    paths[i] = names[i];
+    if (copy_file((i % 2) ? SAUCE_TESTFILE1_PATH : SAUCE_TESTFILE2_PATH, names[i]) != 0) {
+      TEST_FAIL_MESSAGE("Could not copy a test file into the write_many directory");
+    }
+  }
+}
+
+
+void should_PatchEveryFile_when_ManyFilesAreGiven() {
+  static char names[PATCH_MANY_COUNT][64];
+  const char* paths[PATCH_MANY_COUNT];
+  int results[PATCH_MANY_COUNT];
+  copy_patch_many_files(names, paths);
+
+  int res = SAUCE_fpatch_many(paths, PATCH_MANY_COUNT, &sauce, PATCH_FIELDS, results, NULL);
+  TEST_ASSERT_EQUAL(PATCH_MANY_COUNT, res);
+  for (int i = 0; i < PATCH_MANY_COUNT; i++) {
+    TEST_ASSERT_EQUAL(0, results[i]);
+    assert_file_matches_patched(paths[i], patch_expected((i % 2) ? SAUCE_TESTFILE1_PATH : SAUCE_TESTFILE2_PATH));
+  }
+
+  // patching the same fields again leaves every file alone
+  res = SAUCE_fpatch_many(paths, PATCH_MANY_COUNT, &sauce, PATCH_FIELDS, results, NULL);
+  TEST_ASSERT_EQUAL(PATCH_MANY_COUNT, res);
+  for (int i = 0; i < PATCH_MANY_COUNT; i++) {
+    TEST_ASSERT_EQUAL(SAUCE_UNCHANGED, results[i]);
+  }
+}
+
+
+void should_PatchEveryFile_when_GroupDurabilityIsSet() {
+  static char names[PATCH_MANY_COUNT][64];
+  const char* paths[PATCH_MANY_COUNT];
+  int results[PATCH_MANY_COUNT];
+  if (SAUCE_set_durability(SAUCE_DURABLE_GROUP) != 0) {
+    TEST_IGNORE_MESSAGE("Syncing files is not supported on this system");
+  }
+  copy_patch_many_files(names, paths);
+
+  // the batch syncs as the calling context asks, even without options
+  int res = SAUCE_fpatch_many(paths, PATCH_MANY_COUNT, &sauce, PATCH_FIELDS, results, NULL);
+  TEST_ASSERT_EQUAL(PATCH_MANY_COUNT, res);
+  for (int i = 0; i < PATCH_MANY_COUNT; i++) {
+    TEST_ASSERT_EQUAL(0, results[i]);
+    assert_file_matches_patched(paths[i], patch_expected((i % 2) ? SAUCE_TESTFILE1_PATH : SAUCE_TESTFILE2_PATH));
+  }
+}
+
+
 
 
 // Buffer success cases
@@ -300,6 +470,34 @@ void should_FailToWrite_when_FileSauceIsNull() {
 
 
 
+void should_FailToPatch_when_FieldsCannotBePatched() {
+  if (copy_file(SAUCE_TESTFILE1_PATH, SAUCE_WRITE_ACTUAL_PATH) != 0) {
+    TEST_FAIL_MESSAGE("Failed to write TestFile1.ans to write_actual.ans");
+    return;
+  }
+
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_fpatch(SAUCE_WRITE_ACTUAL_PATH, &sauce, SAUCE_FIELD_BIT(SAUCE_FIELD_COMMENTS)));
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_fpatch(SAUCE_WRITE_ACTUAL_PATH, &sauce, SAUCE_FIELD_BIT(SAUCE_FIELD_TINFOS + 1)));
+  TEST_ASSERT_TRUE(test_file_matches_expected(SAUCE_WRITE_ACTUAL_PATH, SAUCE_TESTFILE1_PATH));
+}
+
+
+void should_FailToPatch_when_ArgumentsAreNull() {
+  const char* paths[] = { "expect/weird/File123456.txt", NULL };
+  int results[2];
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_fpatch(NULL, &sauce, PATCH_FIELDS));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_fpatch(SAUCE_WRITE_ACTUAL_PATH, NULL, PATCH_FIELDS));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_fpatch_many(NULL, 2, &sauce, PATCH_FIELDS, results, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_fpatch_many(paths, 2, &sauce, PATCH_FIELDS, NULL, NULL));
+
+  // files that cannot be patched only fail their own result
+  TEST_ASSERT_EQUAL(0, SAUCE_fpatch_many(paths, 2, &sauce, PATCH_FIELDS, results, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, results[0]);
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, results[1]);
+}
+
+
+
 
 // Buffer fail cases
 void should_FailToWrite_when_BufferIsNull() {
@@ -336,6 +534,12 @@ int main(int argc, char** argv) {
   RUN_TEST(should_ReplaceSAUCE_when_FileOnlyContainsSAUCE);
   RUN_TEST(should_ReplaceSAUCEAndAddEOF_when_FileContainsFullSAUCEWithNoEOF);
   RUN_TEST(should_ReplaceSAUCEAndAddEOF_when_FileOnlyContainsRecordWithNoEOF);
+  RUN_TEST(should_ReportUnchanged_when_FileAlreadyContainsRecord);
+  RUN_TEST(should_PatchOnlyGivenFields_when_FileContainsSAUCE);
+  RUN_TEST(should_LeaveFileUnchanged_when_PatchChangesNothing);
+  RUN_TEST(should_AppendDefaultRecordWithFields_when_FileHasNoSAUCE);
+  RUN_TEST(should_PatchEveryFile_when_ManyFilesAreGiven);
+  RUN_TEST(should_PatchEveryFile_when_GroupDurabilityIsSet);
   RUN_TEST(should_WriteToBuffer_when_BufferLengthIsZero);
   RUN_TEST(should_AppendToBuffer_when_BufferContainsContent);
   RUN_TEST(should_AppendToBufferAndAddEOF_when_BufferContainsContentAndEOF);
@@ -346,6 +550,8 @@ int main(int argc, char** argv) {
   RUN_TEST(should_FailToWrite_when_FileDoesNotExist);
   RUN_TEST(should_FailToWrite_when_FilePathIsNull);
   RUN_TEST(should_FailToWrite_when_FileSauceIsNull);
+  RUN_TEST(should_FailToPatch_when_FieldsCannotBePatched);
+  RUN_TEST(should_FailToPatch_when_ArgumentsAreNull);
   RUN_TEST(should_FailToWrite_when_BufferIsNull);
   RUN_TEST(should_FailToWrite_when_BufferSauceIsNull);
 
@@ -0,0 +1,253 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+  #include <sys/resource.h>
+  #define TEST_RLIMIT
+#endif
+
+// ScanTreeTest, tests scanning a directory tree for SAUCE data
+
+// The directory scanned by the tests
+#define SCAN_ROOT_PATH      "expect"
+
+// Number of files in expect/, including its subdirectories
+#define SCAN_ROOT_FILES     28
+
+
+// Directory filled by the tests with one large and one small subdirectory
+#define SCAN_ACTUAL_PATH        "actual/scan_tree"
+
+// Number of files written to the large subdirectory, enough to be split between threads
+#define SCAN_LARGE_DIR_FILES    300
+
+// Number of files written to the small subdirectory
+#define SCAN_SMALL_DIR_FILES    5
+
+// Number of files the process may open in the low file limit test, so that fewer directories are kept
+// open than expect/ has
+#define SCAN_FILE_LIMIT         12
+
+
+// Results of a single threaded scan
+typedef struct ScanResults {
+  int64_t calls;
+  int     foundTestFile1;
+  int     foundNoSauce;
+  int     stopAfter;
+} ScanResults;
+
+static ScanResults results;
+static SAUCE_ScanOptions singleThread;
+
+
+static int scan_callback(const SAUCE_ScanEntry* entry, void* data) {
+  ScanResults* res = (ScanResults*)data;
+  res->calls++;
+
+  if (strcmp(entry->path, SAUCE_TESTFILE1_PATH) == 0) {
+    res->foundTestFile1 = 1;
+    TEST_ASSERT_EQUAL(0, entry->result);
+    TEST_ASSERT_TRUE(entry->record_exists);
+    TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile1_expected_record(), &entry->record));
+    TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, entry->comment_lines);
+    TEST_ASSERT_NOT_NULL(entry->comment);
+    TEST_ASSERT_EQUAL_MEMORY(test_get_testfile1_expected_comment(), entry->comment,
+                             SAUCE_COMMENT_STRING_LENGTH(TESTFILE1_EXPECTED_LINES));
+  } else if (strcmp(entry->path, SAUCE_NOSAUCE_PATH) == 0) {
+    res->foundNoSauce = 1;
+    TEST_ASSERT_EQUAL(SAUCE_ERMISS, entry->result);
+    TEST_ASSERT_FALSE(entry->record_exists);
+    TEST_ASSERT_EQUAL(0, entry->comment_lines);
+    TEST_ASSERT_NULL(entry->comment);
+  }
+
+  return res->stopAfter > 0 && res->calls >= res->stopAfter;
+}
+
+
+// Only counts files, as it may be called from many threads at once
+static int count_callback(const SAUCE_ScanEntry* entry, void* data) {
+  (void)entry;
+  __atomic_fetch_add((int64_t*)data, 1, __ATOMIC_RELAXED);
+  return 0;
+}
+
+
+void setUp() {
+  memset(&results, 0, sizeof(results));
+  memset(&singleThread, 0, sizeof(singleThread));
+  singleThread.threads = 1;
+}
+
+void tearDown() {}
+
+
+// every scan test is ignored if the system cannot scan directory trees
+static void ignore_if_unsupported(int64_t res) {
+  if (res == SAUCE_EOTHER) {
+    TEST_IGNORE_MESSAGE("SAUCE_scan_tree is not supported on this system");
+  }
+}
+
+
+
+
+// Success cases
+
+void should_ReportEveryFile_when_TreeIsScanned() {
+  int64_t res = SAUCE_scan_tree(SCAN_ROOT_PATH, scan_callback, &results, &singleThread);
+  ignore_if_unsupported(res);
+
+  TEST_ASSERT_EQUAL(SCAN_ROOT_FILES, res);
+  TEST_ASSERT_EQUAL(SCAN_ROOT_FILES, results.calls);
+  TEST_ASSERT_TRUE(results.foundTestFile1);
+  TEST_ASSERT_TRUE(results.foundNoSauce);
+}
+
+
+void should_ReportSameFiles_when_ManyThreadsScan() {
+  int64_t count = 0;
+  SAUCE_ScanOptions options;
+  memset(&options, 0, sizeof(options));
+  options.threads = 8;
+
+  int64_t res = SAUCE_scan_tree(SCAN_ROOT_PATH, count_callback, &count, &options);
+  ignore_if_unsupported(res);
+
+  TEST_ASSERT_EQUAL(SCAN_ROOT_FILES, res);
+  TEST_ASSERT_EQUAL(SCAN_ROOT_FILES, count);
+
+  // the default thread count
+  count = 0;
+  res = SAUCE_scan_tree(SCAN_ROOT_PATH, count_callback, &count, NULL);
+  TEST_ASSERT_EQUAL(SCAN_ROOT_FILES, res);
+  TEST_ASSERT_EQUAL(SCAN_ROOT_FILES, count);
+}
+
+
+void should_ReportEveryFile_when_DirectorySizesAreUnbalanced() {
+  char path[64];
+  for (int i = 0; i < SCAN_LARGE_DIR_FILES + SCAN_SMALL_DIR_FILES; i++) {
+    const char* dir = i < SCAN_LARGE_DIR_FILES ? "large" : "small";
+    snprintf(path, sizeof(path), SCAN_ACTUAL_PATH "/%s/%d.ans", dir, i);
+    if (copy_file(SAUCE_TESTFILE1_PATH, path) != 0) {
+      TEST_FAIL_MESSAGE("Could not copy TestFile1.ans to actual/scan_tree");
+      return;
+    }
+  }
+
+  int64_t count = 0;
+  SAUCE_ScanOptions options;
+  memset(&options, 0, sizeof(options));
+  options.threads = 4;
+
+  int64_t res = SAUCE_scan_tree(SCAN_ACTUAL_PATH, count_callback, &count, &options);
+  ignore_if_unsupported(res);
+
+  TEST_ASSERT_EQUAL(SCAN_LARGE_DIR_FILES + SCAN_SMALL_DIR_FILES, res);
+  TEST_ASSERT_EQUAL(SCAN_LARGE_DIR_FILES + SCAN_SMALL_DIR_FILES, count);
+}
+
+
+void should_ReportEveryFile_when_FewFilesMayBeOpened() {
+  #ifdef TEST_RLIMIT
+  struct rlimit limit;
+  TEST_ASSERT_EQUAL(0, getrlimit(RLIMIT_NOFILE, &limit));
+  rlim_t previous = limit.rlim_cur;
+  if (limit.rlim_max != RLIM_INFINITY && limit.rlim_max < SCAN_FILE_LIMIT) {
+    TEST_IGNORE_MESSAGE("The file limit is already too low");
+  }
+
+  // some directories are opened relative to their parent, and the rest by their path
+  limit.rlim_cur = SCAN_FILE_LIMIT;
+  TEST_ASSERT_EQUAL(0, setrlimit(RLIMIT_NOFILE, &limit));
+  int64_t res = SAUCE_scan_tree(SCAN_ROOT_PATH, scan_callback, &results, &singleThread);
+  limit.rlim_cur = previous;
+  TEST_ASSERT_EQUAL(0, setrlimit(RLIMIT_NOFILE, &limit));
+  ignore_if_unsupported(res);
+
+  TEST_ASSERT_EQUAL(SCAN_ROOT_FILES, res);
+  TEST_ASSERT_EQUAL(SCAN_ROOT_FILES, results.calls);
+  TEST_ASSERT_TRUE(results.foundTestFile1);
+  TEST_ASSERT_TRUE(results.foundNoSauce);
+  #else
+  TEST_IGNORE_MESSAGE("The file limit cannot be changed on this system");
+  #endif
+}
+
+
+void should_StopScan_when_CallbackReturnsNonZero() {
+  results.stopAfter = 3;
+
+  int64_t res = SAUCE_scan_tree(SCAN_ROOT_PATH, scan_callback, &results, &singleThread);
+  ignore_if_unsupported(res);
+
+  TEST_ASSERT_EQUAL(3, res);
+  TEST_ASSERT_EQUAL(3, results.calls);
+}
+
+
+void should_ScanSubdirectory_when_RootHasTrailingSlash() {
+  int64_t count = 0;
+  int64_t res = SAUCE_scan_tree("expect/write/", count_callback, &count, &singleThread);
+  ignore_if_unsupported(res);
+
+  TEST_ASSERT_GREATER_THAN(0, res);
+  TEST_ASSERT_EQUAL(res, count);
+}
+
+
+
+
+// Failure cases
+
+void should_FailToScan_when_RootDoesNotExist() {
+  int64_t res = SAUCE_scan_tree("expect/DIRDOESNOTEXIST", scan_callback, &results, &singleThread);
+  ignore_if_unsupported(res);
+
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, res);
+  TEST_ASSERT_EQUAL(0, results.calls);
+}
+
+
+void should_FailToScan_when_RootIsAFile() {
+  int64_t res = SAUCE_scan_tree(SAUCE_TESTFILE1_PATH, scan_callback, &results, &singleThread);
+  ignore_if_unsupported(res);
+
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, res);
+  TEST_ASSERT_EQUAL(0, results.calls);
+}
+
+
+void should_FailToScan_when_ArgumentsAreNULL() {
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_scan_tree(NULL, scan_callback, &results, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_scan_tree(SCAN_ROOT_PATH, NULL, &results, NULL));
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_ReportEveryFile_when_TreeIsScanned);
+  RUN_TEST(should_ReportSameFiles_when_ManyThreadsScan);
+  RUN_TEST(should_ReportEveryFile_when_DirectorySizesAreUnbalanced);
+  RUN_TEST(should_ReportEveryFile_when_FewFilesMayBeOpened);
+  RUN_TEST(should_StopScan_when_CallbackReturnsNonZero);
+  RUN_TEST(should_ScanSubdirectory_when_RootHasTrailingSlash);
+  RUN_TEST(should_FailToScan_when_RootDoesNotExist);
+  RUN_TEST(should_FailToScan_when_RootIsAFile);
+  RUN_TEST(should_FailToScan_when_ArgumentsAreNULL);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
@@ -0,0 +1,259 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// StreamTest, tests parsing SAUCE data from content fed in chunks
+
+
+// Size of the generated content, several times larger than the ring of a stream
+#define LARGE_CONTENT_SIZE    (4 * SAUCE_MAX_TAIL_SIZE + 123)
+
+// Size of the buffers that hold the content passed on by a stream
+#define OUTPUT_SIZE           (LARGE_CONTENT_SIZE + SAUCE_MAX_TAIL_SIZE)
+
+
+// Content passed on by a stream
+typedef struct StreamOutput {
+  char    content[OUTPUT_SIZE];
+  size_t  length;
+  int     calls;
+  int     stopAfter;
+} StreamOutput;
+
+static StreamOutput output;
+static SAUCE_Stream* stream;
+static SAUCE_Layout layout;
+static char input[OUTPUT_SIZE];
+static char commentStr[SAUCE_COMMENT_STRING_LENGTH(255) + 1];
+
+
+static int collect_callback(const char* content, size_t n, void* data) {
+  StreamOutput* out = data;
+  TEST_ASSERT_TRUE(out->length + n <= sizeof(out->content));
+  memcpy(&out->content[out->length], content, n);
+  out->length += n;
+  out->calls++;
+  return out->stopAfter > 0 && out->calls >= out->stopAfter;
+}
+
+
+// Feed `n` bytes of `data` to the stream in chunks of `chunk` bytes
+static void feed_in_chunks(const char* data, size_t n, size_t chunk) {
+  for (size_t i = 0; i < n; i += chunk) {
+    size_t length = (n - i < chunk) ? n - i : chunk;
+    TEST_ASSERT_EQUAL(0, SAUCE_Stream_feed(stream, data + i, length));
+  }
+}
+
+
+// Fill `input` with generated content followed by an EOF character, a comment and a record.
+// Returns the length of the input.
+static size_t make_large_input() {
+  for (size_t i = 0; i < LARGE_CONTENT_SIZE; i++) input[i] = (char)('a' + i % 26);
+
+  SAUCE sauce;
+  SAUCE_set_default(&sauce);
+  memcpy(sauce.Title, "Large", 5);
+  int64_t length = SAUCE_write64(input, LARGE_CONTENT_SIZE, &sauce);
+  TEST_ASSERT_TRUE(length > 0);
+
+  const char* comment = "A comment on a large file";
+  length = SAUCE_Comment_write64(input, (size_t)length, comment, SAUCE_num_lines(comment));
+  TEST_ASSERT_TRUE(length > 0);
+  return (size_t)length;
+}
+
+
+void setUp() {
+  memset(&output, 0, sizeof(output));
+  memset(&layout, 0xFF, sizeof(layout));
+  memset(commentStr, 0, sizeof(commentStr));
+  stream = NULL;
+  TEST_ASSERT_EQUAL(0, SAUCE_Stream_open(collect_callback, &output, &stream));
+}
+
+void tearDown() {
+  SAUCE_Stream_close(stream);
+}
+
+
+
+
+// Successful tests
+
+void should_ParseRecordAndComment_when_FedOneByteAtATime() {
+  int length = copy_file_into_buffer(SAUCE_TESTFILE1_PATH, input);
+  feed_in_chunks(input, length, 1);
+  TEST_ASSERT_EQUAL(0, SAUCE_Stream_finish(stream, &layout));
+
+  TEST_ASSERT_TRUE(layout.record_exists);
+  TEST_ASSERT_TRUE(layout.comment_exists);
+  TEST_ASSERT_TRUE(layout.eof_exists);
+  TEST_ASSERT_EQUAL(length - SAUCE_TOTAL_SIZE(TESTFILE1_EXPECTED_LINES), layout.start);
+  TEST_ASSERT_EQUAL(layout.start - 1, layout.content_length);
+
+  // only the content is passed on
+  TEST_ASSERT_EQUAL(layout.content_length, output.length);
+  TEST_ASSERT_EQUAL_MEMORY(input, output.content, output.length);
+
+  SAUCE sauce;
+  TEST_ASSERT_EQUAL(0, SAUCE_Stream_read(stream, &sauce));
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile1_expected_record(), &sauce));
+  TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, SAUCE_Stream_Comment_read(stream, commentStr, 255));
+  TEST_ASSERT_EQUAL_STRING(test_get_testfile1_expected_comment(), commentStr);
+}
+
+
+void should_PassContentOnEarly_when_StreamIsLarge() {
+  size_t length = make_large_input();
+
+  // everything before the last SAUCE_MAX_TAIL_SIZE bytes is passed on as soon as it is fed
+  TEST_ASSERT_EQUAL(0, SAUCE_Stream_feed(stream, input, length));
+  TEST_ASSERT_EQUAL(length - SAUCE_MAX_TAIL_SIZE, output.length);
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Stream_finish(stream, &layout));
+  TEST_ASSERT_EQUAL(LARGE_CONTENT_SIZE, layout.content_length);
+  TEST_ASSERT_EQUAL(LARGE_CONTENT_SIZE, output.length);
+  TEST_ASSERT_EQUAL_MEMORY(input, output.content, LARGE_CONTENT_SIZE);
+
+  SAUCE sauce;
+  TEST_ASSERT_EQUAL(0, SAUCE_Stream_read(stream, &sauce));
+  TEST_ASSERT_EQUAL_MEMORY("Large", sauce.Title, 5);
+  TEST_ASSERT_EQUAL(1, SAUCE_Stream_Comment_read(stream, commentStr, 255));
+}
+
+
+void should_MatchWholeFeed_when_FedInUnevenChunks() {
+  size_t length = make_large_input();
+  size_t chunks[] = { 7, 64, 1000, SAUCE_MAX_TAIL_SIZE - 1, SAUCE_MAX_TAIL_SIZE + 1 };
+
+  for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+    SAUCE_Stream_close(stream);
+    memset(&output, 0, sizeof(output));
+    TEST_ASSERT_EQUAL(0, SAUCE_Stream_open(collect_callback, &output, &stream));
+
+    feed_in_chunks(input, length, chunks[i]);
+    TEST_ASSERT_EQUAL(0, SAUCE_Stream_finish(stream, &layout));
+    TEST_ASSERT_EQUAL(LARGE_CONTENT_SIZE, output.length);
+    TEST_ASSERT_EQUAL_MEMORY(input, output.content, LARGE_CONTENT_SIZE);
+    TEST_ASSERT_EQUAL(LARGE_CONTENT_SIZE + 1, layout.start);
+  }
+}
+
+
+void should_ParseWithoutCallback_when_CallbackIsNull() {
+  SAUCE_Stream_close(stream);
+  TEST_ASSERT_EQUAL(0, SAUCE_Stream_open(NULL, NULL, &stream));
+
+  int length = copy_file_into_buffer(SAUCE_TESTFILE2_PATH, input);
+  feed_in_chunks(input, length, 5);
+  TEST_ASSERT_EQUAL(0, SAUCE_Stream_finish(stream, &layout));
+  TEST_ASSERT_EQUAL(0, layout.content_length);
+
+  SAUCE sauce;
+  TEST_ASSERT_EQUAL(0, SAUCE_Stream_read(stream, &sauce));
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile2_expected_record(), &sauce));
+  TEST_ASSERT_EQUAL(0, SAUCE_Stream_Comment_read(stream, commentStr, 255));
+}
+
+
+
+
+// Failure tests
+
+void should_PassEverythingOn_when_StreamHasNoRecord() {
+  int length = copy_file_into_buffer(SAUCE_NOSAUCE_PATH, input);
+  feed_in_chunks(input, length, 100);
+
+  TEST_ASSERT_EQUAL(SAUCE_ERMISS, SAUCE_Stream_finish(stream, &layout));
+  TEST_ASSERT_FALSE(layout.record_exists);
+  TEST_ASSERT_EQUAL(length, layout.content_length);
+  TEST_ASSERT_EQUAL(length, output.length);
+  TEST_ASSERT_EQUAL_MEMORY(input, output.content, length);
+
+  SAUCE sauce;
+  TEST_ASSERT_EQUAL(SAUCE_ERMISS, SAUCE_Stream_read(stream, &sauce));
+}
+
+
+void should_FailToFinish_when_StreamIsTooShort() {
+  int length = copy_file_into_buffer(SAUCE_SHORTFILE_PATH, input);
+  feed_in_chunks(input, length, 10);
+
+  TEST_ASSERT_EQUAL(SAUCE_ESHORT, SAUCE_Stream_finish(stream, &layout));
+  TEST_ASSERT_EQUAL(length, output.length);
+}
+
+
+void should_FailToReadComment_when_CommentIsInvalid() {
+  int length = copy_file_into_buffer(SAUCE_INVALIDCOMMENT_PATH, input);
+  feed_in_chunks(input, length, 33);
+
+  TEST_ASSERT_EQUAL(SAUCE_ECMISS, SAUCE_Stream_finish(stream, &layout));
+  TEST_ASSERT_TRUE(layout.record_exists);
+
+  SAUCE sauce;
+  TEST_ASSERT_EQUAL(0, SAUCE_Stream_read(stream, &sauce));
+  TEST_ASSERT_EQUAL(SAUCE_ECMISS, SAUCE_Stream_Comment_read(stream, commentStr, 255));
+}
+
+
+void should_StopStream_when_CallbackReturnsNonZero() {
+  size_t length = make_large_input();
+  output.stopAfter = 1;
+
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Stream_feed(stream, input, length));
+  TEST_ASSERT_EQUAL(1, output.calls);
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Stream_feed(stream, input, 1));
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Stream_finish(stream, NULL));
+}
+
+
+void should_FailToUse_when_StreamIsNotFinished() {
+  SAUCE sauce;
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Stream_read(stream, &sauce));
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Stream_Comment_read(stream, commentStr, 1));
+
+  TEST_ASSERT_EQUAL(SAUCE_EEMPTY, SAUCE_Stream_finish(stream, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Stream_feed(stream, input, 1));
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Stream_finish(stream, NULL));
+}
+
+
+void should_FailToUse_when_ArgumentsAreNull() {
+  SAUCE sauce;
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Stream_open(NULL, NULL, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Stream_feed(NULL, input, 1));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Stream_feed(stream, NULL, 1));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Stream_finish(NULL, &layout));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Stream_read(NULL, &sauce));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Stream_read(stream, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Stream_Comment_read(stream, NULL, 1));
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_ParseRecordAndComment_when_FedOneByteAtATime);
+  RUN_TEST(should_PassContentOnEarly_when_StreamIsLarge);
+  RUN_TEST(should_MatchWholeFeed_when_FedInUnevenChunks);
+  RUN_TEST(should_ParseWithoutCallback_when_CallbackIsNull);
+  RUN_TEST(should_PassEverythingOn_when_StreamHasNoRecord);
+  RUN_TEST(should_FailToFinish_when_StreamIsTooShort);
+  RUN_TEST(should_FailToReadComment_when_CommentIsInvalid);
+  RUN_TEST(should_StopStream_when_CallbackReturnsNonZero);
+  RUN_TEST(should_FailToUse_when_StreamIsNotFinished);
+  RUN_TEST(should_FailToUse_when_ArgumentsAreNull);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
@@ -0,0 +1,241 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+  #include <fcntl.h>
+  #include <unistd.h>
+  #define TEST_FD
+#endif
+
+// StreamWriterTest, tests writing content through a writer that appends SAUCE data when finished
+
+
+// Size of the generated content
+#define CONTENT_SIZE    (3 * SAUCE_MAX_TAIL_SIZE + 57)
+
+// Size of the buffer that holds the output of a writer
+#define OUTPUT_SIZE     (CONTENT_SIZE + SAUCE_MAX_TAIL_SIZE)
+
+
+// Output of a writer
+typedef struct WriterOutput {
+  char    content[OUTPUT_SIZE];
+  size_t  length;
+  int     calls;
+  int     stopAfter;
+} WriterOutput;
+
+static WriterOutput output;
+static SAUCE_Writer* writer;
+static SAUCE record;
+static char content[CONTENT_SIZE];
+static char commentStr[SAUCE_COMMENT_STRING_LENGTH(255) + 1];
+
+
+static int collect_callback(const char* data, size_t n, void* arg) {
+  WriterOutput* out = arg;
+  TEST_ASSERT_TRUE(out->length + n <= sizeof(out->content));
+  memcpy(&out->content[out->length], data, n);
+  out->length += n;
+  out->calls++;
+  return out->stopAfter > 0 && out->calls >= out->stopAfter;
+}
+
+
+// Write `n` bytes of `data` through the writer in chunks of `chunk` bytes
+static void write_in_chunks(const char* data, size_t n, size_t chunk) {
+  for (size_t i = 0; i < n; i += chunk) {
+    size_t length = (n - i < chunk) ? n - i : chunk;
+    TEST_ASSERT_EQUAL(0, SAUCE_Writer_write(writer, data + i, length));
+  }
+}
+
+
+void setUp() {
+  memset(&output, 0, sizeof(output));
+  memset(commentStr, 0, sizeof(commentStr));
+  writer = NULL;
+  SAUCE_set_default(&record);
+  memcpy(record.Title, "Written", 7);
+  for (size_t i = 0; i < CONTENT_SIZE; i++) content[i] = (char)('a' + i % 26);
+}
+
+void tearDown() {
+  SAUCE_Writer_close(writer);
+}
+
+
+
+
+// Successful tests
+
+void should_AppendRecordWithFileSize_when_WriterIsFinished() {
+  TEST_ASSERT_EQUAL(0, SAUCE_Writer_open(collect_callback, &output, &writer));
+  write_in_chunks(content, CONTENT_SIZE, 100);
+  TEST_ASSERT_EQUAL(0, SAUCE_Writer_finish(writer, &record, NULL, 0));
+
+  TEST_ASSERT_EQUAL(CONTENT_SIZE + 1 + SAUCE_RECORD_SIZE, output.length);
+  TEST_ASSERT_EQUAL_MEMORY(content, output.content, CONTENT_SIZE);
+  TEST_ASSERT_EQUAL(SAUCE_EOF_CHAR, output.content[CONTENT_SIZE]);
+
+  SAUCE actual;
+  TEST_ASSERT_EQUAL(0, SAUCE_read(output.content, output.length, &actual));
+  TEST_ASSERT_EQUAL(CONTENT_SIZE, actual.FileSize);
+  TEST_ASSERT_EQUAL(0, actual.Comments);
+  TEST_ASSERT_EQUAL_MEMORY("Written", actual.Title, 7);
+}
+
+
+void should_AppendCommentAndRecord_when_WriterIsFinishedWithComment() {
+  TEST_ASSERT_EQUAL(0, SAUCE_Writer_open(collect_callback, &output, &writer));
+  write_in_chunks(content, CONTENT_SIZE, 7);
+  int callsBeforeFinish = output.calls;
+  TEST_ASSERT_EQUAL(0, SAUCE_Writer_finish(writer, &record, test_get_testfile1_expected_comment(),
+                                           TESTFILE1_EXPECTED_LINES));
+
+  // the EOF character, comment and record are passed on in a single call
+  TEST_ASSERT_EQUAL(callsBeforeFinish + 1, output.calls);
+  TEST_ASSERT_EQUAL(CONTENT_SIZE + 1 + SAUCE_TOTAL_SIZE(TESTFILE1_EXPECTED_LINES), output.length);
+
+  SAUCE actual;
+  TEST_ASSERT_EQUAL(0, SAUCE_read(output.content, output.length, &actual));
+  TEST_ASSERT_EQUAL(CONTENT_SIZE, actual.FileSize);
+  TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, actual.Comments);
+
+  int lines = SAUCE_Comment_read(output.content, output.length, commentStr, TESTFILE1_EXPECTED_LINES);
+  TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, lines);
+  TEST_ASSERT_EQUAL_STRING(test_get_testfile1_expected_comment(), commentStr);
+}
+
+
+void should_WriteOnlyEOFAndRecord_when_NoContentIsWritten() {
+  TEST_ASSERT_EQUAL(0, SAUCE_Writer_open(collect_callback, &output, &writer));
+  TEST_ASSERT_EQUAL(0, SAUCE_Writer_finish(writer, &record, NULL, 0));
+
+  TEST_ASSERT_EQUAL(1 + SAUCE_RECORD_SIZE, output.length);
+  SAUCE actual;
+  TEST_ASSERT_EQUAL(0, SAUCE_read(output.content, output.length, &actual));
+  TEST_ASSERT_EQUAL(0, actual.FileSize);
+}
+
+
+void should_WriteFileThatCanBeRead_when_WriterUsesFileDescriptor() {
+  #ifdef TEST_FD
+  int fd = open(SAUCE_WRITER_ACTUAL_PATH, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  TEST_ASSERT_TRUE(fd >= 0);
+  if (SAUCE_Writer_fd_open(fd, &writer) != 0) {
+    close(fd);
+    TEST_IGNORE_MESSAGE("SAUCE_Writer_fd_open is not supported on this system");
+  }
+  write_in_chunks(content, CONTENT_SIZE, 1000);
+  int res = SAUCE_Writer_finish(writer, &record, test_get_testfile1_expected_comment(), TESTFILE1_EXPECTED_LINES);
+  close(fd);
+  TEST_ASSERT_EQUAL(0, res);
+
+  SAUCE actual;
+  TEST_ASSERT_EQUAL(0, SAUCE_fread(SAUCE_WRITER_ACTUAL_PATH, &actual));
+  TEST_ASSERT_EQUAL(CONTENT_SIZE, actual.FileSize);
+  TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, SAUCE_Comment_fread(SAUCE_WRITER_ACTUAL_PATH, commentStr,
+                                                                  TESTFILE1_EXPECTED_LINES));
+  TEST_ASSERT_EQUAL_STRING(test_get_testfile1_expected_comment(), commentStr);
+
+  SAUCE_Layout layout;
+  TEST_ASSERT_EQUAL(0, SAUCE_flayout(SAUCE_WRITER_ACTUAL_PATH, &layout));
+  TEST_ASSERT_TRUE(layout.eof_exists);
+  TEST_ASSERT_EQUAL(CONTENT_SIZE, layout.content_length);
+  #else
+  TEST_IGNORE_MESSAGE("File descriptors are not available on this system");
+  #endif
+}
+
+
+
+
+// Failure tests
+
+void should_FailToWrite_when_WriterIsFinished() {
+  TEST_ASSERT_EQUAL(0, SAUCE_Writer_open(collect_callback, &output, &writer));
+  TEST_ASSERT_EQUAL(0, SAUCE_Writer_finish(writer, &record, NULL, 0));
+  size_t length = output.length;
+
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Writer_write(writer, content, 10));
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Writer_finish(writer, &record, NULL, 0));
+  TEST_ASSERT_EQUAL(length, output.length);
+}
+
+
+void should_FailToWrite_when_CallbackStopsWriter() {
+  output.stopAfter = 2;
+  TEST_ASSERT_EQUAL(0, SAUCE_Writer_open(collect_callback, &output, &writer));
+  TEST_ASSERT_EQUAL(0, SAUCE_Writer_write(writer, content, 10));
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Writer_write(writer, content, 10));
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Writer_write(writer, content, 10));
+  TEST_ASSERT_EQUAL(SAUCE_EOTHER, SAUCE_Writer_finish(writer, &record, NULL, 0));
+  TEST_ASSERT_EQUAL(2, output.calls);
+}
+
+
+void should_FailToFinish_when_FileDescriptorIsNotWritable() {
+  #ifdef TEST_FD
+  int fd = open(SAUCE_TESTFILE1_PATH, O_RDONLY);
+  TEST_ASSERT_TRUE(fd >= 0);
+  if (SAUCE_Writer_fd_open(fd, &writer) != 0) {
+    close(fd);
+    TEST_IGNORE_MESSAGE("SAUCE_Writer_fd_open is not supported on this system");
+  }
+  int res = SAUCE_Writer_finish(writer, &record, NULL, 0);
+  close(fd);
+  TEST_ASSERT_EQUAL(SAUCE_EFFAIL, res);
+  #else
+  TEST_IGNORE_MESSAGE("File descriptors are not available on this system");
+  #endif
+}
+
+
+void should_FailToOpen_when_ArgumentsAreInvalid() {
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Writer_open(NULL, &output, &writer));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Writer_open(collect_callback, &output, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Writer_fd_open(0, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, SAUCE_Writer_fd_open(-1, &writer));
+  TEST_ASSERT_NULL(writer);
+}
+
+
+void should_FailToWrite_when_ArgumentsAreNull() {
+  TEST_ASSERT_EQUAL(0, SAUCE_Writer_open(collect_callback, &output, &writer));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Writer_write(NULL, content, 10));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Writer_write(writer, NULL, 10));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Writer_finish(NULL, &record, NULL, 0));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Writer_finish(writer, NULL, NULL, 0));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Writer_finish(writer, &record, NULL, 1));
+
+  // the writer can still be finished after the failed calls
+  TEST_ASSERT_EQUAL(0, SAUCE_Writer_finish(writer, &record, NULL, 0));
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_AppendRecordWithFileSize_when_WriterIsFinished);
+  RUN_TEST(should_AppendCommentAndRecord_when_WriterIsFinishedWithComment);
+  RUN_TEST(should_WriteOnlyEOFAndRecord_when_NoContentIsWritten);
+  RUN_TEST(should_WriteFileThatCanBeRead_when_WriterUsesFileDescriptor);
+  RUN_TEST(should_FailToWrite_when_WriterIsFinished);
+  RUN_TEST(should_FailToWrite_when_CallbackStopsWriter);
+  RUN_TEST(should_FailToFinish_when_FileDescriptorIsNotWritable);
+  RUN_TEST(should_FailToOpen_when_ArgumentsAreInvalid);
+  RUN_TEST(should_FailToWrite_when_ArgumentsAreNull);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
@@ -61,6 +61,9 @@
 // File to contain the actual results of a test write
 #define SAUCE_WRITE_ACTUAL_PATH   "actual/write_actual.ans"
 
+// Directory filled with copies of the test files by the batch patch tests
+#define SAUCE_WRITE_MANY_ACTUAL_DIR   "actual/write_many"
+
 
 // Expected remove file results. These files should not be changed
 
@@ -76,6 +79,15 @@
 // File to contain the actual results of a test remove
 #define SAUCE_REMOVE_ACTUAL_PATH  "actual/remove_actual.ans"
 
+// Directory filled with copies of the test files by the batch remove tests
+#define SAUCE_REMOVE_MANY_ACTUAL_DIR  "actual/remove_many"
+
+
+// Comment read file results.
+
+// File to contain a generated file for a test comment read
+#define SAUCE_COMMENT_READ_ACTUAL_PATH      "actual/comment_read_actual.ans"
+
 
 // Expected comment write file results. These files should not be changed.
 
@@ -110,6 +122,69 @@
 #define SAUCE_REMOVECOMMENTANDADDEOF_PATH   "expect/comment_remove/RemoveCommentAndAddEOF.ans"
 
 
+// File descriptor file results.
+
+// File to contain the actual results of a test done through a file descriptor
+#define SAUCE_FD_ACTUAL_PATH                "actual/fd_actual.ans"
+
+
+// File mode file results.
+
+// File to contain the actual results of a test done in a SAUCE_FileMode
+#define SAUCE_FILE_MODE_ACTUAL_PATH         "actual/file_mode_actual.ans"
+
+
+// Large file results.
+
+// File that is grown past 4GB to test large files. The file is sparse, so it takes up almost no disk space.
+#define SAUCE_LARGE_ACTUAL_PATH             "actual/large_actual.ans"
+
+
+// Cache results.
+
+// Cache file written by the cache tests
+#define SAUCE_CACHE_PATH                    "actual/cache_actual.cache"
+
+// File that is changed while its record is in a cache
+#define SAUCE_CACHE_ACTUAL_PATH             "actual/cache_actual.ans"
+
+
+// Watch results.
+
+// Directory watched by the watch tests
+#define SAUCE_WATCH_ACTUAL_PATH             "actual/watch"
+
+
+// Writer results.
+
+// File written by the stream writer tests
+#define SAUCE_WRITER_ACTUAL_PATH            "actual/writer_actual.ans"
+
+
+// Edit results.
+
+// File changed by the edit tests
+#define SAUCE_EDIT_ACTUAL_PATH              "actual/edit_actual.ans"
+
+// File changed by the write and remove functions to give the expected result of an edit
+#define SAUCE_EDIT_EXPECTED_PATH            "actual/edit_expected.ans"
+
+
+// Allocation results.
+
+// File written by the allocation tests
+#define SAUCE_ALLOCATION_ACTUAL_PATH        "actual/allocation_actual.ans"
+
+
+// Durability results.
+
+// File written by the durability tests while its syncs fail
+#define SAUCE_DURABILITY_ACTUAL_PATH        "actual/durability_actual.ans"
+
+// Second name of the file written by the durability tests
+#define SAUCE_DURABILITY_LINK_PATH          "actual/durability_link.ans"
+
+
 // The expected result of SAUCE_set_default
 extern const SAUCE default_record;
 
@@ -0,0 +1,169 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// ViewTest, tests viewing the SAUCE data of a buffer without copying it
+
+
+static char buffer[1024];
+static SAUCE_View view;
+static SAUCE_CommentIter iter;
+
+
+void setUp() {
+  memset(buffer, 0, sizeof(buffer));
+  memset(&view, 0xFF, sizeof(view));
+  memset(&iter, 0, sizeof(iter));
+}
+
+void tearDown() {}
+
+
+
+
+// Successful tests
+
+void should_PointIntoBuffer_when_BufferContainsRecordAndComment() {
+  int length = copy_file_into_buffer(SAUCE_TESTFILE1_PATH, buffer);
+
+  TEST_ASSERT_EQUAL(0, SAUCE_view(buffer, length, &view));
+  TEST_ASSERT_EQUAL_PTR(&buffer[length - SAUCE_RECORD_SIZE], view.record);
+  TEST_ASSERT_EQUAL_PTR(&buffer[length - SAUCE_TOTAL_SIZE(TESTFILE1_EXPECTED_LINES) + 5], view.comment);
+  TEST_ASSERT_EQUAL(TESTFILE1_EXPECTED_LINES, view.lines);
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile1_expected_record(), view.record));
+}
+
+
+void should_HaveNoComment_when_BufferContainsOnlyRecord() {
+  int length = copy_file_into_buffer(SAUCE_TESTFILE2_PATH, buffer);
+
+  TEST_ASSERT_EQUAL(0, SAUCE_view(buffer, length, &view));
+  TEST_ASSERT_EQUAL_PTR(&buffer[length - SAUCE_RECORD_SIZE], view.record);
+  TEST_ASSERT_NULL(view.comment);
+  TEST_ASSERT_EQUAL(0, view.lines);
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile2_expected_record(), view.record));
+}
+
+
+void should_TrimEveryLine_when_CommentIsIterated() {
+  int length = copy_file_into_buffer(SAUCE_TESTFILE1_PATH, buffer);
+  TEST_ASSERT_EQUAL(0, SAUCE_view(buffer, length, &view));
+
+  const char* expected = test_get_testfile1_expected_comment();
+  const char* line = NULL;
+  uint8_t lineLength = 0;
+  SAUCE_Comment_iter_init(&view, &iter);
+
+  // the first line ends in a word and a single space, and the second line is padded with spaces
+  TEST_ASSERT_EQUAL(1, SAUCE_Comment_iter_next(&iter, &line, &lineLength));
+  TEST_ASSERT_EQUAL_PTR(view.comment, line);
+  TEST_ASSERT_EQUAL(SAUCE_COMMENT_LINE_LENGTH - 1, lineLength);
+  TEST_ASSERT_EQUAL_MEMORY(expected, line, lineLength);
+
+  TEST_ASSERT_EQUAL(1, SAUCE_Comment_iter_next(&iter, &line, &lineLength));
+  TEST_ASSERT_EQUAL_PTR(view.comment + SAUCE_COMMENT_LINE_LENGTH, line);
+  TEST_ASSERT_EQUAL(97 - SAUCE_COMMENT_LINE_LENGTH, lineLength);
+  TEST_ASSERT_EQUAL_MEMORY(expected + SAUCE_COMMENT_LINE_LENGTH, line, lineLength);
+
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_iter_next(&iter, &line, &lineLength));
+}
+
+
+void should_TrimNullPadding_when_LineIsPaddedWithNulls() {
+  // a comment whose only line is a word followed by null characters
+  SAUCE sauce;
+  SAUCE_set_default(&sauce);
+  sauce.Comments = 1;
+  memcpy(buffer, SAUCE_COMMENT_ID, 5);
+  memcpy(buffer + 5, "word", 4);
+  memcpy(buffer + SAUCE_COMMENT_BLOCK_SIZE(1), &sauce, SAUCE_RECORD_SIZE);
+
+  TEST_ASSERT_EQUAL(0, SAUCE_view(buffer, SAUCE_TOTAL_SIZE(1), &view));
+
+  const char* line = NULL;
+  uint8_t lineLength = 0;
+  SAUCE_Comment_iter_init(&view, &iter);
+  TEST_ASSERT_EQUAL(1, SAUCE_Comment_iter_next(&iter, &line, &lineLength));
+  TEST_ASSERT_EQUAL(4, lineLength);
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_iter_next(&iter, &line, &lineLength));
+}
+
+
+void should_IterateNothing_when_ViewHasNoComment() {
+  int length = copy_file_into_buffer(SAUCE_TESTFILE2_PATH, buffer);
+  TEST_ASSERT_EQUAL(0, SAUCE_view(buffer, length, &view));
+
+  const char* line = NULL;
+  uint8_t lineLength = 0;
+  SAUCE_Comment_iter_init(&view, &iter);
+  TEST_ASSERT_EQUAL(0, SAUCE_Comment_iter_next(&iter, &line, &lineLength));
+  TEST_ASSERT_NULL(line);
+}
+
+
+
+
+// Failure tests
+
+void should_FailToView_when_BufferHasNoSauce() {
+  int length = copy_file_into_buffer(SAUCE_NOSAUCE_PATH, buffer);
+
+  TEST_ASSERT_EQUAL(SAUCE_ERMISS, SAUCE_view(buffer, length, &view));
+  TEST_ASSERT_NULL(view.record);
+  TEST_ASSERT_NULL(view.comment);
+}
+
+
+void should_ViewOnlyRecord_when_CommentIsInvalid() {
+  int length = copy_file_into_buffer(SAUCE_INVALIDCOMMENT_PATH, buffer);
+
+  TEST_ASSERT_EQUAL(SAUCE_ECMISS, SAUCE_view(buffer, length, &view));
+  TEST_ASSERT_EQUAL_PTR(&buffer[length - SAUCE_RECORD_SIZE], view.record);
+  TEST_ASSERT_NULL(view.comment);
+  TEST_ASSERT_EQUAL(0, view.lines);
+}
+
+
+void should_FailToView_when_BufferIsTooShort() {
+  int length = copy_file_into_buffer(SAUCE_SHORTFILE_PATH, buffer);
+  TEST_ASSERT_EQUAL(SAUCE_ESHORT, SAUCE_view(buffer, length, &view));
+  TEST_ASSERT_EQUAL(SAUCE_EEMPTY, SAUCE_view(buffer, 0, &view));
+}
+
+
+void should_FailToView_when_ArgumentsAreNull() {
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_view(NULL, sizeof(buffer), &view));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_view(buffer, sizeof(buffer), NULL));
+
+  const char* line = NULL;
+  uint8_t lineLength = 0;
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Comment_iter_next(NULL, &line, &lineLength));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Comment_iter_next(&iter, NULL, &lineLength));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Comment_iter_next(&iter, &line, NULL));
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_PointIntoBuffer_when_BufferContainsRecordAndComment);
+  RUN_TEST(should_HaveNoComment_when_BufferContainsOnlyRecord);
+  RUN_TEST(should_TrimEveryLine_when_CommentIsIterated);
+  RUN_TEST(should_TrimNullPadding_when_LineIsPaddedWithNulls);
+  RUN_TEST(should_IterateNothing_when_ViewHasNoComment);
+  RUN_TEST(should_FailToView_when_BufferHasNoSauce);
+  RUN_TEST(should_ViewOnlyRecord_when_CommentIsInvalid);
+  RUN_TEST(should_FailToView_when_BufferIsTooShort);
+  RUN_TEST(should_FailToView_when_ArgumentsAreNull);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
@@ -0,0 +1,250 @@
+#include "unity.h"
+#include "SauceTool.h"
+#include "TestRes.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if defined (__unix__) || (defined (__APPLE__) && defined (__MACH__))
+  #include <sys/stat.h>
+  #include <unistd.h>
+  #define TEST_DIRS
+#endif
+
+// WatchTest, tests watching a directory tree for changed files
+
+
+// Milliseconds a file must go without events before it is reported
+#define WATCH_DELAY_MS      20
+
+// Longest time a test waits for an event, in milliseconds
+#define WATCH_TIMEOUT_MS    2000
+
+// Largest number of events recorded by a test
+#define WATCH_MAX_EVENTS    16
+
+// Files and directories written by the tests, inside of SAUCE_WATCH_ACTUAL_PATH
+#define WATCH_FILE_A        SAUCE_WATCH_ACTUAL_PATH "/a.ans"
+#define WATCH_FILE_B        SAUCE_WATCH_ACTUAL_PATH "/b.ans"
+#define WATCH_SUBDIR        SAUCE_WATCH_ACTUAL_PATH "/sub"
+#define WATCH_SUBDIR_FILE   WATCH_SUBDIR "/c.ans"
+
+
+// Events recorded by record_callback
+typedef struct WatchResults {
+  int     count;
+  int     events[WATCH_MAX_EVENTS];
+  char    paths[WATCH_MAX_EVENTS][64];
+  int     results[WATCH_MAX_EVENTS];
+  SAUCE   records[WATCH_MAX_EVENTS];
+  int     stopAfter;
+} WatchResults;
+
+static WatchResults results;
+static SAUCE_Watcher* watcher;
+static SAUCE_WatchOptions options;
+
+
+static int record_callback(enum SAUCE_WatchEvent event, const SAUCE_ScanEntry* entry, void* data) {
+  WatchResults* res = (WatchResults*)data;
+  if (res->count < WATCH_MAX_EVENTS) {
+    res->events[res->count] = event;
+    snprintf(res->paths[res->count], sizeof(res->paths[0]), "%s", entry->path);
+    res->results[res->count] = entry->result;
+    if (entry->record_exists) res->records[res->count] = entry->record;
+  }
+  res->count++;
+  return res->stopAfter > 0 && res->count >= res->stopAfter;
+}
+
+
+// Find a recorded event for a path. Return its index, or -1 if there is none.
+static int find_event(enum SAUCE_WatchEvent event, const char* path) {
+  for (int i = 0; i < results.count && i < WATCH_MAX_EVENTS; i++) {
+    if (results.events[i] == (int)event && strcmp(results.paths[i], path) == 0) return i;
+  }
+  return -1;
+}
+
+
+// Poll until `count` events were recorded or the timeout passes
+static void poll_for(int count) {
+  for (int i = 0; i < 100 && results.count < count; i++) {
+    int64_t res = SAUCE_Watcher_poll(watcher, WATCH_TIMEOUT_MS / 100, record_callback, &results);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, res);
+  }
+}
+
+
+void setUp() {
+  memset(&results, 0, sizeof(results));
+  memset(&options, 0, sizeof(options));
+  options.delay_ms = WATCH_DELAY_MS;
+
+  remove(WATCH_FILE_A);
+  remove(WATCH_FILE_B);
+  remove(WATCH_SUBDIR_FILE);
+  #ifdef TEST_DIRS
+  rmdir(WATCH_SUBDIR);
+  #endif
+
+  // every watch test is ignored if the system does not support watching
+  watcher = NULL;
+  if (SAUCE_Watcher_open(SAUCE_WATCH_ACTUAL_PATH, &options, &watcher) == SAUCE_EOTHER) {
+    TEST_IGNORE_MESSAGE("SAUCE_Watcher is not supported on this system");
+  }
+}
+
+void tearDown() {
+  SAUCE_Watcher_close(watcher);
+}
+
+
+
+
+// Success cases
+
+void should_ReportRecord_when_FileIsWritten() {
+  TEST_ASSERT_EQUAL(0, copy_file(SAUCE_TESTFILE1_PATH, WATCH_FILE_A));
+  poll_for(1);
+
+  TEST_ASSERT_EQUAL(1, results.count);
+  TEST_ASSERT_EQUAL(SAUCE_WATCH_CHANGED, results.events[0]);
+  TEST_ASSERT_EQUAL_STRING(WATCH_FILE_A, results.paths[0]);
+  TEST_ASSERT_EQUAL(0, results.results[0]);
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile1_expected_record(), &results.records[0]));
+}
+
+
+void should_ReportFileOnce_when_FileIsWrittenManyTimes() {
+  TEST_ASSERT_EQUAL(0, copy_file(SAUCE_TESTFILE1_PATH, WATCH_FILE_A));
+  SAUCE sauce = *test_get_testfile1_expected_record();
+  for (int i = 0; i < 5; i++) {
+    sauce.TInfo1 = (uint16_t)i;
+    TEST_ASSERT_EQUAL(0, SAUCE_fwrite(WATCH_FILE_A, &sauce));
+  }
+  poll_for(1);
+
+  // the last write is the one that is reported
+  TEST_ASSERT_EQUAL(0, SAUCE_Watcher_poll(watcher, WATCH_DELAY_MS * 5, record_callback, &results));
+  TEST_ASSERT_EQUAL(1, results.count);
+  TEST_ASSERT_TRUE(SAUCE_equal(&sauce, &results.records[0]));
+}
+
+
+void should_ReportRemoved_when_FileIsDeleted() {
+  TEST_ASSERT_EQUAL(0, copy_file(SAUCE_TESTFILE1_PATH, WATCH_FILE_A));
+  poll_for(1);
+
+  TEST_ASSERT_EQUAL(0, remove(WATCH_FILE_A));
+  poll_for(2);
+
+  TEST_ASSERT_EQUAL(2, results.count);
+  TEST_ASSERT_EQUAL(SAUCE_WATCH_REMOVED, results.events[1]);
+  TEST_ASSERT_EQUAL_STRING(WATCH_FILE_A, results.paths[1]);
+}
+
+
+void should_ReportBothPaths_when_FileIsRenamed() {
+  TEST_ASSERT_EQUAL(0, copy_file(SAUCE_TESTFILE2_PATH, WATCH_FILE_A));
+  poll_for(1);
+
+  TEST_ASSERT_EQUAL(0, rename(WATCH_FILE_A, WATCH_FILE_B));
+  poll_for(3);
+
+  TEST_ASSERT_EQUAL(3, results.count);
+  TEST_ASSERT_NOT_EQUAL(-1, find_event(SAUCE_WATCH_REMOVED, WATCH_FILE_A));
+  int changed = find_event(SAUCE_WATCH_CHANGED, WATCH_FILE_B);
+  TEST_ASSERT_NOT_EQUAL(-1, changed);
+  TEST_ASSERT_TRUE(SAUCE_equal(test_get_testfile2_expected_record(), &results.records[changed]));
+}
+
+
+void should_ReportFile_when_WrittenToNewDirectory() {
+  #ifdef TEST_DIRS
+  TEST_ASSERT_EQUAL(0, mkdir(WATCH_SUBDIR, 0755));
+  TEST_ASSERT_EQUAL(0, copy_file(SAUCE_TESTFILE1_PATH, WATCH_SUBDIR_FILE));
+  poll_for(1);
+
+  TEST_ASSERT_EQUAL(1, results.count);
+  TEST_ASSERT_EQUAL(SAUCE_WATCH_CHANGED, results.events[0]);
+  TEST_ASSERT_EQUAL_STRING(WATCH_SUBDIR_FILE, results.paths[0]);
+
+  // the new directory is watched as well
+  TEST_ASSERT_EQUAL(0, remove(WATCH_SUBDIR_FILE));
+  TEST_ASSERT_EQUAL(0, rmdir(WATCH_SUBDIR));
+  poll_for(3);
+
+  TEST_ASSERT_NOT_EQUAL(-1, find_event(SAUCE_WATCH_REMOVED, WATCH_SUBDIR_FILE));
+  TEST_ASSERT_NOT_EQUAL(-1, find_event(SAUCE_WATCH_DIR_REMOVED, WATCH_SUBDIR));
+  #else
+  TEST_IGNORE_MESSAGE("Directories cannot be created on this system");
+  #endif
+}
+
+
+void should_KeepEvents_when_CallbackStops() {
+  TEST_ASSERT_EQUAL(0, copy_file(SAUCE_TESTFILE1_PATH, WATCH_FILE_A));
+  TEST_ASSERT_EQUAL(0, copy_file(SAUCE_TESTFILE1_PATH, WATCH_FILE_B));
+  results.stopAfter = 1;
+  poll_for(1);
+  TEST_ASSERT_EQUAL(1, results.count);
+
+  results.stopAfter = 0;
+  TEST_ASSERT_EQUAL(1, SAUCE_Watcher_poll(watcher, WATCH_TIMEOUT_MS, record_callback, &results));
+  TEST_ASSERT_EQUAL(2, results.count);
+}
+
+
+void should_ReturnZero_when_NothingChanges() {
+  TEST_ASSERT_EQUAL(0, SAUCE_Watcher_poll(watcher, 0, record_callback, &results));
+  TEST_ASSERT_EQUAL(0, SAUCE_Watcher_poll(watcher, WATCH_DELAY_MS, record_callback, &results));
+  TEST_ASSERT_EQUAL(0, results.count);
+  TEST_ASSERT_GREATER_OR_EQUAL(0, SAUCE_Watcher_fd(watcher));
+}
+
+
+
+
+// Failure cases
+
+void should_FailToOpen_when_RootDoesNotExist() {
+  SAUCE_Watcher* other = NULL;
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, SAUCE_Watcher_open("actual/DIRDOESNOTEXIST", NULL, &other));
+  TEST_ASSERT_NULL(other);
+  TEST_ASSERT_EQUAL(SAUCE_EFOPEN, SAUCE_Watcher_open(SAUCE_TESTFILE1_PATH, NULL, &other));
+}
+
+
+void should_FailToWatch_when_ArgumentsAreNULL() {
+  SAUCE_Watcher* other = NULL;
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Watcher_open(NULL, NULL, &other));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Watcher_open(SAUCE_WATCH_ACTUAL_PATH, NULL, NULL));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Watcher_poll(NULL, 0, record_callback, &results));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Watcher_poll(watcher, 0, NULL, &results));
+  TEST_ASSERT_EQUAL(SAUCE_ENULL, SAUCE_Watcher_fd(NULL));
+  SAUCE_Watcher_close(NULL);
+}
+
+
+
+
+
+
+
+int main(int argc, char** argv) {
+  UNITY_BEGIN();
+
+  RUN_TEST(should_ReportRecord_when_FileIsWritten);
+  RUN_TEST(should_ReportFileOnce_when_FileIsWrittenManyTimes);
+  RUN_TEST(should_ReportRemoved_when_FileIsDeleted);
+  RUN_TEST(should_ReportBothPaths_when_FileIsRenamed);
+  RUN_TEST(should_ReportFile_when_WrittenToNewDirectory);
+  RUN_TEST(should_KeepEvents_when_CallbackStops);
+  RUN_TEST(should_ReturnZero_when_NothingChanges);
+  RUN_TEST(should_FailToOpen_when_RootDoesNotExist);
+  RUN_TEST(should_FailToWatch_when_ArgumentsAreNULL);
+
+  SAUCE_clear_error();
+  return UNITY_END();
+}
@@ -0,0 +1,761 @@
+#include "SauceTool.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// saucetool, a command-line tool for reading, writing and removing the SAUCE data of many files at once.
+// Files are worked on by a pool of threads, and paths can be given as arguments or on stdin.
+//
+// Usage: saucetool <command> [options] [file...]
+
+
+// Number of paths worked on at a time. In ordered mode, the results of a window are printed once
+// every path in it is done, which keeps memory use bounded for any number of paths.
+#define WINDOW_SIZE         4096
+
+// Size at which a worker writes out its output in unordered mode
+#define FLUSH_SIZE          (64 * 1024)
+
+// Exit statuses
+#define EXIT_FILE_FAILED    1     // at least one file could not be worked on
+#define EXIT_USAGE          2     // the command line was invalid
+
+
+static const char* usage =
+  "Usage: saucetool <command> [options] [file...]\n"
+  "\n"
+  "Commands:\n"
+  "  read       Print the SAUCE record of each file\n"
+  "  write      Set fields of the SAUCE record of each file, adding a record if there is none\n"
+  "  strip      Remove the SAUCE record and comment of each file\n"
+  "  comment    Print the comment of each file, or replace or remove it with -s or -r\n"
+  "  scan       Print the SAUCE record of every file in each directory tree\n"
+  "  export     Print the SAUCE record and comment of each file as CSV, with a header\n"
+  "\n"
+  "Records are printed as tab-separated lines of: path, title, author, group, date, file size,\n"
+  "data type, file type, tinfo1, tinfo2, tinfo3, tinfo4, comment lines, tflags and tinfos.\n"
+  "Comments are printed as one line per comment line: path, a tab and the line.\n"
+  "If no files are given, paths are read from stdin, one per line.\n"
+  "\n"
+  "Options:\n"
+  "  -0         Read NUL-delimited paths from stdin, as written by find -print0\n"
+  "  -j N       Work on N files at once (default: the number of processors)\n"
+  "  -u         Print results as soon as they are ready, in any order\n"
+  "  -t TITLE   write: set the title\n"
+  "  -a AUTHOR  write: set the author\n"
+  "  -g GROUP   write: set the group\n"
+  "  -d DATE    write: set the date, as CCYYMMDD\n"
+  "  -s TEXT    comment: replace the comment with TEXT\n"
+  "  -r         comment: remove the comment\n"
+  "  -h         Print this help\n";
+
+
+// Growable output buffer
+typedef struct Buffer {
+  char*   data;
+  size_t  length;
+  size_t  capacity;
+} Buffer;
+
+// Commands
+enum Command { CMD_READ, CMD_WRITE, CMD_STRIP, CMD_COMMENT, CMD_SCAN, CMD_EXPORT };
+
+static const char* command_names[] = { "read", "write", "strip", "comment", "scan", "export" };
+
+// Parsed command line
+typedef struct Options {
+  enum Command command;
+  char delimiter;               // delimiter of the paths read from stdin
+  uint32_t jobs;                // number of files worked on at once
+  int unordered;                // true to print results as soon as they are ready
+  SAUCE patch;                  // values of the fields set by write
+  uint32_t patchFields;         // the fields set by write, see SAUCE_FIELD_BIT()
+  char* comment;                // comment set by `comment -s`, padded to whole lines, or NULL
+  uint8_t commentLines;
+  int removeComment;            // true for `comment -r`
+} Options;
+
+// A window of paths worked on by the workers
+typedef struct Work {
+  const Options* options;
+  char** paths;
+  size_t count;
+  size_t next;                  // index of the next path to claim
+  Buffer* outputs;              // output of every path of the window, in ordered mode
+  Buffer* errors;               // error messages of every path of the window, in ordered mode
+  pthread_mutex_t lock;         // guards `next`, `failed` and the standard streams
+  uint64_t failed;              // number of paths that failed
+} Work;
+
+// Source of the paths to work on
+typedef struct PathSource {
+  char** args;                  // paths given on the command line, or NULL to read stdin
+  int nArgs;
+  int nextArg;
+  char delimiter;
+  char* line;                   // buffer of getdelim()
+  size_t lineCapacity;
+  char* owned[WINDOW_SIZE];     // paths of the current window read from stdin
+  size_t nOwned;
+} PathSource;
+
+// Records found by scan, sorted before they are printed in ordered mode
+typedef struct ScanState {
+  const Options* options;
+  pthread_mutex_t lock;         // guards the fields below and stdout
+  char** lines;
+  size_t count;
+  size_t capacity;
+  uint64_t failed;              // number of files with invalid SAUCE data or that could not be read
+} ScanState;
+
+
+
+
+// Buffers
+
+static void out_of_memory(void) {
+  fprintf(stderr, "saucetool: out of memory\n");
+  exit(EXIT_FAILURE);
+}
+
+
+// Make room for `n` more bytes in a buffer
+static void buffer_reserve(Buffer* buffer, size_t n) {
+  if (buffer->length + n <= buffer->capacity) return;
+  size_t capacity = (buffer->capacity == 0) ? 256 : buffer->capacity;
+  while (capacity < buffer->length + n) capacity *= 2;
+  char* data = realloc(buffer->data, capacity);
+  if (data == NULL) out_of_memory();
+  buffer->data = data;
+  buffer->capacity = capacity;
+}
+
+
+static void buffer_append(Buffer* buffer, const char* data, size_t n) {
+  buffer_reserve(buffer, n);
+  memcpy(buffer->data + buffer->length, data, n);
+  buffer->length += n;
+}
+
+
+static void buffer_char(Buffer* buffer, char c) {
+  buffer_append(buffer, &c, 1);
+}
+
+
+#if defined(__GNUC__) || defined(__llvm__)
+__attribute__((format(printf, 2, 3)))
+#endif
+static void buffer_printf(Buffer* buffer, const char* format, ...) {
+  va_list ap;
+  va_start(ap, format);
+  int n = vsnprintf(NULL, 0, format, ap);
+  va_end(ap);
+  if (n < 0) return;
+
+  buffer_reserve(buffer, (size_t)n + 1);
+  va_start(ap, format);
+  vsnprintf(buffer->data + buffer->length, (size_t)n + 1, format, ap);
+  va_end(ap);
+  buffer->length += (size_t)n;
+}
+
+
+// Length of a fixed-size field without its trailing spaces and null characters
+static size_t field_length(const char* field, size_t size) {
+  while (size > 0 && (field[size - 1] == ' ' || field[size - 1] == 0)) size--;
+  return size;
+}
+
+
+// Append a fixed-size field of a record, replacing control characters so that it stays on one column
+static void buffer_field(Buffer* buffer, const char* field, size_t size) {
+  size = field_length(field, size);
+  buffer_reserve(buffer, size);
+  for (size_t i = 0; i < size; i++) {
+    unsigned char c = (unsigned char)field[i];
+    buffer->data[buffer->length++] = (c < 0x20 || c == 0x7F) ? ' ' : (char)c;
+  }
+}
+
+
+// Append text as a CSV value, quoting it if needed
+static void buffer_csv(Buffer* buffer, const char* text, size_t n) {
+  int quote = 0;
+  for (size_t i = 0; i < n && !quote; i++) {
+    quote = text[i] == ',' || text[i] == '"' || text[i] == '\n' || text[i] == '\r';
+  }
+  if (!quote) {
+    buffer_append(buffer, text, n);
+    return;
+  }
+
+  buffer_char(buffer, '"');
+  for (size_t i = 0; i < n; i++) {
+    if (text[i] == '"') buffer_char(buffer, '"');
+    buffer_char(buffer, text[i]);
+  }
+  buffer_char(buffer, '"');
+}
+
+
+
+
+// Formatting
+
+// Append a record as a tab-separated line
+static void format_record(Buffer* out, const char* path, const SAUCE* sauce) {
+  buffer_field(out, path, strlen(path));
+  buffer_char(out, '\t');
+  buffer_field(out, sauce->Title, sizeof(sauce->Title));
+  buffer_char(out, '\t');
+  buffer_field(out, sauce->Author, sizeof(sauce->Author));
+  buffer_char(out, '\t');
+  buffer_field(out, sauce->Group, sizeof(sauce->Group));
+  buffer_char(out, '\t');
+  buffer_field(out, sauce->Date, sizeof(sauce->Date));
+  buffer_printf(out, "\t%lu\t%u\t%u\t%u\t%u\t%u\t%u\t%u\t%u\t", (unsigned long)sauce->FileSize,
+                sauce->DataType, sauce->FileType, sauce->TInfo1, sauce->TInfo2, sauce->TInfo3,
+                sauce->TInfo4, sauce->Comments, sauce->TFlags);
+  buffer_field(out, sauce->TInfoS, sizeof(sauce->TInfoS));
+  buffer_char(out, '\n');
+}
+
+
+// Append a record and its comment as a CSV row
+static void format_csv(Buffer* out, const char* path, const SAUCE* sauce, const char* comment, int lines) {
+  buffer_csv(out, path, strlen(path));
+  const char* fields[] = { sauce->Title, sauce->Author, sauce->Group, sauce->Date };
+  const size_t sizes[] = { sizeof(sauce->Title), sizeof(sauce->Author), sizeof(sauce->Group), sizeof(sauce->Date) };
+  for (int i = 0; i < 4; i++) {
+    buffer_char(out, ',');
+    buffer_csv(out, fields[i], field_length(fields[i], sizes[i]));
+  }
+  buffer_printf(out, ",%lu,%u,%u,%u,%u,%u,%u,%u,%u,", (unsigned long)sauce->FileSize,
+                sauce->DataType, sauce->FileType, sauce->TInfo1, sauce->TInfo2, sauce->TInfo3,
+                sauce->TInfo4, sauce->Comments, sauce->TFlags);
+  buffer_csv(out, sauce->TInfoS, field_length(sauce->TInfoS, sizeof(sauce->TInfoS)));
+  buffer_char(out, ',');
+
+  // comment lines are joined with newlines, without their padding
+  Buffer joined = { NULL, 0, 0 };
+  for (int i = 0; i < lines; i++) {
+    const char* line = comment + (size_t)i * SAUCE_COMMENT_LINE_LENGTH;
+    if (i > 0) buffer_char(&joined, '\n');
+    buffer_append(&joined, line, field_length(line, SAUCE_COMMENT_LINE_LENGTH));
+  }
+  buffer_csv(out, joined.data, joined.length);
+  free(joined.data);
+  buffer_char(out, '\n');
+}
+
+
+// Fill a fixed-size field with a string, padded with spaces
+static void set_field(char* field, size_t size, const char* value) {
+  size_t length = strlen(value);
+  if (length > size) length = size;
+  memset(field, ' ', size);
+  memcpy(field, value, length);
+}
+
+
+
+
+// Commands
+
+// Append the error of a file to `err` and return -1
+static int file_error(Buffer* err) {
+  buffer_printf(err, "saucetool: %s\n", SAUCE_get_error());
+  return -1;
+}
+
+
+// Work on a single file. Its output is appended to `out` and its error message to `err`.
+// Return 0 on success, or -1 if the file failed.
+static int work_file(const Options* options, const char* path, Buffer* out, Buffer* err) {
+  SAUCE sauce;
+  char comment[SAUCE_COMMENT_STRING_LENGTH(255) + 1];
+  int res;
+
+  switch (options->command) {
+    case CMD_READ:
+      if (SAUCE_fread(path, &sauce) < 0) return file_error(err);
+      format_record(out, path, &sauce);
+      return 0;
+
+    case CMD_COMMENT:
+      if (options->removeComment) {
+        res = SAUCE_Comment_fremove(path);
+        if (res < 0 && res != SAUCE_ECMISS && res != SAUCE_ERMISS && res != SAUCE_ESHORT && res != SAUCE_EEMPTY) {
+          return file_error(err);
+        }
+        return 0;
+      }
+
+      if (options->comment != NULL) {
+        SAUCE_Edit* edit;
+        if (SAUCE_Edit_open(path, &edit) < 0) return file_error(err);
+        SAUCE_Edit_set_comment(edit, options->comment, options->commentLines);
+        res = SAUCE_Edit_commit(edit);
+
+        // a comment can only be added after a record, so a default record is added with it
+        if (res == SAUCE_ERMISS || res == SAUCE_ESHORT || res == SAUCE_EEMPTY) {
+          SAUCE_set_default(&sauce);
+          SAUCE_Edit_set_record(edit, &sauce);
+          res = SAUCE_Edit_commit(edit);
+        }
+        SAUCE_Edit_close(edit);
+        if (res < 0) return file_error(err);
+        return 0;
+      }
+
+      res = SAUCE_Comment_fread(path, comment, 255);
+      if (res < 0) return file_error(err);
+      for (int i = 0; i < res; i++) {
+        buffer_field(out, path, strlen(path));
+        buffer_char(out, '\t');
+        buffer_field(out, comment + (size_t)i * SAUCE_COMMENT_LINE_LENGTH, SAUCE_COMMENT_LINE_LENGTH);
+        buffer_char(out, '\n');
+      }
+      return 0;
+
+    case CMD_EXPORT:
+      if (SAUCE_fread(path, &sauce) < 0) return file_error(err);
+      res = SAUCE_Comment_fread(path, comment, 255);
+      format_csv(out, path, &sauce, comment, (res > 0) ? res : 0);
+      return 0;
+
+    default:
+      return 0;
+  }
+}
+
+
+
+
+// Workers
+
+static void work_flush(Work* work, Buffer* out, Buffer* err) {
+  pthread_mutex_lock(&work->lock);
+  fwrite(out->data, 1, out->length, stdout);
+  fwrite(err->data, 1, err->length, stderr);
+  pthread_mutex_unlock(&work->lock);
+  out->length = 0;
+  err->length = 0;
+}
+
+
+// Claim and work on paths of a window until none are left
+static void* work_thread(void* arg) {
+  Work* work = arg;
+  int unordered = work->options->unordered;
+  Buffer out = { NULL, 0, 0 };
+  Buffer err = { NULL, 0, 0 };
+
+  while (1) {
+    pthread_mutex_lock(&work->lock);
+    size_t i = work->next++;
+    pthread_mutex_unlock(&work->lock);
+    if (i >= work->count) break;
+
+    Buffer* fileOut = unordered ? &out : &work->outputs[i];
+    Buffer* fileErr = unordered ? &err : &work->errors[i];
+    if (work_file(work->options, work->paths[i], fileOut, fileErr) < 0) {
+      pthread_mutex_lock(&work->lock);
+      work->failed++;
+      pthread_mutex_unlock(&work->lock);
+    }
+
+    // errors are written out right away, so they are not held back by other output
+    if (unordered && (err.length > 0 || out.length >= FLUSH_SIZE)) work_flush(work, &out, &err);
+  }
+
+  if (unordered) work_flush(work, &out, &err);
+  free(out.data);
+  free(err.data);
+  return NULL;
+}
+
+
+// Work on a window of paths with up to `options->jobs` threads, including the calling thread
+static void work_window(Work* work) {
+  work->next = 0;
+  if (!work->options->unordered) {
+    for (size_t i = 0; i < work->count; i++) {
+      work->outputs[i].length = 0;
+      work->errors[i].length = 0;
+    }
+  }
+
+  pthread_t threads[256];
+  size_t nThreads = work->options->jobs;
+  if (nThreads > work->count) nThreads = work->count;
+  if (nThreads > sizeof(threads) / sizeof(threads[0])) nThreads = sizeof(threads) / sizeof(threads[0]);
+
+  // if a thread cannot be created, the threads that were started pick up its work
+  size_t started = 0;
+  for (size_t i = 1; i < nThreads; i++) {
+    if (pthread_create(&threads[started], NULL, work_thread, work) != 0) break;
+    started++;
+  }
+  work_thread(work);
+  for (size_t i = 0; i < started; i++) pthread_join(threads[i], NULL);
+
+  if (!work->options->unordered) {
+    for (size_t i = 0; i < work->count; i++) {
+      fwrite(work->outputs[i].data, 1, work->outputs[i].length, stdout);
+      fwrite(work->errors[i].data, 1, work->errors[i].length, stderr);
+    }
+  }
+}
+
+
+
+
+// Batches
+
+// Patch or strip a window of paths with SAUCE_fpatch_many() or SAUCE_fremove_many(), which work on
+// the library's own pool of threads. Return the number of paths that failed.
+static uint64_t batch_window(const Options* options, const char* const* paths, size_t count, int* results) {
+  SAUCE_BatchOptions batchOptions;
+  memset(&batchOptions, 0, sizeof(batchOptions));
+  batchOptions.threads = options->jobs;
+  int res;
+  if (options->command == CMD_WRITE) {
+    res = SAUCE_fpatch_many(paths, (uint32_t)count, &options->patch, options->patchFields, results, &batchOptions);
+  } else {
+    res = SAUCE_fremove_many(paths, (uint32_t)count, results, &batchOptions);
+  }
+
+  // the whole window failed, and no result was set
+  if (res < 0) {
+    fprintf(stderr, "saucetool: %s\n", SAUCE_get_error());
+    return count;
+  }
+
+  // files without SAUCE data are already stripped
+  uint64_t failed = 0;
+  for (size_t i = 0; i < count; i++) {
+    switch (results[i]) {
+      case 0:
+      case SAUCE_UNCHANGED:
+      case SAUCE_ERMISS:
+      case SAUCE_ESHORT:
+      case SAUCE_EEMPTY:
+        break;
+      case SAUCE_EFOPEN:
+        fprintf(stderr, "saucetool: Failed to open %s for reading & writing\n", paths[i]);
+        failed++;
+        break;
+      default:
+        fprintf(stderr, "saucetool: Failed to %s %s\n",
+                (options->command == CMD_WRITE) ? "patch the record of" : "remove the SAUCE data of", paths[i]);
+        failed++;
+        break;
+    }
+  }
+  return failed;
+}
+
+
+
+
+// Paths
+
+// Get the next window of at most WINDOW_SIZE paths. Return the number of paths, or 0 if there are none left.
+static size_t next_paths(PathSource* source, char** paths) {
+  size_t count = 0;
+  if (source->args != NULL) {
+    while (count < WINDOW_SIZE && source->nextArg < source->nArgs) {
+      paths[count++] = source->args[source->nextArg++];
+    }
+    return count;
+  }
+
+  for (size_t i = 0; i < source->nOwned; i++) free(source->owned[i]);
+  source->nOwned = 0;
+
+  ssize_t length;
+  while (count < WINDOW_SIZE &&
+         (length = getdelim(&source->line, &source->lineCapacity, source->delimiter, stdin)) > 0) {
+    if (source->line[length - 1] == source->delimiter) source->line[--length] = 0;
+    if (length == 0) continue;
+
+    char* path = malloc((size_t)length + 1);
+    if (path == NULL) out_of_memory();
+    memcpy(path, source->line, (size_t)length + 1);
+    source->owned[source->nOwned++] = path;
+    paths[count++] = path;
+  }
+  return count;
+}
+
+
+static void free_paths(PathSource* source) {
+  for (size_t i = 0; i < source->nOwned; i++) free(source->owned[i]);
+  source->nOwned = 0;
+  free(source->line);
+}
+
+
+
+
+// Scanning
+
+// Describe why a file found by scan could not be read, or NULL if it simply has no SAUCE data
+static const char* scan_error(int result) {
+  switch (result) {
+    case 0:
+    case SAUCE_ERMISS:
+    case SAUCE_ESHORT:
+    case SAUCE_EEMPTY:
+      return NULL;
+    case SAUCE_EFOPEN:
+      return "Failed to open the file for reading";
+    case SAUCE_ECMISS:
+      return "The comment of the file is missing";
+    case SAUCE_EFFAIL:
+      return "Failed to read the file";
+    default:
+      return "The SAUCE data of the file is invalid";
+  }
+}
+
+
+static int scan_callback(const SAUCE_ScanEntry* entry, void* data) {
+  ScanState* state = data;
+
+  // errors are written out right away, like the errors of read
+  const char* error = scan_error(entry->result);
+  if (error != NULL) {
+    pthread_mutex_lock(&state->lock);
+    fprintf(stderr, "saucetool: %s: %s\n", entry->path, error);
+    state->failed++;
+    pthread_mutex_unlock(&state->lock);
+  }
+  if (!entry->record_exists) return 0;
+
+  Buffer line = { NULL, 0, 0 };
+  format_record(&line, entry->path, &entry->record);
+
+  pthread_mutex_lock(&state->lock);
+  if (state->options->unordered) {
+    fwrite(line.data, 1, line.length, stdout);
+    free(line.data);
+  } else {
+    if (state->count == state->capacity) {
+      size_t capacity = (state->capacity == 0) ? 1024 : state->capacity * 2;
+      char** lines = realloc(state->lines, capacity * sizeof(char*));
+      if (lines == NULL) out_of_memory();
+      state->lines = lines;
+      state->capacity = capacity;
+    }
+    buffer_char(&line, 0);
+    state->lines[state->count++] = line.data;
+  }
+  pthread_mutex_unlock(&state->lock);
+  return 0;
+}
+
+
+static int compare_lines(const void* a, const void* b) {
+  return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+
+// Scan every directory tree given. Return the number of trees that could not be scanned, and of files
+// that could not be read.
+static uint64_t run_scan(const Options* options, PathSource* source) {
+  ScanState state;
+  memset(&state, 0, sizeof(state));
+  state.options = options;
+  pthread_mutex_init(&state.lock, NULL);
+
+  SAUCE_ScanOptions scanOptions;
+  memset(&scanOptions, 0, sizeof(scanOptions));
+  scanOptions.threads = options->jobs;
+
+  uint64_t failed = 0;
+  char* roots[WINDOW_SIZE];
+  size_t count;
+  while ((count = next_paths(source, roots)) > 0) {
+    for (size_t i = 0; i < count; i++) {
+      if (SAUCE_scan_tree(roots[i], scan_callback, &state, &scanOptions) < 0) {
+        fprintf(stderr, "saucetool: %s\n", SAUCE_get_error());
+        failed++;
+      }
+    }
+  }
+
+  // lines start with their path, so sorting the lines sorts them by path
+  qsort(state.lines, state.count, sizeof(char*), compare_lines);
+  for (size_t i = 0; i < state.count; i++) {
+    fputs(state.lines[i], stdout);
+    free(state.lines[i]);
+  }
+  free(state.lines);
+  pthread_mutex_destroy(&state.lock);
+  return failed + state.failed;
+}
+
+
+
+
+// Command line
+
+// Pad a comment to whole comment lines
+static char* make_comment(const char* text, uint8_t* lines) {
+  size_t length = strlen(text);
+  if (length > SAUCE_COMMENT_STRING_LENGTH(255)) return NULL;
+
+  *lines = SAUCE_num_lines(text);
+  if (*lines == 0) *lines = 1;
+  char* comment = malloc(SAUCE_COMMENT_STRING_LENGTH(*lines) + 1);
+  if (comment == NULL) out_of_memory();
+  memset(comment, ' ', SAUCE_COMMENT_STRING_LENGTH(*lines));
+  memcpy(comment, text, length);
+  comment[SAUCE_COMMENT_STRING_LENGTH(*lines)] = 0;
+  return comment;
+}
+
+
+static int usage_error(const char* message) {
+  if (message != NULL) fprintf(stderr, "saucetool: %s\n", message);
+  fputs(usage, stderr);
+  return EXIT_USAGE;
+}
+
+
+int main(int argc, char** argv) {
+  if (argc < 2) return usage_error(NULL);
+  if (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0) {
+    fputs(usage, stdout);
+    return EXIT_SUCCESS;
+  }
+
+  Options options;
+  memset(&options, 0, sizeof(options));
+  options.delimiter = '\n';
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  options.jobs = (cpus > 0) ? (uint32_t)cpus : 1;
+
+  size_t nCommands = sizeof(command_names) / sizeof(command_names[0]);
+  size_t c = 0;
+  while (c < nCommands && strcmp(argv[1], command_names[c]) != 0) c++;
+  if (c == nCommands) return usage_error("unknown command");
+  options.command = (enum Command)c;
+
+  // options are parsed after the command
+  int opt;
+  char* end;
+  const char* commentText = NULL;
+  optind = 2;
+  while ((opt = getopt(argc, argv, "0j:ut:a:g:d:s:rh")) != -1) {
+    switch (opt) {
+      case '0': options.delimiter = 0; break;
+      case 'j':
+        options.jobs = (uint32_t)strtoul(optarg, &end, 10);
+        if (*end != 0 || options.jobs == 0) return usage_error("-j must be a positive number");
+        break;
+      case 'u': options.unordered = 1; break;
+      case 't':
+        set_field(options.patch.Title, sizeof(options.patch.Title), optarg);
+        options.patchFields |= SAUCE_FIELD_BIT(SAUCE_FIELD_TITLE);
+        break;
+      case 'a':
+        set_field(options.patch.Author, sizeof(options.patch.Author), optarg);
+        options.patchFields |= SAUCE_FIELD_BIT(SAUCE_FIELD_AUTHOR);
+        break;
+      case 'g':
+        set_field(options.patch.Group, sizeof(options.patch.Group), optarg);
+        options.patchFields |= SAUCE_FIELD_BIT(SAUCE_FIELD_GROUP);
+        break;
+      case 'd':
+        if (strlen(optarg) != 8 || strspn(optarg, "0123456789") != 8) {
+          return usage_error("-d must be a date written as CCYYMMDD");
+        }
+        set_field(options.patch.Date, sizeof(options.patch.Date), optarg);
+        options.patchFields |= SAUCE_FIELD_BIT(SAUCE_FIELD_DATE);
+        break;
+      case 's': commentText = optarg; break;
+      case 'r': options.removeComment = 1; break;
+      case 'h':
+        fputs(usage, stdout);
+        return EXIT_SUCCESS;
+      default:
+        return usage_error(NULL);
+    }
+  }
+
+  if (options.patchFields != 0 && options.command != CMD_WRITE) return usage_error("-t, -a, -g and -d can only be used with write");
+  if (options.patchFields == 0 && options.command == CMD_WRITE) return usage_error("write needs at least one of -t, -a, -g and -d");
+  if ((commentText != NULL || options.removeComment) && options.command != CMD_COMMENT) {
+    return usage_error("-s and -r can only be used with comment");
+  }
+  if (commentText != NULL && options.removeComment) return usage_error("-s and -r cannot be used together");
+  if (commentText != NULL) {
+    options.comment = make_comment(commentText, &options.commentLines);
+    if (options.comment == NULL) return usage_error("the comment given to -s is too long");
+  }
+
+  PathSource source;
+  memset(&source, 0, sizeof(source));
+  source.delimiter = options.delimiter;
+  if (optind < argc) {
+    source.args = argv + optind;
+    source.nArgs = argc - optind;
+  }
+
+  uint64_t failed = 0;
+  if (options.command == CMD_SCAN) {
+    failed = run_scan(&options, &source);
+  } else if (options.command == CMD_WRITE || options.command == CMD_STRIP) {
+    char* paths[WINDOW_SIZE];
+    int* results = malloc(WINDOW_SIZE * sizeof(int));
+    if (results == NULL) out_of_memory();
+    size_t count;
+    while ((count = next_paths(&source, paths)) > 0) {
+      failed += batch_window(&options, (const char* const*)paths, count, results);
+    }
+    free(results);
+  } else {
+    if (options.command == CMD_EXPORT) {
+      fputs("path,title,author,group,date,filesize,datatype,filetype,tinfo1,tinfo2,tinfo3,tinfo4,"
+            "comments,tflags,tinfos,comment\n", stdout);
+    }
+
+    Work work;
+    memset(&work, 0, sizeof(work));
+    work.options = &options;
+    pthread_mutex_init(&work.lock, NULL);
+    char** paths = malloc(WINDOW_SIZE * sizeof(char*));
+    if (paths == NULL) out_of_memory();
+    work.paths = paths;
+    if (!options.unordered) {
+      work.outputs = calloc(WINDOW_SIZE, sizeof(Buffer));
+      work.errors = calloc(WINDOW_SIZE, sizeof(Buffer));
+      if (work.outputs == NULL || work.errors == NULL) out_of_memory();
+    }
+
+    while ((work.count = next_paths(&source, paths)) > 0) work_window(&work);
+    failed = work.failed;
+
+    for (size_t i = 0; !options.unordered && i < WINDOW_SIZE; i++) {
+      free(work.outputs[i].data);
+      free(work.errors[i].data);
+    }
+    free(work.outputs);
+    free(work.errors);
+    free(paths);
+    pthread_mutex_destroy(&work.lock);
+  }
+
+  free_paths(&source);
+  free(options.comment);
+  fflush(stdout);
+  return (failed > 0) ? EXIT_FILE_FAILED : EXIT_SUCCESS;
+}